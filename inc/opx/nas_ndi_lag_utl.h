@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2016 Dell Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License. You may obtain
+ * a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * THIS CODE IS PROVIDED ON AN *AS IS* BASIS, WITHOUT WARRANTIES OR
+ * CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ * LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ * FOR A PARTICULAR PURPOSE, MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ * See the Apache Version 2.0 License for specific language governing
+ * permissions and limitations under the License.
+ */
+
+/*
+ * nas_ndi_lag_utl.h
+ */
+
+#ifndef _NAS_NDI_LAG_UTL_H_
+#define _NAS_NDI_LAG_UTL_H_
+
+#include "std_error_codes.h"
+#include "ds_common_types.h"
+#include "nas_ndi_common.h"
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/**
+ * Add several ports to a LAG. A member is created for every port and the
+ * (LAG, port) to member mapping is recorded in the NDI member index.
+ * @param npu_id npu id
+ * @param ndi_lag_id LAG id
+ * @param lag_port_list ports to add
+ * @param[out] ndi_lag_member_ids member id per port, in lag_port_list order.
+ *             A port already a member of the LAG is not added again and
+ *             gets its existing member id, unlike with ndi_add_ports_to_lag
+ *             which fails for it. Ports that could not be added get 0.
+ * @return STD_ERR_OK if all ports were added, error of the last failure otherwise
+ */
+t_std_error ndi_add_ports_to_lag_multi(npu_id_t npu_id, ndi_obj_id_t ndi_lag_id,
+                                       ndi_port_list_t *lag_port_list,
+                                       ndi_obj_id_t *ndi_lag_member_ids);
+
+/**
+ * Remove several ports from a LAG, looking up their members in the NDI
+ * member index. Ports that are not members of the LAG are skipped.
+ * @param npu_id npu id
+ * @param ndi_lag_id LAG id
+ * @param lag_port_list ports to remove
+ * @return STD_ERR_OK if all ports were removed, error of the last failure otherwise
+ */
+t_std_error ndi_del_ports_from_lag_multi(npu_id_t npu_id, ndi_obj_id_t ndi_lag_id,
+                                         ndi_port_list_t *lag_port_list);
+
+/**
+ * Get the member id of a port in a LAG from the NDI member index.
+ * @param npu_id npu id
+ * @param ndi_lag_id LAG id
+ * @param ndi_port port
+ * @param[out] ndi_lag_member_id member id
+ * @return STD_ERR_OK if found, error otherwise
+ */
+t_std_error ndi_lag_member_id_get(npu_id_t npu_id, ndi_obj_id_t ndi_lag_id,
+                                  const ndi_port_t *ndi_port,
+                                  ndi_obj_id_t *ndi_lag_member_id);
+
+/*  Desired forwarding mode of one LAG member */
+typedef struct _ndi_lag_member_mode_t {
+    ndi_obj_id_t member_id;
+    bool ingress_disable;
+    bool egress_disable;
+} ndi_lag_member_mode_t;
+
+typedef struct _ndi_lag_member_mode_stats_t {
+    uint64_t sai_sets;          /*  attribute sets sent to SAI */
+    uint64_t noop_suppressed;   /*  attribute sets dropped, already in that state */
+    uint64_t get_cache_hits;    /*  mode gets answered from the cache */
+} ndi_lag_member_mode_stats_t;
+
+/**
+ * Set ingress/egress disable on several LAG members. Attributes already in
+ * the requested state per the NDI member mode cache are not sent to SAI.
+ * @param npu_id npu id
+ * @param modes member mode tuples
+ * @param count number of tuples
+ * @param[out] status per tuple result, may be NULL
+ * @return STD_ERR_OK if all members were set, error of the last failure otherwise
+ */
+t_std_error ndi_set_lag_member_mode_multi(npu_id_t npu_id, const ndi_lag_member_mode_t *modes,
+                                          size_t count, t_std_error *status);
+
+/**
+ * Get ingress/egress disable of a LAG member, from the NDI member mode
+ * cache when known.
+ * @param npu_id npu id
+ * @param ndi_lag_member_id member id
+ * @param[out] ingress_disable may be NULL
+ * @param[out] egress_disable may be NULL
+ * @return standard error
+ */
+t_std_error ndi_get_lag_member_mode(npu_id_t npu_id, ndi_obj_id_t ndi_lag_member_id,
+                                    bool *ingress_disable, bool *egress_disable);
+
+void ndi_lag_member_mode_stats_get(ndi_lag_member_mode_stats_t *stats);
+
+/*  Member mode cache. A NULL mode means unknown/unchanged. */
+bool ndi_lag_member_mode_cache_get(npu_id_t npu_id, ndi_obj_id_t ndi_lag_member_id,
+                                   bool *ingress_disable, bool *egress_disable);
+
+void ndi_lag_member_mode_cache_set(npu_id_t npu_id, ndi_obj_id_t ndi_lag_member_id,
+                                   const bool *ingress_disable, const bool *egress_disable);
+
+void ndi_lag_member_mode_stats_add(uint64_t sai_sets, uint64_t noop_suppressed,
+                                   uint64_t get_cache_hits);
+
+/*  Member index maintenance, called once SAI has accepted the change.
+ *  Adding fails only when out of memory, the index is then unchanged.
+ */
+t_std_error ndi_lag_member_index_add(npu_id_t npu_id, ndi_obj_id_t ndi_lag_id,
+                                     const ndi_port_t *ndi_port,
+                                     ndi_obj_id_t ndi_lag_member_id);
+
+void ndi_lag_member_index_del(npu_id_t npu_id, ndi_obj_id_t ndi_lag_member_id);
+
+void ndi_lag_member_index_lag_delete(npu_id_t npu_id, ndi_obj_id_t ndi_lag_id);
+
+/*  Forget the members of a port in every LAG, e.g. when the port is deleted */
+void ndi_lag_member_index_port_delete(npu_id_t npu_id, npu_port_t port_id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /*  _NAS_NDI_LAG_UTL_H_ */
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2016 Dell Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License. You may obtain
+ * a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * THIS CODE IS PROVIDED ON AN *AS IS* BASIS, WITHOUT WARRANTIES OR
+ * CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ * LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ * FOR A PARTICULAR PURPOSE, MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ * See the Apache Version 2.0 License for specific language governing
+ * permissions and limitations under the License.
+ */
+
+/*
+ * nas_ndi_link_damp.h
+ */
+
+#ifndef _NAS_NDI_LINK_DAMP_H_
+#define _NAS_NDI_LINK_DAMP_H_
+
+#include "std_error_codes.h"
+#include "ds_common_types.h"
+#include "nas_ndi_port.h"
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/**
+ * Link state debounce and flap dampening configuration.
+ * Hold timers delay reporting a new oper state until it has been stable for
+ * that long. With dampening enabled every up to down transition adds
+ * penalty, which decays by half every half_life_ms. Once the penalty
+ * reaches suppress_threshold the port is reported down until the penalty
+ * decays to reuse_threshold. Dampening needs a non zero half_life_ms and
+ * reuse_threshold, and reuse_threshold not above suppress_threshold. The
+ * all zero configuration reports every transition as it happens.
+ */
+typedef struct _ndi_link_damp_cfg_t {
+    uint32_t hold_up_ms;
+    uint32_t hold_down_ms;
+    bool     damp_enable;
+    uint32_t flap_penalty;
+    uint32_t suppress_threshold;
+    uint32_t reuse_threshold;
+    uint32_t half_life_ms;
+    uint32_t max_penalty;
+} ndi_link_damp_cfg_t;
+
+typedef struct _ndi_link_damp_state_t {
+    ndi_port_oper_status_t raw_state;       /*  last state reported by SAI */
+    ndi_port_oper_status_t reported_state;  /*  last state reported to NAS */
+    bool     pending;                       /*  a hold timer is running */
+    bool     suppressed;
+    uint32_t penalty;                       /*  decayed to the time of the query */
+    uint64_t transitions;                   /*  SAI oper state changes */
+    uint64_t flaps;                         /*  up to down transitions */
+    uint64_t filtered;                      /*  SAI changes never reported to NAS */
+    uint64_t reported;                      /*  states reported to NAS */
+} ndi_link_damp_state_t;
+
+typedef void (*ndi_link_damp_emit_fn)(npu_id_t npu_id, npu_port_t port_id,
+                                      ndi_port_oper_status_t state);
+
+/*  Configuration for ports without their own */
+t_std_error ndi_link_damp_default_cfg_set(const ndi_link_damp_cfg_t *cfg);
+
+/*  Per port configuration, NULL reverts the port to the default */
+t_std_error ndi_link_damp_port_cfg_set(npu_id_t npu_id, npu_port_t port_id,
+                                       const ndi_link_damp_cfg_t *cfg);
+
+t_std_error ndi_link_damp_state_get(npu_id_t npu_id, npu_port_t port_id,
+                                    ndi_link_damp_state_t *state);
+
+t_std_error ndi_link_damp_counters_clear(npu_id_t npu_id, npu_port_t port_id);
+
+/*  Feed a SAI oper state change; stable states are passed to emit. A state
+ *  equal to the last one SAI reported for the port is ignored.
+ */
+void ndi_link_damp_event(npu_id_t npu_id, npu_port_t port_id,
+                         ndi_port_oper_status_t state, ndi_link_damp_emit_fn emit);
+
+/*  Expire hold timers and reuse suppressed ports; stable states are passed to emit */
+void ndi_link_damp_tick(ndi_link_damp_emit_fn emit);
+
+/*  Milliseconds until the next tick is due, at most INT_MAX, -1 if nothing
+ *  is pending
+ */
+int ndi_link_damp_next_timeout_ms(void);
+
+/*  Forget a deleted port */
+void ndi_link_damp_port_delete(npu_id_t npu_id, npu_port_t port_id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /*  _NAS_NDI_LINK_DAMP_H_ */
@@ -28,6 +28,7 @@
 #include "dell-base-if-phy.h"
 #include "sai.h"
 #include "std_rw_lock.h"
+#include "nas_ndi_common.h"
 
 #define NDI_MAX_HWPORT_PER_PORT  10
 
@@ -55,6 +56,51 @@ t_std_error ndi_sai_port_map_create(void);
 
 t_std_error ndi_npu_port_id_get(sai_object_id_t sai_port, npu_id_t *npu_id, npu_port_t *port_id);
 
+/*  Result of one staged port map operation */
+typedef struct _ndi_port_map_change_t {
+    bool add;                   /*  true for port add, false for port delete */
+    sai_object_id_t sai_port;
+    ndi_port_t port;            /*  ndi port added or removed */
+    uint32_t hwport;            /*  first hwport of an added port, 0 on delete */
+    t_std_error rc;             /*  result of this operation */
+} ndi_port_map_change_t;
+
+typedef struct _ndi_port_map_txn_t ndi_port_map_txn_t;
+
+/*  Start staging port map changes for a npu */
+ndi_port_map_txn_t *ndi_port_map_txn_begin(npu_id_t npu);
+
+/*  Stage a sai port add, its hwport list is read from SAI at this point */
+t_std_error ndi_port_map_txn_port_add(ndi_port_map_txn_t *txn, sai_object_id_t sai_port);
+
+/*  Stage a sai port delete */
+t_std_error ndi_port_map_txn_port_delete(ndi_port_map_txn_t *txn, sai_object_id_t sai_port);
+
+size_t ndi_port_map_txn_op_count(ndi_port_map_txn_t *txn);
+
+/**
+ * Publish all staged operations, in staging order, within one port map
+ * write lock section.
+ * @param txn transaction
+ * @param[out] changes one entry per staged operation
+ * @param[in,out] count in: size of changes, at least the staged op count.
+ *                      out: number of entries filled
+ * @return STD_ERR_OK if the transaction was applied, per port results are in changes
+ */
+t_std_error ndi_port_map_txn_commit(ndi_port_map_txn_t *txn, ndi_port_map_change_t *changes,
+                                    size_t *count);
+
+void ndi_port_map_txn_free(ndi_port_map_txn_t *txn);
+
+/*  Consolidated port add/delete notification, one call per committed burst */
+typedef void (*ndi_port_event_batch_update_fn)(npu_id_t npu_id,
+                                               const ndi_port_map_change_t *changes,
+                                               size_t count);
+
+t_std_error ndi_port_event_batch_cb_register(npu_id_t npu_id, ndi_port_event_batch_update_fn func);
+
+ndi_port_event_batch_update_fn ndi_port_event_batch_cb_get(npu_id_t npu_id);
+
 void ndi_port_map_table_dump(void);
 
 void ndi_saiport_map_table_dump(void);
@@ -40,6 +40,167 @@ BASE_CMN_LOOPBACK_TYPE_t ndi_port_get_ndi_loopback_mode(sai_port_internal_loopba
 bool ndi_port_get_sai_speed(BASE_IF_SPEED_t speed, uint32_t *sai_speed);
 bool ndi_port_get_ndi_speed(uint32_t sai_speed, BASE_IF_SPEED_t *ndi_speed);
 
+sai_port_media_type_t ndi_port_get_sai_media_type(PLATFORM_MEDIA_TYPE_t media);
+
+/*  Canonical platform media type of a SAI media type, false if there is none */
+bool ndi_port_get_ndi_media_type(sai_port_media_type_t sai_media, PLATFORM_MEDIA_TYPE_t *media);
+
+/*  Media type last programmed on a port, used to skip unchanged sets */
+bool ndi_port_media_type_cache_get(npu_id_t npu_id, npu_port_t port_id,
+                                   sai_port_media_type_t *sai_media);
+
+void ndi_port_media_type_cache_set(npu_id_t npu_id, npu_port_t port_id,
+                                   sai_port_media_type_t sai_media);
+
+void ndi_port_media_type_cache_port_delete(npu_id_t npu_id, npu_port_t port_id);
+
+/*  Value last programmed for a scalar port attribute, used to skip unchanged sets */
+bool ndi_port_attr_cache_get(npu_id_t npu_id, npu_port_t port_id, sai_attr_id_t attr_id,
+                             sai_attribute_value_t *value);
+
+void ndi_port_attr_cache_set(npu_id_t npu_id, npu_port_t port_id, const sai_attribute_t *attr);
+
+/*  Forget an attribute whose hardware value is no longer known */
+void ndi_port_attr_cache_clear(npu_id_t npu_id, npu_port_t port_id, sai_attr_id_t attr_id);
+
+void ndi_port_attr_cache_port_delete(npu_id_t npu_id, npu_port_t port_id);
+
+/**
+ * Set several port attributes as one transaction. All attributes are
+ * validated before anything is programmed, attributes already holding the
+ * requested value are skipped and the rest are applied in hardware
+ * dependency order: admin down first, then speed, duplex and autoneg,
+ * then the forwarding attributes, admin up last. If an attribute fails,
+ * the attributes already applied are restored to their previous values.
+ * Supported attributes: SAI_PORT_ATTR_ADMIN_STATE, SPEED, FULL_DUPLEX_MODE,
+ * AUTO_NEG_MODE, INTERNAL_LOOPBACK, MTU, FDB_LEARNING, DROP_UNTAGGED,
+ * DROP_TAGGED and INGRESS_FILTERING, each at most once.
+ * @param npu_id npu id
+ * @param port_id npu port
+ * @param attr_list SAI attributes to set
+ * @param count number of attributes
+ * @return standard error
+ */
+t_std_error ndi_port_attr_set_multi(npu_id_t npu_id, npu_port_t port_id,
+                                    const sai_attribute_t *attr_list, size_t count);
+
+/*  Port profile fields, the bits of ndi_port_profile_t.valid */
+typedef enum {
+    NDI_PORT_PROFILE_ADMIN_STATE = (1 << 0),
+    NDI_PORT_PROFILE_SPEED       = (1 << 1),
+    NDI_PORT_PROFILE_DUPLEX      = (1 << 2),
+    NDI_PORT_PROFILE_AUTONEG     = (1 << 3),
+    NDI_PORT_PROFILE_LOOPBACK    = (1 << 4),
+    NDI_PORT_PROFILE_MTU         = (1 << 5),
+    NDI_PORT_PROFILE_LEARN_MODE  = (1 << 6),
+} ndi_port_profile_field_t;
+
+typedef struct _ndi_port_profile_t {
+    uint32_t valid;                         /*  NDI_PORT_PROFILE_* fields to apply */
+    bool admin_state;
+    BASE_IF_SPEED_t speed;
+    BASE_CMN_DUPLEX_TYPE_t duplex;
+    bool autoneg;
+    BASE_CMN_LOOPBACK_TYPE_t loopback;
+    uint_t mtu;
+    BASE_IF_PHY_MAC_LEARN_MODE_t learn_mode;
+} ndi_port_profile_t;
+
+/**
+ * Apply the valid fields of a port profile with ndi_port_attr_set_multi.
+ * As with ndi_port_speed_set, speed AUTO is accepted and not programmed.
+ * @param npu_id npu id
+ * @param port_id npu port
+ * @param profile port profile
+ * @return standard error
+ */
+t_std_error ndi_port_profile_set(npu_id_t npu_id, npu_port_t port_id,
+                                 const ndi_port_profile_t *profile);
+
+/**
+ * Program the same media type on a list of ports, e.g. all ports behind one
+ * physical connector. Ports already programmed with the media type are
+ * skipped.
+ * @param npu_id npu id
+ * @param port_list ports to program
+ * @param port_count number of entries in port_list
+ * @param media platform media type
+ * @param[out] status per port result, may be NULL
+ * @return STD_ERR_OK if all ports were programmed, error of the last failure otherwise
+ */
+t_std_error ndi_port_media_type_set_multi(npu_id_t npu_id, const npu_port_t *port_list,
+                                          size_t port_count, PLATFORM_MEDIA_TYPE_t media,
+                                          t_std_error *status);
+
+/*  Link related state of a port, read from SAI in a single call */
+typedef struct _ndi_port_link_snapshot_t {
+    ndi_port_oper_status_t oper_status;
+    BASE_IF_SPEED_t speed;              /*  BASE_IF_SPEED_0MBPS unless the link is up */
+    BASE_CMN_DUPLEX_TYPE_t duplex;
+    bool autoneg;
+} ndi_port_link_snapshot_t;
+
+/**
+ * Read oper status, speed, duplex and autoneg of a port with one
+ * multi-attribute SAI get.
+ * @param npu_id npu id
+ * @param port_id npu port
+ * @param[out] snapshot link state of the port
+ * @return standard error
+ */
+t_std_error ndi_port_link_snapshot_get(npu_id_t npu_id, npu_port_t port_id,
+                                       ndi_port_link_snapshot_t *snapshot);
+
+/**
+ * Read the link snapshot of a list of ports, one SAI call per port.
+ * @param npu_id npu id
+ * @param port_list ports to read
+ * @param port_count number of entries in port_list
+ * @param[out] snapshots port_count entries, snapshots[i] is for port_list[i]
+ * @param[out] status per port result, may be NULL
+ * @return STD_ERR_OK if all ports were read, error of the last failure otherwise
+ */
+t_std_error ndi_port_link_snapshot_get_multi(npu_id_t npu_id, const npu_port_t *port_list,
+                                             size_t port_count,
+                                             ndi_port_link_snapshot_t *snapshots,
+                                             t_std_error *status);
+
+/**
+ * Read the link snapshot of every front panel port of a npu, for a full
+ * refresh. Arrays sized with ndi_max_npu_port_get() are always large enough.
+ * A port that can't be read is logged and left out.
+ * @param npu_id npu id
+ * @param[out] port_list ports that were read
+ * @param[out] snapshots snapshots[i] is for port_list[i]
+ * @param[in,out] count in: size of port_list and snapshots. out: entries filled
+ * @return STD_ERR_OK if all ports were read, error of the last failure otherwise
+ */
+t_std_error ndi_port_link_snapshot_get_all(npu_id_t npu_id, npu_port_t *port_list,
+                                           ndi_port_link_snapshot_t *snapshots,
+                                           size_t *count);
+
+/**
+ * Clear the same counter set on a list of ports. The counter ids are
+ * translated and the SAI ports resolved once up front, then each port is
+ * cleared in turn. Counters are cleared against a software baseline, the
+ * hardware counters keep counting.
+ * @param npu_id npu id
+ * @param port_list ports to clear
+ * @param port_count number of entries in port_list
+ * @param ndi_stat_ids counter ids, NULL with stat_count 0 clears all port counters
+ * @param stat_count number of counter ids
+ * @param[out] snapshot port_count * stat_count counter values as of the clear,
+ *             snapshot[i * stat_count + j] holding counter j of port_list[i].
+ *             May be NULL. A port whose counters can't be read is not
+ *             cleared and its row is zeroed.
+ * @param[out] status per port result, may be NULL
+ * @return STD_ERR_OK if all ports were cleared, error of the last failure otherwise
+ */
+t_std_error ndi_port_stats_clear_multi(npu_id_t npu_id, const npu_port_t *port_list,
+                                       size_t port_count, const ndi_stat_id_t *ndi_stat_ids,
+                                       size_t stat_count, uint64_t *snapshot,
+                                       t_std_error *status);
+
 #ifdef __cplusplus
 }
 #endif
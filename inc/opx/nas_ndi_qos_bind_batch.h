@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2016 Dell Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License. You may obtain
+ * a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * THIS CODE IS PROVIDED ON AN *AS IS* BASIS, WITHOUT WARRANTIES OR
+ * CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ * LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ * FOR A PARTICULAR PURPOSE, MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ * See the Apache Version 2.0 License for specific language governing
+ * permissions and limitations under the License.
+ */
+
+/*
+ * nas_ndi_qos_bind_batch.h
+ */
+
+#ifndef _NAS_NDI_QOS_BIND_BATCH_H_
+#define _NAS_NDI_QOS_BIND_BATCH_H_
+
+#include "std_error_codes.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+
+#include <algorithm>
+#include <vector>
+
+/*  Outcome of a batch of profile bindings */
+typedef struct _ndi_qos_bind_batch_result_t {
+    t_std_error rc;         /*  error of the failed binding latest in the batch */
+    size_t rc_ix;           /*  its position in the batch */
+    uint64_t set;
+    uint64_t skipped;
+    uint64_t failed;
+} ndi_qos_bind_batch_result_t;
+
+/*  Record a failed binding, the one latest in the batch is reported */
+static inline void ndi_qos_bind_batch_fail(ndi_qos_bind_batch_result_t &res,
+                                           size_t ix, t_std_error rc)
+{
+    if (res.rc == STD_ERR_OK || ix > res.rc_ix) {
+        res.rc = rc;
+        res.rc_ix = ix;
+    }
+}
+
+/**
+ * Apply a batch of bindings. order holds the positions in the batch to
+ * apply and is sorted with less, which must order bindings of the same
+ * object next to each other; same tells whether two bindings are for the
+ * same object. Of such a run only the last in batch order is applied,
+ * through bind(ix, &skipped), which sets skipped if the object is bound to
+ * the profile already. All bindings of a run report the status of the one
+ * applied.
+ */
+template <typename Less, typename Same, typename Bind>
+void ndi_qos_bind_batch(std::vector<size_t> &order, Less less, Same same, Bind bind,
+                        t_std_error *status, ndi_qos_bind_batch_result_t &res)
+{
+    std::stable_sort(order.begin(), order.end(), less);
+
+    size_t first = 0;
+    while (first < order.size()) {
+        size_t last = first;
+        while (last + 1 < order.size() && same(order[first], order[last + 1])) {
+            ++last;
+        }
+
+        bool skipped = false;
+        t_std_error bind_rc = bind(order[last], &skipped);
+        res.skipped += last - first;
+        if (skipped) {
+            res.skipped++;
+        } else {
+            res.set++;
+            if (bind_rc != STD_ERR_OK) {
+                res.failed++;
+                ndi_qos_bind_batch_fail(res, order[last], bind_rc);
+            }
+        }
+
+        for (; first <= last; ++first) {
+            if (status != NULL)
+                status[order[first]] = bind_rc;
+        }
+    }
+}
+
+#endif
+
+#endif  /*  _NAS_NDI_QOS_BIND_BATCH_H_ */
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2016 Dell Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License. You may obtain
+ * a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * THIS CODE IS PROVIDED ON AN *AS IS* BASIS, WITHOUT WARRANTIES OR
+ * CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ * LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ * FOR A PARTICULAR PURPOSE, MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ * See the Apache Version 2.0 License for specific language governing
+ * permissions and limitations under the License.
+ */
+
+/*
+ * nas_ndi_qos_buffer_telemetry.h
+ */
+
+#ifndef _NAS_NDI_QOS_BUFFER_TELEMETRY_H_
+#define _NAS_NDI_QOS_BUFFER_TELEMETRY_H_
+
+#include "std_error_codes.h"
+#include "ds_common_types.h"
+#include "nas_ndi_common.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/*  Values kept per buffer pool in a sample */
+typedef enum {
+    NDI_QOS_POOL_SAMPLE_OCCUPANCY = 0,
+    NDI_QOS_POOL_SAMPLE_WATERMARK,
+    NDI_QOS_POOL_SAMPLE_MAX
+} ndi_qos_pool_sample_t;
+
+/*  Values kept per priority group in a sample */
+typedef enum {
+    NDI_QOS_PG_SAMPLE_OCCUPANCY = 0,
+    NDI_QOS_PG_SAMPLE_WATERMARK,
+    NDI_QOS_PG_SAMPLE_SHARED_OCCUPANCY,
+    NDI_QOS_PG_SAMPLE_SHARED_WATERMARK,
+    NDI_QOS_PG_SAMPLE_XOFF_ROOM_OCCUPANCY,
+    NDI_QOS_PG_SAMPLE_XOFF_ROOM_WATERMARK,
+    NDI_QOS_PG_SAMPLE_MAX
+} ndi_qos_pg_sample_t;
+
+typedef struct _ndi_qos_buffer_sample_hdr_t {
+    uint64_t seq;                   /*  1 for the first sample */
+    uint64_t timestamp_ms;          /*  CLOCK_MONOTONIC */
+    uint32_t read_errors;           /*  objects that couldn't be read, their values are
+                                     *  carried over from the previous sample (0 in the first) */
+} ndi_qos_buffer_sample_hdr_t;
+
+/*  Highest occupancy seen since the last read of the peaks */
+typedef struct _ndi_qos_pg_peak_t {
+    uint64_t peak_bytes;
+    uint64_t shared_peak_bytes;
+    uint64_t xoff_room_peak_bytes;
+} ndi_qos_pg_peak_t;
+
+typedef struct _ndi_qos_buffer_telemetry_state_t {
+    size_t pool_count;
+    size_t pg_count;
+    size_t ring_size;
+    uint64_t oldest_seq;            /*  0 if nothing was sampled yet */
+    uint64_t newest_seq;
+} ndi_qos_buffer_telemetry_state_t;
+
+/**
+ * Set the buffer pools and priority groups sampled on a npu. The counter ids
+ * are translated and a ring of ring_size samples is allocated here, so that
+ * sampling does neither. Samples and peaks taken so far are dropped.
+ * A pool_count and pg_count of 0 stops sampling on the npu.
+ * @param npu_id npu id
+ * @param pool_list buffer pools to sample
+ * @param pool_count number of entries in pool_list
+ * @param pg_list priority groups to sample
+ * @param pg_count number of entries in pg_list
+ * @param ring_size number of samples kept, at least 2
+ * @return standard error
+ */
+t_std_error ndi_qos_buffer_telemetry_cfg_set(npu_id_t npu_id,
+                                             const ndi_obj_id_t *pool_list, size_t pool_count,
+                                             const ndi_obj_id_t *pg_list, size_t pg_count,
+                                             size_t ring_size);
+
+/**
+ * Read occupancy and watermarks of every configured pool and priority group
+ * into the next ring slot, overwriting the oldest sample once the ring is
+ * full. Meant to be called from a periodic timer, e.g. every 100 ms.
+ * The peaks are raised by the sampled occupancy and by any change of the
+ * hardware watermark since the previous sample, which catches bursts
+ * shorter than the sampling interval without clearing hardware counters.
+ * @param npu_id npu id
+ * @return STD_ERR_OK if all objects were read, error of the last failure otherwise
+ */
+t_std_error ndi_qos_buffer_telemetry_sample(npu_id_t npu_id);
+
+t_std_error ndi_qos_buffer_telemetry_state_get(npu_id_t npu_id,
+                                               ndi_qos_buffer_telemetry_state_t *state);
+
+/**
+ * Copy one sample out of the ring.
+ * @param npu_id npu id
+ * @param seq sample to read, 0 for the newest
+ * @param[out] hdr sample header
+ * @param[out] pool_values pool_count * NDI_QOS_POOL_SAMPLE_MAX values in configuration
+ *             order, value j of pool i at pool_values[i * NDI_QOS_POOL_SAMPLE_MAX + j].
+ *             May be NULL.
+ * @param[out] pg_values pg_count * NDI_QOS_PG_SAMPLE_MAX values laid out the same way.
+ *             May be NULL.
+ * @return standard error, fails if the sample was overwritten or not taken yet
+ */
+t_std_error ndi_qos_buffer_telemetry_sample_get(npu_id_t npu_id, uint64_t seq,
+                                                ndi_qos_buffer_sample_hdr_t *hdr,
+                                                uint64_t *pool_values, uint64_t *pg_values);
+
+/**
+ * Read and reset the peaks tracked since the previous call, in configuration
+ * order. Hardware watermarks are left untouched.
+ * @param npu_id npu id
+ * @param[out] pool_peaks pool_count entries, may be NULL
+ * @param[out] pg_peaks pg_count entries, may be NULL
+ * @return standard error
+ */
+t_std_error ndi_qos_buffer_telemetry_peaks_read_reset(npu_id_t npu_id, uint64_t *pool_peaks,
+                                                      ndi_qos_pg_peak_t *pg_peaks);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /*  _NAS_NDI_QOS_BUFFER_TELEMETRY_H_ */
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2016 Dell Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License. You may obtain
+ * a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * THIS CODE IS PROVIDED ON AN *AS IS* BASIS, WITHOUT WARRANTIES OR
+ * CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ * LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ * FOR A PARTICULAR PURPOSE, MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ * See the Apache Version 2.0 License for specific language governing
+ * permissions and limitations under the License.
+ */
+
+/*
+ * nas_ndi_qos_pg_binding.h
+ */
+
+#ifndef _NAS_NDI_QOS_PG_BINDING_H_
+#define _NAS_NDI_QOS_PG_BINDING_H_
+
+#include "std_error_codes.h"
+#include "ds_common_types.h"
+#include "nas_ndi_common.h"
+#include "nas_ndi_port.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+typedef struct _ndi_qos_pg_binding_t {
+    npu_port_t port_id;
+    ndi_obj_id_t pg_id;
+    ndi_obj_id_t buffer_profile_id;     /*  NDI_QOS_NULL_OBJECT_ID to unbind */
+} ndi_qos_pg_binding_t;
+
+typedef struct _ndi_qos_pg_binding_stats_t {
+    uint64_t bindings_set;      /*  set_ingress_priority_group_attr calls */
+    uint64_t bindings_skipped;  /*  already bound through NDI, or repeated in the batch */
+    uint64_t bindings_failed;
+} ndi_qos_pg_binding_stats_t;
+
+/**
+ * Bind priority groups of ports of a npu to buffer profiles. The batch is
+ * applied as in ndi_qos_queue_binding_set_bulk, per port and priority
+ * group. A priority group must belong to the port it is listed with.
+ * @param npu_id npu id
+ * @param binding_list bindings to set
+ * @param count number of entries in binding_list
+ * @param[out] status per binding result, may be NULL
+ * @param[out] stats set and skipped bindings, added to, may be NULL
+ * @return STD_ERR_OK if all bindings were set
+ */
+t_std_error ndi_qos_pg_buffer_profile_bind_bulk(npu_id_t npu_id,
+                                                const ndi_qos_pg_binding_t *binding_list,
+                                                size_t count,
+                                                t_std_error *status,
+                                                ndi_qos_pg_binding_stats_t *stats);
+
+/**
+ * Called when the speed of a port changed, with the priority groups of the
+ * port bound to a buffer profile through NDI and their current profiles.
+ * Their headroom may need a new profile; binding the unchanged ones again
+ * with ndi_qos_pg_buffer_profile_bind_bulk costs nothing.
+ */
+typedef void (*ndi_qos_pg_headroom_update_fn)(npu_id_t npu_id, npu_port_t port_id,
+                                              BASE_IF_SPEED_t speed,
+                                              const ndi_qos_pg_binding_t *binding_list,
+                                              size_t count);
+
+/*  Set the speed change callback, NULL to clear it */
+void ndi_qos_pg_headroom_notify_register(ndi_qos_pg_headroom_update_fn fn);
+
+/*  Port speed changed, called by the port code */
+void ndi_qos_pg_port_speed_changed(npu_id_t npu_id, npu_port_t port_id, BASE_IF_SPEED_t speed);
+
+/*  Forget the priority group bindings of a port, e.g. when it is deleted */
+void ndi_qos_pg_binding_cache_port_delete(npu_id_t npu_id, npu_port_t port_id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /*  _NAS_NDI_QOS_PG_BINDING_H_ */
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2016 Dell Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License. You may obtain
+ * a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * THIS CODE IS PROVIDED ON AN *AS IS* BASIS, WITHOUT WARRANTIES OR
+ * CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ * LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ * FOR A PARTICULAR PURPOSE, MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ * See the Apache Version 2.0 License for specific language governing
+ * permissions and limitations under the License.
+ */
+
+/*
+ * nas_ndi_qos_port_profile.h
+ */
+
+#ifndef _NAS_NDI_QOS_PORT_PROFILE_H_
+#define _NAS_NDI_QOS_PORT_PROFILE_H_
+
+#include "std_error_codes.h"
+#include "ds_common_types.h"
+#include "nas_ndi_common.h"
+#include "dell-base-qos.h"
+#include "nas_ndi_qos.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+typedef struct _ndi_qos_port_profile_apply_stats_t {
+    uint64_t attrs_set;         /*  set_port_attribute calls */
+    uint64_t attrs_skipped;     /*  equal to the value last set through NDI */
+    uint64_t attrs_failed;
+} ndi_qos_port_profile_apply_stats_t;
+
+/**
+ * Apply a port ingress QoS profile to a list of ports. The whole profile is
+ * validated and translated once before any port is touched, then each
+ * attribute is set on each port unless it holds the same value as the last
+ * one NDI set there. A failure on one port doesn't stop the others.
+ * @param npu_id npu id
+ * @param port_list ports to apply the profile to
+ * @param port_count number of entries in port_list
+ * @param attr_list settable ingress attributes to apply
+ * @param num_attr number of entries in attr_list
+ * @param p attribute values
+ * @param[out] status per port result, may be NULL
+ * @param[out] stats set and skipped attributes, added to, may be NULL
+ * @return STD_ERR_OK if all ports were set, error of the last failure otherwise
+ */
+t_std_error ndi_qos_port_ing_profile_apply(npu_id_t npu_id,
+                                           const npu_port_t *port_list, size_t port_count,
+                                           const BASE_QOS_PORT_INGRESS_t *attr_list,
+                                           uint_t num_attr,
+                                           const qos_port_ing_struct_t *p,
+                                           t_std_error *status,
+                                           ndi_qos_port_profile_apply_stats_t *stats);
+
+/*  Same as ndi_qos_port_ing_profile_apply for a port egress QoS profile */
+t_std_error ndi_qos_port_egr_profile_apply(npu_id_t npu_id,
+                                           const npu_port_t *port_list, size_t port_count,
+                                           const BASE_QOS_PORT_EGRESS_t *attr_list,
+                                           uint_t num_attr,
+                                           const qos_port_egr_struct_t *p,
+                                           t_std_error *status,
+                                           ndi_qos_port_profile_apply_stats_t *stats);
+
+/*  Forget the QoS attribute values set on a port, e.g. when it is deleted */
+void ndi_qos_port_profile_cache_port_delete(npu_id_t npu_id, npu_port_t port_id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /*  _NAS_NDI_QOS_PORT_PROFILE_H_ */
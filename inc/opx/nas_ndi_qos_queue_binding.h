@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2016 Dell Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License. You may obtain
+ * a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * THIS CODE IS PROVIDED ON AN *AS IS* BASIS, WITHOUT WARRANTIES OR
+ * CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ * LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ * FOR A PARTICULAR PURPOSE, MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ * See the Apache Version 2.0 License for specific language governing
+ * permissions and limitations under the License.
+ */
+
+/*
+ * nas_ndi_qos_queue_binding.h
+ */
+
+#ifndef _NAS_NDI_QOS_QUEUE_BINDING_H_
+#define _NAS_NDI_QOS_QUEUE_BINDING_H_
+
+#include "std_error_codes.h"
+#include "ds_common_types.h"
+#include "nas_ndi_common.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/*  Profiles a queue can be bound to */
+typedef enum {
+    NDI_QOS_QUEUE_BIND_WRED = 0,
+    NDI_QOS_QUEUE_BIND_SCHEDULER,
+    NDI_QOS_QUEUE_BIND_BUFFER_PROFILE,
+    NDI_QOS_QUEUE_BIND_MAX
+} ndi_qos_queue_bind_kind_t;
+
+typedef struct _ndi_qos_queue_binding_t {
+    npu_port_t port_id;                 /*  port owning the queue */
+    ndi_obj_id_t queue_id;
+    ndi_qos_queue_bind_kind_t kind;
+    ndi_obj_id_t profile_id;            /*  NDI_QOS_NULL_OBJECT_ID to unbind */
+} ndi_qos_queue_binding_t;
+
+typedef struct _ndi_qos_queue_binding_stats_t {
+    uint64_t bindings_set;      /*  set_queue_attribute calls */
+    uint64_t bindings_skipped;  /*  already bound through NDI, or repeated in the batch */
+    uint64_t bindings_failed;
+} ndi_qos_queue_binding_stats_t;
+
+/**
+ * Bind queues of ports of a npu to WRED, scheduler or buffer profiles. The
+ * bindings are grouped by port and queue and a queue already bound to the
+ * profile by NDI is not set again. When the batch binds the same queue and
+ * kind more than once the last binding wins and all of them report its
+ * status.
+ * A failure doesn't stop the other bindings. If several bindings fail the
+ * error of the one latest in binding_list is returned.
+ * @param npu_id npu id
+ * @param binding_list bindings to set
+ * @param count number of entries in binding_list
+ * @param[out] status per binding result, may be NULL
+ * @param[out] stats set and skipped bindings, added to, may be NULL
+ * @return STD_ERR_OK if all bindings were set
+ */
+t_std_error ndi_qos_queue_binding_set_bulk(npu_id_t npu_id,
+                                           const ndi_qos_queue_binding_t *binding_list,
+                                           size_t count,
+                                           t_std_error *status,
+                                           ndi_qos_queue_binding_stats_t *stats);
+
+/*  Forget the bindings of all queues of a npu, e.g. when its ports change */
+void ndi_qos_queue_binding_cache_flush(npu_id_t npu_id);
+
+/*  Forget the bindings of the queues of a port, e.g. when it is deleted and
+ *  its queue ids may be reused
+ */
+void ndi_qos_queue_binding_cache_port_delete(npu_id_t npu_id, npu_port_t port_id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /*  _NAS_NDI_QOS_QUEUE_BINDING_H_ */
@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2016 Dell Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License. You may obtain
+ * a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * THIS CODE IS PROVIDED ON AN *AS IS* BASIS, WITHOUT WARRANTIES OR
+ * CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ * LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ * FOR A PARTICULAR PURPOSE, MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ * See the Apache Version 2.0 License for specific language governing
+ * permissions and limitations under the License.
+ */
+
+/*
+ * nas_ndi_qos_topology.h
+ */
+
+#ifndef _NAS_NDI_QOS_TOPOLOGY_H_
+#define _NAS_NDI_QOS_TOPOLOGY_H_
+
+#include "std_error_codes.h"
+#include "ds_common_types.h"
+#include "nas_ndi_common.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+/*  A scheduler group of a port and its children */
+typedef struct _ndi_qos_sg_node_t {
+    ndi_obj_id_t sg_id;
+    uint32_t level;
+    bool children_valid;                    /*  false if the child list couldn't be read */
+    std::vector<ndi_obj_id_t> child_list;   /*  scheduler groups or queues */
+} ndi_qos_sg_node_t;
+
+/**
+ * QoS hierarchy of a port: its queues, priority groups and scheduler group
+ * tree. It is read from SAI on first use and kept for the lifetime of the
+ * port. A topology handed out is never modified, changes made through NDI
+ * replace it with an updated copy.
+ */
+typedef struct _ndi_qos_port_topology_t {
+    std::vector<ndi_obj_id_t> queue_list;
+    std::vector<ndi_obj_id_t> pg_list;
+    std::vector<ndi_qos_sg_node_t> sg_list;
+    uint32_t sg_count;                      /*  SAI_PORT_ATTR_QOS_NUMBER_OF_SCHEDULER_GROUPS */
+    std::unordered_map<ndi_obj_id_t, size_t> sg_index;  /*  sg id to sg_list position */
+} ndi_qos_port_topology_t;
+
+typedef std::shared_ptr<const ndi_qos_port_topology_t> ndi_qos_port_topology_ptr_t;
+
+/*  Topology of a port, NULL if a list the port has can't be read from SAI.
+ *  A failed read is not cached.
+ */
+ndi_qos_port_topology_ptr_t ndi_qos_port_topology_get(ndi_port_t ndi_port_id);
+
+extern "C"{
+#endif
+
+/*  Children were added to or removed from a scheduler group */
+void ndi_qos_port_topology_sg_child_update(ndi_obj_id_t sg_id, uint32_t child_count,
+                                           const ndi_obj_id_t *child_list, bool add);
+
+/*  Forget the topology holding a scheduler group, e.g. when it is deleted */
+void ndi_qos_port_topology_sg_invalidate(ndi_obj_id_t sg_id);
+
+/*  Forget the topology of a port, it is read again on next use */
+void ndi_qos_port_topology_port_delete(npu_id_t npu_id, npu_port_t port_id);
+
+/*  Desired children of one scheduler group */
+typedef struct _ndi_qos_sg_children_t {
+    ndi_obj_id_t sg_id;
+    uint32_t child_count;
+    const ndi_obj_id_t *child_list;     /*  scheduler groups or queues */
+} ndi_qos_sg_children_t;
+
+typedef struct _ndi_qos_sg_reconcile_stats_t {
+    uint32_t children_detached;
+    uint32_t children_attached;
+    uint32_t sai_calls;         /*  add/remove child calls issued */
+    uint32_t sai_calls_saved;   /*  against detaching and attaching every child one by one */
+} ndi_qos_sg_reconcile_stats_t;
+
+/**
+ * Bring the scheduler group tree of a port to a desired shape. The desired
+ * children of each listed scheduler group are compared with the cached
+ * topology and only the difference is programmed: all detaches first,
+ * deepest level first, so a child moving between parents is free before it
+ * is attached again, then all attaches, top level first. Children of one
+ * parent are moved with a single SAI child list call. Scheduler groups not
+ * listed keep their children, except those moved to a listed group, which
+ * are detached from their old parent first. On failure the calls already
+ * made are undone in reverse order and the port topology is read again
+ * from SAI on next use.
+ * @param ndi_port_id port owning the scheduler groups
+ * @param desired desired children per scheduler group
+ * @param count number of entries in desired
+ * @param[out] stats operations done and saved, may be NULL
+ * @return standard error
+ */
+t_std_error ndi_qos_port_sg_tree_reconcile(ndi_port_t ndi_port_id,
+                                           const ndi_qos_sg_children_t *desired,
+                                           size_t count,
+                                           ndi_qos_sg_reconcile_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /*  _NAS_NDI_QOS_TOPOLOGY_H_ */
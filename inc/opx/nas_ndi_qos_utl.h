@@ -24,6 +24,8 @@
 #include "dell-base-qos.h"
 #include "nas_ndi_qos.h"
 #include <stdlib.h>
+#include <stdint.h>
+#include <algorithm>
 #include <list>
 #include <vector>
 
@@ -57,6 +59,48 @@
 #define sai2ndi_priority_group_id(x) (x)
 #define ndi2sai_priority_group_id(x) (x)
 
+/*  Number of entries of a static table, usable as an array size */
+#define NDI_QOS_TBL_SIZE(tbl) (sizeof(tbl) / sizeof((tbl)[0]))
+
+#define NDI_QOS_ATTR_TBL_INVALID    (-1)
+
+/*  Attribute table of a QoS object, looked up by NAS attribute id.
+ *  The attribute ids of one yang container are consecutive, so the
+ *  entries are indexed by a dense array from the lowest id to the highest,
+ *  built once at start up. E is an entry type with a nas_attr_id_t nas_id
+ *  member. The entries are not copied and must be static.
+ */
+template <typename E>
+class ndi_qos_attr_tbl {
+  public:
+    template <size_t N>
+    explicit ndi_qos_attr_tbl(const E (&list)[N]) : entries(list), base(list[0].nas_id) {
+        nas_attr_id_t last = base;
+        for (size_t ix = 1; ix < N; ++ix) {
+            base = std::min(base, list[ix].nas_id);
+            last = std::max(last, list[ix].nas_id);
+        }
+        index.resize(last - base + 1, NDI_QOS_ATTR_TBL_INVALID);
+        for (size_t ix = 0; ix < N; ++ix) {
+            index[list[ix].nas_id - base] = ix;
+        }
+    }
+
+    /*  Entry of an attribute id, NULL if the table has none */
+    const E *find(nas_attr_id_t nas_id) const {
+        uint64_t off = (uint64_t)nas_id - (uint64_t)base;
+        if (off >= index.size() || index[off] == NDI_QOS_ATTR_TBL_INVALID) {
+            return NULL;
+        }
+        return &entries[index[off]];
+    }
+
+  private:
+    const E *entries;
+    nas_attr_id_t base;
+    std::vector<int16_t> index;
+};
+
 
 
 /*  NDI QoS specific APIs  */
@@ -104,4 +148,151 @@ static inline  sai_buffer_api_t *ndi_sai_qos_buffer_api(nas_ndi_db_t *ndi_db_ptr
 }
 
 
+extern "C" {
+
+/**
+ * This function clears policer statistics against a software baseline,
+ * the hardware counters keep counting.
+ * @param npu_id npu id
+ * @param ndi_policer_id
+ * @param stat_list_count number of statistics types to clear
+ * @param *stat_list list of statistics types to clear
+ * @return standard error
+ */
+t_std_error ndi_qos_clear_policer_stat(npu_id_t npu_id,
+                                ndi_obj_id_t ndi_policer_id,
+                                uint_t     stat_list_count,
+                                const BASE_QOS_POLICER_STAT_TYPE_t * stat_list);
+
+/*  Policer statistics types translated once for bulk reads */
+typedef struct _ndi_qos_policer_stat_plan_t ndi_qos_policer_stat_plan_t;
+
+/**
+ * This function translates a list of policer statistics types once for
+ * repeated bulk reads.
+ * @param stat_list_count number of statistics types
+ * @param *stat_list list of statistics types, each at most once
+ * @param[out] plan counter plan, freed with ndi_qos_policer_stat_plan_delete
+ * @return standard error
+ */
+t_std_error ndi_qos_policer_stat_plan_create(uint_t stat_list_count,
+                                const BASE_QOS_POLICER_STAT_TYPE_t * stat_list,
+                                ndi_qos_policer_stat_plan_t **plan);
+
+void ndi_qos_policer_stat_plan_delete(ndi_qos_policer_stat_plan_t *plan);
+
+/**
+ * This function reads the same statistics of a list of policers into one
+ * matrix. In delta mode each counter is returned as its change since the
+ * previous delta read of that policer through the same plan, the first
+ * read returning the value since the last clear.
+ * @param npu_id npu id
+ * @param plan counter plan
+ * @param ndi_policer_list policers to read
+ * @param policer_count number of entries in ndi_policer_list
+ * @param delta true for the change since the previous delta read
+ * @param[out] counters policer_count * plan counters, counters[i * n + j]
+ *        holding counter j of ndi_policer_list[i]. The row of a policer
+ *        that can't be read is zeroed.
+ * @param[out] status per policer result, may be NULL
+ * @return STD_ERR_OK if all policers were read, error of the last failure otherwise
+ */
+t_std_error ndi_qos_get_policer_stat_bulk(npu_id_t npu_id,
+                                const ndi_qos_policer_stat_plan_t *plan,
+                                const ndi_obj_id_t *ndi_policer_list,
+                                size_t policer_count,
+                                bool delta,
+                                uint64_t *counters,
+                                t_std_error *status);
+
+
+/**
+ * This function creates a QoS map that may be shared. Maps created this way
+ * with identical type and entries share one SAI map, the id of an existing
+ * one is returned and its reference count raised. Maps created without
+ * entries are not shared until entries are set. Change such a map only
+ * through ndi_qos_map_set_entries or ndi_qos_map_update_entries.
+ * @param npu_id npu id
+ * @param type of qos map
+ * @param map_entry_count number of entries in map_entry
+ * @param map_entry key-to-value mappings
+ * @param[out] ndi_map_id
+ * @return standard error
+ */
+t_std_error ndi_qos_create_shared_map(npu_id_t npu_id,
+                                      ndi_qos_map_type_t type,
+                                      uint_t map_entry_count,
+                                      const ndi_qos_map_struct_t *map_entry,
+                                      ndi_obj_id_t *ndi_map_id);
+
+/**
+ * This function sets key-to-value mappings of a map. If other users share
+ * the map the caller gets a private copy holding the change, or a shared
+ * map that holds the same entries already, and its reference moves there.
+ * The others keep the old map. Ports the caller bound to the old map must
+ * be bound to the new id.
+ * @param npu_id npu id
+ * @param[in,out] ndi_map_id map to change, replaced by the id of the copy
+ * @param map_entry_count number of entries in map_entry
+ * @param map_entry key-to-value mappings
+ * @return standard error, the map and ndi_map_id are left as they were on failure
+ */
+t_std_error ndi_qos_map_set_entries(npu_id_t npu_id,
+                                    ndi_obj_id_t *ndi_map_id,
+                                    uint_t map_entry_count,
+                                    const ndi_qos_map_struct_t *map_entry);
+
+/**
+ * This function returns the number of users of a QoS map, see
+ * ndi_qos_create_shared_map.
+ * @param npu_id npu id
+ * @param ndi_map_id
+ * @param[out] ref_count 1 for a map that isn't shared
+ * @return standard error
+ */
+t_std_error ndi_qos_map_ref_count_get(npu_id_t npu_id,
+                                      ndi_obj_id_t ndi_map_id,
+                                      uint_t *ref_count);
+
+
+/*  Counters of ndi_qos_map_update_entries on a npu */
+typedef struct _ndi_qos_map_update_stats_t {
+    uint64_t updates;
+    uint64_t sai_calls;
+    uint64_t entries_sent;
+    uint64_t bytes_sent;
+    uint64_t bytes_avoided;     // compared to rewriting the whole map on each update
+} ndi_qos_map_update_stats_t;
+
+/**
+ * This function merges new or changed key-to-value mappings into a map.
+ * NDI keeps a copy of the entries of each map, entries that don't change
+ * are dropped and nothing is sent if none is left. The SAI gets only the
+ * changed entries if the npu supports partial map updates, the whole
+ * merged map otherwise. A shared map is copied on write as in
+ * ndi_qos_map_set_entries, the copy gets the whole merged map.
+ * @param npu_id npu id
+ * @param[in,out] ndi_map_id map to change, replaced by the id of the copy
+ * @param map_entry_count number of entries in map_entry
+ * @param map_entry key-to-value mappings
+ * @return standard error, the map and ndi_map_id are left as they were on failure
+ */
+t_std_error ndi_qos_map_update_entries(npu_id_t npu_id,
+                                       ndi_obj_id_t *ndi_map_id,
+                                       uint_t map_entry_count,
+                                       const ndi_qos_map_struct_t *map_entry);
+
+/**
+ * This function sets whether the SAI of a npu merges the entries of a map
+ * set into the map instead of replacing all of them. Off by default.
+ * @param npu_id npu id
+ * @param partial_update true if the SAI merges
+ * @return standard error
+ */
+t_std_error ndi_qos_map_partial_update_set(npu_id_t npu_id, bool partial_update);
+
+t_std_error ndi_qos_map_update_stats_get(npu_id_t npu_id, ndi_qos_map_update_stats_t *stats);
+
+}
+
 #endif
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2016 Dell Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License. You may obtain
+ * a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * THIS CODE IS PROVIDED ON AN *AS IS* BASIS, WITHOUT WARRANTIES OR
+ * CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ * LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ * FOR A PARTICULAR PURPOSE, MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ * See the Apache Version 2.0 License for specific language governing
+ * permissions and limitations under the License.
+ */
+
+/*
+ * nas_ndi_stat_baseline.h
+ */
+
+#ifndef _NAS_NDI_STAT_BASELINE_H_
+#define _NAS_NDI_STAT_BASELINE_H_
+
+#include "std_error_codes.h"
+#include "ds_common_types.h"
+#include "nas_ndi_common.h"
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/**
+ * Software counter baselines. A "clear" records the current hardware value
+ * of each cumulative counter and later reads subtract it, so the hardware
+ * counters stay monotonic for every other consumer. Counters are keyed by
+ * their NDI counter id. Gauges such as occupancy and watermarks must not be
+ * given a baseline.
+ */
+typedef enum {
+    NDI_STAT_OBJ_PORT,
+    NDI_STAT_OBJ_QUEUE,
+    NDI_STAT_OBJ_PRIORITY_GROUP,
+    NDI_STAT_OBJ_POLICER,
+    NDI_STAT_OBJ_VLAN,
+} ndi_stat_obj_type_t;
+
+/**
+ * Record hardware counter values as the new zero of an object's counters.
+ * @param type object type
+ * @param npu_id npu id
+ * @param obj_id npu port, VLAN id or NDI object id
+ * @param owner port the object belongs to (queues, priority groups), may be NULL
+ * @param stat_ids NDI counter ids
+ * @param hw_vals current hardware values of the counters
+ * @param count number of counters
+ * @return standard error
+ */
+t_std_error ndi_stat_baseline_set(ndi_stat_obj_type_t type, npu_id_t npu_id,
+                                  uint64_t obj_id, const ndi_port_t *owner,
+                                  const uint64_t *stat_ids, const uint64_t *hw_vals,
+                                  size_t count);
+
+/**
+ * Subtract the recorded baselines from hardware counter values in place.
+ * A counter found below its baseline was reset underneath NDI; its baseline
+ * is dropped and the hardware value is returned as is.
+ */
+void ndi_stat_baseline_apply(ndi_stat_obj_type_t type, npu_id_t npu_id, uint64_t obj_id,
+                             const uint64_t *stat_ids, uint64_t *vals, size_t count);
+
+/*  Forget the baselines of a deleted object */
+void ndi_stat_baseline_object_delete(ndi_stat_obj_type_t type, npu_id_t npu_id,
+                                     uint64_t obj_id);
+
+/*  Forget the baselines of a deleted port and of the objects it owned */
+void ndi_stat_baseline_port_delete(npu_id_t npu_id, npu_port_t port_id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /*  _NAS_NDI_STAT_BASELINE_H_ */
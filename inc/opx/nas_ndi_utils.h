@@ -54,6 +54,13 @@ bool ndi_to_sai_if_stats(ndi_stat_id_t ndi_id, sai_port_stat_t * sai_id);
 
 bool ndi_to_sai_vlan_stats(ndi_stat_id_t ndi_id, sai_vlan_stat_t * sai_id);
 
+/*  Translate a list of stat ids in one call, false if any id is unknown */
+bool ndi_to_sai_if_stats_multi(const ndi_stat_id_t *ndi_ids, sai_port_stat_t *sai_ids,
+                               size_t count);
+
+bool ndi_to_sai_vlan_stats_multi(const ndi_stat_id_t *ndi_ids, sai_vlan_stat_t *sai_ids,
+                                 size_t count);
+
 t_std_error ndi_switch_state_change_cb_register(npu_id_t npu_id,
                       sai_switch_state_change_notification_fn sw_state_change_cb);
 
@@ -80,6 +87,23 @@ t_std_error ndi_port_get_sai_ports_len(npu_id_t npu_id, size_t * len);
 
 t_std_error ndi_port_get_all_sai_ports(npu_id_t npu_id,sai_object_id_t *list , size_t len);
 
+/*  Generation of the npu's sai port list, it moves on every port add or delete */
+uint64_t ndi_port_sai_ports_generation_get(npu_id_t npu_id);
+
+/**
+ * Read the active front panel sai ports of a npu and the list generation
+ * in one step. A caller keeping a copy only needs to compare
+ * ndi_port_sai_ports_generation_get() with the saved generation to know
+ * whether the copy is still current.
+ * @param npu_id npu id
+ * @param[out] list sai ports
+ * @param[in,out] len in: size of list. out: number of ports, also set if list is too short
+ * @param[out] generation list generation, may be NULL
+ * @return STD_ERR_OK, STD_ERR(NPU,FAIL,0) if list is too short
+ */
+t_std_error ndi_port_sai_ports_snapshot_get(npu_id_t npu_id, sai_object_id_t *list, size_t *len,
+                                            uint64_t *generation);
+
 static inline t_std_error ndi_utl_mk_std_err (enum e_std_error_subsystems sub,
                                               sai_status_t st)
 {
@@ -0,0 +1,238 @@
+/*
+ * Copyright (c) 2016 Dell Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License. You may obtain
+ * a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * THIS CODE IS PROVIDED ON AN *AS IS* BASIS, WITHOUT WARRANTIES OR
+ * CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ * LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ * FOR A PARTICULAR PURPOSE, MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ * See the Apache Version 2.0 License for specific language governing
+ * permissions and limitations under the License.
+ */
+
+/*
+ * nas_ndi_vlan_utl.h
+ */
+
+#ifndef _NAS_NDI_VLAN_UTL_H_
+#define _NAS_NDI_VLAN_UTL_H_
+
+#include "std_error_codes.h"
+#include "ds_common_types.h"
+#include "nas_ndi_common.h"
+#include "saitypes.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+#define NDI_VLAN_ID_MAX          4095
+#define NDI_VLAN_BITMAP_WORDS    ((NDI_VLAN_ID_MAX + 64) / 64)
+
+/*  Bitmap of VLAN ids, bit n stands for VLAN n */
+typedef struct _ndi_vlan_bitmap_t {
+    uint64_t bits[NDI_VLAN_BITMAP_WORDS];
+} ndi_vlan_bitmap_t;
+
+static inline void ndi_vlan_bitmap_clear_all(ndi_vlan_bitmap_t *bmp)
+{
+    memset(bmp, 0, sizeof(*bmp));
+}
+
+static inline void ndi_vlan_bitmap_set(ndi_vlan_bitmap_t *bmp, hal_vlan_id_t vlan_id)
+{
+    if (vlan_id <= NDI_VLAN_ID_MAX) {
+        bmp->bits[vlan_id / 64] |= ((uint64_t)1 << (vlan_id % 64));
+    }
+}
+
+static inline bool ndi_vlan_bitmap_test(const ndi_vlan_bitmap_t *bmp, hal_vlan_id_t vlan_id)
+{
+    return (vlan_id <= NDI_VLAN_ID_MAX) &&
+           (bmp->bits[vlan_id / 64] & ((uint64_t)1 << (vlan_id % 64)));
+}
+
+/*  Return the first VLAN set in the bitmap at or after vlan_id, -1 if none */
+static inline int ndi_vlan_bitmap_next(const ndi_vlan_bitmap_t *bmp, int vlan_id)
+{
+    int word = vlan_id / 64;
+    uint64_t bits;
+
+    if ((vlan_id < 0) || (vlan_id > NDI_VLAN_ID_MAX)) return -1;
+
+    bits = bmp->bits[word] & (~(uint64_t)0 << (vlan_id % 64));
+    while (bits == 0) {
+        if (++word >= NDI_VLAN_BITMAP_WORDS) return -1;
+        bits = bmp->bits[word];
+    }
+    return (word * 64) + __builtin_ctzll(bits);
+}
+
+#define NDI_VLAN_BITMAP_FOR_EACH(bmp, vlan) \
+    for ((vlan) = ndi_vlan_bitmap_next((bmp), 0); (vlan) >= 0; \
+         (vlan) = ndi_vlan_bitmap_next((bmp), (vlan) + 1))
+
+/**
+ * Program the complete membership of a VLAN. The desired tagged and
+ * untagged port lists are compared against the NDI membership cache and
+ * only the ports that are added, removed or change tagging mode are
+ * handed to SAI. The cache of a VLAN is read from SAI on first use, so
+ * members not added through NDI are removed as well.
+ * @param npu_id npu id
+ * @param vlan_id VLAN id
+ * @param p_t_port_list desired tagged members, may be NULL
+ * @param p_ut_port_list desired untagged members, may be NULL
+ * @return standard error
+ */
+t_std_error ndi_vlan_set_members(npu_id_t npu_id, hal_vlan_id_t vlan_id,
+                                 ndi_port_list_t *p_t_port_list,
+                                 ndi_port_list_t *p_ut_port_list);
+
+/**
+ * Get the VLANs a port is a member of, from the NDI membership cache.
+ * @param npu_id npu id
+ * @param port_id npu port
+ * @param[out] tagged bitmap of VLANs the port is a tagged member of, may be NULL
+ * @param[out] untagged bitmap of VLANs the port is an untagged member of, may be NULL
+ * @return standard error
+ */
+t_std_error ndi_vlan_port_membership_get(npu_id_t npu_id, npu_port_t port_id,
+                                         ndi_vlan_bitmap_t *tagged,
+                                         ndi_vlan_bitmap_t *untagged);
+
+/**
+ * Create every VLAN set in the bitmap. Nothing is created if VLAN 0 or
+ * 4095 is set.
+ * @param npu_id npu id
+ * @param vlans VLANs to create
+ * @param[out] failed VLANs SAI failed to create or reserved ones, may be NULL
+ * @return STD_ERR_OK if all VLANs were created, error of the last failure otherwise
+ */
+t_std_error ndi_create_vlan_range(npu_id_t npu_id, const ndi_vlan_bitmap_t *vlans,
+                                  ndi_vlan_bitmap_t *failed);
+
+/**
+ * Delete every VLAN set in the bitmap. Nothing is deleted if VLAN 0 or
+ * 4095 is set.
+ * @param npu_id npu id
+ * @param vlans VLANs to delete
+ * @param[out] failed VLANs SAI failed to delete or reserved ones, may be NULL
+ * @return STD_ERR_OK if all VLANs were deleted, error of the last failure otherwise
+ */
+t_std_error ndi_delete_vlan_range(npu_id_t npu_id, const ndi_vlan_bitmap_t *vlans,
+                                  ndi_vlan_bitmap_t *failed);
+
+/**
+ * Add one port to every VLAN set in the bitmap. The SAI port is resolved
+ * once and VLANs where the port already is a member in the requested
+ * tagging mode are skipped. A member in the other tagging mode is removed
+ * and added again. Nothing is programmed if VLAN 0 or 4095 is set.
+ * @param npu_id npu id
+ * @param port_id npu port
+ * @param tagged true for tagged membership, false for untagged
+ * @param vlans VLANs to add the port to
+ * @param[out] failed VLANs SAI failed to add the port to or reserved ones, may be NULL
+ * @return STD_ERR_OK if all VLANs were programmed, error of the last failure otherwise
+ */
+t_std_error ndi_add_port_to_vlans(npu_id_t npu_id, npu_port_t port_id, bool tagged,
+                                  const ndi_vlan_bitmap_t *vlans,
+                                  ndi_vlan_bitmap_t *failed);
+
+/**
+ * Remove one port from every VLAN set in the bitmap. VLANs the NDI
+ * membership cache doesn't show the port in are not sent to SAI and are
+ * reported as failed. Nothing is programmed if VLAN 0 or 4095 is set.
+ * @param npu_id npu id
+ * @param port_id npu port
+ * @param vlans VLANs to remove the port from
+ * @param[out] failed VLANs the port wasn't removed from, may be NULL
+ * @return STD_ERR_OK if all VLANs were programmed, error of the last failure otherwise
+ */
+t_std_error ndi_del_port_from_vlans(npu_id_t npu_id, npu_port_t port_id,
+                                    const ndi_vlan_bitmap_t *vlans,
+                                    ndi_vlan_bitmap_t *failed);
+
+/**
+ * Read the same counter set for a list of VLANs. The counter ids are
+ * translated to SAI once and the results are stored row by row,
+ * stats_matrix[i * stat_count + j] holding counter j of vlan_list[i].
+ * @param npu_id npu id
+ * @param vlan_list VLANs to read
+ * @param vlan_count number of entries in vlan_list
+ * @param ndi_stat_ids counter ids, NULL for the platform VLAN counter list
+ * @param stat_count number of counters per VLAN
+ * @param[out] stats_matrix vlan_count * stat_count counter values
+ * @param[out] failed VLANs whose counters could not be read, may be NULL.
+ *             Their rows are zeroed.
+ * @return STD_ERR_OK if all VLANs were read, error of the last failure otherwise
+ */
+t_std_error ndi_vlan_stats_get_multi(npu_id_t npu_id, const hal_vlan_id_t *vlan_list,
+                                     size_t vlan_count, const ndi_stat_id_t *ndi_stat_ids,
+                                     size_t stat_count, uint64_t *stats_matrix,
+                                     ndi_vlan_bitmap_t *failed);
+
+/**
+ * Same as ndi_vlan_stats_get_multi for every VLAN set in the bitmap, rows
+ * are filled in ascending VLAN order.
+ */
+t_std_error ndi_vlan_stats_get_bitmap(npu_id_t npu_id, const ndi_vlan_bitmap_t *vlans,
+                                      const ndi_stat_id_t *ndi_stat_ids,
+                                      size_t stat_count, uint64_t *stats_matrix,
+                                      ndi_vlan_bitmap_t *failed);
+
+/**
+ * Clear VLAN counters. The current counter values become the new zero of
+ * later reads, the hardware counters are not cleared.
+ * @param npu_id npu id
+ * @param vlan_id VLAN id
+ * @param ndi_stat_ids counter ids, NULL for the platform VLAN counter list
+ * @param len number of counters
+ * @return standard error
+ */
+t_std_error ndi_vlan_stats_clear(npu_id_t npu_id, hal_vlan_id_t vlan_id,
+                                 const ndi_stat_id_t *ndi_stat_ids, size_t len);
+
+typedef struct _ndi_vlan_default_remove_stats_t {
+    uint64_t ports_batched;     /*  ports removed from the default VLAN through a batch */
+    uint64_t flushes;           /*  batches flushed */
+    uint64_t sai_calls;         /*  remove_ports_from_vlan calls made */
+    uint64_t fallback_ports;    /*  ports retried one by one after a batch failed */
+} ndi_vlan_default_remove_stats_t;
+
+/*  Queue a new sai port for removal from the default VLAN */
+void ndi_vlan_default_remove_defer(npu_id_t npu_id, sai_object_id_t sai_port);
+
+/*  Drop a queued port, e.g. when it is deleted before the flush */
+void ndi_vlan_default_remove_cancel(npu_id_t npu_id, sai_object_id_t sai_port);
+
+/*  Remove all queued ports of the npu from the default VLAN in one SAI call */
+t_std_error ndi_vlan_default_remove_flush(npu_id_t npu_id);
+
+void ndi_vlan_default_remove_stats_get(ndi_vlan_default_remove_stats_t *stats);
+
+/*  Membership cache maintenance, called once SAI has accepted the change */
+void ndi_vlan_member_cache_update(npu_id_t npu_id, hal_vlan_id_t vlan_id,
+                                  const ndi_port_list_t *p_t_port_list,
+                                  const ndi_port_list_t *p_ut_port_list,
+                                  bool add);
+
+/*  Check if a port is cached as a VLAN member, with its tagging mode */
+bool ndi_vlan_member_cache_test(npu_id_t npu_id, hal_vlan_id_t vlan_id,
+                                npu_port_t port_id, bool *tagged);
+
+void ndi_vlan_member_cache_vlan_delete(npu_id_t npu_id, hal_vlan_id_t vlan_id);
+
+void ndi_vlan_member_cache_port_delete(npu_id_t npu_id, npu_port_t port_id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /*  _NAS_NDI_VLAN_UTL_H_ */
@@ -33,6 +33,15 @@
 #include "saistatus.h"
 #include "saitypes.h"
 #include "nas_ndi_vlan.h"
+#include "nas_ndi_vlan_utl.h"
+#include "nas_ndi_lag_utl.h"
+#include "nas_ndi_link_damp.h"
+#include "nas_ndi_stat_baseline.h"
+#include "nas_ndi_port_utils.h"
+#include "nas_ndi_qos_topology.h"
+#include "nas_ndi_qos_port_profile.h"
+#include "nas_ndi_qos_queue_binding.h"
+#include "nas_ndi_qos_pg_binding.h"
 
 #include "std_thread_tools.h"
 #include "std_socket_tools.h"
@@ -41,6 +50,7 @@
 #include <string.h>
 #include<unistd.h>
 #include <inttypes.h>
+#include <poll.h>
 
 
 typedef enum {
@@ -274,6 +284,11 @@ static void ndi_switch_state_change_cb_int (sai_switch_oper_status_t oper_status
     STD_ASSERT(ndi_db_ptr != NULL);
 
     ndi_db_ptr->npu_oper_status =  ndi_oper_status_translate(oper_status);
+
+    /*  ports announced during bring up leave the default VLAN in one go */
+    if (ndi_db_ptr->npu_oper_status == NDI_SWITCH_OPER_UP) {
+        ndi_vlan_default_remove_flush(npu_id);
+    }
 }
 static void ndi_fdb_event_cb (uint32_t count,sai_fdb_event_notification_data_t *data)
 {
@@ -374,12 +389,30 @@ static void ndi_port_state_change_cb(uint32_t count,
     }
 }
 
+/*  Report a stable port oper state to NAS */
+static void ndi_port_oper_state_emit(npu_id_t npu_id, npu_port_t port_id,
+                                     ndi_port_oper_status_t state)
+{
+    ndi_intf_link_state_t link_state;
+    nas_ndi_db_t *ndi_db_ptr = ndi_db_ptr_get(npu_id);
+
+    if (ndi_db_ptr == NULL) {
+        return;
+    }
+    link_state.oper_status = state;
+    /*  @todo add a lock before calling callback */
+    if (ndi_db_ptr->switch_notification->port_oper_status_change_cb != NULL) {
+        ndi_db_ptr->switch_notification->port_oper_status_change_cb(npu_id, port_id,
+                                                            &link_state);
+    }
+}
+
 static void ndi_port_state_change_cb_int( sai_object_id_t sai_port_id,
                                 sai_port_oper_status_t port_state)
 {
     t_std_error ret_code = STD_ERR_OK;
     nas_ndi_db_t *ndi_db_ptr = NULL;
-    ndi_intf_link_state_t link_state;
+    ndi_port_oper_status_t oper_status;
 
     npu_id_t npu_id;
     npu_port_t port_id;
@@ -394,15 +427,12 @@ static void ndi_port_state_change_cb_int( sai_object_id_t sai_port_id,
     NDI_INIT_LOG_TRACE("Calling port state change notification npu_id %d port_id %d state %d \n",
                         npu_id, sai_port_id, port_state);
 
-    ret_code = ndi_sai_oper_state_to_link_state_get(port_state, &link_state.oper_status);
+    ret_code = ndi_sai_oper_state_to_link_state_get(port_state, &oper_status);
     if (ret_code != STD_ERR_OK) {
         return;
     }
-    /*  @todo add a lock before calling callback */
-    if (ndi_db_ptr->switch_notification->port_oper_status_change_cb != NULL) {
-        ndi_db_ptr->switch_notification->port_oper_status_change_cb(npu_id, port_id,
-                                                            &link_state);
-    }
+    /*  hold timers and flap dampening decide when NAS sees the change */
+    ndi_link_damp_event(npu_id, port_id, oper_status, ndi_port_oper_state_emit);
 }
 
 static void ndi_port_event_cb(uint32_t count,
@@ -418,118 +448,212 @@ static void ndi_port_event_cb(uint32_t count,
     }
 }
 
-static t_std_error ndi_delete_port_default_vlan(npu_id_t npu_id, sai_object_id_t sai_port)
+/*  Upper bound on port events coalesced into one port map transaction */
+#define NDI_PORT_EVENT_BATCH_MAX   256
+
+typedef struct {
+    sai_object_id_t sai_port;
+    sai_port_event_t port_event;
+} ndi_port_event_entry_t;
+
+static void ndi_port_map_changes_notify(npu_id_t npu_id, ndi_port_map_change_t *changes,
+                                        size_t count)
 {
     nas_ndi_db_t *ndi_db_ptr = ndi_db_ptr_get(npu_id);
-    if(ndi_db_ptr == NULL){
-        return STD_ERR(NPU, PARAM, 0);
-    }
-    sai_status_t sai_ret = SAI_STATUS_FAILURE;
-
-    sai_vlan_port_t vlan_port;
-    memset(&vlan_port, 0, sizeof(sai_vlan_port_t));
+    ndi_port_event_batch_update_fn batch_cb = ndi_port_event_batch_cb_get(npu_id);
+    size_t ix, ok = 0;
 
-    vlan_port.port_id = sai_port;
-    vlan_port.tagging_mode = SAI_VLAN_TAGGING_MODE_UNTAGGED;
+    for (ix = 0; ix < count; ++ix) {
+        ndi_port_map_change_t *chg = &changes[ix];
 
-    int port_count = 1;
-    sai_vlan_id_t vlan_id = 1;
+        NDI_INIT_LOG_TRACE(" SAI PORT %s event sai_port 0x%" PRIx64 " npu id %d ndi_port %d \n",
+                  chg->add ? "ADD" : "DELETE", chg->sai_port, chg->port.npu_id,
+                  chg->port.npu_port);
 
-    EV_LOG_INFO(ev_log_t_NDI, ev_log_s_MAJOR, "NDI_VLAN",
-                "Deleting port %d from system default vlan %d", sai_port, vlan_id);
+        if (chg->rc != STD_ERR_OK) {
+            NDI_PORT_LOG_ERROR("Can not find HW PORT for the SAI PORT %"PRIx64" ErrorCode 0x%x",
+                                            chg->sai_port, chg->rc);
+            continue;
+        }
+        /*  a new port starts from the SAI default media type, attributes and QoS tree */
+        ndi_port_media_type_cache_port_delete(chg->port.npu_id, chg->port.npu_port);
+        ndi_port_attr_cache_port_delete(chg->port.npu_id, chg->port.npu_port);
+        ndi_qos_port_topology_port_delete(chg->port.npu_id, chg->port.npu_port);
+        ndi_qos_port_profile_cache_port_delete(chg->port.npu_id, chg->port.npu_port);
+        ndi_qos_pg_binding_cache_port_delete(chg->port.npu_id, chg->port.npu_port);
+        if (!chg->add) {
+            /*  the port is gone along with its VLAN memberships */
+            ndi_vlan_member_cache_port_delete(chg->port.npu_id, chg->port.npu_port);
+            /*  queue ids of the port may be reused */
+            ndi_qos_queue_binding_cache_port_delete(chg->port.npu_id, chg->port.npu_port);
+            ndi_lag_member_index_port_delete(chg->port.npu_id, chg->port.npu_port);
+            ndi_link_damp_port_delete(chg->port.npu_id, chg->port.npu_port);
+            ndi_stat_baseline_port_delete(chg->port.npu_id, chg->port.npu_port);
+        }
+        changes[ok++] = *chg;
+    }
 
-    if ((sai_ret = ndi_db_ptr->ndi_sai_api_tbl.n_sai_vlan_api_tbl->remove_ports_from_vlan(vlan_id,
-                                                port_count, &vlan_port))
-            != SAI_STATUS_SUCCESS) {
-        return STD_ERR(INTERFACE, CFG, sai_ret);
+    if (ok == 0) {
+        return;
+    }
+    if (batch_cb != NULL) {
+        batch_cb(npu_id, changes, ok);
+        return;
+    }
+    if (ndi_db_ptr->switch_notification->port_event_update_cb == NULL) {
+        return;
+    }
+    for (ix = 0; ix < ok; ++ix) {
+        ndi_db_ptr->switch_notification->port_event_update_cb(&changes[ix].port,
+                changes[ix].add ? ndi_port_ADD : ndi_port_DELETE, changes[ix].hwport);
     }
-    return STD_ERR_OK;
 }
 
-static void ndi_port_event_cb_int(sai_object_id_t sai_port,
-                              sai_port_event_t port_event)
+static void ndi_port_map_txn_publish(ndi_port_map_txn_t *txn, npu_id_t npu_id)
 {
-    t_std_error rc = STD_ERR_OK;
-    npu_id_t npu_id = 0 ;
-    npu_port_t npu_port = 0;
-    uint32_t hport_list[NDI_MAX_HWPORT_PER_PORT];
-    hwport_list_t hwport_list;
-    ndi_port_t ndi_port;
-    ndi_port_event_t event;
-    uint32_t hwport = 0;
-
-    NDI_INIT_LOG_TRACE("Calling port event notification from SAI\n");
-
-    npu_id = ndi_saiport_to_npu_id_get(sai_port);
-    nas_ndi_db_t *ndi_db_ptr = ndi_db_ptr_get(npu_id);
-    if (ndi_db_ptr == NULL) {
-        NDI_INIT_LOG_ERROR("invalid sai_port 0x%" PRIx64 " ", sai_port);
+    size_t count = ndi_port_map_txn_op_count(txn);
+    ndi_port_map_change_t changes[NDI_PORT_EVENT_BATCH_MAX];
+
+    if (count == 0) {
         return;
     }
-    if(port_event == SAI_PORT_EVENT_ADD) {
-        ndi_delete_port_default_vlan(npu_id, sai_port);
-    }
-    /*  Ignore PORT ADD and DELETE events until NPU status is not operationally UP */
-    if (ndi_db_ptr->npu_oper_status != NDI_SWITCH_OPER_UP) {
-        NDI_INIT_LOG_TRACE("Ignore SAI port event notification if SAI is not UP yet \n");
+    if (ndi_port_map_txn_commit(txn, changes, &count) != STD_ERR_OK) {
+        NDI_PORT_LOG_ERROR("Port map transaction commit failed for npu %d", npu_id);
         return;
     }
+    ndi_port_map_changes_notify(npu_id, changes, count);
+}
 
-    switch(port_event) {
-        case SAI_PORT_EVENT_ADD:
-            hwport_list.list = hport_list;
-            hwport_list.count = NDI_MAX_HWPORT_PER_PORT;
-            if ((rc = ndi_sai_port_hwport_list_get(npu_id, sai_port, hport_list, &hwport_list.count)) != STD_ERR_OK) {
-                NDI_PORT_LOG_ERROR("could not find HW port list for the corresponding saiport 0x%"PRIx64" ", sai_port);
-                break;
-            }
-            if ((rc = ndi_port_map_sai_port_add(npu_id, sai_port, &npu_port)) != STD_ERR_OK) {
-                NDI_PORT_LOG_ERROR("Can not find HW PORT for the SAI PORT %"PRIx64" ErrorCode 0x%x",
-                                                sai_port, rc);
-                break;
+/*  Apply a burst of SAI port add/delete events (e.g. one breakout) as a
+ *  single port map transaction per npu and notify NAS once.
+ */
+static void ndi_port_event_batch_int(ndi_port_event_entry_t *events, size_t count)
+{
+    ndi_port_map_txn_t *txn = NULL;
+    npu_id_t txn_npu = 0;
+    size_t ix;
+
+    NDI_INIT_LOG_TRACE("Calling port event notification from SAI for %d ports\n", (int)count);
+
+    for (ix = 0; ix < count; ++ix) {
+        sai_object_id_t sai_port = events[ix].sai_port;
+        sai_port_event_t port_event = events[ix].port_event;
+        npu_id_t npu_id = ndi_saiport_to_npu_id_get(sai_port);
+
+        nas_ndi_db_t *ndi_db_ptr = ndi_db_ptr_get(npu_id);
+        if (ndi_db_ptr == NULL) {
+            NDI_INIT_LOG_ERROR("invalid sai_port 0x%" PRIx64 " ", sai_port);
+            continue;
+        }
+        /*  default VLAN removal is batched and flushed before NAS hears of the port */
+        if(port_event == SAI_PORT_EVENT_ADD) {
+            ndi_vlan_default_remove_defer(npu_id, sai_port);
+        } else if (port_event == SAI_PORT_EVENT_DELETE) {
+            ndi_vlan_default_remove_cancel(npu_id, sai_port);
+        }
+        /*  Ignore PORT ADD and DELETE events until NPU status is not operationally UP */
+        if (ndi_db_ptr->npu_oper_status != NDI_SWITCH_OPER_UP) {
+            NDI_INIT_LOG_TRACE("Ignore SAI port event notification if SAI is not UP yet \n");
+            continue;
+        }
+        if ((port_event != SAI_PORT_EVENT_ADD) && (port_event != SAI_PORT_EVENT_DELETE)) {
+            continue;
+        }
+
+        if ((txn != NULL) && (txn_npu != npu_id)) {
+            ndi_vlan_default_remove_flush(txn_npu);
+            ndi_port_map_txn_publish(txn, txn_npu);
+            ndi_port_map_txn_free(txn);
+            txn = NULL;
+        }
+        if (txn == NULL) {
+            if ((txn = ndi_port_map_txn_begin(npu_id)) == NULL) {
+                NDI_PORT_LOG_ERROR("Port map transaction alloc failed for npu %d", npu_id);
+                continue;
             }
-            event = ndi_port_ADD;
-            hwport = hport_list[0];
-            break;
-        case SAI_PORT_EVENT_DELETE:
-            if ((rc = ndi_port_map_sai_port_delete(npu_id, sai_port, &npu_port)) != STD_ERR_OK) {
-                NDI_PORT_LOG_ERROR("Can not find HW PORT for the SAI PORT %"PRIx64" ErrorCode 0x%x",
-                                                sai_port, rc);
-                break;
+            txn_npu = npu_id;
+        }
+
+        if (port_event == SAI_PORT_EVENT_ADD) {
+            if (ndi_port_map_txn_port_add(txn, sai_port) != STD_ERR_OK) {
+                NDI_PORT_LOG_ERROR("could not find HW port list for the corresponding saiport 0x%"PRIx64" ", sai_port);
             }
-            event = ndi_port_DELETE;
-            hwport = 0; /*  in case of port DELETE event, hwport is ignored. */
-            break;
-        default:
-            break;
+        } else {
+            ndi_port_map_txn_port_delete(txn, sai_port);
+        }
+    }
+
+    if (txn != NULL) {
+        ndi_vlan_default_remove_flush(txn_npu);
+        ndi_port_map_txn_publish(txn, txn_npu);
+        ndi_port_map_txn_free(txn);
     }
-    NDI_INIT_LOG_TRACE(" SAI PORT %s event sai_port 0x%" PRIx64 " npu id %d ndi_port %d \n",
-              (port_event == SAI_PORT_EVENT_ADD) ? "ADD" : "DELETE", sai_port, npu_id, npu_port);
+}
+
+/*  true if an event can be read within timeout ms (-1 waits forever) */
+static bool nas_event_wait(int timeout) {
+    struct pollfd pfd = { .fd = _nas_fd[0], .events = POLLIN, .revents = 0 };
+    return (poll(&pfd, 1, timeout) > 0) && (pfd.revents & POLLIN);
+}
+
+/*  true if another event can be read without blocking */
+static bool nas_event_pending(void) {
+    return nas_event_wait(0);
+}
 
-    if (rc == STD_ERR_OK) {
-        ndi_port.npu_id = npu_id;
-        ndi_port.npu_port = npu_port;
-        if (ndi_db_ptr->switch_notification->port_event_update_cb != NULL) {
-            ndi_db_ptr->switch_notification->port_event_update_cb(&ndi_port, event,
-                                                            hwport);
+/*  Collect the port event in ev and every port event queued right behind
+ *  it, then process them as one batch. A non port event read while
+ *  draining is left in ev and true is returned so the caller handles it.
+ */
+static bool ndi_port_event_drain(ndi_internal_event_t *ev)
+{
+    ndi_port_event_entry_t events[NDI_PORT_EVENT_BATCH_MAX];
+    size_t count = 0;
+    bool pending = false;
+
+    events[count].sai_port = ev->u.port_event.sai_port;
+    events[count++].port_event = ev->u.port_event.port_event;
+
+    while ((count < NDI_PORT_EVENT_BATCH_MAX) && nas_event_pending()) {
+        if (!receive_nas_event(ev)) {
+            break;
         }
+        if (ev->type != ndi_internal_event_T_PORT_EVENT) {
+            pending = true;
+            break;
+        }
+        events[count].sai_port = ev->u.port_event.sai_port;
+        events[count++].port_event = ev->u.port_event.port_event;
     }
+
+    ndi_port_event_batch_int(events, count);
+    return pending;
 }
 
 static void * _ndi_event_push(void * param) {
     ndi_internal_event_t ev;
+    bool pending = false;
 
     while (true) {
-        if (!receive_nas_event(&ev)) {
-            continue;
+        if (!pending) {
+            /*  wake up for link state hold timers even when SAI is quiet */
+            int timeout = ndi_link_damp_next_timeout_ms();
+            if ((timeout == 0) || ((timeout > 0) && !nas_event_wait(timeout))) {
+                ndi_link_damp_tick(ndi_port_oper_state_emit);
+                continue;
+            }
+            if (!receive_nas_event(&ev)) {
+                continue;
+            }
         }
+        pending = false;
         switch(ev.type) {
             case ndi_internal_event_T_PORT_STATE:
                 ndi_port_state_change_cb_int(ev.u.port_state.port_id,ev.u.port_state.port_state);
                 break;
 
             case ndi_internal_event_T_PORT_EVENT:
-                ndi_port_event_cb_int(ev.u.port_event.sai_port,ev.u.port_event.port_event);
+                pending = ndi_port_event_drain(&ev);
                 break;
 
             case ndi_internal_event_T_SWITCH_OPER:
@@ -23,6 +23,7 @@
 #include "std_assert.h"
 #include "nas_ndi_event_logs.h"
 #include "nas_ndi_lag.h"
+#include "nas_ndi_lag_utl.h"
 #include "nas_ndi_utils.h"
 #include "sai.h"
 #include "sailag.h"
@@ -77,41 +78,33 @@ t_std_error ndi_delete_lag(npu_id_t npu_id, ndi_obj_id_t ndi_lag_id)
         return STD_ERR(INTERFACE, CFG, sai_ret);
     }
 
+    ndi_lag_member_index_lag_delete(npu_id, ndi_lag_id);
     return STD_ERR_OK;
 }
 
 
 
-t_std_error ndi_add_ports_to_lag(npu_id_t npu_id, ndi_obj_id_t ndi_lag_id,
-        ndi_port_list_t *lag_port_list,ndi_obj_id_t *ndi_lag_member_id)
+/*  Create the LAG member for one port and record it in the member index */
+static t_std_error ndi_lag_member_create(nas_ndi_db_t *ndi_db_ptr, npu_id_t npu_id,
+                                         ndi_obj_id_t ndi_lag_id, ndi_port_t *ndi_port,
+                                         ndi_obj_id_t *ndi_lag_member_id)
 {
     sai_status_t sai_ret = SAI_STATUS_FAILURE;
     sai_attribute_t sai_lag_attr_list[4];
     sai_object_id_t  sai_port;
-    ndi_port_t *ndi_port = NULL;
     unsigned int count = 0;
 
-    NDI_LAG_LOG_INFO("Add ports to Lag ID  %lld ",ndi_lag_id);
-
-    nas_ndi_db_t *ndi_db_ptr = ndi_db_ptr_get(npu_id);
-    if (ndi_db_ptr == NULL) {
-        return STD_ERR(INTERFACE, CFG,0);
-    }
-
     memset(sai_lag_attr_list,0, sizeof(sai_lag_attr_list));
     sai_lag_attr_list [count].id = SAI_LAG_MEMBER_ATTR_LAG_ID;
     sai_lag_attr_list [count].value.oid = ndi_lag_id;
     count++;
 
-
-    ndi_port = &(lag_port_list->port_list[0]);
     if(ndi_sai_port_id_get(ndi_port->npu_id,ndi_port->npu_port,&sai_port) != STD_ERR_OK) {
         NDI_LAG_LOG_ERROR("Failed to convert  npu %d and port %d to sai port",
                 ndi_port->npu_id, ndi_port->npu_port);
         return STD_ERR(INTERFACE, CFG,0);
     }
 
-
     sai_lag_attr_list [count].id = SAI_LAG_MEMBER_ATTR_PORT_ID;
     sai_lag_attr_list [count].value.oid = sai_port;
     count++;
@@ -121,10 +114,75 @@ t_std_error ndi_add_ports_to_lag(npu_id_t npu_id, ndi_obj_id_t ndi_lag_id,
         NDI_LAG_LOG_ERROR("Add ports to LAG Group Failure");
         return STD_ERR(INTERFACE, CFG, sai_ret);
     }
+
+    t_std_error rc = ndi_lag_member_index_add(npu_id, ndi_lag_id, ndi_port, *ndi_lag_member_id);
+    if (rc != STD_ERR_OK) {
+        /*  a member the index doesn't know can't be removed by port */
+        if ((sai_ret = ndi_sai_lag_api(ndi_db_ptr)->remove_lag_member(*ndi_lag_member_id))
+                != SAI_STATUS_SUCCESS) {
+            NDI_LAG_LOG_ERROR("Failed to remove unrecorded lag member id %lld",
+                              *ndi_lag_member_id);
+        }
+        return rc;
+    }
     return STD_ERR_OK;
 }
 
+t_std_error ndi_add_ports_to_lag(npu_id_t npu_id, ndi_obj_id_t ndi_lag_id,
+        ndi_port_list_t *lag_port_list,ndi_obj_id_t *ndi_lag_member_id)
+{
+    NDI_LAG_LOG_INFO("Add ports to Lag ID  %lld ",ndi_lag_id);
+
+    nas_ndi_db_t *ndi_db_ptr = ndi_db_ptr_get(npu_id);
+    if (ndi_db_ptr == NULL) {
+        return STD_ERR(INTERFACE, CFG,0);
+    }
 
+    ndi_obj_id_t cur_member_id;
+    if (ndi_lag_member_id_get(npu_id, ndi_lag_id, &(lag_port_list->port_list[0]),
+                              &cur_member_id) == STD_ERR_OK) {
+        NDI_LAG_LOG_ERROR("Port %d is already member %lld of Lag ID %lld",
+                          lag_port_list->port_list[0].npu_port, cur_member_id, ndi_lag_id);
+        return STD_ERR(INTERFACE, PARAM, 0);
+    }
+
+    return ndi_lag_member_create(ndi_db_ptr, npu_id, ndi_lag_id,
+                                 &(lag_port_list->port_list[0]), ndi_lag_member_id);
+}
+
+t_std_error ndi_add_ports_to_lag_multi(npu_id_t npu_id, ndi_obj_id_t ndi_lag_id,
+                                       ndi_port_list_t *lag_port_list,
+                                       ndi_obj_id_t *ndi_lag_member_ids)
+{
+    t_std_error rc = STD_ERR_OK;
+    t_std_error ret;
+    unsigned int ix;
+
+    nas_ndi_db_t *ndi_db_ptr = ndi_db_ptr_get(npu_id);
+    if ((ndi_db_ptr == NULL) || (lag_port_list == NULL) || (ndi_lag_member_ids == NULL)) {
+        return STD_ERR(INTERFACE, CFG,0);
+    }
+
+    NDI_LAG_LOG_INFO("Add %d ports to Lag ID  %lld ",lag_port_list->port_count,ndi_lag_id);
+
+    for (ix = 0; ix < lag_port_list->port_count; ++ix) {
+        ndi_port_t *ndi_port = &(lag_port_list->port_list[ix]);
+
+        /*  Already a member, hand back the existing member id */
+        if (ndi_lag_member_id_get(npu_id, ndi_lag_id, ndi_port,
+                                  &ndi_lag_member_ids[ix]) == STD_ERR_OK) {
+            continue;
+        }
+
+        ndi_lag_member_ids[ix] = 0;
+        if ((ret = ndi_lag_member_create(ndi_db_ptr, npu_id, ndi_lag_id, ndi_port,
+                                         &ndi_lag_member_ids[ix])) != STD_ERR_OK) {
+            ndi_lag_member_ids[ix] = 0;
+            rc = ret;
+        }
+    }
+    return rc;
+}
 
 t_std_error ndi_del_ports_from_lag(npu_id_t npu_id,ndi_obj_id_t ndi_lag_member_id)
 {
@@ -143,14 +201,59 @@ t_std_error ndi_del_ports_from_lag(npu_id_t npu_id,ndi_obj_id_t ndi_lag_member_i
         return STD_ERR(INTERFACE, CFG, sai_ret);
     }
 
+    ndi_lag_member_index_del(npu_id, ndi_lag_member_id);
     return STD_ERR_OK;
 }
 
+t_std_error ndi_del_ports_from_lag_multi(npu_id_t npu_id, ndi_obj_id_t ndi_lag_id,
+                                         ndi_port_list_t *lag_port_list)
+{
+    t_std_error rc = STD_ERR_OK;
+    t_std_error ret;
+    ndi_obj_id_t ndi_lag_member_id;
+    unsigned int ix;
+
+    if (lag_port_list == NULL) {
+        return STD_ERR(INTERFACE, CFG,0);
+    }
+
+    for (ix = 0; ix < lag_port_list->port_count; ++ix) {
+        if (ndi_lag_member_id_get(npu_id, ndi_lag_id, &(lag_port_list->port_list[ix]),
+                                  &ndi_lag_member_id) != STD_ERR_OK) {
+            continue;
+        }
+        if ((ret = ndi_del_ports_from_lag(npu_id, ndi_lag_member_id)) != STD_ERR_OK) {
+            rc = ret;
+        }
+    }
+    return rc;
+}
+
+
+static t_std_error ndi_lag_member_bool_attr_set(nas_ndi_db_t *ndi_db_ptr,
+                                                ndi_obj_id_t ndi_lag_member_id,
+                                                sai_attr_id_t attr_id, bool value)
+{
+    sai_status_t sai_ret = SAI_STATUS_FAILURE;
+    sai_attribute_t sai_lag_member_attr;
+
+    memset (&sai_lag_member_attr, 0, sizeof (sai_lag_member_attr));
+    sai_lag_member_attr.id = attr_id;
+    sai_lag_member_attr.value.booldata = value;
+
+    if((sai_ret = ndi_sai_lag_api(ndi_db_ptr)->set_lag_member_attribute(ndi_lag_member_id,
+                    &sai_lag_member_attr)) != SAI_STATUS_SUCCESS) {
+        NDI_LAG_LOG_ERROR("Lag port mode set Failure");
+        return STD_ERR(INTERFACE, CFG, sai_ret);
+    }
+    return STD_ERR_OK;
+}
 
 t_std_error ndi_set_lag_port_mode (npu_id_t npu_id,ndi_obj_id_t ndi_lag_member_id,
                                   bool egr_disable)
 {
-    sai_status_t sai_ret = SAI_STATUS_FAILURE;
+    t_std_error rc;
+    bool cur_egr_disable;
 
     nas_ndi_db_t *ndi_db_ptr = ndi_db_ptr_get(npu_id);
     if (ndi_db_ptr == NULL) {
@@ -160,20 +263,75 @@ t_std_error ndi_set_lag_port_mode (npu_id_t npu_id,ndi_obj_id_t ndi_lag_member_i
     NDI_LAG_LOG_INFO("Set port mode in NPU %d lag member id%lld  egr_disable %d",
             npu_id,ndi_lag_member_id,egr_disable);
 
-    sai_attribute_t sai_lag_member_attr;
-    memset (&sai_lag_member_attr, 0, sizeof (sai_lag_member_attr));
+    if (ndi_lag_member_mode_cache_get(npu_id, ndi_lag_member_id, NULL, &cur_egr_disable) &&
+        (cur_egr_disable == egr_disable)) {
+        ndi_lag_member_mode_stats_add(0, 1, 0);
+        return STD_ERR_OK;
+    }
 
-    sai_lag_member_attr.id = SAI_LAG_MEMBER_ATTR_EGRESS_DISABLE;
-    sai_lag_member_attr.value.booldata = egr_disable;
+    if ((rc = ndi_lag_member_bool_attr_set(ndi_db_ptr, ndi_lag_member_id,
+                                           SAI_LAG_MEMBER_ATTR_EGRESS_DISABLE,
+                                           egr_disable)) != STD_ERR_OK) {
+        return rc;
+    }
 
+    ndi_lag_member_mode_cache_set(npu_id, ndi_lag_member_id, NULL, &egr_disable);
+    ndi_lag_member_mode_stats_add(1, 0, 0);
+    return STD_ERR_OK;
+}
 
-    if((sai_ret = ndi_sai_lag_api(ndi_db_ptr)->set_lag_member_attribute(ndi_lag_member_id,
-                    &sai_lag_member_attr)) != SAI_STATUS_SUCCESS) {
-        NDI_LAG_LOG_ERROR("Lag port mode set Failure");
-        return STD_ERR(INTERFACE, CFG, sai_ret);
+t_std_error ndi_set_lag_member_mode_multi(npu_id_t npu_id, const ndi_lag_member_mode_t *modes,
+                                          size_t count, t_std_error *status)
+{
+    t_std_error rc = STD_ERR_OK;
+    t_std_error ret;
+    uint64_t sai_sets = 0, noops = 0;
+    bool cur_ing, cur_egr, known;
+    size_t ix;
+
+    nas_ndi_db_t *ndi_db_ptr = ndi_db_ptr_get(npu_id);
+    if ((ndi_db_ptr == NULL) || ((modes == NULL) && (count != 0))) {
+        return STD_ERR(INTERFACE, CFG,0);
     }
 
-    return STD_ERR_OK;
+    for (ix = 0; ix < count; ++ix) {
+        const ndi_lag_member_mode_t *mode = &modes[ix];
+
+        ret = STD_ERR_OK;
+        known = ndi_lag_member_mode_cache_get(npu_id, mode->member_id, &cur_ing, &cur_egr);
+
+        if (known && (cur_ing == mode->ingress_disable)) {
+            ++noops;
+        } else if ((ret = ndi_lag_member_bool_attr_set(ndi_db_ptr, mode->member_id,
+                                                       SAI_LAG_MEMBER_ATTR_INGRESS_DISABLE,
+                                                       mode->ingress_disable)) == STD_ERR_OK) {
+            ndi_lag_member_mode_cache_set(npu_id, mode->member_id, &mode->ingress_disable, NULL);
+            ++sai_sets;
+        }
+
+        if (ret == STD_ERR_OK) {
+            if (known && (cur_egr == mode->egress_disable)) {
+                ++noops;
+            } else if ((ret = ndi_lag_member_bool_attr_set(ndi_db_ptr, mode->member_id,
+                                                           SAI_LAG_MEMBER_ATTR_EGRESS_DISABLE,
+                                                           mode->egress_disable)) == STD_ERR_OK) {
+                ndi_lag_member_mode_cache_set(npu_id, mode->member_id, NULL, &mode->egress_disable);
+                ++sai_sets;
+            }
+        }
+
+        if (ret != STD_ERR_OK) {
+            NDI_LAG_LOG_ERROR("Lag member %lld mode set failed in NPU %d",
+                    mode->member_id, npu_id);
+            rc = ret;
+        }
+        if (status != NULL) {
+            status[ix] = ret;
+        }
+    }
+
+    ndi_lag_member_mode_stats_add(sai_sets, noops, 0);
+    return rc;
 }
 
 t_std_error ndi_set_lag_member_attr(npu_id_t npu_id, ndi_obj_id_t ndi_lag_member_id,
@@ -187,8 +345,8 @@ t_std_error ndi_set_lag_member_attr(npu_id_t npu_id, ndi_obj_id_t ndi_lag_member
     return STD_ERR_OK;
 }
 
-t_std_error ndi_get_lag_port_mode (npu_id_t npu_id,ndi_obj_id_t ndi_lag_member_id,
-                                   bool *egr_disable)
+t_std_error ndi_get_lag_member_mode(npu_id_t npu_id, ndi_obj_id_t ndi_lag_member_id,
+                                    bool *ingress_disable, bool *egress_disable)
 {
     sai_status_t sai_ret = SAI_STATUS_FAILURE;
 
@@ -197,27 +355,53 @@ t_std_error ndi_get_lag_port_mode (npu_id_t npu_id,ndi_obj_id_t ndi_lag_member_i
         return STD_ERR(INTERFACE, CFG,0);
     }
 
+    if (ndi_lag_member_mode_cache_get(npu_id, ndi_lag_member_id,
+                                      ingress_disable, egress_disable)) {
+        ndi_lag_member_mode_stats_add(0, 0, 1);
+        return STD_ERR_OK;
+    }
+
     NDI_LAG_LOG_INFO("Get port mode in NPU %d lag member id%lld",
             npu_id,ndi_lag_member_id);
 
-    sai_attribute_t sai_lag_member_attr;
-    memset (&sai_lag_member_attr, 0, sizeof (sai_lag_member_attr));
+    /*  Only ask SAI for the attributes the caller wants */
+    sai_attribute_t sai_lag_member_attr[2];
+    unsigned int count = 0;
+    memset (sai_lag_member_attr, 0, sizeof (sai_lag_member_attr));
 
-    sai_lag_member_attr.id = SAI_LAG_MEMBER_ATTR_EGRESS_DISABLE;
+    if (ingress_disable) {
+        sai_lag_member_attr[count++].id = SAI_LAG_MEMBER_ATTR_INGRESS_DISABLE;
+    }
+    if (egress_disable) {
+        sai_lag_member_attr[count++].id = SAI_LAG_MEMBER_ATTR_EGRESS_DISABLE;
+    }
+    if (count == 0) {
+        return STD_ERR_OK;
+    }
 
     if((sai_ret = ndi_sai_lag_api(ndi_db_ptr)->get_lag_member_attribute(ndi_lag_member_id,
-                    1, &sai_lag_member_attr)) != SAI_STATUS_SUCCESS) {
+                    count, sai_lag_member_attr)) != SAI_STATUS_SUCCESS) {
         NDI_LAG_LOG_ERROR("Lag port mode get Failure");
         return STD_ERR(INTERFACE, CFG, sai_ret);
     }
 
-    if (egr_disable) {
-        *egr_disable = sai_lag_member_attr.value.booldata;
+    count = 0;
+    if (ingress_disable) {
+        *ingress_disable = sai_lag_member_attr[count++].value.booldata;
+    }
+    if (egress_disable) {
+        *egress_disable = sai_lag_member_attr[count++].value.booldata;
     }
 
     return STD_ERR_OK;
 }
 
+t_std_error ndi_get_lag_port_mode (npu_id_t npu_id,ndi_obj_id_t ndi_lag_member_id,
+                                   bool *egr_disable)
+{
+    return ndi_get_lag_member_mode(npu_id, ndi_lag_member_id, NULL, egr_disable);
+}
+
 t_std_error ndi_get_lag_member_attr(npu_id_t npu_id, ndi_obj_id_t ndi_lag_member_id,
         bool* egress_disable)
 {
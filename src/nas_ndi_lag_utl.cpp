@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2016 Dell Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License. You may obtain
+ * a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * THIS CODE IS PROVIDED ON AN *AS IS* BASIS, WITHOUT WARRANTIES OR
+ * CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ * LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ * FOR A PARTICULAR PURPOSE, MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ * See the Apache Version 2.0 License for specific language governing
+ * permissions and limitations under the License.
+ */
+
+/*
+ * filename: nas_ndi_lag_utl.cpp
+ */
+
+#include "std_error_codes.h"
+#include "std_mutex_lock.h"
+#include "nas_ndi_event_logs.h"
+#include "nas_ndi_lag_utl.h"
+
+#include <stdint.h>
+#include <map>
+#include <new>
+#include <tuple>
+
+/*  This file keeps the LAG members created through NDI, indexed both by
+ *  (npu, LAG, port) and by member id, so LAG members can be removed by
+ *  port without the caller tracking member ids. Each member also caches
+ *  its ingress/egress disable state so mode gets and no-op mode sets do
+ *  not go to SAI.
+ */
+
+typedef struct _ndi_lag_member_t {
+    ndi_obj_id_t lag_id;
+    ndi_port_t   port;
+    bool         ingress_disable;
+    bool         egress_disable;
+} ndi_lag_member_t;
+
+/*  key is (npu_id, lag_id, port npu_id, npu_port) */
+typedef std::tuple<npu_id_t, ndi_obj_id_t, npu_id_t, npu_port_t> ndi_lag_port_key_t;
+
+/*  key is (npu_id, member_id) */
+typedef std::pair<npu_id_t, ndi_obj_id_t> ndi_lag_member_key_t;
+
+static std::map<ndi_lag_port_key_t, ndi_obj_id_t> g_ndi_lag_port_tbl;
+static std::map<ndi_lag_member_key_t, ndi_lag_member_t> g_ndi_lag_member_tbl;
+
+static ndi_lag_member_mode_stats_t g_ndi_lag_member_mode_stats;
+
+static std_mutex_lock_create_static_init_rec(lag_member_lock);
+
+static inline ndi_lag_port_key_t ndi_lag_port_key(npu_id_t npu_id, ndi_obj_id_t lag_id,
+                                                  const ndi_port_t &port)
+{
+    return std::make_tuple(npu_id, lag_id, port.npu_id, port.npu_port);
+}
+
+extern "C" {
+
+t_std_error ndi_lag_member_index_add(npu_id_t npu_id, ndi_obj_id_t ndi_lag_id,
+                                     const ndi_port_t *ndi_port, ndi_obj_id_t ndi_lag_member_id)
+{
+    std_mutex_simple_lock_guard g(&lag_member_lock);
+
+    /*  drop whatever the port or the member id stood for before, so that
+     *  neither table keeps an entry the other one doesn't know
+     */
+    ndi_lag_port_key_t port_key = ndi_lag_port_key(npu_id, ndi_lag_id, *ndi_port);
+    auto port_it = g_ndi_lag_port_tbl.find(port_key);
+    if (port_it != g_ndi_lag_port_tbl.end()) {
+        g_ndi_lag_member_tbl.erase(std::make_pair(npu_id, port_it->second));
+    }
+    auto member_it = g_ndi_lag_member_tbl.find(std::make_pair(npu_id, ndi_lag_member_id));
+    if (member_it != g_ndi_lag_member_tbl.end()) {
+        g_ndi_lag_port_tbl.erase(ndi_lag_port_key(npu_id, member_it->second.lag_id,
+                                                  member_it->second.port));
+    }
+
+    try {
+        g_ndi_lag_port_tbl[port_key] = ndi_lag_member_id;
+    } catch (std::bad_alloc &) {
+        NDI_LAG_LOG_ERROR("Out of memory recording member %lld of Lag ID %lld",
+                          ndi_lag_member_id, ndi_lag_id);
+        return STD_ERR(INTERFACE, NOMEM, 0);
+    }
+    try {
+        /*  New members come up with both directions enabled */
+        g_ndi_lag_member_tbl[std::make_pair(npu_id, ndi_lag_member_id)] =
+            { ndi_lag_id, *ndi_port, false, false };
+    } catch (std::bad_alloc &) {
+        g_ndi_lag_port_tbl.erase(port_key);
+        NDI_LAG_LOG_ERROR("Out of memory recording member %lld of Lag ID %lld",
+                          ndi_lag_member_id, ndi_lag_id);
+        return STD_ERR(INTERFACE, NOMEM, 0);
+    }
+    return STD_ERR_OK;
+}
+
+void ndi_lag_member_index_del(npu_id_t npu_id, ndi_obj_id_t ndi_lag_member_id)
+{
+    std_mutex_simple_lock_guard g(&lag_member_lock);
+
+    auto it = g_ndi_lag_member_tbl.find(std::make_pair(npu_id, ndi_lag_member_id));
+    if (it == g_ndi_lag_member_tbl.end()) {
+        return;
+    }
+    g_ndi_lag_port_tbl.erase(ndi_lag_port_key(npu_id, it->second.lag_id, it->second.port));
+    g_ndi_lag_member_tbl.erase(it);
+}
+
+void ndi_lag_member_index_lag_delete(npu_id_t npu_id, ndi_obj_id_t ndi_lag_id)
+{
+    std_mutex_simple_lock_guard g(&lag_member_lock);
+
+    auto it = g_ndi_lag_member_tbl.begin();
+    while (it != g_ndi_lag_member_tbl.end()) {
+        if ((it->first.first == npu_id) && (it->second.lag_id == ndi_lag_id)) {
+            g_ndi_lag_port_tbl.erase(ndi_lag_port_key(npu_id, ndi_lag_id, it->second.port));
+            it = g_ndi_lag_member_tbl.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void ndi_lag_member_index_port_delete(npu_id_t npu_id, npu_port_t port_id)
+{
+    std_mutex_simple_lock_guard g(&lag_member_lock);
+
+    auto it = g_ndi_lag_member_tbl.begin();
+    while (it != g_ndi_lag_member_tbl.end()) {
+        if ((it->second.port.npu_id == npu_id) && (it->second.port.npu_port == port_id)) {
+            g_ndi_lag_port_tbl.erase(ndi_lag_port_key(it->first.first, it->second.lag_id,
+                                                      it->second.port));
+            it = g_ndi_lag_member_tbl.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+bool ndi_lag_member_mode_cache_get(npu_id_t npu_id, ndi_obj_id_t ndi_lag_member_id,
+                                   bool *ingress_disable, bool *egress_disable)
+{
+    std_mutex_simple_lock_guard g(&lag_member_lock);
+
+    auto it = g_ndi_lag_member_tbl.find(std::make_pair(npu_id, ndi_lag_member_id));
+    if (it == g_ndi_lag_member_tbl.end()) {
+        return false;
+    }
+    if (ingress_disable != NULL) *ingress_disable = it->second.ingress_disable;
+    if (egress_disable != NULL) *egress_disable = it->second.egress_disable;
+    return true;
+}
+
+void ndi_lag_member_mode_cache_set(npu_id_t npu_id, ndi_obj_id_t ndi_lag_member_id,
+                                   const bool *ingress_disable, const bool *egress_disable)
+{
+    std_mutex_simple_lock_guard g(&lag_member_lock);
+
+    auto it = g_ndi_lag_member_tbl.find(std::make_pair(npu_id, ndi_lag_member_id));
+    if (it == g_ndi_lag_member_tbl.end()) {
+        return;
+    }
+    if (ingress_disable != NULL) it->second.ingress_disable = *ingress_disable;
+    if (egress_disable != NULL) it->second.egress_disable = *egress_disable;
+}
+
+void ndi_lag_member_mode_stats_add(uint64_t sai_sets, uint64_t noop_suppressed,
+                                   uint64_t get_cache_hits)
+{
+    std_mutex_simple_lock_guard g(&lag_member_lock);
+
+    g_ndi_lag_member_mode_stats.sai_sets += sai_sets;
+    g_ndi_lag_member_mode_stats.noop_suppressed += noop_suppressed;
+    g_ndi_lag_member_mode_stats.get_cache_hits += get_cache_hits;
+}
+
+void ndi_lag_member_mode_stats_get(ndi_lag_member_mode_stats_t *stats)
+{
+    if (stats == NULL) return;
+
+    std_mutex_simple_lock_guard g(&lag_member_lock);
+    *stats = g_ndi_lag_member_mode_stats;
+}
+
+t_std_error ndi_lag_member_id_get(npu_id_t npu_id, ndi_obj_id_t ndi_lag_id,
+                                  const ndi_port_t *ndi_port,
+                                  ndi_obj_id_t *ndi_lag_member_id)
+{
+    if ((ndi_port == NULL) || (ndi_lag_member_id == NULL)) {
+        return STD_ERR(INTERFACE, PARAM, 0);
+    }
+
+    std_mutex_simple_lock_guard g(&lag_member_lock);
+
+    auto it = g_ndi_lag_port_tbl.find(ndi_lag_port_key(npu_id, ndi_lag_id, *ndi_port));
+    if (it == g_ndi_lag_port_tbl.end()) {
+        return STD_ERR(INTERFACE, FAIL, 0);
+    }
+    *ndi_lag_member_id = it->second;
+    return STD_ERR_OK;
+}
+
+}
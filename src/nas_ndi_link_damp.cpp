@@ -0,0 +1,374 @@
+/*
+ * Copyright (c) 2016 Dell Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License. You may obtain
+ * a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * THIS CODE IS PROVIDED ON AN *AS IS* BASIS, WITHOUT WARRANTIES OR
+ * CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ * LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ * FOR A PARTICULAR PURPOSE, MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ * See the Apache Version 2.0 License for specific language governing
+ * permissions and limitations under the License.
+ */
+
+/*
+ * filename: nas_ndi_link_damp.cpp
+ */
+
+#include "std_error_codes.h"
+#include "std_mutex_lock.h"
+#include "nas_ndi_event_logs.h"
+#include "nas_ndi_link_damp.h"
+
+#include <limits.h>
+#include <math.h>
+#include <string.h>
+#include <time.h>
+#include <tuple>
+#include <vector>
+#include <unordered_map>
+
+/*  This file filters SAI port oper state changes before they reach NAS.
+ *  It runs in the NDI event thread: ndi_link_damp_event() is fed every SAI
+ *  transition and ndi_link_damp_tick() is called when the event thread
+ *  wakes up for the next timer. A port is only reported once its state has
+ *  been stable for the hold time, and a port that keeps flapping is held
+ *  down until its dampening penalty decays.
+ */
+
+typedef struct _ndi_link_damp_port_t {
+    bool has_cfg = false;
+    ndi_link_damp_cfg_t cfg;
+
+    bool raw_valid = false;
+    ndi_port_oper_status_t raw_state;
+    bool reported_valid = false;
+    ndi_port_oper_status_t reported_state;
+
+    bool pending = false;
+    ndi_port_oper_status_t pending_state;
+    uint64_t pending_deadline = 0;
+
+    bool suppressed = false;
+    double penalty = 0;
+    uint64_t penalty_time = 0;
+
+    /*  0 when no timer is due for the port */
+    uint64_t next_check = 0;
+
+    uint64_t transitions = 0;
+    uint64_t flaps = 0;
+    uint64_t reported = 0;
+} ndi_link_damp_port_t;
+
+typedef std::unordered_map<uint64_t, ndi_link_damp_port_t> ndi_link_damp_tbl_t;
+
+typedef std::tuple<npu_id_t, npu_port_t, ndi_port_oper_status_t> ndi_link_damp_emit_t;
+
+static ndi_link_damp_tbl_t g_ndi_link_damp_tbl;
+static ndi_link_damp_cfg_t g_ndi_link_damp_default_cfg;
+
+static std_mutex_lock_create_static_init_rec(link_damp_lock);
+
+static inline uint64_t ndi_link_damp_key(npu_id_t npu_id, npu_port_t port_id)
+{
+    return (((uint64_t)npu_id << 32) | port_id);
+}
+
+static uint64_t ndi_link_damp_now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000) + (ts.tv_nsec / 1000000);
+}
+
+static inline const ndi_link_damp_cfg_t &ndi_link_damp_port_cfg(const ndi_link_damp_port_t &port)
+{
+    return port.has_cfg ? port.cfg : g_ndi_link_damp_default_cfg;
+}
+
+static void ndi_link_damp_decay(ndi_link_damp_port_t &port, const ndi_link_damp_cfg_t &cfg,
+                                uint64_t now)
+{
+    if ((port.penalty > 0) && (cfg.half_life_ms != 0) && (now > port.penalty_time)) {
+        port.penalty *= exp2(-(double)(now - port.penalty_time) / cfg.half_life_ms);
+    }
+    port.penalty_time = now;
+}
+
+/*  A suppressed port is released once its penalty is down to the reuse threshold */
+static inline bool ndi_link_damp_reusable(const ndi_link_damp_port_t &port,
+                                          const ndi_link_damp_cfg_t &cfg)
+{
+    return !cfg.damp_enable || (port.penalty <= cfg.reuse_threshold);
+}
+
+/*  Time at which a suppressed port becomes reusable, always after now so
+ *  the event thread never polls without waiting
+ */
+static uint64_t ndi_link_damp_reuse_time(const ndi_link_damp_port_t &port,
+                                         const ndi_link_damp_cfg_t &cfg, uint64_t now)
+{
+    uint64_t reuse = now + 1;
+    if (!ndi_link_damp_reusable(port, cfg)) {
+        double dt = cfg.half_life_ms * log2(port.penalty / cfg.reuse_threshold);
+        reuse = port.penalty_time + (uint64_t)ceil(dt) + 1;
+    }
+    return (reuse > now) ? reuse : now + 1;
+}
+
+/*  Dampening needs a decay and a reuse threshold, or a suppressed port
+ *  would never be released
+ */
+static bool ndi_link_damp_cfg_valid(const ndi_link_damp_cfg_t *cfg)
+{
+    return !cfg->damp_enable ||
+           ((cfg->half_life_ms != 0) && (cfg->reuse_threshold != 0) &&
+            (cfg->reuse_threshold <= cfg->suppress_threshold));
+}
+
+/*  Work out what NAS should see for the port and report it once stable */
+static void ndi_link_damp_evaluate(npu_id_t npu_id, npu_port_t port_id,
+                                   ndi_link_damp_port_t &port, uint64_t now,
+                                   std::vector<ndi_link_damp_emit_t> &emits)
+{
+    const ndi_link_damp_cfg_t &cfg = ndi_link_damp_port_cfg(port);
+
+    if (port.suppressed) {
+        ndi_link_damp_decay(port, cfg, now);
+        if (ndi_link_damp_reusable(port, cfg)) {
+            port.suppressed = false;
+            NDI_PORT_LOG_TRACE("Port %d:%d link dampening released", npu_id, port_id);
+        }
+    }
+
+    ndi_port_oper_status_t target = port.suppressed ? ndi_port_OPER_DOWN : port.raw_state;
+
+    port.next_check = 0;
+    if (port.reported_valid && (target == port.reported_state)) {
+        port.pending = false;
+    } else {
+        uint32_t hold = (target == ndi_port_OPER_UP) ? cfg.hold_up_ms : cfg.hold_down_ms;
+        if (!port.pending || (port.pending_state != target)) {
+            port.pending = true;
+            port.pending_state = target;
+            port.pending_deadline = now + hold;
+        }
+        if (now >= port.pending_deadline) {
+            port.pending = false;
+            port.reported_valid = true;
+            port.reported_state = target;
+            ++port.reported;
+            emits.emplace_back(npu_id, port_id, target);
+        } else {
+            port.next_check = port.pending_deadline;
+        }
+    }
+
+    if (port.suppressed) {
+        uint64_t reuse = ndi_link_damp_reuse_time(port, cfg, now);
+        if ((port.next_check == 0) || (reuse < port.next_check)) {
+            port.next_check = reuse;
+        }
+    }
+}
+
+static void ndi_link_damp_emit_all(const std::vector<ndi_link_damp_emit_t> &emits,
+                                   ndi_link_damp_emit_fn emit)
+{
+    if (emit == NULL) return;
+    for (auto &e : emits) {
+        emit(std::get<0>(e), std::get<1>(e), std::get<2>(e));
+    }
+}
+
+extern "C" {
+
+t_std_error ndi_link_damp_default_cfg_set(const ndi_link_damp_cfg_t *cfg)
+{
+    if ((cfg == NULL) || !ndi_link_damp_cfg_valid(cfg)) {
+        return STD_ERR(NPU, PARAM, 0);
+    }
+
+    std_mutex_simple_lock_guard g(&link_damp_lock);
+    g_ndi_link_damp_default_cfg = *cfg;
+    return STD_ERR_OK;
+}
+
+t_std_error ndi_link_damp_port_cfg_set(npu_id_t npu_id, npu_port_t port_id,
+                                       const ndi_link_damp_cfg_t *cfg)
+{
+    if ((cfg != NULL) && !ndi_link_damp_cfg_valid(cfg)) {
+        return STD_ERR(NPU, PARAM, 0);
+    }
+
+    std_mutex_simple_lock_guard g(&link_damp_lock);
+    try {
+        ndi_link_damp_port_t &port = g_ndi_link_damp_tbl[ndi_link_damp_key(npu_id, port_id)];
+        port.has_cfg = (cfg != NULL);
+        if (cfg != NULL) {
+            port.cfg = *cfg;
+        }
+    } catch (...) {
+        return STD_ERR(NPU, NOMEM, 0);
+    }
+    return STD_ERR_OK;
+}
+
+t_std_error ndi_link_damp_state_get(npu_id_t npu_id, npu_port_t port_id,
+                                    ndi_link_damp_state_t *state)
+{
+    if (state == NULL) {
+        return STD_ERR(NPU, PARAM, 0);
+    }
+
+    std_mutex_simple_lock_guard g(&link_damp_lock);
+
+    auto it = g_ndi_link_damp_tbl.find(ndi_link_damp_key(npu_id, port_id));
+    if (it == g_ndi_link_damp_tbl.end()) {
+        return STD_ERR(NPU, FAIL, 0);
+    }
+    ndi_link_damp_port_t &port = it->second;
+
+    ndi_link_damp_decay(port, ndi_link_damp_port_cfg(port), ndi_link_damp_now_ms());
+
+    memset(state, 0, sizeof(*state));
+    state->raw_state = port.raw_state;
+    state->reported_state = port.reported_state;
+    state->pending = port.pending;
+    state->suppressed = port.suppressed;
+    state->penalty = (uint32_t)port.penalty;
+    state->transitions = port.transitions;
+    state->flaps = port.flaps;
+    state->reported = port.reported;
+    state->filtered = (port.transitions > port.reported) ? port.transitions - port.reported : 0;
+    return STD_ERR_OK;
+}
+
+t_std_error ndi_link_damp_counters_clear(npu_id_t npu_id, npu_port_t port_id)
+{
+    std_mutex_simple_lock_guard g(&link_damp_lock);
+
+    auto it = g_ndi_link_damp_tbl.find(ndi_link_damp_key(npu_id, port_id));
+    if (it == g_ndi_link_damp_tbl.end()) {
+        return STD_ERR(NPU, FAIL, 0);
+    }
+    it->second.transitions = 0;
+    it->second.flaps = 0;
+    it->second.reported = 0;
+    return STD_ERR_OK;
+}
+
+void ndi_link_damp_event(npu_id_t npu_id, npu_port_t port_id,
+                         ndi_port_oper_status_t state, ndi_link_damp_emit_fn emit)
+{
+    std::vector<ndi_link_damp_emit_t> emits;
+    uint64_t now = ndi_link_damp_now_ms();
+
+    {
+        std_mutex_simple_lock_guard g(&link_damp_lock);
+
+        try {
+            ndi_link_damp_port_t &port = g_ndi_link_damp_tbl[ndi_link_damp_key(npu_id, port_id)];
+            const ndi_link_damp_cfg_t &cfg = ndi_link_damp_port_cfg(port);
+
+            /*  SAI may repeat a state, it is not a transition */
+            if (port.raw_valid && (port.raw_state == state)) {
+                return;
+            }
+            ++port.transitions;
+
+            if (port.raw_valid && (port.raw_state == ndi_port_OPER_UP)) {
+                ++port.flaps;
+                if (cfg.damp_enable) {
+                    ndi_link_damp_decay(port, cfg, now);
+                    port.penalty += cfg.flap_penalty;
+                    if ((cfg.max_penalty != 0) && (port.penalty > cfg.max_penalty)) {
+                        port.penalty = cfg.max_penalty;
+                    }
+                    if (!port.suppressed && (port.penalty >= cfg.suppress_threshold)) {
+                        port.suppressed = true;
+                        NDI_PORT_LOG_TRACE("Port %d:%d link dampening suppressed, penalty %d",
+                                           npu_id, port_id, (int)port.penalty);
+                    }
+                }
+            }
+
+            port.raw_valid = true;
+            port.raw_state = state;
+            ndi_link_damp_evaluate(npu_id, port_id, port, now, emits);
+        } catch (...) {
+            NDI_PORT_LOG_ERROR("Link state filter failure for port %d:%d", npu_id, port_id);
+            emits.clear();
+            emits.emplace_back(npu_id, port_id, state);
+        }
+    }
+    ndi_link_damp_emit_all(emits, emit);
+}
+
+void ndi_link_damp_tick(ndi_link_damp_emit_fn emit)
+{
+    std::vector<ndi_link_damp_emit_t> emits;
+    uint64_t now = ndi_link_damp_now_ms();
+
+    {
+        std_mutex_simple_lock_guard g(&link_damp_lock);
+
+        for (auto &it : g_ndi_link_damp_tbl) {
+            ndi_link_damp_port_t &port = it.second;
+            if ((port.next_check == 0) || (port.next_check > now) || !port.raw_valid) {
+                continue;
+            }
+            ndi_link_damp_evaluate((npu_id_t)(it.first >> 32), (npu_port_t)it.first,
+                                   port, now, emits);
+        }
+    }
+    ndi_link_damp_emit_all(emits, emit);
+}
+
+int ndi_link_damp_next_timeout_ms(void)
+{
+    uint64_t next = 0;
+    uint64_t now = ndi_link_damp_now_ms();
+
+    std_mutex_simple_lock_guard g(&link_damp_lock);
+
+    for (auto &it : g_ndi_link_damp_tbl) {
+        uint64_t check = it.second.next_check;
+        if ((check != 0) && ((next == 0) || (check < next))) {
+            next = check;
+        }
+    }
+    if (next == 0) {
+        return -1;
+    }
+    if (next <= now) {
+        return 0;
+    }
+    /*  a long suppress or half-life can put the next check beyond an int */
+    return (next - now > (uint64_t)INT_MAX) ? INT_MAX : (int)(next - now);
+}
+
+void ndi_link_damp_port_delete(npu_id_t npu_id, npu_port_t port_id)
+{
+    std_mutex_simple_lock_guard g(&link_damp_lock);
+
+    auto it = g_ndi_link_damp_tbl.find(ndi_link_damp_key(npu_id, port_id));
+    if (it == g_ndi_link_damp_tbl.end()) {
+        return;
+    }
+    /*  keep the port configuration for when the port comes back */
+    if (it->second.has_cfg) {
+        ndi_link_damp_cfg_t cfg = it->second.cfg;
+        it->second = ndi_link_damp_port_t();
+        it->second.has_cfg = true;
+        it->second.cfg = cfg;
+    } else {
+        g_ndi_link_damp_tbl.erase(it);
+    }
+}
+
+} //extern "C"
@@ -22,12 +22,16 @@
 #include "std_assert.h"
 #include "ds_common_types.h"
 #include "dell-base-platform-common.h"
+#include "dell-interface.h"
 
 #include "nas_ndi_event_logs.h"
 #include "nas_ndi_int.h"
 #include "nas_ndi_utils.h"
 #include "nas_ndi_port.h"
 #include "nas_ndi_port_utils.h"
+#include "nas_ndi_plat_stat.h"
+#include "nas_ndi_stat_baseline.h"
+#include "nas_ndi_qos_pg_binding.h"
 #include "sai.h"
 #include "saiport.h"
 #include "saistatus.h"
@@ -35,6 +39,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 
 /*  NDI Port specific APIs  */
@@ -49,13 +54,66 @@ typedef enum  {
     SAI_SG_ACT_GET
 } SAI_SET_OR_GET_ACTION_t;
 
+typedef enum {
+    NDI_PORT_ATTR_BOOL,
+    NDI_PORT_ATTR_U32,          /*  u32, and enums held in s32 */
+} ndi_port_attr_val_type_t;
+
+typedef struct {
+    sai_attr_id_t id;
+    ndi_port_attr_val_type_t type;
+} ndi_port_attr_desc_t;
+
+/*  Attributes ndi_port_attr_set_multi accepts, in the order they are
+ *  applied. Admin state must stay last, admin down is moved to the front. */
+static const ndi_port_attr_desc_t ndi_port_attr_set_order[] = {
+    {SAI_PORT_ATTR_SPEED,               NDI_PORT_ATTR_U32},
+    {SAI_PORT_ATTR_FULL_DUPLEX_MODE,    NDI_PORT_ATTR_BOOL},
+    {SAI_PORT_ATTR_AUTO_NEG_MODE,       NDI_PORT_ATTR_BOOL},
+    {SAI_PORT_ATTR_INTERNAL_LOOPBACK,   NDI_PORT_ATTR_U32},
+    {SAI_PORT_ATTR_MTU,                 NDI_PORT_ATTR_U32},
+    {SAI_PORT_ATTR_FDB_LEARNING,        NDI_PORT_ATTR_U32},
+    {SAI_PORT_ATTR_DROP_TAGGED,         NDI_PORT_ATTR_BOOL},
+    {SAI_PORT_ATTR_DROP_UNTAGGED,       NDI_PORT_ATTR_BOOL},
+    {SAI_PORT_ATTR_INGRESS_FILTERING,   NDI_PORT_ATTR_BOOL},
+    {SAI_PORT_ATTR_ADMIN_STATE,         NDI_PORT_ATTR_BOOL},
+};
+
+#define NDI_PORT_ATTR_SET_MAX \
+    (sizeof(ndi_port_attr_set_order)/sizeof(ndi_port_attr_set_order[0]))
+
+/*  Position of an attribute in ndi_port_attr_set_order, false if it isn't there */
+static bool ndi_port_attr_rank_get(sai_attr_id_t id, size_t *rank)
+{
+    size_t ix = 0;
+    for ( ; ix < NDI_PORT_ATTR_SET_MAX; ++ix) {
+        if (ndi_port_attr_set_order[ix].id == id) {
+            *rank = ix;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool ndi_port_attr_value_equal(size_t rank, const sai_attribute_value_t *a,
+                                      const sai_attribute_value_t *b)
+{
+    if (ndi_port_attr_set_order[rank].type == NDI_PORT_ATTR_BOOL) {
+        return a->booldata == b->booldata;
+    }
+    return a->u32 == b->u32;
+}
+
 t_std_error _sai_port_attr_set_or_get(npu_id_t npu, port_t port, SAI_SET_OR_GET_ACTION_t set,
         sai_attribute_t *attr, size_t count) {
     STD_ASSERT(attr != NULL);
 
-    if (count==0 || ((set==SAI_SG_ACT_SET) && (count >1))) {
+    if (count==0) {
         return STD_ERR(NPU, PARAM, 0);
     }
+    if ((set==SAI_SG_ACT_SET) && (count >1)) {
+        return ndi_port_attr_set_multi(npu, port, attr, count);
+    }
 
     nas_ndi_db_t *ndi_db_ptr = ndi_db_ptr_get(npu);
     if (ndi_db_ptr == NULL) {
@@ -72,6 +130,10 @@ t_std_error _sai_port_attr_set_or_get(npu_id_t npu, port_t port, SAI_SET_OR_GET_
     sai_status_t sai_ret = SAI_STATUS_SUCCESS;
     if (set==SAI_SG_ACT_SET) {
         sai_ret = ndi_sai_port_api_tbl_get(ndi_db_ptr)->set_port_attribute(sai_port,attr);
+        size_t rank;
+        if ((sai_ret == SAI_STATUS_SUCCESS) && ndi_port_attr_rank_get(attr->id, &rank)) {
+            ndi_port_attr_cache_set(npu, port, attr);
+        }
     } else {
         sai_ret = ndi_sai_port_api_tbl_get(ndi_db_ptr)->get_port_attribute(sai_port, count, attr);
     }
@@ -81,6 +143,241 @@ t_std_error _sai_port_attr_set_or_get(npu_id_t npu, port_t port, SAI_SET_OR_GET_
             STD_ERR(NPU, CFG, sai_ret);
 }
 
+/*  Restore applied attributes, newest first, after a failed transaction */
+static void ndi_port_attr_set_rollback(nas_ndi_db_t *ndi_db_ptr, npu_id_t npu_id,
+                                       npu_port_t port_id, sai_object_id_t sai_port,
+                                       const sai_attribute_t *prev, const size_t *applied,
+                                       size_t applied_count)
+{
+    while (applied_count > 0) {
+        const sai_attribute_t *attr = &prev[applied[--applied_count]];
+        if (ndi_sai_port_api_tbl_get(ndi_db_ptr)->set_port_attribute(sai_port, attr)
+                == SAI_STATUS_SUCCESS) {
+            ndi_port_attr_cache_set(npu_id, port_id, attr);
+        } else {
+            NDI_PORT_LOG_ERROR("Unable to restore attribute %d of npu %d port %d",
+                               attr->id, npu_id, port_id);
+            ndi_port_attr_cache_clear(npu_id, port_id, attr->id);
+        }
+    }
+}
+
+t_std_error ndi_port_attr_set_multi(npu_id_t npu_id, npu_port_t port_id,
+                                    const sai_attribute_t *attr_list, size_t count)
+{
+    if ((attr_list == NULL) || (count == 0) || (count > NDI_PORT_ATTR_SET_MAX)) {
+        return STD_ERR(NPU, PARAM, 0);
+    }
+
+    /*  requested value of each attribute, indexed by its application rank */
+    const sai_attribute_t *target[NDI_PORT_ATTR_SET_MAX];
+    memset(target, 0, sizeof(target));
+
+    size_t ix = 0;
+    size_t rank = 0;
+    for ( ; ix < count; ++ix) {
+        if (!ndi_port_attr_rank_get(attr_list[ix].id, &rank) || (target[rank] != NULL)) {
+            NDI_PORT_LOG_ERROR("Attribute %d can't be part of a port set on npu %d port %d",
+                               attr_list[ix].id, npu_id, port_id);
+            return STD_ERR(NPU, PARAM, 0);
+        }
+        target[rank] = &attr_list[ix];
+    }
+
+    nas_ndi_db_t *ndi_db_ptr = ndi_db_ptr_get(npu_id);
+    if (ndi_db_ptr == NULL) {
+        return STD_ERR(NPU, PARAM, 0);
+    }
+
+    sai_object_id_t sai_port;
+    t_std_error rc = ndi_sai_port_id_get(npu_id, port_id, &sai_port);
+    if (rc != STD_ERR_OK) {
+        return rc;
+    }
+
+    /*  the port is taken down before and brought up after everything else */
+    const size_t admin_rank = NDI_PORT_ATTR_SET_MAX - 1;
+    bool admin_down = (target[admin_rank] != NULL) && !target[admin_rank]->value.booldata;
+
+    size_t order[NDI_PORT_ATTR_SET_MAX];
+    size_t order_count = 0;
+    if (admin_down) {
+        order[order_count++] = admin_rank;
+    }
+    for (rank = 0; rank < admin_rank; ++rank) {
+        if (target[rank] != NULL) {
+            order[order_count++] = rank;
+        }
+    }
+    if ((target[admin_rank] != NULL) && !admin_down) {
+        order[order_count++] = admin_rank;
+    }
+
+    /*  previous values come from the cache, the rest from one SAI get */
+    sai_attribute_t prev[NDI_PORT_ATTR_SET_MAX];
+    sai_attribute_t hw_attr[NDI_PORT_ATTR_SET_MAX];
+    size_t hw_rank[NDI_PORT_ATTR_SET_MAX];
+    size_t hw_count = 0;
+
+    for (ix = 0; ix < order_count; ++ix) {
+        rank = order[ix];
+        prev[rank].id = ndi_port_attr_set_order[rank].id;
+        if (!ndi_port_attr_cache_get(npu_id, port_id, prev[rank].id, &prev[rank].value)) {
+            memset(&hw_attr[hw_count], 0, sizeof(hw_attr[hw_count]));
+            hw_attr[hw_count].id = prev[rank].id;
+            hw_rank[hw_count++] = rank;
+        }
+    }
+
+    sai_status_t sai_ret = SAI_STATUS_SUCCESS;
+    if (hw_count > 0) {
+        sai_ret = ndi_sai_port_api_tbl_get(ndi_db_ptr)->get_port_attribute(sai_port,
+                                                        hw_count, hw_attr);
+        if (sai_ret != SAI_STATUS_SUCCESS) {
+            NDI_PORT_LOG_ERROR("Unable to read current attributes of npu %d port %d",
+                               npu_id, port_id);
+            return STD_ERR(NPU, CFG, sai_ret);
+        }
+        for (ix = 0; ix < hw_count; ++ix) {
+            prev[hw_rank[ix]].value = hw_attr[ix].value;
+            ndi_port_attr_cache_set(npu_id, port_id, &hw_attr[ix]);
+        }
+    }
+
+    size_t applied[NDI_PORT_ATTR_SET_MAX];
+    size_t applied_count = 0;
+
+    for (ix = 0; ix < order_count; ++ix) {
+        rank = order[ix];
+        if (ndi_port_attr_value_equal(rank, &prev[rank].value, &target[rank]->value)) {
+            continue;
+        }
+        sai_ret = ndi_sai_port_api_tbl_get(ndi_db_ptr)->set_port_attribute(sai_port,
+                                                                           target[rank]);
+        if (sai_ret != SAI_STATUS_SUCCESS) {
+            NDI_PORT_LOG_ERROR("Set of attribute %d failed on npu %d port %d, rolling back",
+                               target[rank]->id, npu_id, port_id);
+            ndi_port_attr_set_rollback(ndi_db_ptr, npu_id, port_id, sai_port, prev,
+                                       applied, applied_count);
+            return STD_ERR(NPU, CFG, sai_ret);
+        }
+        ndi_port_attr_cache_set(npu_id, port_id, target[rank]);
+        applied[applied_count++] = rank;
+    }
+
+    return STD_ERR_OK;
+}
+
+/*  SAI speed attribute for a speed. Speed AUTO is not supported at BASE
+ *  level and is not programmed, *program is false for it.
+ */
+static t_std_error ndi_port_speed_attr_fill(BASE_IF_SPEED_t speed, sai_attribute_t *attr,
+                                            bool *program)
+{
+    *program = false;
+    if (speed == BASE_IF_SPEED_AUTO) {
+        return STD_ERR_OK;
+    }
+    attr->id = SAI_PORT_ATTR_SPEED;
+    if (!ndi_port_get_sai_speed(speed, (uint32_t *)&attr->value.u32)) {
+        NDI_PORT_LOG_ERROR("unsupported Speed %d", (uint32_t)speed);
+        return STD_ERR(NPU, PARAM, 0);
+    }
+    *program = true;
+    return STD_ERR_OK;
+}
+
+/*  Speed programmed on a port, from the attribute cache or else from SAI */
+static bool ndi_port_speed_programmed_get(npu_id_t npu_id, npu_port_t port_id, uint32_t *speed)
+{
+    sai_attribute_t attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.id = SAI_PORT_ATTR_SPEED;
+
+    if (!ndi_port_attr_cache_get(npu_id, port_id, attr.id, &attr.value)) {
+        if (_sai_port_attr_set_or_get(npu_id, port_id, SAI_SG_ACT_GET, &attr, 1) != STD_ERR_OK) {
+            return false;
+        }
+        ndi_port_attr_cache_set(npu_id, port_id, &attr);
+    }
+    *speed = attr.value.u32;
+    return true;
+}
+
+/*  Set port attributes including the speed, attr_list[speed_ix]. Lossless
+ *  priority groups may need a new headroom at a new speed, the QoS code is
+ *  told when the speed changed or its old value can't be read.
+ */
+static t_std_error ndi_port_speed_attrs_set(npu_id_t npu_id, npu_port_t port_id,
+                                            const sai_attribute_t *attr_list, size_t count,
+                                            size_t speed_ix, BASE_IF_SPEED_t speed)
+{
+    uint32_t prev_speed = 0;
+    bool prev_known = ndi_port_speed_programmed_get(npu_id, port_id, &prev_speed);
+
+    t_std_error rc = ndi_port_attr_set_multi(npu_id, port_id, attr_list, count);
+    if ((rc == STD_ERR_OK) && (!prev_known || (prev_speed != attr_list[speed_ix].value.u32))) {
+        ndi_qos_pg_port_speed_changed(npu_id, port_id, speed);
+    }
+    return rc;
+}
+
+t_std_error ndi_port_profile_set(npu_id_t npu_id, npu_port_t port_id,
+                                 const ndi_port_profile_t *profile)
+{
+    STD_ASSERT(profile != NULL);
+
+    sai_attribute_t sai_attr[NDI_PORT_ATTR_SET_MAX];
+    size_t count = 0;
+    memset(sai_attr, 0, sizeof(sai_attr));
+
+    bool speed_set = false;
+    if (profile->valid & NDI_PORT_PROFILE_SPEED) {
+        t_std_error rc = ndi_port_speed_attr_fill(profile->speed, &sai_attr[count], &speed_set);
+        if (rc != STD_ERR_OK) {
+            return rc;
+        }
+        if (speed_set) {
+            ++count;
+        }
+    }
+    if (profile->valid & NDI_PORT_PROFILE_DUPLEX) {
+        sai_attr[count].id = SAI_PORT_ATTR_FULL_DUPLEX_MODE;
+        sai_attr[count++].value.booldata = (profile->duplex == BASE_CMN_DUPLEX_TYPE_HALF) ?
+                                                false : true;
+    }
+    if (profile->valid & NDI_PORT_PROFILE_AUTONEG) {
+        sai_attr[count].id = SAI_PORT_ATTR_AUTO_NEG_MODE;
+        sai_attr[count++].value.booldata = profile->autoneg;
+    }
+    if (profile->valid & NDI_PORT_PROFILE_LOOPBACK) {
+        sai_attr[count].id = SAI_PORT_ATTR_INTERNAL_LOOPBACK;
+        sai_attr[count++].value.s32 = ndi_port_get_sai_loopback_mode(profile->loopback);
+    }
+    if (profile->valid & NDI_PORT_PROFILE_MTU) {
+        sai_attr[count].id = SAI_PORT_ATTR_MTU;
+        sai_attr[count++].value.u32 = profile->mtu;
+    }
+    if (profile->valid & NDI_PORT_PROFILE_LEARN_MODE) {
+        sai_attr[count].id = SAI_PORT_ATTR_FDB_LEARNING;
+        sai_attr[count++].value.u32 =
+            (sai_port_fdb_learning_mode_t)ndi_port_get_sai_mac_learn_mode(profile->learn_mode);
+    }
+    if (profile->valid & NDI_PORT_PROFILE_ADMIN_STATE) {
+        sai_attr[count].id = SAI_PORT_ATTR_ADMIN_STATE;
+        sai_attr[count++].value.booldata = profile->admin_state;
+    }
+
+    if (count == 0) {
+        return STD_ERR_OK;
+    }
+    if (speed_set) {
+        /*  the speed is the first attribute */
+        return ndi_port_speed_attrs_set(npu_id, port_id, sai_attr, count, 0, profile->speed);
+    }
+    return ndi_port_attr_set_multi(npu_id, port_id, sai_attr, count);
+}
+
 t_std_error ndi_port_oper_state_notify_register(ndi_port_oper_status_change_fn reg_fn)
 {
     t_std_error ret_code = STD_ERR_OK;
@@ -249,19 +546,19 @@ t_std_error ndi_port_supported_speed_get(npu_id_t npu_id, npu_port_t ndi_port,
 }
 t_std_error ndi_port_speed_set(npu_id_t npu_id, npu_port_t port_id, BASE_IF_SPEED_t speed) {
     sai_attribute_t sai_attr;
-    sai_attr.id = SAI_PORT_ATTR_SPEED;
-    if (speed == BASE_IF_SPEED_AUTO)  {
+    bool speed_set = false;
+    t_std_error rc = ndi_port_speed_attr_fill(speed, &sai_attr, &speed_set);
+    if (rc != STD_ERR_OK) {
+        return rc;
+    }
+    if (!speed_set)  {
         /*  speed==AUTO is not supported at BASE level
          *  TODO just return ok for the time being until it is supported at application layer
          */
         NDI_PORT_LOG_ERROR("Speed AUTO is not supported at BASE level");
         return STD_ERR_OK;
     }
-    if (!ndi_port_get_sai_speed(speed, (uint32_t *)&sai_attr.value.u32)) {
-        NDI_PORT_LOG_ERROR("unsupported Speed %d", (uint32_t)speed);
-        return STD_ERR(NPU, PARAM, 0);
-    }
-    return _sai_port_attr_set_or_get(npu_id,port_id,SAI_SG_ACT_SET,&sai_attr,1);
+    return ndi_port_speed_attrs_set(npu_id, port_id, &sai_attr, 1, 0, speed);
 }
 
 t_std_error ndi_port_mtu_get(npu_id_t npu_id, npu_port_t port_id, uint_t *mtu) {
@@ -304,146 +601,59 @@ t_std_error ndi_port_loopback_set(npu_id_t npu_id, npu_port_t port_id, BASE_CMN_
     return _sai_port_attr_set_or_get(npu_id,port_id,SAI_SG_ACT_SET,&sai_attr,1);
 }
 
-static inline sai_port_media_type_t ndi_sai_port_media_type_translate (PLATFORM_MEDIA_TYPE_t hal_media_type)
+t_std_error ndi_port_media_type_set(npu_id_t npu_id, npu_port_t port_id, PLATFORM_MEDIA_TYPE_t media)
 {
-    sai_port_media_type_t sal_media_type;
-    switch (hal_media_type) {
-        case PLATFORM_MEDIA_TYPE_AR_POPTICS_NOTPRESENT:
-           sal_media_type = SAI_PORT_MEDIA_TYPE_NOT_PRESENT;
-            break;
-        case PLATFORM_MEDIA_TYPE_AR_POPTICS_UNKNOWN:
-           sal_media_type = SAI_PORT_MEDIA_TYPE_UNKNONWN;
-            break;
-        case PLATFORM_MEDIA_TYPE_AR_SFPPLUS_10GBASE_USR:
-        case PLATFORM_MEDIA_TYPE_AR_SFPPLUS_10GBASE_SR:
-        case PLATFORM_MEDIA_TYPE_AR_SFPPLUS_10GBASE_LR:
-        case PLATFORM_MEDIA_TYPE_AR_SFPPLUS_10GBASE_ER:
-        case PLATFORM_MEDIA_TYPE_AR_SFPPLUS_10GBASE_ZR:
-        case PLATFORM_MEDIA_TYPE_AR_SFPPLUS_10GBASE_LRM:
-        case PLATFORM_MEDIA_TYPE_AR_SFPPLUS_10GBASE_DWDM:
-        case PLATFORM_MEDIA_TYPE_AR_SFPPLUS_10GBASE_DWDM_40KM:
-        case PLATFORM_MEDIA_TYPE_AR_SFPPLUS_10GBASE_DWDM_80KM:
-        case PLATFORM_MEDIA_TYPE_SFPPLUS_10GBASE_ZR_TUNABLE:
-        case PLATFORM_MEDIA_TYPE_SFPPLUS_10GBASE_SR_AOCXXM:
-            sal_media_type = SAI_PORT_MEDIA_TYPE_SFP_FIBER;
-            break;
-        case PLATFORM_MEDIA_TYPE_AR_SFPPLUS_10GBASE_T:
-        case PLATFORM_MEDIA_TYPE_AR_SFPPLUS_10GBASE_CUHALFM:
-        case PLATFORM_MEDIA_TYPE_AR_SFPPLUS_10GBASE_CU1M:
-        case PLATFORM_MEDIA_TYPE_AR_SFPPLUS_10GBASE_CU2M:
-        case PLATFORM_MEDIA_TYPE_AR_SFPPLUS_10GBASE_CU3M:
-        case PLATFORM_MEDIA_TYPE_AR_SFPPLUS_10GBASE_CU5M:
-        case PLATFORM_MEDIA_TYPE_AR_SFPPLUS_10GBASE_CU7M:
-        case PLATFORM_MEDIA_TYPE_AR_SFPPLUS_10GBASE_CU10M:
-        case PLATFORM_MEDIA_TYPE_AR_SFPPLUS_10GBASE_ACU7M:
-        case PLATFORM_MEDIA_TYPE_AR_SFPPLUS_10GBASE_ACU10M:
-        case PLATFORM_MEDIA_TYPE_AR_SFPPLUS_10GBASE_ACU15M:
-        case PLATFORM_MEDIA_TYPE_AR_SFPPLUS_10GBASE_CX4:
-            sal_media_type = SAI_PORT_MEDIA_TYPE_SFP_COPPER;
-            break;
-        case PLATFORM_MEDIA_TYPE_AR_QSFP_40GBASE_SR4:
-        case PLATFORM_MEDIA_TYPE_AR_QSFP_40GBASE_SR4_EXT:
-        case PLATFORM_MEDIA_TYPE_AR_QSFP_40GBASE_LR4:
-        case PLATFORM_MEDIA_TYPE_AR_QSFP_40GBASE_PSM4_LR:
-        case PLATFORM_MEDIA_TYPE_AR_QSFP_40GBASE_PSM4_1490NM:
-        case PLATFORM_MEDIA_TYPE_AR_QSFP_40GBASE_PSM4_1490NM_1M:
-        case PLATFORM_MEDIA_TYPE_AR_QSFP_40GBASE_PSM4_1490NM_3M:
-        case PLATFORM_MEDIA_TYPE_AR_QSFP_40GBASE_PSM4_1490NM_5M:
-        case PLATFORM_MEDIA_TYPE_QSFP_40GBASE_SM4:
-        case PLATFORM_MEDIA_TYPE_QSFP_40GBASE_ER4:
-        case PLATFORM_MEDIA_TYPE_AR_QSFP_40GBASE_LM4:
-        case PLATFORM_MEDIA_TYPE_QSFP_40GBASE_BIDI:
-        case PLATFORM_MEDIA_TYPE_QSFP_40GBASE_AOC:
-        case PLATFORM_MEDIA_TYPE_QSFP_40GBASE_PSM4_PIGTAIL:
-            sal_media_type = SAI_PORT_MEDIA_TYPE_QSFP_FIBER;
-            break;
-        case PLATFORM_MEDIA_TYPE_AR_4X1_1000BASE_T:
-        case PLATFORM_MEDIA_TYPE_AR_QSFP_40GBASE_CR4_1M:
-        case PLATFORM_MEDIA_TYPE_AR_QSFP_40GBASE_CR4_HAL_M:
-        case PLATFORM_MEDIA_TYPE_AR_QSFP_40GBASE_CR4_2M:
-        case PLATFORM_MEDIA_TYPE_AR_QSFP_40GBASE_CR4_3M:
-        case PLATFORM_MEDIA_TYPE_AR_QSFP_40GBASE_CR4_5M:
-        case PLATFORM_MEDIA_TYPE_AR_QSFP_40GBASE_CR4_7M:
-        case PLATFORM_MEDIA_TYPE_AR_QSFP_40GBASE_CR4_10M:
-        case PLATFORM_MEDIA_TYPE_AR_QSFP_40GBASE_CR4_50M:
-        case PLATFORM_MEDIA_TYPE_AR_QSFP_40GBASE_CR4:
-        case PLATFORM_MEDIA_TYPE_AR_4X10_10GBASE_CR1_HAL_M:
-        case PLATFORM_MEDIA_TYPE_AR_4X10_10GBASE_CR1_1M:
-        case PLATFORM_MEDIA_TYPE_QSFP_4X10_10GBASE_CR1_2M:
-        case PLATFORM_MEDIA_TYPE_AR_4X10_10GBASE_CR1_3M:
-        case PLATFORM_MEDIA_TYPE_AR_4X10_10GBASE_CR1_5M:
-        case PLATFORM_MEDIA_TYPE_AR_4X10_10GBASE_CR1_7M:
-        case PLATFORM_MEDIA_TYPE_QSFPPLUS_50GBASE_CR2:
-        case PLATFORM_MEDIA_TYPE_QSFPPLUS_50GBASE_CR2_1M:
-        case PLATFORM_MEDIA_TYPE_QSFPPLUS_50GBASE_CR2_2M:
-        case PLATFORM_MEDIA_TYPE_QSFPPLUS_50GBASE_CR2_3M:
-            sal_media_type = SAI_PORT_MEDIA_TYPE_QSFP_COPPER;
-            break;
-        case PLATFORM_MEDIA_TYPE_AR_QSFP28_100GBASE_SR4:
-        case PLATFORM_MEDIA_TYPE_AR_QSFP28_100GBASE_LR4:
-        case PLATFORM_MEDIA_TYPE_AR_QSFP28_100GBASE_PSM4_IR:
-        case PLATFORM_MEDIA_TYPE_AR_QSFP28_100GBASE_AOC:
-        case PLATFORM_MEDIA_TYPE_AR_QSFP28_100GBASE_CWDM4:
-        case PLATFORM_MEDIA_TYPE_QSFP28_100GBASE_LR4_LITE:
-        case PLATFORM_MEDIA_TYPE_QSFP28_100GBASE_ER4:
-        case PLATFORM_MEDIA_TYPE_QSFP28_100GBASE_PSM4_PIGTAIL:
-        case PLATFORM_MEDIA_TYPE_QSFP28_100GBASE_SWDM4:
-            sal_media_type = SAI_PORT_MEDIA_TYPE_QSFP28_FIBER;
-            break;
-        case PLATFORM_MEDIA_TYPE_AR_QSFP28_100GBASE_CR4:
-        case PLATFORM_MEDIA_TYPE_AR_QSFP28_100GBASE_CR4_HAL_M:
-        case PLATFORM_MEDIA_TYPE_AR_QSFP28_100GBASE_CR4_1M:
-        case PLATFORM_MEDIA_TYPE_AR_QSFP28_100GBASE_CR4_2M:
-        case PLATFORM_MEDIA_TYPE_AR_QSFP28_100GBASE_CR4_3M:
-        case PLATFORM_MEDIA_TYPE_AR_QSFP28_100GBASE_CR4_4M:
-        case PLATFORM_MEDIA_TYPE_AR_QSFP28_100GBASE_CR4_5M:
-        case PLATFORM_MEDIA_TYPE_QSFP28_100GBASE_CR4_7M:
-        case PLATFORM_MEDIA_TYPE_QSFP28_100GBASE_CR4_10M:
-        case PLATFORM_MEDIA_TYPE_QSFP28_100GBASE_CR4_50M:
-        case PLATFORM_MEDIA_TYPE_4X25_25GBASE_CR1_HALF_M:
-        case PLATFORM_MEDIA_TYPE_4X25_25GBASE_CR1_1M:
-        case PLATFORM_MEDIA_TYPE_4X25_25GBASE_CR1_2M:
-        case PLATFORM_MEDIA_TYPE_4X25_25GBASE_CR1_3M:
-        case PLATFORM_MEDIA_TYPE_4X25_25GBASE_CR1_4M:
-        case PLATFORM_MEDIA_TYPE_4X25_25GBASE_CR1:
-        case PLATFORM_MEDIA_TYPE_2X50_50GBASE_CR2_HALF_M:
-        case PLATFORM_MEDIA_TYPE_2X50_50GBASE_CR2_1M:
-        case PLATFORM_MEDIA_TYPE_2X50_50GBASE_CR2_2M:
-        case PLATFORM_MEDIA_TYPE_2X50_50GBASE_CR2_3M:
-        case PLATFORM_MEDIA_TYPE_2X50_50GBASE_CR2_4M:
-        case PLATFORM_MEDIA_TYPE_2X50_50GBASE_CR2:
-            sal_media_type = SAI_PORT_MEDIA_TYPE_QSFP28_COPPER;
-            break;
-        default:
-            NDI_PORT_LOG_ERROR("media type is not recognized %d \n", hal_media_type);
-            sal_media_type = SAI_PORT_MEDIA_TYPE_UNKNONWN;
-    }
-    return (sal_media_type);
+    return ndi_port_media_type_set_multi(npu_id, &port_id, 1, media, NULL);
 }
 
-t_std_error ndi_port_media_type_set(npu_id_t npu_id, npu_port_t port_id, PLATFORM_MEDIA_TYPE_t media)
+t_std_error ndi_port_media_type_set_multi(npu_id_t npu_id, const npu_port_t *port_list,
+                                          size_t port_count, PLATFORM_MEDIA_TYPE_t media,
+                                          t_std_error *status)
 {
     t_std_error ret_code = STD_ERR_OK;
+    t_std_error rc;
     sai_status_t sai_ret = SAI_STATUS_FAILURE;
+    sai_port_media_type_t cur_media;
+    size_t ix = 0;
 
     sai_attribute_t sai_attr;
     sai_object_id_t sai_port;
 
     nas_ndi_db_t *ndi_db_ptr = ndi_db_ptr_get(npu_id);
-    if (ndi_db_ptr == NULL) {
+    if ((ndi_db_ptr == NULL) || (port_list == NULL)) {
         return STD_ERR(NPU, PARAM, 0);
     }
 
-    if ((ret_code = ndi_sai_port_id_get(npu_id, port_id, &sai_port) != STD_ERR_OK)) {
-        return ret_code;
-    }
-
-    sai_attr.value.s32 = ndi_sai_port_media_type_translate(media);
+    /*  translated once for every port of the connector */
+    sai_attr.value.s32 = ndi_port_get_sai_media_type(media);
     sai_attr.id = SAI_PORT_ATTR_MEDIA_TYPE;
 
-    if ((sai_ret = ndi_sai_port_api_tbl_get(ndi_db_ptr)->set_port_attribute(sai_port, &sai_attr))
+    for (ix = 0; ix < port_count; ++ix) {
+        rc = STD_ERR_OK;
+
+        if (ndi_port_media_type_cache_get(npu_id, port_list[ix], &cur_media) &&
+            (cur_media == (sai_port_media_type_t)sai_attr.value.s32)) {
+            /*  media unchanged, nothing to program */
+        } else if ((rc = ndi_sai_port_id_get(npu_id, port_list[ix], &sai_port)) != STD_ERR_OK) {
+            NDI_PORT_LOG_TRACE("Failed to convert  npu %d and port %d to sai port",
+                               npu_id, port_list[ix]);
+        } else if ((sai_ret = ndi_sai_port_api_tbl_get(ndi_db_ptr)->set_port_attribute(sai_port,
+                                                                                     &sai_attr))
                          != SAI_STATUS_SUCCESS) {
-        return STD_ERR(NPU, CFG, sai_ret);
+            NDI_PORT_LOG_TRACE("Media type set failed for npu %d, port %d, ret %d",
+                               npu_id, port_list[ix], sai_ret);
+            rc = STD_ERR(NPU, CFG, sai_ret);
+        } else {
+            ndi_port_media_type_cache_set(npu_id, port_list[ix],
+                                          (sai_port_media_type_t)sai_attr.value.s32);
+        }
+
+        if (status != NULL) {
+            status[ix] = rc;
+        }
+        if (rc != STD_ERR_OK) {
+            ret_code = rc;
+        }
     }
 
     return ret_code;
@@ -453,25 +663,156 @@ t_std_error ndi_port_media_type_set(npu_id_t npu_id, npu_port_t port_id, PLATFOR
 t_std_error ndi_port_speed_get(npu_id_t npu_id, npu_port_t port_id, BASE_IF_SPEED_t *speed) {
     STD_ASSERT(speed!=NULL);
 
+    /*  oper status and speed are read together */
+    sai_attribute_t sai_attr[2];
+    sai_attr[0].id = SAI_PORT_ATTR_OPER_STATUS;
+    sai_attr[1].id = SAI_PORT_ATTR_SPEED;
+
+    ndi_port_oper_status_t oper_status = ndi_port_OPER_DOWN;
+    t_std_error rc = _sai_port_attr_set_or_get(npu_id,port_id,SAI_SG_ACT_GET,sai_attr,2);
+    if (rc == STD_ERR_OK) {
+        rc = ndi_sai_oper_state_to_link_state_get(
+                        (sai_port_oper_status_t)sai_attr[0].value.s32, &oper_status);
+    }
+
     /*  in case if link is not UP then return speed = 0 Mbps */
-    ndi_intf_link_state_t link_state;
-    t_std_error rc = ndi_port_link_state_get(npu_id, port_id, &link_state);
-    if ((rc != STD_ERR_OK) || /* unable to read link state */
-        ((rc == STD_ERR_OK) && (link_state.oper_status != ndi_port_OPER_UP)))  /*  Link is not UP */
-    {
+    if ((rc != STD_ERR_OK) || (oper_status != ndi_port_OPER_UP)) {
         *speed = BASE_IF_SPEED_0MBPS;
         return rc;
     }
 
-    sai_attribute_t sai_attr;
-    sai_attr.id = SAI_PORT_ATTR_SPEED;
+    if (!ndi_port_get_ndi_speed((uint32_t)sai_attr[1].value.u32, speed)) return STD_ERR(NPU, PARAM, 0);
 
-    rc = _sai_port_attr_set_or_get(npu_id,port_id,SAI_SG_ACT_GET,&sai_attr,1);
-    if (rc==STD_ERR_OK) {
-        if (!ndi_port_get_ndi_speed((uint32_t)sai_attr.value.u32, speed)) return STD_ERR(NPU, PARAM, 0);
+    return rc;
+}
+
+/*  Attributes of the link snapshot, in the order they are read */
+enum {
+    NDI_LINK_SNAPSHOT_OPER_STATUS,
+    NDI_LINK_SNAPSHOT_SPEED,
+    NDI_LINK_SNAPSHOT_DUPLEX,
+    NDI_LINK_SNAPSHOT_AUTONEG,
+    NDI_LINK_SNAPSHOT_MAX
+};
+
+static t_std_error ndi_port_link_snapshot_read(nas_ndi_db_t *ndi_db_ptr, sai_object_id_t sai_port,
+                                               ndi_port_link_snapshot_t *snapshot)
+{
+    sai_attribute_t sai_attr[NDI_LINK_SNAPSHOT_MAX];
+    memset(sai_attr, 0, sizeof(sai_attr));
+    sai_attr[NDI_LINK_SNAPSHOT_OPER_STATUS].id = SAI_PORT_ATTR_OPER_STATUS;
+    sai_attr[NDI_LINK_SNAPSHOT_SPEED].id = SAI_PORT_ATTR_SPEED;
+    sai_attr[NDI_LINK_SNAPSHOT_DUPLEX].id = SAI_PORT_ATTR_FULL_DUPLEX_MODE;
+    sai_attr[NDI_LINK_SNAPSHOT_AUTONEG].id = SAI_PORT_ATTR_AUTO_NEG_MODE;
+
+    sai_status_t sai_ret = ndi_sai_port_api_tbl_get(ndi_db_ptr)->get_port_attribute(sai_port,
+                                                    NDI_LINK_SNAPSHOT_MAX, sai_attr);
+    if (sai_ret != SAI_STATUS_SUCCESS) {
+        return STD_ERR(NPU, CFG, sai_ret);
     }
 
-    return rc;
+    t_std_error rc = ndi_sai_oper_state_to_link_state_get(
+            (sai_port_oper_status_t)sai_attr[NDI_LINK_SNAPSHOT_OPER_STATUS].value.s32,
+            &snapshot->oper_status);
+    if (rc != STD_ERR_OK) {
+        return rc;
+    }
+
+    snapshot->duplex = (sai_attr[NDI_LINK_SNAPSHOT_DUPLEX].value.booldata == true) ?
+                          BASE_CMN_DUPLEX_TYPE_FULL : BASE_CMN_DUPLEX_TYPE_HALF;
+    snapshot->autoneg = sai_attr[NDI_LINK_SNAPSHOT_AUTONEG].value.booldata;
+
+    /*  same as ndi_port_speed_get, speed is 0 Mbps while the link is not up */
+    snapshot->speed = BASE_IF_SPEED_0MBPS;
+    if ((snapshot->oper_status == ndi_port_OPER_UP) &&
+        !ndi_port_get_ndi_speed((uint32_t)sai_attr[NDI_LINK_SNAPSHOT_SPEED].value.u32,
+                                &snapshot->speed)) {
+        return STD_ERR(NPU, PARAM, 0);
+    }
+    return STD_ERR_OK;
+}
+
+t_std_error ndi_port_link_snapshot_get(npu_id_t npu_id, npu_port_t port_id,
+                                       ndi_port_link_snapshot_t *snapshot)
+{
+    STD_ASSERT(snapshot != NULL);
+    return ndi_port_link_snapshot_get_multi(npu_id, &port_id, 1, snapshot, NULL);
+}
+
+t_std_error ndi_port_link_snapshot_get_multi(npu_id_t npu_id, const npu_port_t *port_list,
+                                             size_t port_count,
+                                             ndi_port_link_snapshot_t *snapshots,
+                                             t_std_error *status)
+{
+    if ((port_count != 0) && ((port_list == NULL) || (snapshots == NULL))) {
+        return STD_ERR(NPU, PARAM, 0);
+    }
+
+    nas_ndi_db_t *ndi_db_ptr = ndi_db_ptr_get(npu_id);
+    if (ndi_db_ptr == NULL) {
+        return STD_ERR(NPU, PARAM, 0);
+    }
+
+    t_std_error ret_code = STD_ERR_OK;
+    size_t ix = 0;
+    for ( ; ix < port_count; ++ix) {
+        sai_object_id_t sai_port;
+        t_std_error rc = ndi_sai_port_id_get(npu_id, port_list[ix], &sai_port);
+        if (rc == STD_ERR_OK) {
+            rc = ndi_port_link_snapshot_read(ndi_db_ptr, sai_port, &snapshots[ix]);
+        }
+        if (rc != STD_ERR_OK) {
+            NDI_PORT_LOG_TRACE("Link snapshot read failed for npu %d, port %d \n",
+                               npu_id, port_list[ix]);
+            ret_code = rc;
+        }
+        if (status != NULL) {
+            status[ix] = rc;
+        }
+    }
+    return ret_code;
+}
+
+t_std_error ndi_port_link_snapshot_get_all(npu_id_t npu_id, npu_port_t *port_list,
+                                           ndi_port_link_snapshot_t *snapshots,
+                                           size_t *count)
+{
+    if ((port_list == NULL) || (snapshots == NULL) || (count == NULL)) {
+        return STD_ERR(NPU, PARAM, 0);
+    }
+
+    nas_ndi_db_t *ndi_db_ptr = ndi_db_ptr_get(npu_id);
+    if (ndi_db_ptr == NULL) {
+        return STD_ERR(NPU, PARAM, 0);
+    }
+
+    npu_port_t cpu_port;
+    if (ndi_cpu_port_get(npu_id, &cpu_port) != STD_ERR_OK) {
+        return STD_ERR(NPU, PARAM, 0);
+    }
+
+    t_std_error ret_code = STD_ERR_OK;
+    size_t filled = 0;
+    size_t max_port = ndi_max_npu_port_get(npu_id);
+    npu_port_t port_id = 0;
+
+    for ( ; (port_id < max_port) && (filled < *count); ++port_id) {
+        sai_object_id_t sai_port;
+        if ((port_id == cpu_port) ||
+            (ndi_sai_port_id_get(npu_id, port_id, &sai_port) != STD_ERR_OK)) {
+            continue;   /*  no front panel port at this index */
+        }
+        t_std_error rc = ndi_port_link_snapshot_read(ndi_db_ptr, sai_port, &snapshots[filled]);
+        if (rc != STD_ERR_OK) {
+            NDI_PORT_LOG_ERROR("Link snapshot read failed for npu %d, port %d", npu_id, port_id);
+            ret_code = rc;
+            continue;
+        }
+        port_list[filled++] = port_id;
+    }
+
+    *count = filled;
+    return ret_code;
 }
 
 t_std_error ndi_port_stats_get(npu_id_t npu_id, npu_port_t port_id,
@@ -495,11 +836,8 @@ t_std_error ndi_port_stats_get(npu_id_t npu_id, npu_port_t port_id,
     if ((ret_code = ndi_sai_port_id_get(npu_id, port_id, &sai_port)) != STD_ERR_OK) {
         return ret_code;
     }
-    size_t ix = 0;
-    for ( ; ix < len ; ++ix){
-        if(!ndi_to_sai_if_stats(ndi_stat_ids[ix],&sai_port_stats_ids[ix])){
-            return STD_ERR(NPU,PARAM,0);
-        }
+    if(!ndi_to_sai_if_stats_multi(ndi_stat_ids, sai_port_stats_ids, len)){
+        return STD_ERR(NPU,PARAM,0);
     }
 
     if ((sai_ret = ndi_sai_port_api_tbl_get(ndi_db_ptr)->get_port_stats(sai_port,
@@ -510,9 +848,57 @@ t_std_error ndi_port_stats_get(npu_id_t npu_id, npu_port_t port_id,
         return STD_ERR(NPU, FAIL, sai_ret);
     }
 
+    ndi_stat_baseline_apply(NDI_STAT_OBJ_PORT, npu_id, port_id, ndi_stat_ids, stats_val, len);
+
     return ret_code;
 }
 
+/*  Gauges report a level, not a count, and are never baselined */
+static bool ndi_port_stat_is_gauge(ndi_stat_id_t ndi_stat_id)
+{
+    return (ndi_stat_id == DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_IF_OUT_QLEN);
+}
+
+/*  Clear a port's counters by taking the current hardware values as their
+ *  new zero. The hardware counters are left running. If snapshot is not
+ *  NULL it receives the values as seen before the clear. */
+static t_std_error ndi_port_stats_baseline_take(nas_ndi_db_t *ndi_db_ptr, npu_id_t npu_id,
+                                                npu_port_t port_id, sai_object_id_t sai_port,
+                                                const ndi_stat_id_t *ndi_stat_ids,
+                                                const sai_port_stat_t *sai_port_stats_ids,
+                                                size_t len, uint64_t *snapshot)
+{
+    const unsigned int list_len = len;
+    uint64_t hw_vals[list_len];
+    ndi_stat_id_t base_ids[list_len];
+    uint64_t base_vals[list_len];
+    size_t base_len = 0;
+    size_t ix = 0;
+    sai_status_t sai_ret = SAI_STATUS_FAILURE;
+
+    if ((sai_ret = ndi_sai_port_api_tbl_get(ndi_db_ptr)->get_port_stats(sai_port,
+                   sai_port_stats_ids, len, hw_vals))
+                   != SAI_STATUS_SUCCESS) {
+        EV_LOGGING(NDI,DEBUG,"PORT-STAT","Port stats Get failed for npu %d, port %d, ret %d \n",
+                            npu_id, port_id, sai_ret);
+        return STD_ERR(NPU, FAIL, sai_ret);
+    }
+
+    if (snapshot != NULL) {
+        memcpy(snapshot, hw_vals, len * sizeof(*snapshot));
+        ndi_stat_baseline_apply(NDI_STAT_OBJ_PORT, npu_id, port_id, ndi_stat_ids,
+                                snapshot, len);
+    }
+
+    for (ix = 0; ix < len; ++ix) {
+        if (!ndi_port_stat_is_gauge(ndi_stat_ids[ix])) {
+            base_ids[base_len] = ndi_stat_ids[ix];
+            base_vals[base_len++] = hw_vals[ix];
+        }
+    }
+    return ndi_stat_baseline_set(NDI_STAT_OBJ_PORT, npu_id, port_id, NULL,
+                                 base_ids, base_vals, base_len);
+}
 
 t_std_error ndi_port_stats_clear(npu_id_t npu_id, npu_port_t port_id,
                                ndi_stat_id_t *ndi_stats_counter_ids,
@@ -523,7 +909,6 @@ t_std_error ndi_port_stats_clear(npu_id_t npu_id, npu_port_t port_id,
     sai_port_stat_t sai_port_stats_ids[list_len];
 
     t_std_error ret_code = STD_ERR_OK;
-    sai_status_t sai_ret = SAI_STATUS_FAILURE;
 
     nas_ndi_db_t *ndi_db_ptr = ndi_db_ptr_get(npu_id);
 
@@ -536,55 +921,111 @@ t_std_error ndi_port_stats_clear(npu_id_t npu_id, npu_port_t port_id,
         return ret_code;
     }
 
+    if(!ndi_to_sai_if_stats_multi(ndi_stats_counter_ids, sai_port_stats_ids, len)){
+        return STD_ERR(NPU,PARAM,0);
+    }
+
+    return ndi_port_stats_baseline_take(ndi_db_ptr, npu_id, port_id, sai_port,
+                                        ndi_stats_counter_ids, sai_port_stats_ids,
+                                        len, NULL);
+}
+
+t_std_error ndi_port_stats_clear_multi(npu_id_t npu_id, const npu_port_t *port_list,
+                                       size_t port_count, const ndi_stat_id_t *ndi_stat_ids,
+                                       size_t stat_count, uint64_t *snapshot,
+                                       t_std_error *status)
+{
+    t_std_error ret_code = STD_ERR_OK;
     size_t ix = 0;
-    for ( ; ix < len ; ++ix){
-        if(!ndi_to_sai_if_stats(ndi_stats_counter_ids[ix],&sai_port_stats_ids[ix])){
-            return STD_ERR(NPU,PARAM,0);
+
+    nas_ndi_db_t *ndi_db_ptr = ndi_db_ptr_get(npu_id);
+
+    if (ndi_db_ptr == NULL) {
+        EV_LOGGING(NDI,DEBUG,"PORT-STAT","Invalid NPU Id %d", npu_id);
+        return STD_ERR(NPU, PARAM, 0);
+    }
+
+    if ((port_list == NULL) || (port_count == 0) ||
+        ((stat_count != 0) && (ndi_stat_ids == NULL)) ||
+        ((snapshot != NULL) && (stat_count == 0))) {
+        return STD_ERR(NPU, PARAM, 0);
+    }
+
+    /*  no counter list means every counter the platform supports */
+    unsigned int plat_len = 0;
+    if (stat_count == 0) {
+        if ((ret_code = ndi_plat_get_ids_len(NAS_STAT_IF, &plat_len)) != STD_ERR_OK) {
+            return ret_code;
+        }
+    }
+    const unsigned int plat_list_len = (plat_len != 0) ? plat_len : 1;
+    ndi_stat_id_t plat_ids[plat_list_len];
+    if (stat_count == 0) {
+        if ((ret_code = ndi_plat_port_stat_list_get(plat_ids, &plat_len)) != STD_ERR_OK) {
+            return ret_code;
         }
+        ndi_stat_ids = plat_ids;
+        stat_count = plat_len;
     }
 
-    if ((sai_ret = ndi_sai_port_api_tbl_get(ndi_db_ptr)->clear_port_stats(sai_port,
-                   sai_port_stats_ids, len))
-                   != SAI_STATUS_SUCCESS) {
-        EV_LOGGING(NDI,DEBUG,"PORT-STAT","Port stats Get failed for npu %d, port %d, ret %d \n",
-                            npu_id, port_id, sai_ret);
-        return STD_ERR(NPU, FAIL, sai_ret);
+    /*  translate the counter set once for all ports */
+    const unsigned int list_len = (stat_count != 0) ? stat_count : 1;
+    sai_port_stat_t sai_port_stats_ids[list_len];
+
+    if (!ndi_to_sai_if_stats_multi(ndi_stat_ids, sai_port_stats_ids, stat_count)) {
+        return STD_ERR(NPU, PARAM, 0);
     }
 
-    return ret_code;
+    /*  resolve every port before touching the hardware */
+    const unsigned int port_len = port_count;
+    sai_object_id_t sai_ports[port_len];
+    t_std_error port_rc[port_len];
 
+    for (ix = 0; ix < port_count; ++ix) {
+        port_rc[ix] = ndi_sai_port_id_get(npu_id, port_list[ix], &sai_ports[ix]);
+        if (port_rc[ix] != STD_ERR_OK) {
+            NDI_PORT_LOG_TRACE("Failed to convert  npu %d and port %d to sai port",
+                               npu_id, port_list[ix]);
+        }
+    }
+
+    for (ix = 0; ix < port_count; ++ix) {
+        uint64_t *row = (snapshot != NULL) ? &snapshot[ix * stat_count] : NULL;
+
+        if (port_rc[ix] == STD_ERR_OK) {
+            port_rc[ix] = ndi_port_stats_baseline_take(ndi_db_ptr, npu_id, port_list[ix],
+                                                       sai_ports[ix], ndi_stat_ids,
+                                                       sai_port_stats_ids, stat_count, row);
+        }
+
+        if ((port_rc[ix] != STD_ERR_OK) && (row != NULL)) {
+            memset(row, 0, stat_count * sizeof(*row));
+        }
+        if (status != NULL) {
+            status[ix] = port_rc[ix];
+        }
+        if (port_rc[ix] != STD_ERR_OK) {
+            ret_code = port_rc[ix];
+        }
+    }
+
+    return ret_code;
 }
 
 t_std_error ndi_port_set_untagged_port_attrib(npu_id_t npu_id,
                                               npu_port_t port_id,
                                               BASE_IF_PHY_IF_INTERFACES_INTERFACE_TAGGING_MODE_t mode) {
-    sai_attribute_t cur_modes[2];
-    cur_modes[0].id = SAI_PORT_ATTR_DROP_TAGGED;
-    cur_modes[1].id = SAI_PORT_ATTR_DROP_UNTAGGED;
-
     sai_attribute_t targ_modes[2];
-    t_std_error rc= _sai_port_attr_set_or_get(npu_id,port_id,SAI_SG_ACT_GET,cur_modes,2);
-    if (rc!=STD_ERR_OK) {
-        return rc;
-    }
-    memcpy(targ_modes,cur_modes,sizeof(cur_modes));
+    targ_modes[0].id = SAI_PORT_ATTR_DROP_TAGGED;
     targ_modes[0].value.booldata = !(mode == BASE_IF_PHY_IF_INTERFACES_INTERFACE_TAGGING_MODE_HYBRID ||
             mode == BASE_IF_PHY_IF_INTERFACES_INTERFACE_TAGGING_MODE_TAGGED );
 
+    targ_modes[1].id = SAI_PORT_ATTR_DROP_UNTAGGED;
     targ_modes[1].value.booldata = !(mode == BASE_IF_PHY_IF_INTERFACES_INTERFACE_TAGGING_MODE_HYBRID ||
             mode == BASE_IF_PHY_IF_INTERFACES_INTERFACE_TAGGING_MODE_UNTAGGED );
 
-    rc= _sai_port_attr_set_or_get(npu_id,port_id,SAI_SG_ACT_SET,&targ_modes[0],1);
-    if (rc!=STD_ERR_OK) {
-        return rc;
-    }
-
-    rc= _sai_port_attr_set_or_get(npu_id,port_id,SAI_SG_ACT_SET,&targ_modes[1],1);
-    if (rc!=STD_ERR_OK) {
-        _sai_port_attr_set_or_get(npu_id,port_id,SAI_SG_ACT_SET,&cur_modes[0],1);
-        return rc;
-    }
-    return rc;
+    /*  both modes change together or not at all */
+    return ndi_port_attr_set_multi(npu_id, port_id, targ_modes, 2);
 }
 
 t_std_error ndi_port_get_untagged_port_attrib(npu_id_t npu_id,
@@ -668,30 +1109,8 @@ t_std_error ndi_port_mac_learn_mode_get(npu_id_t npu_id, npu_port_t port_id,
 
 
 t_std_error ndi_port_clear_all_stat(npu_id_t npu_id, npu_port_t port_id){
-    sai_object_id_t sai_port;
-    sai_status_t sai_ret = SAI_STATUS_FAILURE;
-    t_std_error rc;
-    nas_ndi_db_t *ndi_db_ptr = ndi_db_ptr_get(npu_id);
-
-    if (ndi_db_ptr == NULL) {
-        NDI_PORT_LOG_ERROR("Invalid NPU Id %d", npu_id);
-        return STD_ERR(NPU, PARAM, 0);
-    }
-
-    if ((rc = ndi_sai_port_id_get(npu_id, port_id, &sai_port)) != STD_ERR_OK) {
-        NDI_PORT_LOG_TRACE("Failed to convert  npu %d and port %d to sai port",
-                            npu_id, port_id);
-        return rc;
-    }
-
-    if ((sai_ret = ndi_sai_port_api_tbl_get(ndi_db_ptr)->clear_port_all_stats(sai_port))
-                   != SAI_STATUS_SUCCESS) {
-        NDI_PORT_LOG_TRACE("Port stats clear failed for npu %d, port %d, ret %d ",
-                            npu_id, port_id, sai_ret);
-        return STD_ERR(NPU, FAIL, sai_ret);
-    }
-
-    return STD_ERR_OK;
+    /*  every counter the platform supports, without clearing the hardware */
+    return ndi_port_stats_clear_multi(npu_id, &port_id, 1, NULL, 0, NULL, NULL);
 }
 
 t_std_error ndi_port_set_ingress_filtering(npu_id_t npu_id, npu_port_t port_id, bool ing_filter) {
@@ -28,6 +28,8 @@
 #define __STDC_FORMAT_MACROS
 #include <inttypes.h>
 #include <vector>
+#include <new>
+#include <atomic>
 #include <unordered_map>
 
 #define NDI_MAX_NPU          1
@@ -68,6 +70,42 @@ typedef std::vector <std::vector<ndi_port_map_t > > ndi_port_to_sai_port_map_tbl
 
 static ndi_port_to_sai_port_map_tbl_t g_ndi_port_map_tbl;
 
+/*  Active front panel sai ports of each npu in port map order. The list is
+ *  rebuilt under the port map write lock whenever a port is added or removed
+ *  and the generation is bumped, so readers can copy it without walking the
+ *  port map and cache it until the generation moves. */
+typedef struct _ndi_sai_port_list_t {
+    std::vector<sai_object_id_t> ports;
+    std::atomic<uint64_t> generation{0};
+} ndi_sai_port_list_t;
+
+static ndi_sai_port_list_t g_ndi_sai_port_list[NDI_MAX_NPU];
+
+/*  Caller holds the port map write lock */
+static void ndi_sai_port_list_rebuild_locked(npu_id_t npu)
+{
+    if ((npu < 0) || ((size_t)npu >= g_ndi_port_map_tbl.size()) || (npu >= NDI_MAX_NPU)) {
+        return;
+    }
+    ndi_sai_port_list_t &pl = g_ndi_sai_port_list[npu];
+
+    /*  On failure readers keep the old list and generation */
+    std::vector<sai_object_id_t> ports;
+    try {
+        for (auto &entry : g_ndi_port_map_tbl[npu]) {
+            if ((entry.flags & NDI_PORT_MAP_ACTIVE_MASK) &&
+                !(entry.flags & NDI_PORT_MAP_CPU_PORT_MASK)) {
+                ports.push_back(entry.sai_port);
+            }
+        }
+    } catch (...) {
+        NDI_PORT_LOG_ERROR("Unable to rebuild the sai port list of npu %d", npu);
+        return;
+    }
+    pl.ports.swap(ports);
+    pl.generation.fetch_add(1);
+}
+
 /*  following is for sai_port to ndi_port  */
 
 typedef struct ndi_saiport_map_t {
@@ -283,22 +321,39 @@ static t_std_error ndi_port_map_tbl_allocate(void) {
     return STD_ERR_OK;
 }
 
-/*  Add sai port in to the port map table */
-t_std_error ndi_port_map_sai_port_add(npu_id_t npu, sai_object_id_t sai_port, npu_port_t *npu_port)
+/*  Build a port map entry for a sai port. This queries SAI for the hwport
+ *  list and allocates the entry, so it is done without the port map locks. */
+static t_std_error ndi_port_map_entry_build(npu_id_t npu, sai_object_id_t sai_port,
+                                            ndi_port_map_t &entry)
 {
     uint32_t hwport_list[NDI_MAX_HWPORT_PER_PORT];
     uint32_t hwport_count = NDI_MAX_HWPORT_PER_PORT;
     t_std_error rc = STD_ERR_OK;
-    uint32_t first_hwport = 0;
-    ndi_saiport_map_t sai_entry;
 
     if ((rc = ndi_sai_port_hwport_list_get(npu, sai_port, hwport_list, &hwport_count)) != STD_ERR_OK) {
         return(rc);
     }
-    /*  use first HW port as index in the port map table */
-    first_hwport = hwport_list[0];
+    if (hwport_count == 0) {
+        return(STD_ERR(NPU,FAIL,0));
+    }
 
-    std_rw_lock_write_guard l(&ndi_port_map_rwlock);
+    try {
+        entry.hwport_list.assign(hwport_list, hwport_list + hwport_count);
+    } catch(...) {
+        return(STD_ERR(NPU,NOMEM,0));
+    }
+    entry.sai_port = sai_port;
+    entry.hwport_count = hwport_count;
+    entry.flags = NDI_PORT_MAP_ACTIVE_MASK;
+    return(STD_ERR_OK);
+}
+
+/*  Install a prebuilt entry. Caller holds both port map write locks. */
+static t_std_error ndi_port_map_entry_install_locked(npu_id_t npu, ndi_port_map_t &entry,
+                                                     npu_port_t *npu_port)
+{
+    /*  use first HW port as index in the port map table */
+    uint32_t first_hwport = entry.hwport_list[0];
 
     if (first_hwport > g_ndi_port_map_tbl[npu].size()-1) {
         try {
@@ -313,28 +368,44 @@ t_std_error ndi_port_map_sai_port_add(npu_id_t npu, sai_object_id_t sai_port, np
         return(STD_ERR(NPU,CFG,0));
     }
 
-    /*  add the entry  */
-    g_ndi_port_map_tbl[npu][first_hwport].sai_port = sai_port;
-    g_ndi_port_map_tbl[npu][first_hwport].hwport_count = hwport_count;
-    g_ndi_port_map_tbl[npu][first_hwport].flags |= NDI_PORT_MAP_ACTIVE_MASK;
-    g_ndi_port_map_tbl[npu][first_hwport].hwport_list.resize(hwport_count);
-
-    for (uint32_t idx =0; idx < hwport_count; idx++) {
-       g_ndi_port_map_tbl[npu][first_hwport].hwport_list[idx] = hwport_list[idx];
-    }
-
     /*  Now add an entry in the sai port map   */
-    sai_entry.npu_id = npu;
-    sai_entry.npu_port = first_hwport;
-    if (ndi_saiport_map_add_entry(sai_port, &sai_entry) != true) {
+    try {
+        g_saiport_map[entry.sai_port] = { npu, first_hwport };
+    } catch(...) {
+        NDI_PORT_LOG_ERROR("SAI port entry Add failure %" PRIx64 " ",  entry.sai_port);
         return STD_ERR(NPU, FAIL, 0);
     }
 
-    NDI_PORT_LOG_TRACE(" Initializing ports hwport %X - sai port%" PRIx64 " ",first_hwport,sai_port);
+    /*  add the entry, the hwport list is moved so no allocation under the lock */
+    g_ndi_port_map_tbl[npu][first_hwport].sai_port = entry.sai_port;
+    g_ndi_port_map_tbl[npu][first_hwport].hwport_count = entry.hwport_count;
+    g_ndi_port_map_tbl[npu][first_hwport].flags |= NDI_PORT_MAP_ACTIVE_MASK;
+    g_ndi_port_map_tbl[npu][first_hwport].hwport_list.swap(entry.hwport_list);
+
+    NDI_PORT_LOG_TRACE(" Initializing ports hwport %X - sai port%" PRIx64 " ",first_hwport,entry.sai_port);
     *npu_port = first_hwport;
     return(STD_ERR_OK);
 }
 
+/*  Add sai port in to the port map table */
+t_std_error ndi_port_map_sai_port_add(npu_id_t npu, sai_object_id_t sai_port, npu_port_t *npu_port)
+{
+    t_std_error rc = STD_ERR_OK;
+    ndi_port_map_t entry;
+
+    if ((rc = ndi_port_map_entry_build(npu, sai_port, entry)) != STD_ERR_OK) {
+        return(rc);
+    }
+
+    std_rw_lock_write_guard l(&ndi_port_map_rwlock);
+    std_rw_lock_write_guard m(&sai_port_map_rwlock);
+
+    if ((rc = ndi_port_map_entry_install_locked(npu, entry, npu_port)) == STD_ERR_OK) {
+        ndi_sai_port_list_rebuild_locked(npu);
+    }
+    return rc;
+}
+
 t_std_error ndi_sai_cpu_port_add(npu_id_t npu_id)
 {
     sai_status_t sai_ret = SAI_STATUS_FAILURE;
@@ -379,18 +450,18 @@ t_std_error ndi_sai_cpu_port_add(npu_id_t npu_id)
     return(STD_ERR_OK);
 }
 
-t_std_error ndi_port_map_sai_port_delete(npu_id_t npu, sai_object_id_t sai_port, npu_port_t *npu_port)
+/*  Remove a sai port from both tables. Caller holds both port map write locks. */
+static t_std_error ndi_port_map_entry_remove_locked(sai_object_id_t sai_port, npu_id_t *npu_id,
+                                                    npu_port_t *npu_port)
 {
-    t_std_error rc = STD_ERR_OK;
+    npu_id_t npu = 0;
     uint32_t first_hwport = 0;
 
-    std_rw_lock_write_guard l(&ndi_port_map_rwlock);
-
-    std_rw_lock_write_guard m(&sai_port_map_rwlock);
-
     auto it = g_saiport_map.find(sai_port);
     if (it==g_saiport_map.end()) {
-        return rc;
+        /*  nothing was removed, there is no npu port to report */
+        NDI_PORT_LOG_TRACE("SAI port entry does not exist %" PRIx64 " ",  sai_port);
+        return STD_ERR(NPU,FAIL,0);
     }
     if ((g_ndi_port_map_tbl.size()<= (size_t)it->second.npu_id)) {
         //error
@@ -418,6 +489,7 @@ t_std_error ndi_port_map_sai_port_delete(npu_id_t npu, sai_object_id_t sai_port,
     g_ndi_port_map_tbl[npu][first_hwport].flags &= ~NDI_PORT_MAP_ACTIVE_MASK;
     g_ndi_port_map_tbl[npu][first_hwport].hwport_count = 0;
 
+    *npu_id = npu;
     *npu_port = first_hwport;
     /*  Now delete from saiport map table  */
     try {
@@ -428,6 +500,132 @@ t_std_error ndi_port_map_sai_port_delete(npu_id_t npu, sai_object_id_t sai_port,
     return(STD_ERR_OK);
 }
 
+t_std_error ndi_port_map_sai_port_delete(npu_id_t npu, sai_object_id_t sai_port, npu_port_t *npu_port)
+{
+    std_rw_lock_write_guard l(&ndi_port_map_rwlock);
+
+    std_rw_lock_write_guard m(&sai_port_map_rwlock);
+
+    t_std_error rc = ndi_port_map_entry_remove_locked(sai_port, &npu, npu_port);
+    if (rc == STD_ERR_OK) {
+        ndi_sai_port_list_rebuild_locked(npu);
+    }
+    return rc;
+}
+
+/*  Port map transactions.
+ *  A breakout shows up as a burst of sai port deletes and adds. The staged
+ *  adds are built (SAI hwport query, allocation) when staged, then all
+ *  operations are published in order under a single write lock section so
+ *  lookups are held off once per burst instead of once per port.
+ */
+typedef struct _ndi_port_map_txn_op_t {
+    bool add;
+    sai_object_id_t sai_port;
+    t_std_error rc;
+    ndi_port_map_t entry;
+} ndi_port_map_txn_op_t;
+
+struct _ndi_port_map_txn_t {
+    npu_id_t npu;
+    std::vector<ndi_port_map_txn_op_t> ops;
+};
+
+ndi_port_map_txn_t *ndi_port_map_txn_begin(npu_id_t npu)
+{
+    if (npu >= (npu_id_t)ndi_max_npu_get()) {
+        return NULL;
+    }
+    ndi_port_map_txn_t *txn = new (std::nothrow) ndi_port_map_txn_t;
+    if (txn != NULL) {
+        txn->npu = npu;
+    }
+    return txn;
+}
+
+static t_std_error ndi_port_map_txn_stage(ndi_port_map_txn_t *txn, sai_object_id_t sai_port, bool add)
+{
+    if (txn == NULL) {
+        return STD_ERR(NPU, PARAM, 0);
+    }
+    try {
+        txn->ops.emplace_back();
+    } catch(...) {
+        return STD_ERR(NPU, NOMEM, 0);
+    }
+    ndi_port_map_txn_op_t &op = txn->ops.back();
+    op.add = add;
+    op.sai_port = sai_port;
+    op.rc = STD_ERR_OK;
+    if (add) {
+        /*  failures are kept and reported per port at commit */
+        op.rc = ndi_port_map_entry_build(txn->npu, sai_port, op.entry);
+    }
+    return op.rc;
+}
+
+t_std_error ndi_port_map_txn_port_add(ndi_port_map_txn_t *txn, sai_object_id_t sai_port)
+{
+    return ndi_port_map_txn_stage(txn, sai_port, true);
+}
+
+t_std_error ndi_port_map_txn_port_delete(ndi_port_map_txn_t *txn, sai_object_id_t sai_port)
+{
+    return ndi_port_map_txn_stage(txn, sai_port, false);
+}
+
+size_t ndi_port_map_txn_op_count(ndi_port_map_txn_t *txn)
+{
+    return (txn == NULL) ? 0 : txn->ops.size();
+}
+
+t_std_error ndi_port_map_txn_commit(ndi_port_map_txn_t *txn, ndi_port_map_change_t *changes,
+                                    size_t *count)
+{
+    if ((txn == NULL) || (count == NULL) ||
+        ((changes == NULL) && !txn->ops.empty()) || (*count < txn->ops.size())) {
+        return STD_ERR(NPU, PARAM, 0);
+    }
+
+    {
+        std_rw_lock_write_guard l(&ndi_port_map_rwlock);
+        std_rw_lock_write_guard m(&sai_port_map_rwlock);
+
+        for (auto &op : txn->ops) {
+            ndi_port_map_change_t &chg = changes[&op - &txn->ops[0]];
+            npu_id_t npu = txn->npu;
+
+            memset(&chg, 0, sizeof(chg));
+            chg.add = op.add;
+            chg.sai_port = op.sai_port;
+            chg.port.npu_id = txn->npu;
+            if (op.rc == STD_ERR_OK) {
+                if (op.add) {
+                    chg.hwport = op.entry.hwport_list[0];
+                    op.rc = ndi_port_map_entry_install_locked(txn->npu, op.entry,
+                                                              &chg.port.npu_port);
+                } else {
+                    op.rc = ndi_port_map_entry_remove_locked(op.sai_port, &npu,
+                                                             &chg.port.npu_port);
+                    chg.port.npu_id = npu;
+                }
+            }
+            chg.rc = op.rc;
+        }
+        /*  one rebuild for the whole burst */
+        ndi_sai_port_list_rebuild_locked(txn->npu);
+    }
+
+    *count = txn->ops.size();
+    txn->ops.clear();
+    return STD_ERR_OK;
+}
+
+void ndi_port_map_txn_free(ndi_port_map_txn_t *txn)
+{
+    delete txn;
+}
+
 /*  Extract npu_id from the sai port object*/
 /*  TODO confirm if this conversion is as per SAI spec */
 npu_id_t ndi_saiport_to_npu_id_get(sai_object_id_t sai_port)
@@ -640,53 +838,79 @@ t_std_error ndi_port_event_cb_register(npu_id_t npu_id, ndi_port_event_update_fn
     return(STD_ERR_OK);
 }
 
+static ndi_port_event_batch_update_fn g_ndi_port_event_batch_cb[NDI_MAX_NPU];
+
+t_std_error ndi_port_event_batch_cb_register(npu_id_t npu_id, ndi_port_event_batch_update_fn func)
+{
+    if ((npu_id < 0) || (npu_id >= NDI_MAX_NPU)) {
+        return STD_ERR(NPU, PARAM, 0);
+    }
+    g_ndi_port_event_batch_cb[npu_id] = func;
+    return(STD_ERR_OK);
+}
+
+ndi_port_event_batch_update_fn ndi_port_event_batch_cb_get(npu_id_t npu_id)
+{
+    if ((npu_id < 0) || (npu_id >= NDI_MAX_NPU)) {
+        return NULL;
+    }
+    return g_ndi_port_event_batch_cb[npu_id];
+}
+
 t_std_error ndi_port_get_sai_ports_len(npu_id_t npu, size_t * len){
-    std_rw_lock_read_guard l(&ndi_port_map_rwlock);
-    if (npu >= (npu_id_t)g_ndi_port_map_tbl.size()){
+    if (len == NULL){
         return STD_ERR(NPU,PARAM,0);
     }
-    *len = 0;
 
-    for(auto port = g_ndi_port_map_tbl[npu].begin();port != g_ndi_port_map_tbl[npu].end(); ++port){
-        if(port->sai_port) ++(*len);
+    std_rw_lock_read_guard l(&ndi_port_map_rwlock);
+    if ((npu < 0) || (npu >= NDI_MAX_NPU) || (npu >= (npu_id_t)g_ndi_port_map_tbl.size())){
+        return STD_ERR(NPU,PARAM,0);
     }
-    // Subtract for the cpu port
-    --(*len);
+    *len = g_ndi_sai_port_list[npu].ports.size();
     return STD_ERR_OK;
 }
 
 t_std_error ndi_port_get_all_sai_ports(npu_id_t npu,sai_object_id_t *list , size_t len){
+    return ndi_port_sai_ports_snapshot_get(npu, list, &len, NULL);
+}
 
-    std_rw_lock_read_guard l(&ndi_port_map_rwlock);
-    if (npu >= (npu_id_t)g_ndi_port_map_tbl.size()){
-        return STD_ERR(NPU,PARAM,0);
+uint64_t ndi_port_sai_ports_generation_get(npu_id_t npu){
+    if ((npu < 0) || (npu >= NDI_MAX_NPU)){
+        return 0;
     }
-    size_t cur_len = 0;
-    for(auto port = g_ndi_port_map_tbl[npu].begin();port != g_ndi_port_map_tbl[npu].end(); ++port){
-        if(port->sai_port) ++(cur_len);
+    return g_ndi_sai_port_list[npu].generation.load();
+}
+
+t_std_error ndi_port_sai_ports_snapshot_get(npu_id_t npu, sai_object_id_t *list, size_t *len,
+                                            uint64_t *generation){
+    if (len == NULL){
+        return STD_ERR(NPU,PARAM,0);
     }
 
-    // Subtract for the cpu port
-    --cur_len;
+    std_rw_lock_read_guard l(&ndi_port_map_rwlock);
+    if ((npu < 0) || (npu >= NDI_MAX_NPU) || (npu >= (npu_id_t)g_ndi_port_map_tbl.size())){
+        return STD_ERR(NPU,PARAM,0);
+    }
+    const ndi_sai_port_list_t &pl = g_ndi_sai_port_list[npu];
+    size_t cur_len = pl.ports.size();
 
-    if (cur_len > len){
+    if (generation != NULL){
+        *generation = pl.generation.load();
+    }
+    if (cur_len > *len){
         EV_LOGGING(NDI,ERR,"NDI-ALL-PORT","List legnth %d passed to get all sai "
-                "ports is shorter than actual length %d",len,cur_len);
+                "ports is shorter than actual length %d",(int)*len,(int)cur_len);
+        *len = cur_len;
         return STD_ERR(NPU,FAIL,0);
     }
-    size_t list_ix = 0;
-    /*
-     * first port is cpu port skip it
-     */
-    if(cur_len > 1){
-        for(auto it = g_ndi_port_map_tbl[npu].begin()+1; it != g_ndi_port_map_tbl[npu].end(); ++it){
-            if(it->sai_port != 0){
-                list[list_ix++] = it->sai_port;
-            }
+    if (cur_len > 0){
+        if (list == NULL){
+            return STD_ERR(NPU,PARAM,0);
         }
+        memcpy(list, &pl.ports[0], cur_len * sizeof(sai_object_id_t));
     }
+    *len = cur_len;
     return STD_ERR_OK;
-
 }
 
 } //extern "C"
@@ -19,8 +19,11 @@
  */
 
 #include "nas_ndi_port_utils.h"
+#include "nas_ndi_event_logs.h"
+#include "std_mutex_lock.h"
 #include<unordered_map>
 #include <algorithm>
+#include <vector>
 
 static std::unordered_map<BASE_IF_PHY_MAC_LEARN_MODE_t, sai_port_fdb_learning_mode_t,std::hash<int>>
 ndi_to_sai_fdb_learn_mode =
@@ -139,3 +142,229 @@ bool ndi_port_get_ndi_speed(uint32_t sai_speed, BASE_IF_SPEED_t *ndi_speed) {
     return true;
 }
 
+/*  Platform media type to SAI media type. This list is compiled into the
+ *  dense tables below on first use.
+ */
+static const std::pair<PLATFORM_MEDIA_TYPE_t, sai_port_media_type_t>
+ndi2sai_media_type_list[] =
+{
+    {PLATFORM_MEDIA_TYPE_AR_POPTICS_NOTPRESENT,          SAI_PORT_MEDIA_TYPE_NOT_PRESENT},
+    {PLATFORM_MEDIA_TYPE_AR_POPTICS_UNKNOWN,             SAI_PORT_MEDIA_TYPE_UNKNONWN},
+    {PLATFORM_MEDIA_TYPE_AR_SFPPLUS_10GBASE_USR,         SAI_PORT_MEDIA_TYPE_SFP_FIBER},
+    {PLATFORM_MEDIA_TYPE_AR_SFPPLUS_10GBASE_SR,          SAI_PORT_MEDIA_TYPE_SFP_FIBER},
+    {PLATFORM_MEDIA_TYPE_AR_SFPPLUS_10GBASE_LR,          SAI_PORT_MEDIA_TYPE_SFP_FIBER},
+    {PLATFORM_MEDIA_TYPE_AR_SFPPLUS_10GBASE_ER,          SAI_PORT_MEDIA_TYPE_SFP_FIBER},
+    {PLATFORM_MEDIA_TYPE_AR_SFPPLUS_10GBASE_ZR,          SAI_PORT_MEDIA_TYPE_SFP_FIBER},
+    {PLATFORM_MEDIA_TYPE_AR_SFPPLUS_10GBASE_LRM,         SAI_PORT_MEDIA_TYPE_SFP_FIBER},
+    {PLATFORM_MEDIA_TYPE_AR_SFPPLUS_10GBASE_DWDM,        SAI_PORT_MEDIA_TYPE_SFP_FIBER},
+    {PLATFORM_MEDIA_TYPE_AR_SFPPLUS_10GBASE_DWDM_40KM,   SAI_PORT_MEDIA_TYPE_SFP_FIBER},
+    {PLATFORM_MEDIA_TYPE_AR_SFPPLUS_10GBASE_DWDM_80KM,   SAI_PORT_MEDIA_TYPE_SFP_FIBER},
+    {PLATFORM_MEDIA_TYPE_SFPPLUS_10GBASE_ZR_TUNABLE,     SAI_PORT_MEDIA_TYPE_SFP_FIBER},
+    {PLATFORM_MEDIA_TYPE_SFPPLUS_10GBASE_SR_AOCXXM,      SAI_PORT_MEDIA_TYPE_SFP_FIBER},
+    {PLATFORM_MEDIA_TYPE_AR_SFPPLUS_10GBASE_T,           SAI_PORT_MEDIA_TYPE_SFP_COPPER},
+    {PLATFORM_MEDIA_TYPE_AR_SFPPLUS_10GBASE_CUHALFM,     SAI_PORT_MEDIA_TYPE_SFP_COPPER},
+    {PLATFORM_MEDIA_TYPE_AR_SFPPLUS_10GBASE_CU1M,        SAI_PORT_MEDIA_TYPE_SFP_COPPER},
+    {PLATFORM_MEDIA_TYPE_AR_SFPPLUS_10GBASE_CU2M,        SAI_PORT_MEDIA_TYPE_SFP_COPPER},
+    {PLATFORM_MEDIA_TYPE_AR_SFPPLUS_10GBASE_CU3M,        SAI_PORT_MEDIA_TYPE_SFP_COPPER},
+    {PLATFORM_MEDIA_TYPE_AR_SFPPLUS_10GBASE_CU5M,        SAI_PORT_MEDIA_TYPE_SFP_COPPER},
+    {PLATFORM_MEDIA_TYPE_AR_SFPPLUS_10GBASE_CU7M,        SAI_PORT_MEDIA_TYPE_SFP_COPPER},
+    {PLATFORM_MEDIA_TYPE_AR_SFPPLUS_10GBASE_CU10M,       SAI_PORT_MEDIA_TYPE_SFP_COPPER},
+    {PLATFORM_MEDIA_TYPE_AR_SFPPLUS_10GBASE_ACU7M,       SAI_PORT_MEDIA_TYPE_SFP_COPPER},
+    {PLATFORM_MEDIA_TYPE_AR_SFPPLUS_10GBASE_ACU10M,      SAI_PORT_MEDIA_TYPE_SFP_COPPER},
+    {PLATFORM_MEDIA_TYPE_AR_SFPPLUS_10GBASE_ACU15M,      SAI_PORT_MEDIA_TYPE_SFP_COPPER},
+    {PLATFORM_MEDIA_TYPE_AR_SFPPLUS_10GBASE_CX4,         SAI_PORT_MEDIA_TYPE_SFP_COPPER},
+    {PLATFORM_MEDIA_TYPE_AR_QSFP_40GBASE_SR4,            SAI_PORT_MEDIA_TYPE_QSFP_FIBER},
+    {PLATFORM_MEDIA_TYPE_AR_QSFP_40GBASE_SR4_EXT,        SAI_PORT_MEDIA_TYPE_QSFP_FIBER},
+    {PLATFORM_MEDIA_TYPE_AR_QSFP_40GBASE_LR4,            SAI_PORT_MEDIA_TYPE_QSFP_FIBER},
+    {PLATFORM_MEDIA_TYPE_AR_QSFP_40GBASE_PSM4_LR,        SAI_PORT_MEDIA_TYPE_QSFP_FIBER},
+    {PLATFORM_MEDIA_TYPE_AR_QSFP_40GBASE_PSM4_1490NM,    SAI_PORT_MEDIA_TYPE_QSFP_FIBER},
+    {PLATFORM_MEDIA_TYPE_AR_QSFP_40GBASE_PSM4_1490NM_1M, SAI_PORT_MEDIA_TYPE_QSFP_FIBER},
+    {PLATFORM_MEDIA_TYPE_AR_QSFP_40GBASE_PSM4_1490NM_3M, SAI_PORT_MEDIA_TYPE_QSFP_FIBER},
+    {PLATFORM_MEDIA_TYPE_AR_QSFP_40GBASE_PSM4_1490NM_5M, SAI_PORT_MEDIA_TYPE_QSFP_FIBER},
+    {PLATFORM_MEDIA_TYPE_QSFP_40GBASE_SM4,               SAI_PORT_MEDIA_TYPE_QSFP_FIBER},
+    {PLATFORM_MEDIA_TYPE_QSFP_40GBASE_ER4,               SAI_PORT_MEDIA_TYPE_QSFP_FIBER},
+    {PLATFORM_MEDIA_TYPE_AR_QSFP_40GBASE_LM4,            SAI_PORT_MEDIA_TYPE_QSFP_FIBER},
+    {PLATFORM_MEDIA_TYPE_QSFP_40GBASE_BIDI,              SAI_PORT_MEDIA_TYPE_QSFP_FIBER},
+    {PLATFORM_MEDIA_TYPE_QSFP_40GBASE_AOC,               SAI_PORT_MEDIA_TYPE_QSFP_FIBER},
+    {PLATFORM_MEDIA_TYPE_QSFP_40GBASE_PSM4_PIGTAIL,      SAI_PORT_MEDIA_TYPE_QSFP_FIBER},
+    {PLATFORM_MEDIA_TYPE_AR_4X1_1000BASE_T,              SAI_PORT_MEDIA_TYPE_QSFP_COPPER},
+    {PLATFORM_MEDIA_TYPE_AR_QSFP_40GBASE_CR4_1M,         SAI_PORT_MEDIA_TYPE_QSFP_COPPER},
+    {PLATFORM_MEDIA_TYPE_AR_QSFP_40GBASE_CR4_HAL_M,      SAI_PORT_MEDIA_TYPE_QSFP_COPPER},
+    {PLATFORM_MEDIA_TYPE_AR_QSFP_40GBASE_CR4_2M,         SAI_PORT_MEDIA_TYPE_QSFP_COPPER},
+    {PLATFORM_MEDIA_TYPE_AR_QSFP_40GBASE_CR4_3M,         SAI_PORT_MEDIA_TYPE_QSFP_COPPER},
+    {PLATFORM_MEDIA_TYPE_AR_QSFP_40GBASE_CR4_5M,         SAI_PORT_MEDIA_TYPE_QSFP_COPPER},
+    {PLATFORM_MEDIA_TYPE_AR_QSFP_40GBASE_CR4_7M,         SAI_PORT_MEDIA_TYPE_QSFP_COPPER},
+    {PLATFORM_MEDIA_TYPE_AR_QSFP_40GBASE_CR4_10M,        SAI_PORT_MEDIA_TYPE_QSFP_COPPER},
+    {PLATFORM_MEDIA_TYPE_AR_QSFP_40GBASE_CR4_50M,        SAI_PORT_MEDIA_TYPE_QSFP_COPPER},
+    {PLATFORM_MEDIA_TYPE_AR_QSFP_40GBASE_CR4,            SAI_PORT_MEDIA_TYPE_QSFP_COPPER},
+    {PLATFORM_MEDIA_TYPE_AR_4X10_10GBASE_CR1_HAL_M,      SAI_PORT_MEDIA_TYPE_QSFP_COPPER},
+    {PLATFORM_MEDIA_TYPE_AR_4X10_10GBASE_CR1_1M,         SAI_PORT_MEDIA_TYPE_QSFP_COPPER},
+    {PLATFORM_MEDIA_TYPE_QSFP_4X10_10GBASE_CR1_2M,       SAI_PORT_MEDIA_TYPE_QSFP_COPPER},
+    {PLATFORM_MEDIA_TYPE_AR_4X10_10GBASE_CR1_3M,         SAI_PORT_MEDIA_TYPE_QSFP_COPPER},
+    {PLATFORM_MEDIA_TYPE_AR_4X10_10GBASE_CR1_5M,         SAI_PORT_MEDIA_TYPE_QSFP_COPPER},
+    {PLATFORM_MEDIA_TYPE_AR_4X10_10GBASE_CR1_7M,         SAI_PORT_MEDIA_TYPE_QSFP_COPPER},
+    {PLATFORM_MEDIA_TYPE_QSFPPLUS_50GBASE_CR2,           SAI_PORT_MEDIA_TYPE_QSFP_COPPER},
+    {PLATFORM_MEDIA_TYPE_QSFPPLUS_50GBASE_CR2_1M,        SAI_PORT_MEDIA_TYPE_QSFP_COPPER},
+    {PLATFORM_MEDIA_TYPE_QSFPPLUS_50GBASE_CR2_2M,        SAI_PORT_MEDIA_TYPE_QSFP_COPPER},
+    {PLATFORM_MEDIA_TYPE_QSFPPLUS_50GBASE_CR2_3M,        SAI_PORT_MEDIA_TYPE_QSFP_COPPER},
+    {PLATFORM_MEDIA_TYPE_AR_QSFP28_100GBASE_SR4,         SAI_PORT_MEDIA_TYPE_QSFP28_FIBER},
+    {PLATFORM_MEDIA_TYPE_AR_QSFP28_100GBASE_LR4,         SAI_PORT_MEDIA_TYPE_QSFP28_FIBER},
+    {PLATFORM_MEDIA_TYPE_AR_QSFP28_100GBASE_PSM4_IR,     SAI_PORT_MEDIA_TYPE_QSFP28_FIBER},
+    {PLATFORM_MEDIA_TYPE_AR_QSFP28_100GBASE_AOC,         SAI_PORT_MEDIA_TYPE_QSFP28_FIBER},
+    {PLATFORM_MEDIA_TYPE_AR_QSFP28_100GBASE_CWDM4,       SAI_PORT_MEDIA_TYPE_QSFP28_FIBER},
+    {PLATFORM_MEDIA_TYPE_QSFP28_100GBASE_LR4_LITE,       SAI_PORT_MEDIA_TYPE_QSFP28_FIBER},
+    {PLATFORM_MEDIA_TYPE_QSFP28_100GBASE_ER4,            SAI_PORT_MEDIA_TYPE_QSFP28_FIBER},
+    {PLATFORM_MEDIA_TYPE_QSFP28_100GBASE_PSM4_PIGTAIL,   SAI_PORT_MEDIA_TYPE_QSFP28_FIBER},
+    {PLATFORM_MEDIA_TYPE_QSFP28_100GBASE_SWDM4,          SAI_PORT_MEDIA_TYPE_QSFP28_FIBER},
+    {PLATFORM_MEDIA_TYPE_AR_QSFP28_100GBASE_CR4,         SAI_PORT_MEDIA_TYPE_QSFP28_COPPER},
+    {PLATFORM_MEDIA_TYPE_AR_QSFP28_100GBASE_CR4_HAL_M,   SAI_PORT_MEDIA_TYPE_QSFP28_COPPER},
+    {PLATFORM_MEDIA_TYPE_AR_QSFP28_100GBASE_CR4_1M,      SAI_PORT_MEDIA_TYPE_QSFP28_COPPER},
+    {PLATFORM_MEDIA_TYPE_AR_QSFP28_100GBASE_CR4_2M,      SAI_PORT_MEDIA_TYPE_QSFP28_COPPER},
+    {PLATFORM_MEDIA_TYPE_AR_QSFP28_100GBASE_CR4_3M,      SAI_PORT_MEDIA_TYPE_QSFP28_COPPER},
+    {PLATFORM_MEDIA_TYPE_AR_QSFP28_100GBASE_CR4_4M,      SAI_PORT_MEDIA_TYPE_QSFP28_COPPER},
+    {PLATFORM_MEDIA_TYPE_AR_QSFP28_100GBASE_CR4_5M,      SAI_PORT_MEDIA_TYPE_QSFP28_COPPER},
+    {PLATFORM_MEDIA_TYPE_QSFP28_100GBASE_CR4_7M,         SAI_PORT_MEDIA_TYPE_QSFP28_COPPER},
+    {PLATFORM_MEDIA_TYPE_QSFP28_100GBASE_CR4_10M,        SAI_PORT_MEDIA_TYPE_QSFP28_COPPER},
+    {PLATFORM_MEDIA_TYPE_QSFP28_100GBASE_CR4_50M,        SAI_PORT_MEDIA_TYPE_QSFP28_COPPER},
+    {PLATFORM_MEDIA_TYPE_4X25_25GBASE_CR1_HALF_M,        SAI_PORT_MEDIA_TYPE_QSFP28_COPPER},
+    {PLATFORM_MEDIA_TYPE_4X25_25GBASE_CR1_1M,            SAI_PORT_MEDIA_TYPE_QSFP28_COPPER},
+    {PLATFORM_MEDIA_TYPE_4X25_25GBASE_CR1_2M,            SAI_PORT_MEDIA_TYPE_QSFP28_COPPER},
+    {PLATFORM_MEDIA_TYPE_4X25_25GBASE_CR1_3M,            SAI_PORT_MEDIA_TYPE_QSFP28_COPPER},
+    {PLATFORM_MEDIA_TYPE_4X25_25GBASE_CR1_4M,            SAI_PORT_MEDIA_TYPE_QSFP28_COPPER},
+    {PLATFORM_MEDIA_TYPE_4X25_25GBASE_CR1,               SAI_PORT_MEDIA_TYPE_QSFP28_COPPER},
+    {PLATFORM_MEDIA_TYPE_2X50_50GBASE_CR2_HALF_M,        SAI_PORT_MEDIA_TYPE_QSFP28_COPPER},
+    {PLATFORM_MEDIA_TYPE_2X50_50GBASE_CR2_1M,            SAI_PORT_MEDIA_TYPE_QSFP28_COPPER},
+    {PLATFORM_MEDIA_TYPE_2X50_50GBASE_CR2_2M,            SAI_PORT_MEDIA_TYPE_QSFP28_COPPER},
+    {PLATFORM_MEDIA_TYPE_2X50_50GBASE_CR2_3M,            SAI_PORT_MEDIA_TYPE_QSFP28_COPPER},
+    {PLATFORM_MEDIA_TYPE_2X50_50GBASE_CR2_4M,            SAI_PORT_MEDIA_TYPE_QSFP28_COPPER},
+    {PLATFORM_MEDIA_TYPE_2X50_50GBASE_CR2,               SAI_PORT_MEDIA_TYPE_QSFP28_COPPER},
+};
+
+#define NDI_MEDIA_TYPE_INVALID      (-1)
+
+typedef struct _ndi_media_type_tbl_t {
+    std::vector<int32_t> ndi2sai;   /*  indexed by PLATFORM_MEDIA_TYPE_t */
+    std::vector<int32_t> sai2ndi;   /*  indexed by sai_port_media_type_t */
+} ndi_media_type_tbl_t;
+
+static const ndi_media_type_tbl_t &ndi_media_type_tbl(void)
+{
+    static const ndi_media_type_tbl_t tbl = [] {
+        ndi_media_type_tbl_t t;
+        for (auto &p : ndi2sai_media_type_list) {
+            size_t ndi = p.first;
+            size_t sai = p.second;
+            if (t.ndi2sai.size() <= ndi) {
+                t.ndi2sai.resize(ndi + 1, NDI_MEDIA_TYPE_INVALID);
+            }
+            t.ndi2sai[ndi] = p.second;
+            /*  the first platform type listed for a SAI type is its reverse */
+            if (t.sai2ndi.size() <= sai) {
+                t.sai2ndi.resize(sai + 1, NDI_MEDIA_TYPE_INVALID);
+            }
+            if (t.sai2ndi[sai] == NDI_MEDIA_TYPE_INVALID) {
+                t.sai2ndi[sai] = p.first;
+            }
+        }
+        return t;
+    }();
+    return tbl;
+}
+
+sai_port_media_type_t ndi_port_get_sai_media_type(PLATFORM_MEDIA_TYPE_t media){
+    const ndi_media_type_tbl_t &tbl = ndi_media_type_tbl();
+
+    if (((size_t)media < tbl.ndi2sai.size()) &&
+        (tbl.ndi2sai[media] != NDI_MEDIA_TYPE_INVALID)) {
+        return (sai_port_media_type_t)tbl.ndi2sai[media];
+    }
+    NDI_PORT_LOG_ERROR("media type is not recognized %d \n", media);
+    return SAI_PORT_MEDIA_TYPE_UNKNONWN;
+}
+
+bool ndi_port_get_ndi_media_type(sai_port_media_type_t sai_media, PLATFORM_MEDIA_TYPE_t *media){
+    const ndi_media_type_tbl_t &tbl = ndi_media_type_tbl();
+
+    if (((size_t)sai_media >= tbl.sai2ndi.size()) ||
+        (tbl.sai2ndi[sai_media] == NDI_MEDIA_TYPE_INVALID)) {
+        return false;
+    }
+    *media = (PLATFORM_MEDIA_TYPE_t)tbl.sai2ndi[sai_media];
+    return true;
+}
+
+/*  Last media type programmed on each port */
+static std::unordered_map<uint64_t, sai_port_media_type_t> ndi_port_media_cache;
+
+static std_mutex_lock_create_static_init_rec(port_media_lock);
+
+static inline uint64_t ndi_port_cache_key(npu_id_t npu_id, npu_port_t port_id)
+{
+    return (((uint64_t)npu_id << 32) | port_id);
+}
+
+bool ndi_port_media_type_cache_get(npu_id_t npu_id, npu_port_t port_id,
+                                   sai_port_media_type_t *sai_media){
+    std_mutex_simple_lock_guard g(&port_media_lock);
+
+    auto it = ndi_port_media_cache.find(ndi_port_cache_key(npu_id, port_id));
+    if (it == ndi_port_media_cache.end()) return false;
+    *sai_media = it->second;
+    return true;
+}
+
+void ndi_port_media_type_cache_set(npu_id_t npu_id, npu_port_t port_id,
+                                   sai_port_media_type_t sai_media){
+    std_mutex_simple_lock_guard g(&port_media_lock);
+    try {
+        ndi_port_media_cache[ndi_port_cache_key(npu_id, port_id)] = sai_media;
+    } catch (...) {
+        /*  without a cache entry the next set is simply not suppressed */
+    }
+}
+
+void ndi_port_media_type_cache_port_delete(npu_id_t npu_id, npu_port_t port_id){
+    std_mutex_simple_lock_guard g(&port_media_lock);
+    ndi_port_media_cache.erase(ndi_port_cache_key(npu_id, port_id));
+}
+
+/*  Last value programmed for each scalar port attribute set through NDI */
+typedef std::unordered_map<sai_attr_id_t, sai_attribute_value_t> ndi_port_attr_values_t;
+static std::unordered_map<uint64_t, ndi_port_attr_values_t> ndi_port_attr_cache;
+
+static std_mutex_lock_create_static_init_rec(port_attr_lock);
+
+bool ndi_port_attr_cache_get(npu_id_t npu_id, npu_port_t port_id, sai_attr_id_t attr_id,
+                             sai_attribute_value_t *value){
+    std_mutex_simple_lock_guard g(&port_attr_lock);
+
+    auto it = ndi_port_attr_cache.find(ndi_port_cache_key(npu_id, port_id));
+    if (it == ndi_port_attr_cache.end()) return false;
+    auto val = it->second.find(attr_id);
+    if (val == it->second.end()) return false;
+    *value = val->second;
+    return true;
+}
+
+void ndi_port_attr_cache_set(npu_id_t npu_id, npu_port_t port_id, const sai_attribute_t *attr){
+    std_mutex_simple_lock_guard g(&port_attr_lock);
+    try {
+        ndi_port_attr_cache[ndi_port_cache_key(npu_id, port_id)][attr->id] = attr->value;
+    } catch (...) {
+        /*  without a cache entry the next set is simply not suppressed */
+    }
+}
+
+void ndi_port_attr_cache_clear(npu_id_t npu_id, npu_port_t port_id, sai_attr_id_t attr_id){
+    std_mutex_simple_lock_guard g(&port_attr_lock);
+
+    auto it = ndi_port_attr_cache.find(ndi_port_cache_key(npu_id, port_id));
+    if (it != ndi_port_attr_cache.end()) {
+        it->second.erase(attr_id);
+    }
+}
+
+void ndi_port_attr_cache_port_delete(npu_id_t npu_id, npu_port_t port_id){
+    std_mutex_simple_lock_guard g(&port_attr_lock);
+    ndi_port_attr_cache.erase(ndi_port_cache_key(npu_id, port_id));
+}
@@ -32,40 +32,47 @@
 #include <unordered_map>
 
 
-const static std::unordered_map<nas_attr_id_t, sai_attr_id_t, std::hash<int>>
-    ndi2sai_buffer_pool_attr_id_map = {
-    {BASE_QOS_BUFFER_POOL_SHARED_SIZE,        SAI_BUFFER_POOL_ATTR_SHARED_SIZE},
-    {BASE_QOS_BUFFER_POOL_POOL_TYPE,          SAI_BUFFER_POOL_ATTR_TYPE},
-    {BASE_QOS_BUFFER_POOL_SIZE,               SAI_BUFFER_POOL_ATTR_SIZE},
-    {BASE_QOS_BUFFER_POOL_THRESHOLD_MODE,     SAI_BUFFER_POOL_ATTR_TH_MODE},
-
+typedef struct _ndi_qos_buffer_pool_attr_t {
+    nas_attr_id_t nas_id;
+    sai_attr_id_t sai_id;
+    void (*fill)(const qos_buffer_pool_struct_t *p, sai_attribute_value_t &v);
+} ndi_qos_buffer_pool_attr_t;
+
+// Only the settable attributes are included
+static const ndi_qos_buffer_pool_attr_t ndi_qos_buffer_pool_attr_list[] = {
+    {BASE_QOS_BUFFER_POOL_SHARED_SIZE,        SAI_BUFFER_POOL_ATTR_SHARED_SIZE,
+        [](const qos_buffer_pool_struct_t *p, sai_attribute_value_t &v) { v.u32 = p->shared_size; }},
+    {BASE_QOS_BUFFER_POOL_POOL_TYPE,          SAI_BUFFER_POOL_ATTR_TYPE,
+        [](const qos_buffer_pool_struct_t *p, sai_attribute_value_t &v) {
+            v.s32 = (p->type == BASE_QOS_BUFFER_POOL_TYPE_INGRESS?
+                        SAI_BUFFER_POOL_TYPE_INGRESS: SAI_BUFFER_POOL_TYPE_EGRESS); }},
+    {BASE_QOS_BUFFER_POOL_SIZE,               SAI_BUFFER_POOL_ATTR_SIZE,
+        [](const qos_buffer_pool_struct_t *p, sai_attribute_value_t &v) { v.u32 = p->size; }},
+    {BASE_QOS_BUFFER_POOL_THRESHOLD_MODE,     SAI_BUFFER_POOL_ATTR_TH_MODE,
+        [](const qos_buffer_pool_struct_t *p, sai_attribute_value_t &v) {
+            v.s32 = (p->threshold_mode == BASE_QOS_BUFFER_THRESHOLD_MODE_STATIC?
+                        SAI_BUFFER_POOL_THRESHOLD_MODE_STATIC: SAI_BUFFER_POOL_THRESHOLD_MODE_DYNAMIC); }},
 };
 
+static const ndi_qos_attr_tbl<ndi_qos_buffer_pool_attr_t>
+    ndi_qos_buffer_pool_attr_tbl(ndi_qos_buffer_pool_attr_list);
+
+#define NDI_QOS_BUFFER_POOL_ATTR_MAX    NDI_QOS_TBL_SIZE(ndi_qos_buffer_pool_attr_list)
+
 
 static t_std_error ndi_qos_fill_buffer_pool_attr(nas_attr_id_t attr_id,
                         const qos_buffer_pool_struct_t *p,
                         sai_attribute_t &sai_attr)
 {
-    // Only the settable attributes are included
-    try {
-        sai_attr.id = ndi2sai_buffer_pool_attr_id_map.at(attr_id);
-    }
-    catch (...) {
+    const ndi_qos_buffer_pool_attr_t *entry = ndi_qos_buffer_pool_attr_tbl.find(attr_id);
+    if (entry == NULL) {
         EV_LOGGING(NDI, NOTICE, "NDI-QOS",
                       "attr_id %u not supported\n", attr_id);
         return STD_ERR(QOS, CFG, 0);
     }
 
-    if (attr_id == BASE_QOS_BUFFER_POOL_SHARED_SIZE)
-        sai_attr.value.u32 = p->shared_size;
-    else if (attr_id == BASE_QOS_BUFFER_POOL_POOL_TYPE)
-        sai_attr.value.s32 = (p->type == BASE_QOS_BUFFER_POOL_TYPE_INGRESS?
-                                SAI_BUFFER_POOL_TYPE_INGRESS: SAI_BUFFER_POOL_TYPE_EGRESS);
-    else if (attr_id == BASE_QOS_BUFFER_POOL_SIZE)
-        sai_attr.value.u32 = p->size;
-    else if (attr_id == BASE_QOS_BUFFER_POOL_THRESHOLD_MODE)
-        sai_attr.value.s32 = (p->threshold_mode == BASE_QOS_BUFFER_THRESHOLD_MODE_STATIC?
-                                SAI_BUFFER_POOL_THRESHOLD_MODE_STATIC: SAI_BUFFER_POOL_THRESHOLD_MODE_DYNAMIC);
+    sai_attr.id = entry->sai_id;
+    entry->fill(p, sai_attr.value);
 
     return STD_ERR_OK;
 }
@@ -74,17 +81,16 @@ static t_std_error ndi_qos_fill_buffer_pool_attr(nas_attr_id_t attr_id,
 static t_std_error ndi_qos_fill_buffer_pool_attr_list(const nas_attr_id_t *nas_attr_list,
                                     uint_t num_attr,
                                     const qos_buffer_pool_struct_t *p,
-                                    std::vector<sai_attribute_t> &attr_list)
+                                    sai_attribute_t *attr_list)
 {
-    sai_attribute_t sai_attr = {0};
     t_std_error      rc = STD_ERR_OK;
 
+    if (num_attr > NDI_QOS_BUFFER_POOL_ATTR_MAX)
+        return STD_ERR(QOS, CFG, 0);
+
     for (uint_t i = 0; i < num_attr; i++) {
-        if ((rc = ndi_qos_fill_buffer_pool_attr(nas_attr_list[i], p, sai_attr)) != STD_ERR_OK)
+        if ((rc = ndi_qos_fill_buffer_pool_attr(nas_attr_list[i], p, attr_list[i])) != STD_ERR_OK)
             return rc;
-
-        attr_list.push_back(sai_attr);
-
     }
 
     return STD_ERR_OK;
@@ -116,7 +122,7 @@ t_std_error ndi_qos_create_buffer_pool(npu_id_t npu_id,
         return STD_ERR(QOS, CFG, 0);
     }
 
-    std::vector<sai_attribute_t>  attr_list;
+    sai_attribute_t attr_list[NDI_QOS_BUFFER_POOL_ATTR_MAX];
 
     if (ndi_qos_fill_buffer_pool_attr_list(nas_attr_list, num_attr, p, attr_list)
             != STD_ERR_OK)
@@ -125,8 +131,8 @@ t_std_error ndi_qos_create_buffer_pool(npu_id_t npu_id,
     sai_object_id_t sai_qos_buffer_pool_id;
     if ((sai_ret = ndi_sai_qos_buffer_api(ndi_db_ptr)->
             create_buffer_pool(&sai_qos_buffer_pool_id,
-                                attr_list.size(),
-                                &attr_list[0]))
+                                num_attr,
+                                attr_list))
                          != SAI_STATUS_SUCCESS) {
         EV_LOGGING(NDI, NOTICE, "NDI-QOS",
                       "npu_id %d buffer_pool creation failed\n", npu_id);
@@ -242,8 +248,7 @@ t_std_error ndi_qos_get_buffer_pool(npu_id_t npu_id,
 
 {
     sai_status_t sai_ret = SAI_STATUS_FAILURE;
-    std::vector<sai_attribute_t> attr_list;
-    sai_attribute_t sai_attr;
+    sai_attribute_t attr_list[NDI_QOS_BUFFER_POOL_ATTR_MAX];
 
     nas_ndi_db_t *ndi_db_ptr = ndi_db_ptr_get(npu_id);
     if (ndi_db_ptr == NULL) {
@@ -252,23 +257,25 @@ t_std_error ndi_qos_get_buffer_pool(npu_id_t npu_id,
         return STD_ERR(QOS, CFG, 0);
     }
 
-    try {
-        for (uint_t i = 0; i < num_attr; i++) {
-            sai_attr.id = ndi2sai_buffer_pool_attr_id_map.at(nas_attr_list[i]);
-            attr_list.push_back(sai_attr);
-        }
-    }
-    catch(...) {
-        EV_LOGGING(NDI, NOTICE, "NDI-QOS",
-                    "Unexpected error.\n", npu_id);
+    if (num_attr > NDI_QOS_BUFFER_POOL_ATTR_MAX)
         return STD_ERR(QOS, CFG, 0);
+
+    for (uint_t i = 0; i < num_attr; i++) {
+        const ndi_qos_buffer_pool_attr_t *entry =
+                ndi_qos_buffer_pool_attr_tbl.find(nas_attr_list[i]);
+        if (entry == NULL) {
+            EV_LOGGING(NDI, NOTICE, "NDI-QOS",
+                        "attr_id %u not supported\n", nas_attr_list[i]);
+            return STD_ERR(QOS, CFG, 0);
+        }
+        attr_list[i].id = entry->sai_id;
     }
 
     if ((sai_ret = ndi_sai_qos_buffer_api(ndi_db_ptr)->
             get_buffer_pool_attr(
                     ndi2sai_buffer_pool_id(ndi_buffer_pool_id),
                     num_attr,
-                    &attr_list[0]))
+                    attr_list))
                          != SAI_STATUS_SUCCESS) {
         EV_LOGGING(NDI, NOTICE, "NDI-QOS",
                       "npu_id %d buffer_pool get failed\n", npu_id);
@@ -276,7 +283,7 @@ t_std_error ndi_qos_get_buffer_pool(npu_id_t npu_id,
     }
 
     // convert sai result to NAS format
-    _fill_ndi_qos_buffer_pool_struct(&attr_list[0], num_attr, p);
+    _fill_ndi_qos_buffer_pool_struct(attr_list, num_attr, p);
 
 
     return STD_ERR_OK;
@@ -29,51 +29,54 @@
 
 #include <stdio.h>
 #include <vector>
-#include <unordered_map>
 
 
-const static std::unordered_map<nas_attr_id_t, sai_attr_id_t, std::hash<int>>
-    ndi2sai_buffer_profile_attr_id_map = {
-    {BASE_QOS_BUFFER_PROFILE_POOL_ID,                   SAI_BUFFER_PROFILE_ATTR_POOL_ID},
-    {BASE_QOS_BUFFER_PROFILE_BUFFER_SIZE,               SAI_BUFFER_PROFILE_ATTR_BUFFER_SIZE},
-    {BASE_QOS_BUFFER_PROFILE_THRESHOLD_MODE,            SAI_BUFFER_PROFILE_ATTR_TH_MODE},
-    {BASE_QOS_BUFFER_PROFILE_SHARED_DYNAMIC_THRESHOLD,  SAI_BUFFER_PROFILE_ATTR_SHARED_DYNAMIC_TH},
-    {BASE_QOS_BUFFER_PROFILE_SHARED_STATIC_THRESHOLD,   SAI_BUFFER_PROFILE_ATTR_SHARED_STATIC_TH},
-    {BASE_QOS_BUFFER_PROFILE_XOFF_THRESHOLD,            SAI_BUFFER_PROFILE_ATTR_XOFF_TH},
-    {BASE_QOS_BUFFER_PROFILE_XON_THRESHOLD,             SAI_BUFFER_PROFILE_ATTR_XON_TH},
-
+typedef struct _ndi_qos_buffer_profile_attr_t {
+    nas_attr_id_t nas_id;
+    sai_attr_id_t sai_id;
+    void (*fill)(const ndi_qos_buffer_profile_struct_t *p, sai_attribute_value_t &v);
+} ndi_qos_buffer_profile_attr_t;
+
+// Only the settable attributes are included
+static const ndi_qos_buffer_profile_attr_t ndi_qos_buffer_profile_attr_list[] = {
+    {BASE_QOS_BUFFER_PROFILE_POOL_ID,                   SAI_BUFFER_PROFILE_ATTR_POOL_ID,
+        [](const ndi_qos_buffer_profile_struct_t *p, sai_attribute_value_t &v) {
+            v.u64 = (p->pool_id == NDI_QOS_NULL_OBJECT_ID? SAI_NULL_OBJECT_ID: p->pool_id); }},
+    {BASE_QOS_BUFFER_PROFILE_BUFFER_SIZE,               SAI_BUFFER_PROFILE_ATTR_BUFFER_SIZE,
+        [](const ndi_qos_buffer_profile_struct_t *p, sai_attribute_value_t &v) { v.u32 = p->buffer_size; }},
+    {BASE_QOS_BUFFER_PROFILE_THRESHOLD_MODE,            SAI_BUFFER_PROFILE_ATTR_TH_MODE,
+        [](const ndi_qos_buffer_profile_struct_t *p, sai_attribute_value_t &v) {
+            v.u32 = (p->threshold_mode == BASE_QOS_BUFFER_THRESHOLD_MODE_STATIC?
+                        SAI_BUFFER_PROFILE_THRESHOLD_MODE_STATIC: SAI_BUFFER_PROFILE_THRESHOLD_MODE_DYNAMIC); }},
+    {BASE_QOS_BUFFER_PROFILE_SHARED_DYNAMIC_THRESHOLD,  SAI_BUFFER_PROFILE_ATTR_SHARED_DYNAMIC_TH,
+        [](const ndi_qos_buffer_profile_struct_t *p, sai_attribute_value_t &v) { v.u8 = (uint8_t)(p->shared_dynamic_th); }},
+    {BASE_QOS_BUFFER_PROFILE_SHARED_STATIC_THRESHOLD,   SAI_BUFFER_PROFILE_ATTR_SHARED_STATIC_TH,
+        [](const ndi_qos_buffer_profile_struct_t *p, sai_attribute_value_t &v) { v.u32 = p->shared_static_th; }},
+    {BASE_QOS_BUFFER_PROFILE_XOFF_THRESHOLD,            SAI_BUFFER_PROFILE_ATTR_XOFF_TH,
+        [](const ndi_qos_buffer_profile_struct_t *p, sai_attribute_value_t &v) { v.s32 = p->xoff_th; }},
+    {BASE_QOS_BUFFER_PROFILE_XON_THRESHOLD,             SAI_BUFFER_PROFILE_ATTR_XON_TH,
+        [](const ndi_qos_buffer_profile_struct_t *p, sai_attribute_value_t &v) { v.s32 = p->xon_th; }},
 };
 
+static const ndi_qos_attr_tbl<ndi_qos_buffer_profile_attr_t>
+    ndi_qos_buffer_profile_attr_tbl(ndi_qos_buffer_profile_attr_list);
+
+#define NDI_QOS_BUFFER_PROFILE_ATTR_MAX NDI_QOS_TBL_SIZE(ndi_qos_buffer_profile_attr_list)
+
 
 static t_std_error ndi_qos_fill_buffer_profile_attr(nas_attr_id_t attr_id,
                         const ndi_qos_buffer_profile_struct_t *p,
                         sai_attribute_t &sai_attr)
 {
-    // Only the settable attributes are included
-    try {
-        sai_attr.id = ndi2sai_buffer_profile_attr_id_map.at(attr_id);
-    }
-    catch (...) {
+    const ndi_qos_buffer_profile_attr_t *entry = ndi_qos_buffer_profile_attr_tbl.find(attr_id);
+    if (entry == NULL) {
         EV_LOGGING(NDI, NOTICE, "NDI-QOS",
                       "attr_id %u not supported\n", attr_id);
         return STD_ERR(QOS, CFG, 0);
     }
 
-    if (attr_id == BASE_QOS_BUFFER_PROFILE_POOL_ID)
-        sai_attr.value.u64 = (p->pool_id == NDI_QOS_NULL_OBJECT_ID? SAI_NULL_OBJECT_ID: p->pool_id);
-    else if (attr_id == BASE_QOS_BUFFER_PROFILE_BUFFER_SIZE)
-        sai_attr.value.u32 = p->buffer_size;
-    else if (attr_id == BASE_QOS_BUFFER_PROFILE_THRESHOLD_MODE)
-        sai_attr.value.u32 = (p->threshold_mode == BASE_QOS_BUFFER_THRESHOLD_MODE_STATIC?
-                                  SAI_BUFFER_PROFILE_THRESHOLD_MODE_STATIC: SAI_BUFFER_PROFILE_THRESHOLD_MODE_DYNAMIC);
-    else if (attr_id == BASE_QOS_BUFFER_PROFILE_SHARED_DYNAMIC_THRESHOLD)
-        sai_attr.value.u8 = (uint8_t)(p->shared_dynamic_th);
-    else if (attr_id == BASE_QOS_BUFFER_PROFILE_SHARED_STATIC_THRESHOLD)
-        sai_attr.value.u32 = p->shared_static_th;
-    else if (attr_id == BASE_QOS_BUFFER_PROFILE_XOFF_THRESHOLD)
-        sai_attr.value.s32 = p->xoff_th;
-    else if (attr_id == BASE_QOS_BUFFER_PROFILE_XON_THRESHOLD)
-        sai_attr.value.s32 = p->xon_th;
+    sai_attr.id = entry->sai_id;
+    entry->fill(p, sai_attr.value);
 
     return STD_ERR_OK;
 }
@@ -82,17 +85,16 @@ static t_std_error ndi_qos_fill_buffer_profile_attr(nas_attr_id_t attr_id,
 static t_std_error ndi_qos_fill_buffer_profile_attr_list(const nas_attr_id_t *nas_attr_list,
                                     uint_t num_attr,
                                     const ndi_qos_buffer_profile_struct_t *p,
-                                    std::vector<sai_attribute_t> &attr_list)
+                                    sai_attribute_t *attr_list)
 {
-    sai_attribute_t sai_attr = {0};
     t_std_error      rc = STD_ERR_OK;
 
+    if (num_attr > NDI_QOS_BUFFER_PROFILE_ATTR_MAX)
+        return STD_ERR(QOS, CFG, 0);
+
     for (uint_t i = 0; i < num_attr; i++) {
-        if ((rc = ndi_qos_fill_buffer_profile_attr(nas_attr_list[i], p, sai_attr)) != STD_ERR_OK)
+        if ((rc = ndi_qos_fill_buffer_profile_attr(nas_attr_list[i], p, attr_list[i])) != STD_ERR_OK)
             return rc;
-
-        attr_list.push_back(sai_attr);
-
     }
 
     return STD_ERR_OK;
@@ -124,7 +126,7 @@ t_std_error ndi_qos_create_buffer_profile(npu_id_t npu_id,
         return STD_ERR(QOS, CFG, 0);
     }
 
-    std::vector<sai_attribute_t>  attr_list;
+    sai_attribute_t attr_list[NDI_QOS_BUFFER_PROFILE_ATTR_MAX];
 
     if (ndi_qos_fill_buffer_profile_attr_list(nas_attr_list, num_attr, p, attr_list)
             != STD_ERR_OK)
@@ -133,8 +135,8 @@ t_std_error ndi_qos_create_buffer_profile(npu_id_t npu_id,
     sai_object_id_t sai_qos_buffer_profile_id;
     if ((sai_ret = ndi_sai_qos_buffer_api(ndi_db_ptr)->
             create_buffer_profile(&sai_qos_buffer_profile_id,
-                                attr_list.size(),
-                                &attr_list[0]))
+                                num_attr,
+                                attr_list))
                          != SAI_STATUS_SUCCESS) {
         EV_LOGGING(NDI, NOTICE, "NDI-QOS",
                       "npu_id %d buffer_profile creation failed\n", npu_id);
@@ -258,8 +260,7 @@ t_std_error ndi_qos_get_buffer_profile(npu_id_t npu_id,
 
 {
     sai_status_t sai_ret = SAI_STATUS_FAILURE;
-    std::vector<sai_attribute_t> attr_list;
-    sai_attribute_t sai_attr;
+    sai_attribute_t attr_list[NDI_QOS_BUFFER_PROFILE_ATTR_MAX];
 
     nas_ndi_db_t *ndi_db_ptr = ndi_db_ptr_get(npu_id);
     if (ndi_db_ptr == NULL) {
@@ -268,23 +269,25 @@ t_std_error ndi_qos_get_buffer_profile(npu_id_t npu_id,
         return STD_ERR(QOS, CFG, 0);
     }
 
-    try {
-        for (uint_t i = 0; i < num_attr; i++) {
-            sai_attr.id = ndi2sai_buffer_profile_attr_id_map.at(nas_attr_list[i]);
-            attr_list.push_back(sai_attr);
-        }
-    }
-    catch(...) {
-        EV_LOGGING(NDI, NOTICE, "NDI-QOS",
-                    "Unexpected error.\n", npu_id);
+    if (num_attr > NDI_QOS_BUFFER_PROFILE_ATTR_MAX)
         return STD_ERR(QOS, CFG, 0);
+
+    for (uint_t i = 0; i < num_attr; i++) {
+        const ndi_qos_buffer_profile_attr_t *entry =
+                ndi_qos_buffer_profile_attr_tbl.find(nas_attr_list[i]);
+        if (entry == NULL) {
+            EV_LOGGING(NDI, NOTICE, "NDI-QOS",
+                        "attr_id %u not supported\n", nas_attr_list[i]);
+            return STD_ERR(QOS, CFG, 0);
+        }
+        attr_list[i].id = entry->sai_id;
     }
 
     if ((sai_ret = ndi_sai_qos_buffer_api(ndi_db_ptr)->
             get_buffer_profile_attr(
                     ndi2sai_buffer_profile_id(ndi_buffer_profile_id),
                     num_attr,
-                    &attr_list[0]))
+                    attr_list))
                          != SAI_STATUS_SUCCESS) {
         EV_LOGGING(NDI, NOTICE, "NDI-QOS",
                       "npu_id %d buffer_profile get failed\n", npu_id);
@@ -292,7 +295,7 @@ t_std_error ndi_qos_get_buffer_profile(npu_id_t npu_id,
     }
 
     // convert sai result to NAS format
-    _fill_ndi_qos_buffer_profile_struct(&attr_list[0], num_attr, p);
+    _fill_ndi_qos_buffer_profile_struct(attr_list, num_attr, p);
 
 
     return STD_ERR_OK;
@@ -0,0 +1,346 @@
+/*
+ * Copyright (c) 2016 Dell Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License. You may obtain
+ * a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * THIS CODE IS PROVIDED ON AN *AS IS* BASIS, WITHOUT WARRANTIES OR
+ * CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ * LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ * FOR A PARTICULAR PURPOSE, MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ * See the Apache Version 2.0 License for specific language governing
+ * permissions and limitations under the License.
+ */
+
+/*
+ * filename: nas_ndi_qos_buffer_telemetry.cpp
+ */
+
+#include "std_error_codes.h"
+#include "std_mutex_lock.h"
+#include "nas_ndi_event_logs.h"
+#include "nas_ndi_int.h"
+#include "nas_ndi_utils.h"
+#include "nas_ndi_qos_utl.h"
+#include "nas_ndi_qos_buffer_telemetry.h"
+#include "sai.h"
+
+#include <inttypes.h>
+#include <string.h>
+#include <time.h>
+#include <algorithm>
+#include <vector>
+#include <unordered_map>
+
+/*  SAI counters read per object, in ndi_qos_pool_sample_t and
+ *  ndi_qos_pg_sample_t order */
+static const sai_buffer_pool_stat_t ndi_qos_pool_sample_ids[NDI_QOS_POOL_SAMPLE_MAX] = {
+    SAI_BUFFER_POOL_STAT_CURR_OCCUPANCY_BYTES,
+    SAI_BUFFER_POOL_STAT_WATERMARK_BYTES,
+};
+
+static const sai_ingress_priority_group_stat_t ndi_qos_pg_sample_ids[NDI_QOS_PG_SAMPLE_MAX] = {
+    SAI_INGRESS_PRIORITY_GROUP_STAT_CURR_OCCUPANCY_BYTES,
+    SAI_INGRESS_PRIORITY_GROUP_STAT_WATERMARK_BYTES,
+    SAI_INGRESS_PRIORITY_GROUP_STAT_SHARED_CURR_OCCUPANCY_BYTES,
+    SAI_INGRESS_PRIORITY_GROUP_STAT_SHARED_WATERMARK_BYTES,
+    SAI_INGRESS_PRIORITY_GROUP_STAT_XOFF_ROOM_CURR_OCCUPANCY_BYTES,
+    SAI_INGRESS_PRIORITY_GROUP_STAT_XOFF_ROOM_WATERMARK_BYTES,
+};
+
+/*  Occupancy/watermark pairs of a PG that feed one peak */
+static const struct {
+    ndi_qos_pg_sample_t occupancy;
+    ndi_qos_pg_sample_t watermark;
+    uint64_t ndi_qos_pg_peak_t::*peak;
+} ndi_qos_pg_peak_map[] = {
+    {NDI_QOS_PG_SAMPLE_OCCUPANCY, NDI_QOS_PG_SAMPLE_WATERMARK,
+     &ndi_qos_pg_peak_t::peak_bytes},
+    {NDI_QOS_PG_SAMPLE_SHARED_OCCUPANCY, NDI_QOS_PG_SAMPLE_SHARED_WATERMARK,
+     &ndi_qos_pg_peak_t::shared_peak_bytes},
+    {NDI_QOS_PG_SAMPLE_XOFF_ROOM_OCCUPANCY, NDI_QOS_PG_SAMPLE_XOFF_ROOM_WATERMARK,
+     &ndi_qos_pg_peak_t::xoff_room_peak_bytes},
+};
+
+typedef struct _ndi_qos_buffer_sampler_t {
+    std::vector<sai_object_id_t> pool_list;
+    std::vector<sai_object_id_t> pg_list;
+
+    /*  ring_size headers and ring_size * stride values, allocated once */
+    size_t ring_size = 0;
+    size_t stride = 0;
+    std::vector<ndi_qos_buffer_sample_hdr_t> hdr_ring;
+    std::vector<uint64_t> value_ring;
+    uint64_t next_seq = 1;
+
+    std::vector<uint64_t> pool_peaks;
+    std::vector<ndi_qos_pg_peak_t> pg_peaks;
+} ndi_qos_buffer_sampler_t;
+
+static std::unordered_map<npu_id_t, ndi_qos_buffer_sampler_t> g_qos_buffer_sampler;
+
+static std_mutex_lock_create_static_init_rec(qos_buffer_telemetry_lock);
+
+static uint64_t ndi_qos_buffer_telemetry_now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000) + (ts.tv_nsec / 1000000);
+}
+
+static inline size_t ndi_qos_buffer_slot(const ndi_qos_buffer_sampler_t &s, uint64_t seq)
+{
+    return (seq - 1) % s.ring_size;
+}
+
+/*  Values of the previous sample, NULL for the first one */
+static const uint64_t *ndi_qos_buffer_prev_values(const ndi_qos_buffer_sampler_t &s)
+{
+    if (s.next_seq == 1) {
+        return NULL;
+    }
+    return &s.value_ring[ndi_qos_buffer_slot(s, s.next_seq - 1) * s.stride];
+}
+
+/*  Peak seen in an interval: the sampled occupancy and, if the hardware
+ *  watermark moved (it rose, or was cleared and rose again), its value */
+static inline uint64_t ndi_qos_buffer_interval_peak(uint64_t occupancy, uint64_t watermark,
+                                                    const uint64_t *prev_watermark)
+{
+    if ((prev_watermark == NULL) || (watermark != *prev_watermark)) {
+        return std::max(occupancy, watermark);
+    }
+    return occupancy;
+}
+
+/*  An object that couldn't be read keeps its previous values, so the next
+ *  sample doesn't see its watermark move from 0 and report a false peak */
+static inline void ndi_qos_buffer_values_carry(uint64_t *values, const uint64_t *prev_values,
+                                               size_t count)
+{
+    if (prev_values != NULL) {
+        memcpy(values, prev_values, sizeof(*values) * count);
+    } else {
+        memset(values, 0, sizeof(*values) * count);
+    }
+}
+
+extern "C" {
+
+t_std_error ndi_qos_buffer_telemetry_cfg_set(npu_id_t npu_id,
+                                             const ndi_obj_id_t *pool_list, size_t pool_count,
+                                             const ndi_obj_id_t *pg_list, size_t pg_count,
+                                             size_t ring_size)
+{
+    if (((pool_list == NULL) && (pool_count != 0)) || ((pg_list == NULL) && (pg_count != 0))) {
+        return STD_ERR(QOS, PARAM, 0);
+    }
+
+    std_mutex_simple_lock_guard g(&qos_buffer_telemetry_lock);
+
+    if ((pool_count == 0) && (pg_count == 0)) {
+        g_qos_buffer_sampler.erase(npu_id);
+        return STD_ERR_OK;
+    }
+    /*  a sample is compared with the previous one, which must still be there */
+    if (ring_size < 2) {
+        return STD_ERR(QOS, PARAM, 0);
+    }
+    if (ndi_db_ptr_get(npu_id) == NULL) {
+        EV_LOGGING(NDI, DEBUG, "NDI-QOS",
+                      "npu_id %d not exist\n", npu_id);
+        return STD_ERR(QOS, CFG, 0);
+    }
+
+    try {
+        ndi_qos_buffer_sampler_t s;
+
+        for (size_t ix = 0; ix < pool_count; ++ix) {
+            s.pool_list.push_back(ndi2sai_buffer_pool_id(pool_list[ix]));
+        }
+        for (size_t ix = 0; ix < pg_count; ++ix) {
+            s.pg_list.push_back(ndi2sai_priority_group_id(pg_list[ix]));
+        }
+        s.ring_size = ring_size;
+        s.stride = (pool_count * NDI_QOS_POOL_SAMPLE_MAX) + (pg_count * NDI_QOS_PG_SAMPLE_MAX);
+        s.hdr_ring.resize(ring_size);
+        s.value_ring.resize(ring_size * s.stride);
+        s.pool_peaks.resize(pool_count);
+        s.pg_peaks.resize(pg_count);
+
+        g_qos_buffer_sampler[npu_id] = std::move(s);
+    } catch (...) {
+        EV_LOGGING(NDI, NOTICE, "NDI-QOS",
+                   "Unable to allocate buffer telemetry ring of npu_id %d\n", npu_id);
+        return STD_ERR(QOS, NOMEM, 0);
+    }
+    return STD_ERR_OK;
+}
+
+t_std_error ndi_qos_buffer_telemetry_sample(npu_id_t npu_id)
+{
+    nas_ndi_db_t *ndi_db_ptr = ndi_db_ptr_get(npu_id);
+    if (ndi_db_ptr == NULL) {
+        EV_LOGGING(NDI, DEBUG, "NDI-QOS",
+                      "npu_id %d not exist\n", npu_id);
+        return STD_ERR(QOS, CFG, 0);
+    }
+    sai_buffer_api_t *buffer_api = ndi_sai_qos_buffer_api(ndi_db_ptr);
+
+    std_mutex_simple_lock_guard g(&qos_buffer_telemetry_lock);
+
+    auto it = g_qos_buffer_sampler.find(npu_id);
+    if (it == g_qos_buffer_sampler.end()) {
+        return STD_ERR(QOS, CFG, 0);
+    }
+    ndi_qos_buffer_sampler_t &s = it->second;
+
+    uint64_t seq = s.next_seq;
+    size_t slot = ndi_qos_buffer_slot(s, seq);
+    ndi_qos_buffer_sample_hdr_t &hdr = s.hdr_ring[slot];
+    uint64_t *values = &s.value_ring[slot * s.stride];
+    const uint64_t *prev = ndi_qos_buffer_prev_values(s);
+    t_std_error rc = STD_ERR_OK;
+    sai_status_t sai_ret;
+
+    hdr.seq = seq;
+    hdr.timestamp_ms = ndi_qos_buffer_telemetry_now_ms();
+    hdr.read_errors = 0;
+
+    for (size_t ix = 0; ix < s.pool_list.size(); ++ix) {
+        uint64_t *v = values + (ix * NDI_QOS_POOL_SAMPLE_MAX);
+        sai_ret = buffer_api->get_buffer_pool_stats(s.pool_list[ix], ndi_qos_pool_sample_ids,
+                                                    NDI_QOS_POOL_SAMPLE_MAX, v);
+        const uint64_t *pv = (prev != NULL) ? prev + (ix * NDI_QOS_POOL_SAMPLE_MAX) : NULL;
+        if (sai_ret != SAI_STATUS_SUCCESS) {
+            ndi_qos_buffer_values_carry(v, pv, NDI_QOS_POOL_SAMPLE_MAX);
+            hdr.read_errors++;
+            rc = STD_ERR(QOS, CFG, sai_ret);
+            continue;
+        }
+        uint64_t peak = ndi_qos_buffer_interval_peak(v[NDI_QOS_POOL_SAMPLE_OCCUPANCY],
+                            v[NDI_QOS_POOL_SAMPLE_WATERMARK],
+                            (pv != NULL) ? &pv[NDI_QOS_POOL_SAMPLE_WATERMARK] : NULL);
+        s.pool_peaks[ix] = std::max(s.pool_peaks[ix], peak);
+    }
+
+    uint64_t *pg_values = values + (s.pool_list.size() * NDI_QOS_POOL_SAMPLE_MAX);
+    const uint64_t *pg_prev = (prev != NULL) ?
+                                prev + (s.pool_list.size() * NDI_QOS_POOL_SAMPLE_MAX) : NULL;
+
+    for (size_t ix = 0; ix < s.pg_list.size(); ++ix) {
+        uint64_t *v = pg_values + (ix * NDI_QOS_PG_SAMPLE_MAX);
+        sai_ret = buffer_api->get_ingress_priority_group_stats(s.pg_list[ix],
+                                                               ndi_qos_pg_sample_ids,
+                                                               NDI_QOS_PG_SAMPLE_MAX, v);
+        const uint64_t *pv = (pg_prev != NULL) ? pg_prev + (ix * NDI_QOS_PG_SAMPLE_MAX) : NULL;
+        if (sai_ret != SAI_STATUS_SUCCESS) {
+            ndi_qos_buffer_values_carry(v, pv, NDI_QOS_PG_SAMPLE_MAX);
+            hdr.read_errors++;
+            rc = STD_ERR(QOS, CFG, sai_ret);
+            continue;
+        }
+        for (auto &m : ndi_qos_pg_peak_map) {
+            uint64_t peak = ndi_qos_buffer_interval_peak(v[m.occupancy], v[m.watermark],
+                                (pv != NULL) ? &pv[m.watermark] : NULL);
+            uint64_t &cur = s.pg_peaks[ix].*m.peak;
+            cur = std::max(cur, peak);
+        }
+    }
+
+    s.next_seq++;
+
+    if (hdr.read_errors != 0) {
+        EV_LOGGING(NDI, DEBUG, "NDI-QOS",
+                   "npu_id %d buffer telemetry sample %" PRIu64 ": %u objects not read\n",
+                   npu_id, seq, hdr.read_errors);
+    }
+    return rc;
+}
+
+t_std_error ndi_qos_buffer_telemetry_state_get(npu_id_t npu_id,
+                                               ndi_qos_buffer_telemetry_state_t *state)
+{
+    std_mutex_simple_lock_guard g(&qos_buffer_telemetry_lock);
+
+    auto it = g_qos_buffer_sampler.find(npu_id);
+    if ((it == g_qos_buffer_sampler.end()) || (state == NULL)) {
+        return STD_ERR(QOS, PARAM, 0);
+    }
+    const ndi_qos_buffer_sampler_t &s = it->second;
+
+    state->pool_count = s.pool_list.size();
+    state->pg_count = s.pg_list.size();
+    state->ring_size = s.ring_size;
+    state->newest_seq = s.next_seq - 1;
+    if (state->newest_seq == 0) {
+        state->oldest_seq = 0;
+    } else if (state->newest_seq > s.ring_size) {
+        state->oldest_seq = state->newest_seq - s.ring_size + 1;
+    } else {
+        state->oldest_seq = 1;
+    }
+    return STD_ERR_OK;
+}
+
+t_std_error ndi_qos_buffer_telemetry_sample_get(npu_id_t npu_id, uint64_t seq,
+                                                ndi_qos_buffer_sample_hdr_t *hdr,
+                                                uint64_t *pool_values, uint64_t *pg_values)
+{
+    std_mutex_simple_lock_guard g(&qos_buffer_telemetry_lock);
+
+    auto it = g_qos_buffer_sampler.find(npu_id);
+    if (it == g_qos_buffer_sampler.end()) {
+        return STD_ERR(QOS, PARAM, 0);
+    }
+    const ndi_qos_buffer_sampler_t &s = it->second;
+
+    uint64_t newest = s.next_seq - 1;
+    if (seq == 0) {
+        seq = newest;
+    }
+    if ((seq == 0) || (seq > newest) || (newest - seq >= s.ring_size)) {
+        return STD_ERR(QOS, PARAM, 0);
+    }
+
+    size_t slot = ndi_qos_buffer_slot(s, seq);
+    const uint64_t *values = &s.value_ring[slot * s.stride];
+    size_t pool_len = s.pool_list.size() * NDI_QOS_POOL_SAMPLE_MAX;
+
+    if (hdr != NULL) {
+        *hdr = s.hdr_ring[slot];
+    }
+    if (pool_values != NULL) {
+        std::copy(values, values + pool_len, pool_values);
+    }
+    if (pg_values != NULL) {
+        std::copy(values + pool_len, values + s.stride, pg_values);
+    }
+    return STD_ERR_OK;
+}
+
+t_std_error ndi_qos_buffer_telemetry_peaks_read_reset(npu_id_t npu_id, uint64_t *pool_peaks,
+                                                      ndi_qos_pg_peak_t *pg_peaks)
+{
+    std_mutex_simple_lock_guard g(&qos_buffer_telemetry_lock);
+
+    auto it = g_qos_buffer_sampler.find(npu_id);
+    if (it == g_qos_buffer_sampler.end()) {
+        return STD_ERR(QOS, PARAM, 0);
+    }
+    ndi_qos_buffer_sampler_t &s = it->second;
+
+    if (pool_peaks != NULL) {
+        std::copy(s.pool_peaks.begin(), s.pool_peaks.end(), pool_peaks);
+    }
+    if (pg_peaks != NULL) {
+        std::copy(s.pg_peaks.begin(), s.pg_peaks.end(), pg_peaks);
+    }
+    std::fill(s.pool_peaks.begin(), s.pool_peaks.end(), 0);
+    std::fill(s.pg_peaks.begin(), s.pg_peaks.end(), ndi_qos_pg_peak_t());
+    return STD_ERR_OK;
+}
+
+}
@@ -26,14 +26,21 @@
 #include "sai.h"
 #include "dell-base-qos.h" //from yang model
 #include "nas_ndi_qos.h"
+#include "std_mutex_lock.h"
 
 #include <stdio.h>
+#include <inttypes.h>
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <map>
+#include <new>
 #include <vector>
 #include <unordered_map>
 
 
 typedef std::unordered_map<ndi_qos_map_type_t, sai_qos_map_type_t, std::hash<int>> ndi_2_sai_qos_map_type_mapping;
-ndi_2_sai_qos_map_type_mapping    NDI_2_SAI_QOS_MAP_TYPE = {
+static const ndi_2_sai_qos_map_type_mapping    NDI_2_SAI_QOS_MAP_TYPE = {
         {NDI_QOS_MAP_DOT1P_TO_TC,       SAI_QOS_MAP_DOT1P_TO_TC},
         {NDI_QOS_MAP_DOT1P_TO_COLOR,    SAI_QOS_MAP_DOT1P_TO_COLOR},
         {NDI_QOS_MAP_DOT1P_TO_TC_COLOR, SAI_QOS_MAP_DOT1P_TO_TC_AND_COLOR},
@@ -63,7 +70,7 @@ sai_packet_color_t ndi2sai_qos_packet_color(BASE_QOS_PACKET_COLOR_t color)
 }
 
 typedef std::unordered_map<sai_qos_map_type_t, ndi_qos_map_type_t, std::hash<int>> sai_2_ndi_qos_map_type_mapping;
-sai_2_ndi_qos_map_type_mapping    SAI_2_NDI_QOS_MAP_TYPE = {
+static const sai_2_ndi_qos_map_type_mapping    SAI_2_NDI_QOS_MAP_TYPE = {
         {SAI_QOS_MAP_DOT1P_TO_TC,           NDI_QOS_MAP_DOT1P_TO_TC},
         {SAI_QOS_MAP_DOT1P_TO_COLOR,        NDI_QOS_MAP_DOT1P_TO_COLOR},
         {SAI_QOS_MAP_DOT1P_TO_TC_AND_COLOR, NDI_QOS_MAP_DOT1P_TO_TC_COLOR},
@@ -144,6 +151,225 @@ static void _fill_ndi_response_map_entries(sai_qos_map_t * entry_list,
     }
 }
 
+/*  Maps created with identical content share one SAI map. The content is
+ *  kept in a canonical form, npu and type followed by the entries sorted by
+ *  key, and indexes the shared maps of all npus.
+ */
+typedef std::vector<uint32_t> ndi_qos_map_content_t;
+
+struct ndi_qos_map_content_hash {
+    size_t operator()(const ndi_qos_map_content_t &c) const {
+        size_t h = c.size();
+        for (auto v: c) {
+            h ^= std::hash<uint32_t>()(v) + 0x9e3779b9 + (h << 6) + (h >> 2);
+        }
+        return h;
+    }
+};
+
+#define NDI_QOS_MAP_PARAMS_LEN  7
+
+typedef std::array<uint32_t, NDI_QOS_MAP_PARAMS_LEN> ndi_qos_map_params_key_t;
+
+/*  Entries of a map as last sent to SAI, by key */
+typedef std::map<ndi_qos_map_params_key_t, ndi_qos_map_struct_t> ndi_qos_map_shadow_t;
+
+typedef struct _ndi_qos_map_ref_t {
+    uint_t ref_count;
+    ndi_qos_map_type_t type;
+    bool shareable;                     // created by ndi_qos_create_shared_map or copied for it
+    bool indexed;                       // content is in the shared map index
+    ndi_qos_map_content_t content;
+    ndi_qos_map_shadow_t shadow;
+} ndi_qos_map_ref_t;
+
+typedef std::pair<npu_id_t, ndi_obj_id_t> ndi_qos_map_key_t;
+
+typedef struct _ndi_qos_map_npu_t {
+    bool partial_update;
+    ndi_qos_map_update_stats_t stats;
+} ndi_qos_map_npu_t;
+
+static std_mutex_lock_create_static_init_rec(qos_map_lock);
+static std::unordered_map<ndi_qos_map_content_t, ndi_obj_id_t, ndi_qos_map_content_hash>
+    g_qos_map_by_content;
+static std::map<ndi_qos_map_key_t, ndi_qos_map_ref_t> g_qos_map_refs;
+static std::map<npu_id_t, ndi_qos_map_npu_t> g_qos_map_npu;
+
+/*  Key or value of a map entry */
+template <typename P>
+static ndi_qos_map_params_key_t _ndi_qos_map_params_key(const P &p)
+{
+    return ndi_qos_map_params_key_t{{
+            (uint32_t)p.color, (uint32_t)p.dot1p, (uint32_t)p.dscp,
+            (uint32_t)p.qid, (uint32_t)p.tc, (uint32_t)p.prio, (uint32_t)p.pg}};
+}
+
+static void _ndi_qos_map_shadow_merge(ndi_qos_map_shadow_t &shadow,
+                                      uint_t map_entry_count,
+                                      const ndi_qos_map_struct_t *map_entry)
+{
+    for (uint_t i = 0; i < map_entry_count; i++) {
+        shadow[_ndi_qos_map_params_key(map_entry[i].key)] = map_entry[i];
+    }
+}
+
+static void _ndi_qos_map_content(npu_id_t npu_id, ndi_qos_map_type_t type,
+                                 const ndi_qos_map_shadow_t &shadow,
+                                 ndi_qos_map_content_t &content)
+{
+    content.clear();
+    content.reserve(2 + shadow.size() * NDI_QOS_MAP_PARAMS_LEN * 2);
+    content.push_back((uint32_t)npu_id);
+    content.push_back((uint32_t)type);
+    for (auto &e: shadow) {
+        ndi_qos_map_params_key_t value = _ndi_qos_map_params_key(e.second.value);
+        content.insert(content.end(), e.first.begin(), e.first.end());
+        content.insert(content.end(), value.begin(), value.end());
+    }
+}
+
+static void _ndi_qos_map_unindex(ndi_qos_map_ref_t &ref)
+{
+    if (ref.indexed) {
+        g_qos_map_by_content.erase(ref.content);
+        ref.indexed = false;
+        ref.content.clear();
+    }
+}
+
+/*  Offer a shareable map with entries for sharing, unless a map with the
+ *  same content is offered already. A map that can't be indexed just isn't
+ *  shared.
+ */
+static void _ndi_qos_map_index(npu_id_t npu_id, ndi_obj_id_t ndi_map_id,
+                               ndi_qos_map_ref_t &ref)
+{
+    if (!ref.shareable || ref.indexed || ref.shadow.size() == 0)
+        return;
+
+    try {
+        ndi_qos_map_content_t content;
+        _ndi_qos_map_content(npu_id, ref.type, ref.shadow, content);
+        if (g_qos_map_by_content.emplace(content, ndi_map_id).second) {
+            ref.indexed = true;
+            ref.content.swap(content);
+        }
+    } catch (std::bad_alloc &) {
+        EV_LOGGING(NDI, NOTICE, "NDI-QOS",
+                      "npu_id %d map 0x%" PRIx64 " not indexed, out of memory\n",
+                      npu_id, ndi_map_id);
+    }
+}
+
+static t_std_error _ndi_qos_map_sai_create(nas_ndi_db_t *ndi_db_ptr,
+                                           npu_id_t npu_id,
+                                           ndi_qos_map_type_t type,
+                                           uint_t map_entry_count,
+                                           const ndi_qos_map_struct_t *map_entry,
+                                           ndi_obj_id_t *ndi_map_id)
+{
+    sai_status_t sai_ret = SAI_STATUS_FAILURE;
+    uint_t attr_count = 1;  // map-type only
+    sai_attribute_t attr_list[2];
+    std::vector<sai_qos_map_t> entry_list;
+
+    auto it = NDI_2_SAI_QOS_MAP_TYPE.find(type);
+    if (it == NDI_2_SAI_QOS_MAP_TYPE.end()) {
+        EV_LOGGING(NDI, NOTICE, "NDI-QOS",
+                    "npu_id %d map type %d not supported\n", npu_id, type);
+        return STD_ERR(QOS, CFG, 0);
+    }
+    attr_list[0].id = SAI_QOS_MAP_ATTR_TYPE;
+    attr_list[0].value.s32 = it->second;
+
+    if (map_entry_count > 0) {
+        try {
+            entry_list.resize(map_entry_count);
+        } catch (std::bad_alloc &) {
+            return STD_ERR(QOS, NOMEM, 0);
+        }
+        attr_count = 2; // Plus map-list
+        _fill_sai_request_map_entries(&entry_list[0], map_entry_count, map_entry);
+
+        attr_list[1].id = SAI_QOS_MAP_ATTR_MAP_TO_VALUE_LIST;
+        attr_list[1].value.qosmap.count = map_entry_count;
+        attr_list[1].value.qosmap.list = &entry_list[0];
+    }
+
+    sai_object_id_t sai_qos_map_id;
+    if ((sai_ret = ndi_sai_qos_map_api(ndi_db_ptr)->
+                        create_qos_map(&sai_qos_map_id,
+                                attr_count,
+                                attr_list))
+                         != SAI_STATUS_SUCCESS) {
+        EV_LOGGING(NDI, NOTICE, "NDI-QOS",
+                      "npu_id %d map creation failed\n", npu_id);
+        return STD_ERR(QOS, CFG, sai_ret);
+    }
+    *ndi_map_id = sai2ndi_qos_map_id(sai_qos_map_id);
+    return STD_ERR_OK;
+}
+
+static t_std_error _ndi_qos_create_map(npu_id_t npu_id,
+                                       ndi_qos_map_type_t type,
+                                       uint_t map_entry_count,
+                                       const ndi_qos_map_struct_t *map_entry,
+                                       bool shareable,
+                                       ndi_obj_id_t *ndi_map_id)
+{
+    nas_ndi_db_t *ndi_db_ptr = ndi_db_ptr_get(npu_id);
+    if (ndi_db_ptr == NULL) {
+        EV_LOGGING(NDI, DEBUG, "NDI-QOS",
+                      "npu_id %d not exist\n", npu_id);
+        return STD_ERR(QOS, CFG, 0);
+    }
+
+    ndi_qos_map_shadow_t shadow;
+    ndi_qos_map_content_t content;
+    try {
+        _ndi_qos_map_shadow_merge(shadow, map_entry_count, map_entry);
+        if (shareable)
+            _ndi_qos_map_content(npu_id, type, shadow, content);
+    } catch (std::bad_alloc &) {
+        return STD_ERR(QOS, NOMEM, 0);
+    }
+
+    std_mutex_simple_lock_guard g(&qos_map_lock);
+
+    if (shareable && map_entry_count > 0) {
+        auto shared = g_qos_map_by_content.find(content);
+        if (shared != g_qos_map_by_content.end()) {
+            ndi_qos_map_ref_t &ref = g_qos_map_refs.at(ndi_qos_map_key_t(npu_id, shared->second));
+            ref.ref_count++;
+            *ndi_map_id = shared->second;
+            EV_LOGGING(NDI, DEBUG, "NDI-QOS",
+                          "npu_id %d map 0x%" PRIx64 " shared, %u references\n",
+                          npu_id, shared->second, ref.ref_count);
+            return STD_ERR_OK;
+        }
+    }
+
+    t_std_error rc = _ndi_qos_map_sai_create(ndi_db_ptr, npu_id, type,
+                                             map_entry_count, map_entry, ndi_map_id);
+    if (rc != STD_ERR_OK)
+        return rc;
+
+    try {
+        ndi_qos_map_ref_t &ref = g_qos_map_refs[ndi_qos_map_key_t(npu_id, *ndi_map_id)];
+        ref.ref_count = 1;
+        ref.type = type;
+        ref.shareable = shareable;
+        ref.indexed = false;
+        ref.shadow.swap(shadow);
+        _ndi_qos_map_index(npu_id, *ndi_map_id, ref);
+    } catch (std::bad_alloc &) {
+        ndi_sai_qos_map_api(ndi_db_ptr)->remove_qos_map(ndi2sai_qos_map_id(*ndi_map_id));
+        return STD_ERR(QOS, NOMEM, 0);
+    }
+
+    return STD_ERR_OK;
+}
 
 /**
  * This function creates a map ID in the NPU.
@@ -160,24 +386,159 @@ t_std_error ndi_qos_create_map(npu_id_t npu_id,
                                 const ndi_qos_map_struct_t *map_entry,
                                 ndi_obj_id_t *ndi_map_id)
 {
-    sai_status_t sai_ret = SAI_STATUS_FAILURE;
-    uint_t attr_count = 1;  // map-type only
-    sai_attribute_t attr_list[2];
+    return _ndi_qos_create_map(npu_id, type, map_entry_count, map_entry,
+                               false, ndi_map_id);
+}
 
-    if (map_entry_count > 0)
-        attr_count = 2; // Plus map-list
+/**
+ * This function creates a map that may be shared. If a shareable map of the
+ * same type and entries, in any order, exists on the npu its id is returned
+ * and its reference count raised instead. Maps created without entries are
+ * never shared.
+ * @param npu_id npu id
+ * @param type of qos map
+ * @param map_entry_count number of entries in map_entry
+ * @param map_entry key-to-value mappings
+ * @param[out] ndi_map_id
+ * @return standard error
+ */
+t_std_error ndi_qos_create_shared_map(npu_id_t npu_id,
+                                      ndi_qos_map_type_t type,
+                                      uint_t map_entry_count,
+                                      const ndi_qos_map_struct_t *map_entry,
+                                      ndi_obj_id_t *ndi_map_id)
+{
+    return _ndi_qos_create_map(npu_id, type, map_entry_count, map_entry,
+                               true, ndi_map_id);
+}
+
+/*  The map of the caller is shared: create a private copy holding merged,
+ *  or join a shareable map that holds it already, and move the reference
+ *  of the caller there. The other users keep the old map.
+ */
+static t_std_error _ndi_qos_map_copy_on_write(nas_ndi_db_t *ndi_db_ptr,
+                                              npu_id_t npu_id,
+                                              ndi_obj_id_t *ndi_map_id,
+                                              ndi_qos_map_ref_t &ref,
+                                              ndi_qos_map_shadow_t &merged,
+                                              uint_t *entries_sent)
+{
+    std::vector<ndi_qos_map_struct_t> all;
+    ndi_qos_map_content_t content;
+    try {
+        _ndi_qos_map_content(npu_id, ref.type, merged, content);
+        all.reserve(merged.size());
+        for (auto &e: merged) {
+            all.push_back(e.second);
+        }
+    } catch (std::bad_alloc &) {
+        return STD_ERR(QOS, NOMEM, 0);
+    }
+
+    auto shared = g_qos_map_by_content.find(content);
+    if (shared != g_qos_map_by_content.end()) {
+        ref.ref_count--;
+        g_qos_map_refs.at(ndi_qos_map_key_t(npu_id, shared->second)).ref_count++;
+        *ndi_map_id = shared->second;
+        *entries_sent = 0;
+        return STD_ERR_OK;
+    }
+
+    ndi_obj_id_t copy_id;
+    t_std_error rc = _ndi_qos_map_sai_create(ndi_db_ptr, npu_id, ref.type,
+                                             all.size(), all.size() ? &all[0] : NULL,
+                                             &copy_id);
+    if (rc != STD_ERR_OK)
+        return rc;
 
     try {
+        ndi_qos_map_ref_t &copy = g_qos_map_refs[ndi_qos_map_key_t(npu_id, copy_id)];
+        copy.ref_count = 1;
+        copy.type = ref.type;
+        copy.shareable = true;
+        copy.indexed = false;
+        copy.shadow.swap(merged);
+        _ndi_qos_map_index(npu_id, copy_id, copy);
+    } catch (std::bad_alloc &) {
+        ndi_sai_qos_map_api(ndi_db_ptr)->remove_qos_map(ndi2sai_qos_map_id(copy_id));
+        return STD_ERR(QOS, NOMEM, 0);
+    }
 
-        attr_list[0].id = SAI_QOS_MAP_ATTR_TYPE;
-        attr_list[0].value.s32 = NDI_2_SAI_QOS_MAP_TYPE.at(type);
+    EV_LOGGING(NDI, DEBUG, "NDI-QOS",
+                  "npu_id %d map 0x%" PRIx64 " copied to 0x%" PRIx64 " on write\n",
+                  npu_id, *ndi_map_id, copy_id);
+    ref.ref_count--;
+    *ndi_map_id = copy_id;
+    *entries_sent = all.size();
+    return STD_ERR_OK;
+}
 
+/*  Write entries to a map, merged is what the map holds afterwards. A
+ *  shared map is copied on write, the entries are set on a private one.
+ *  The content index follows the map only once SAI took the change.
+ */
+static t_std_error _ndi_qos_map_write(nas_ndi_db_t *ndi_db_ptr,
+                                      npu_id_t npu_id,
+                                      ndi_obj_id_t *ndi_map_id,
+                                      uint_t map_entry_count,
+                                      const ndi_qos_map_struct_t *map_entry,
+                                      ndi_qos_map_shadow_t &merged,
+                                      uint_t *entries_sent)
+{
+    sai_status_t sai_ret = SAI_STATUS_FAILURE;
+
+    auto ref = g_qos_map_refs.find(ndi_qos_map_key_t(npu_id, *ndi_map_id));
+    if (ref != g_qos_map_refs.end() && ref->second.ref_count > 1)
+        return _ndi_qos_map_copy_on_write(ndi_db_ptr, npu_id, ndi_map_id,
+                                          ref->second, merged, entries_sent);
+
+    std::vector<sai_qos_map_t> entry_list;
+    try {
+        entry_list.resize(map_entry_count);
+    } catch (std::bad_alloc &) {
+        return STD_ERR(QOS, NOMEM, 0);
     }
-    catch (...) {
+    _fill_sai_request_map_entries(&entry_list[0], map_entry_count, map_entry);
+
+    sai_attribute_t sai_attr;
+    sai_attr.id = SAI_QOS_MAP_ATTR_MAP_TO_VALUE_LIST;
+    sai_attr.value.qosmap.count = map_entry_count;
+    sai_attr.value.qosmap.list = &entry_list[0];
+
+    if ((sai_ret = ndi_sai_qos_map_api(ndi_db_ptr)->
+                        set_qos_map_attribute(ndi2sai_qos_map_id(*ndi_map_id), &sai_attr))
+                         != SAI_STATUS_SUCCESS) {
         EV_LOGGING(NDI, NOTICE, "NDI-QOS",
-                    "Unexpected error.\n", npu_id);
-        return STD_ERR(QOS, CFG, 0);
+                      "npu_id %d map 0x%" PRIx64 " set failed\n", npu_id, *ndi_map_id);
+        return STD_ERR(QOS, CFG, sai_ret);
     }
+    *entries_sent = map_entry_count;
+
+    if (ref != g_qos_map_refs.end()) {
+        // the content changed, offer the map under its new content
+        _ndi_qos_map_unindex(ref->second);
+        ref->second.shadow.swap(merged);
+        _ndi_qos_map_index(npu_id, *ndi_map_id, ref->second);
+    }
+    return STD_ERR_OK;
+}
+
+/**
+ * This function sets key-to-value mappings of a map. A shared map is
+ * copied first, see ndi_qos_map_set_entries.
+ * @param npu_id npu id
+ * @param[in,out] ndi_map_id replaced by the id of the copy
+ * @param map_entry_count number of entries in map_entry
+ * @param map_entry key-to-value mappings
+ * @return standard error
+ */
+t_std_error ndi_qos_map_set_entries(npu_id_t npu_id,
+                                    ndi_obj_id_t *ndi_map_id,
+                                    uint_t map_entry_count,
+                                    const ndi_qos_map_struct_t *map_entry)
+{
+    if (map_entry_count == 0)
+        return STD_ERR(QOS, CFG, 0);
 
     nas_ndi_db_t *ndi_db_ptr = ndi_db_ptr_get(npu_id);
     if (ndi_db_ptr == NULL) {
@@ -186,20 +547,22 @@ t_std_error ndi_qos_create_map(npu_id_t npu_id,
         return STD_ERR(QOS, CFG, 0);
     }
 
-    sai_object_id_t sai_qos_map_id;
-    if ((sai_ret = ndi_sai_qos_map_api(ndi_db_ptr)->
-                        create_qos_map(&sai_qos_map_id,
-                                attr_count,
-                                attr_list))
-                         != SAI_STATUS_SUCCESS) {
-        EV_LOGGING(NDI, NOTICE, "NDI-QOS",
-                      "npu_id %d map creation failed\n", npu_id);
-        return STD_ERR(QOS, CFG, sai_ret);
-    }
-    *ndi_map_id = sai2ndi_qos_map_id(sai_qos_map_id);
+    std_mutex_simple_lock_guard g(&qos_map_lock);
 
-    return STD_ERR_OK;
+    ndi_qos_map_shadow_t merged;
+    auto ref = g_qos_map_refs.find(ndi_qos_map_key_t(npu_id, *ndi_map_id));
+    try {
+        // without partial updates a set replaces all entries of the map
+        if (ref != g_qos_map_refs.end() && g_qos_map_npu[npu_id].partial_update)
+            merged = ref->second.shadow;
+        _ndi_qos_map_shadow_merge(merged, map_entry_count, map_entry);
+    } catch (std::bad_alloc &) {
+        return STD_ERR(QOS, NOMEM, 0);
+    }
 
+    uint_t entries_sent;
+    return _ndi_qos_map_write(ndi_db_ptr, npu_id, ndi_map_id,
+                              map_entry_count, map_entry, merged, &entries_sent);
 }
 
  /**
@@ -209,25 +572,43 @@ t_std_error ndi_qos_create_map(npu_id_t npu_id,
   * @param number of map entries
   * @param key-to-value mapping
   * @return standard error
+  *
+  * A map from ndi_qos_create_shared_map may be shared, it is changed through
+  * ndi_qos_map_set_entries, which hands out the id of the private copy.
   */
 t_std_error ndi_qos_set_map_attr(npu_id_t npu_id,
                      ndi_obj_id_t ndi_map_id,
                      uint_t map_entry_count,
                      const ndi_qos_map_struct_t *map_entry)
 {
-    sai_status_t sai_ret = SAI_STATUS_FAILURE;
-    sai_attribute_t attr_list[1];
-    std::vector<sai_qos_map_t> entry_list(map_entry_count);
+    std_mutex_simple_lock_guard g(&qos_map_lock);
 
-    if (map_entry_count == 0)
+    auto ref = g_qos_map_refs.find(ndi_qos_map_key_t(npu_id, ndi_map_id));
+    if (ref != g_qos_map_refs.end() && ref->second.ref_count > 1) {
+        EV_LOGGING(NDI, NOTICE, "NDI-QOS",
+                      "npu_id %d map 0x%" PRIx64 " is shared, set it through ndi_qos_map_set_entries\n",
+                      npu_id, ndi_map_id);
         return STD_ERR(QOS, CFG, 0);
+    }
+    return ndi_qos_map_set_entries(npu_id, &ndi_map_id, map_entry_count, map_entry);
+}
 
-    _fill_sai_request_map_entries(&entry_list[0], map_entry_count, map_entry);
-
-    attr_list[0].id = SAI_QOS_MAP_ATTR_MAP_TO_VALUE_LIST;
-    attr_list[0].value.qosmap.count = map_entry_count;
-    attr_list[0].value.qosmap.list = &entry_list[0];
-
+/**
+ * This function merges changed entries into a map, sending SAI only what
+ * changed when the npu supports partial map updates, the whole merged map
+ * otherwise. Nothing is sent if no entry changed. A shared map is copied
+ * first, see ndi_qos_map_set_entries.
+ * @param npu_id npu id
+ * @param[in,out] ndi_map_id replaced by the id of the copy
+ * @param map_entry_count number of entries in map_entry
+ * @param map_entry new or changed key-to-value mappings
+ * @return standard error
+ */
+t_std_error ndi_qos_map_update_entries(npu_id_t npu_id,
+                                       ndi_obj_id_t *ndi_map_id,
+                                       uint_t map_entry_count,
+                                       const ndi_qos_map_struct_t *map_entry)
+{
     nas_ndi_db_t *ndi_db_ptr = ndi_db_ptr_get(npu_id);
     if (ndi_db_ptr == NULL) {
         EV_LOGGING(NDI, DEBUG, "NDI-QOS",
@@ -235,22 +616,108 @@ t_std_error ndi_qos_set_map_attr(npu_id_t npu_id,
         return STD_ERR(QOS, CFG, 0);
     }
 
-    sai_object_id_t sai_qos_map_id = ndi2sai_qos_map_id(ndi_map_id);
-    if ((sai_ret = ndi_sai_qos_map_api(ndi_db_ptr)->
-                        set_qos_map_attribute(sai_qos_map_id, attr_list))
-                         != SAI_STATUS_SUCCESS) {
+    std_mutex_simple_lock_guard g(&qos_map_lock);
+
+    auto ref = g_qos_map_refs.find(ndi_qos_map_key_t(npu_id, *ndi_map_id));
+    if (ref == g_qos_map_refs.end()) {
         EV_LOGGING(NDI, NOTICE, "NDI-QOS",
-                      "npu_id %d map set failed\n", npu_id);
-        return STD_ERR(QOS, CFG, sai_ret);
+                      "npu_id %d map 0x%" PRIx64 " not known\n", npu_id, *ndi_map_id);
+        return STD_ERR(QOS, PARAM, 0);
     }
 
+    std::vector<ndi_qos_map_struct_t> changed;
+    std::vector<ndi_qos_map_struct_t> all;
+    ndi_qos_map_shadow_t merged;
+    ndi_qos_map_npu_t *npu_ptr;
+    try {
+        npu_ptr = &g_qos_map_npu[npu_id];
+        npu_ptr->stats.updates++;
+        merged = ref->second.shadow;
+        for (uint_t i = 0; i < map_entry_count; i++) {
+            auto key = _ndi_qos_map_params_key(map_entry[i].key);
+            auto cur = merged.find(key);
+            if (cur != merged.end() &&
+                _ndi_qos_map_params_key(cur->second.value) == _ndi_qos_map_params_key(map_entry[i].value))
+                continue;
+            merged[key] = map_entry[i];
+            changed.push_back(map_entry[i]);
+        }
+        if (!npu_ptr->partial_update && changed.size() > 0) {
+            all.reserve(merged.size());
+            for (auto &e: merged) {
+                all.push_back(e.second);
+            }
+        }
+    } catch (std::bad_alloc &) {
+        return STD_ERR(QOS, NOMEM, 0);
+    }
+    ndi_qos_map_npu_t &npu = *npu_ptr;
+
+    // what rewriting the whole map would have sent
+    uint64_t full_bytes = merged.size() * sizeof(sai_qos_map_t);
+
+    if (changed.size() == 0) {
+        npu.stats.bytes_avoided += full_bytes;
+        return STD_ERR_OK;
+    }
+
+    const std::vector<ndi_qos_map_struct_t> &send = npu.partial_update ? changed : all;
+    uint_t entries_sent = 0;
+
+    npu.stats.sai_calls++;
+    t_std_error rc = _ndi_qos_map_write(ndi_db_ptr, npu_id, ndi_map_id,
+                                        send.size(), &send[0], merged, &entries_sent);
+    if (rc != STD_ERR_OK)
+        return rc;
+
+    uint64_t sent_bytes = entries_sent * sizeof(sai_qos_map_t);
+    npu.stats.entries_sent += entries_sent;
+    npu.stats.bytes_sent += sent_bytes;
+    if (full_bytes > sent_bytes)
+        npu.stats.bytes_avoided += full_bytes - sent_bytes;
+
     return STD_ERR_OK;
+}
 
+/**
+ * This function sets whether the SAI of a npu merges the entries of a
+ * map set into the map, rather than replacing all of them.
+ * @param npu_id npu id
+ * @param partial_update true if the SAI merges
+ * @return standard error
+ */
+t_std_error ndi_qos_map_partial_update_set(npu_id_t npu_id, bool partial_update)
+{
+    if (ndi_db_ptr_get(npu_id) == NULL)
+        return STD_ERR(QOS, PARAM, 0);
+
+    std_mutex_simple_lock_guard g(&qos_map_lock);
+    try {
+        g_qos_map_npu[npu_id].partial_update = partial_update;
+    } catch (std::bad_alloc &) {
+        return STD_ERR(QOS, NOMEM, 0);
+    }
+    return STD_ERR_OK;
+}
+
+t_std_error ndi_qos_map_update_stats_get(npu_id_t npu_id, ndi_qos_map_update_stats_t *stats)
+{
+    if (ndi_db_ptr_get(npu_id) == NULL)
+        return STD_ERR(QOS, PARAM, 0);
+
+    std_mutex_simple_lock_guard g(&qos_map_lock);
+    auto npu = g_qos_map_npu.find(npu_id);
+    if (npu == g_qos_map_npu.end())
+        *stats = ndi_qos_map_update_stats_t();
+    else
+        *stats = npu->second.stats;
+    return STD_ERR_OK;
 }
 
 
 /**
- * This function deletes a map in the NPU.
+ * This function deletes a map in the NPU. A shared map loses one
+ * reference, the SAI map is removed with the last one.
  * @param npu_id npu id
  * @param ndi_map_id
  * @return standard error
@@ -266,6 +733,14 @@ t_std_error ndi_qos_delete_map(npu_id_t npu_id,
         return STD_ERR(QOS, CFG, 0);
     }
 
+    std_mutex_simple_lock_guard g(&qos_map_lock);
+
+    auto ref = g_qos_map_refs.find(ndi_qos_map_key_t(npu_id, ndi_map_id));
+    if (ref != g_qos_map_refs.end() && ref->second.ref_count > 1) {
+        ref->second.ref_count--;
+        return STD_ERR_OK;
+    }
+
     sai_object_id_t sai_qos_map_id = ndi2sai_qos_map_id(ndi_map_id);
     if ((sai_ret = ndi_sai_qos_map_api(ndi_db_ptr)->
                         remove_qos_map(sai_qos_map_id))
@@ -273,6 +748,11 @@ t_std_error ndi_qos_delete_map(npu_id_t npu_id,
         return STD_ERR(QOS, CFG, sai_ret);
     }
 
+    if (ref != g_qos_map_refs.end()) {
+        _ndi_qos_map_unindex(ref->second);
+        g_qos_map_refs.erase(ref);
+    }
+
     return STD_ERR_OK;
 
 }
@@ -331,8 +811,16 @@ t_std_error ndi_qos_get_map(npu_id_t npu_id,
     }
 
     // fill the outgoing parameters
-    if (type != NULL)
-        *type = SAI_2_NDI_QOS_MAP_TYPE[(sai_qos_map_type_t)(attr_list[0].value.s32)];
+    if (type != NULL) {
+        auto it = SAI_2_NDI_QOS_MAP_TYPE.find((sai_qos_map_type_t)(attr_list[0].value.s32));
+        if (it == SAI_2_NDI_QOS_MAP_TYPE.end()) {
+            EV_LOGGING(NDI, NOTICE, "NDI-QOS",
+                          "npu_id %d unknown SAI map type %d\n",
+                          npu_id, attr_list[0].value.s32);
+            return STD_ERR(QOS, CFG, 0);
+        }
+        *type = it->second;
+    }
 
     _fill_ndi_response_map_entries(&entry_list[0], map_entry_count, map_entry);
 
@@ -341,3 +829,23 @@ t_std_error ndi_qos_get_map(npu_id_t npu_id,
 
 }
 
+/**
+ * This function returns the number of users of a map.
+ * @param npu_id npu id
+ * @param ndi_map_id
+ * @param[out] ref_count 1 for a map that isn't shared
+ * @return standard error, fails for a map not created through NDI
+ */
+t_std_error ndi_qos_map_ref_count_get(npu_id_t npu_id,
+                                      ndi_obj_id_t ndi_map_id,
+                                      uint_t *ref_count)
+{
+    std_mutex_simple_lock_guard g(&qos_map_lock);
+
+    auto ref = g_qos_map_refs.find(ndi_qos_map_key_t(npu_id, ndi_map_id));
+    if (ref == g_qos_map_refs.end())
+        return STD_ERR(QOS, PARAM, 0);
+
+    *ref_count = ref->second.ref_count;
+    return STD_ERR_OK;
+}
@@ -26,8 +26,14 @@
 #include "nas_ndi_event_logs.h"
 #include "nas_ndi_qos.h"
 #include "nas_ndi_qos_utl.h"
+#include "nas_ndi_stat_baseline.h"
+#include "std_mutex_lock.h"
+#include <string.h>
+#include <algorithm>
+#include <new>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 
 static t_std_error ndi_qos_utl_fill_policer_attr (sai_attribute_t *sai_attr_p,
                                          BASE_QOS_METER_t attr_id,
@@ -36,11 +42,15 @@ static t_std_error ndi_qos_utl_fill_policer_attr (sai_attribute_t *sai_attr_p,
 static t_std_error ndi_qos_fill_policer_attr_list(const nas_attr_id_t *nas_attr_list,
                                     uint_t num_attr,
                                     const qos_policer_struct_t *p,
-                                    std::vector<sai_attribute_t> &attr_list);
+                                    sai_attribute_t *attr_list,
+                                    uint_t &count);
 
-static void ndi_qos_utl_fill_policer_info(const std::vector<sai_attribute_t> attr_list,
+static void ndi_qos_utl_fill_policer_info(const sai_attribute_t *attr_list,
+                                        uint_t count,
                                         qos_policer_struct_t *p);
 
+static void ndi_qos_policer_last_read_delete(npu_id_t npu_id, ndi_obj_id_t ndi_policer_id);
+
 
 typedef void (*fill_sai_policer_fn) (sai_attribute_t* s,
                                      const qos_policer_struct_t* p);
@@ -67,44 +77,31 @@ static void _fill_sai_meter_peak_rate(sai_attribute_t *sai_attr_p,
 static void _fill_sai_meter_stat_list(sai_attribute_t *sai_attr_p,
                                  const qos_policer_struct_t* p);
 
-static const
-    std::unordered_map<BASE_QOS_METER_t, fill_sai_policer_fn, std::hash<int>>
-    _fill_sai_policer_fn_map = {
-        {BASE_QOS_METER_TYPE,                    _fill_sai_meter_type},
-        {BASE_QOS_METER_MODE,                    _fill_sai_meter_mode},
-        {BASE_QOS_METER_COLOR_SOURCE,            _fill_sai_meter_color_source},
-        {BASE_QOS_METER_GREEN_PACKET_ACTION,     _fill_sai_meter_green_packet_action},
-        {BASE_QOS_METER_YELLOW_PACKET_ACTION,    _fill_sai_meter_yellow_packet_action},
-        {BASE_QOS_METER_RED_PACKET_ACTION,       _fill_sai_meter_red_packet_action},
-        {BASE_QOS_METER_COMMITTED_BURST,         _fill_sai_meter_commited_burst},
-        {BASE_QOS_METER_COMMITTED_RATE,          _fill_sai_meter_commited_rate},
-        {BASE_QOS_METER_PEAK_BURST,              _fill_sai_meter_peak_burst},
-        {BASE_QOS_METER_PEAK_RATE,               _fill_sai_meter_peak_rate},
-        {BASE_QOS_METER_STAT_LIST,               _fill_sai_meter_stat_list},
+typedef struct _ndi_qos_policer_attr_t {
+    nas_attr_id_t       nas_id;
+    sai_policer_attr_t  sai_id;
+    fill_sai_policer_fn fill;
+} ndi_qos_policer_attr_t;
+
+static const ndi_qos_policer_attr_t ndi_qos_policer_attr_list[] = {
+        {BASE_QOS_METER_TYPE,                 SAI_POLICER_ATTR_METER_TYPE,           _fill_sai_meter_type},
+        {BASE_QOS_METER_MODE,                 SAI_POLICER_ATTR_MODE,                 _fill_sai_meter_mode},
+        {BASE_QOS_METER_COLOR_SOURCE,         SAI_POLICER_ATTR_COLOR_SOURCE,         _fill_sai_meter_color_source},
+        {BASE_QOS_METER_GREEN_PACKET_ACTION,  SAI_POLICER_ATTR_GREEN_PACKET_ACTION,  _fill_sai_meter_green_packet_action},
+        {BASE_QOS_METER_YELLOW_PACKET_ACTION, SAI_POLICER_ATTR_YELLOW_PACKET_ACTION, _fill_sai_meter_yellow_packet_action},
+        {BASE_QOS_METER_RED_PACKET_ACTION,    SAI_POLICER_ATTR_RED_PACKET_ACTION,    _fill_sai_meter_red_packet_action},
+        {BASE_QOS_METER_COMMITTED_BURST,      SAI_POLICER_ATTR_CBS,                  _fill_sai_meter_commited_burst},
+        {BASE_QOS_METER_COMMITTED_RATE,       SAI_POLICER_ATTR_CIR,                  _fill_sai_meter_commited_rate},
+        {BASE_QOS_METER_PEAK_BURST,           SAI_POLICER_ATTR_PBS,                  _fill_sai_meter_peak_burst},
+        {BASE_QOS_METER_PEAK_RATE,            SAI_POLICER_ATTR_PIR,                  _fill_sai_meter_peak_rate},
+        {BASE_QOS_METER_STAT_LIST,            SAI_POLICER_ATTR_ENABLE_COUNTER_LIST,  _fill_sai_meter_stat_list},
     };
 
+static const ndi_qos_attr_tbl<ndi_qos_policer_attr_t>
+    ndi_qos_policer_attr_tbl(ndi_qos_policer_attr_list);
 
-static const
-    std::unordered_map<BASE_QOS_METER_t, sai_policer_attr_t, std::hash<int>>
-        _nas2sai_policer_attr_id_map = {
-        {BASE_QOS_METER_TYPE,                    SAI_POLICER_ATTR_METER_TYPE},
-        {BASE_QOS_METER_MODE,                    SAI_POLICER_ATTR_MODE},
-        {BASE_QOS_METER_COLOR_SOURCE,            SAI_POLICER_ATTR_COLOR_SOURCE},
-        {BASE_QOS_METER_GREEN_PACKET_ACTION,     SAI_POLICER_ATTR_GREEN_PACKET_ACTION},
-        {BASE_QOS_METER_YELLOW_PACKET_ACTION,    SAI_POLICER_ATTR_YELLOW_PACKET_ACTION},
-        {BASE_QOS_METER_RED_PACKET_ACTION,       SAI_POLICER_ATTR_RED_PACKET_ACTION},
-        {BASE_QOS_METER_COMMITTED_BURST,         SAI_POLICER_ATTR_CBS},
-        {BASE_QOS_METER_COMMITTED_RATE,          SAI_POLICER_ATTR_CIR},
-        {BASE_QOS_METER_PEAK_BURST,              SAI_POLICER_ATTR_PBS},
-        {BASE_QOS_METER_PEAK_RATE,               SAI_POLICER_ATTR_PIR},
-        {BASE_QOS_METER_STAT_LIST,               SAI_POLICER_ATTR_ENABLE_COUNTER_LIST},
-       };
-
-static sai_policer_attr_t   ndi_qos_utl_ndi2sai_policer_attr_id (
-                                    BASE_QOS_METER_t ndi_policer_attr_id)
-{
-    return _nas2sai_policer_attr_id_map.at(ndi_policer_attr_id);
-}
+/*  Most SAI attributes a policer create or get can carry */
+#define NDI_QOS_POLICER_ATTR_MAX    NDI_QOS_TBL_SIZE(ndi_qos_policer_attr_list)
 
 static void _fill_sai_meter_type(sai_attribute_t *sai_attr_p,
                                  const qos_policer_struct_t* p)
@@ -235,21 +232,16 @@ static t_std_error ndi_qos_utl_fill_policer_attr (sai_attribute_t *sai_attr_p,
                                          BASE_QOS_METER_t attr_id,
                                          const qos_policer_struct_t * p)
 {
-    try {
-
-        sai_attr_p->id = ndi_qos_utl_ndi2sai_policer_attr_id(attr_id);
-
-        // value
-        auto fn_set_policer = _fill_sai_policer_fn_map.at (attr_id);
-        fn_set_policer (sai_attr_p, p);
-
-    } catch (std::out_of_range e) {
+    const ndi_qos_policer_attr_t *entry = ndi_qos_policer_attr_tbl.find(attr_id);
+    if (entry == NULL) {
         EV_LOGGING(NDI, NOTICE, "NDI-QOS",
-                      "Invalid Policer attr_id %d or value parameter %s",
-                      attr_id, e.what());
+                      "Invalid Policer attr_id %d", attr_id);
         return STD_ERR(QOS, PARAM, 0);
     }
 
+    sai_attr_p->id = entry->sai_id;
+    entry->fill(sai_attr_p, p);
+
     return STD_ERR_OK;
 }
 
@@ -268,10 +260,12 @@ static const std::unordered_map<sai_policer_stat_counter_t, BASE_QOS_POLICER_STA
     };
 
 
-static void ndi_qos_utl_fill_policer_info(const std::vector<sai_attribute_t> attr_list,
+static void ndi_qos_utl_fill_policer_info(const sai_attribute_t *attr_list,
+                                        uint_t count,
                                         qos_policer_struct_t *p)
 {
-    for (auto attr: attr_list) {
+    for (uint_t i = 0; i < count; i++) {
+        const sai_attribute_t &attr = attr_list[i];
         switch (attr.id) {
         case SAI_POLICER_ATTR_METER_TYPE:
             p->meter_type = (attr.value.s32 == SAI_METER_TYPE_BYTES?
@@ -343,23 +337,27 @@ static void ndi_qos_utl_fill_policer_info(const std::vector<sai_attribute_t> att
 static t_std_error ndi_qos_fill_policer_attr_list(const nas_attr_id_t *nas_attr_list,
                                     uint_t num_attr,
                                     const qos_policer_struct_t *p,
-                                    std::vector<sai_attribute_t> &attr_list)
+                                    sai_attribute_t *attr_list,
+                                    uint_t &count)
 {
-    sai_attribute_t sai_attr = {0};
     t_std_error      rc = STD_ERR_OK;
 
+    count = 0;
     for (uint_t i = 0; i < num_attr; i++) {
         if (nas_attr_list[i] == BASE_QOS_METER_SWITCH_ID ||
             nas_attr_list[i] == BASE_QOS_METER_ID ||
             nas_attr_list[i] == BASE_QOS_METER_NPU_ID_LIST)
             continue; // these attributes are not interpreted at ndi level
 
-        rc = ndi_qos_utl_fill_policer_attr(&sai_attr, (BASE_QOS_METER_t)nas_attr_list[i], p);
+        if (count >= NDI_QOS_POLICER_ATTR_MAX)
+            return STD_ERR(QOS, PARAM, 0);
+
+        rc = ndi_qos_utl_fill_policer_attr(&attr_list[count],
+                                           (BASE_QOS_METER_t)nas_attr_list[i], p);
         if (rc != STD_ERR_OK)
             return rc;
 
-        attr_list.push_back(sai_attr);
-
+        count++;
     }
 
     return rc;
@@ -394,11 +392,12 @@ t_std_error ndi_qos_set_policer_attr(npu_id_t npu_id,
     }
 
     sai_attribute_t sai_attr = {0};
-    std::vector<int32_t> list;
+    int32_t list[BASE_QOS_POLICER_STAT_TYPE_MAX];
     if (attr_id == BASE_QOS_METER_STAT_LIST) {
-        list.resize(p->stat_list_count);
+        if (p->stat_list_count > BASE_QOS_POLICER_STAT_TYPE_MAX)
+            return STD_ERR(QOS, CFG, 0);
         sai_attr.value.s32list.count = p->stat_list_count;
-        sai_attr.value.s32list.list = &list[0];
+        sai_attr.value.s32list.list = list;
     }
     if (ndi_qos_utl_fill_policer_attr(&sai_attr, attr_id, p) != STD_ERR_OK)
         return STD_ERR(QOS, CFG, 0);
@@ -435,7 +434,9 @@ t_std_error ndi_qos_create_policer(npu_id_t npu_id,
     t_std_error ret_code = STD_ERR_OK;
     sai_status_t sai_ret = SAI_STATUS_FAILURE;
 
-    std::vector<sai_attribute_t>  sai_policer_attr_list;
+    sai_attribute_t sai_policer_attr_list[NDI_QOS_POLICER_ATTR_MAX];
+    int32_t list[BASE_QOS_POLICER_STAT_TYPE_MAX];
+    uint_t attr_count = 0;
 
     nas_ndi_db_t *ndi_db_ptr = ndi_db_ptr_get(npu_id);
     if (ndi_db_ptr == NULL) {
@@ -444,32 +445,35 @@ t_std_error ndi_qos_create_policer(npu_id_t npu_id,
         return STD_ERR(QOS, CFG, 0);
     }
 
-    sai_attribute_t sai_attr = {0};
-    std::vector<int32_t> list;
     for (uint_t i=0; i< num_attr; i++ ) {
         if (nas_attr_list[i] == BASE_QOS_METER_SWITCH_ID ||
             nas_attr_list[i] == BASE_QOS_METER_ID ||
             nas_attr_list[i] == BASE_QOS_METER_NPU_ID_LIST)
             continue; // these attributes are not interpreted at ndi level
 
+        if (attr_count >= NDI_QOS_POLICER_ATTR_MAX)
+            return STD_ERR(QOS, CFG, 0);
+
+        sai_attribute_t &sai_attr = sai_policer_attr_list[attr_count];
         if (nas_attr_list[i] == BASE_QOS_METER_STAT_LIST) {
-            list.resize(p->stat_list_count);
+            if (p->stat_list_count > BASE_QOS_POLICER_STAT_TYPE_MAX)
+                return STD_ERR(QOS, CFG, 0);
             sai_attr.value.s32list.count = p->stat_list_count;
-            sai_attr.value.s32list.list = &list[0];
+            sai_attr.value.s32list.list = list;
         }
 
         if (ndi_qos_utl_fill_policer_attr(&sai_attr, (BASE_QOS_METER_t)nas_attr_list[i], p)
                 != STD_ERR_OK)
             return STD_ERR(QOS, CFG, 0);
 
-        sai_policer_attr_list.push_back(sai_attr);
+        attr_count++;
     }
 
     sai_object_id_t sai_policer_id;
     if ((sai_ret = ndi_sai_qos_policer_api(ndi_db_ptr)->
                     create_policer(&sai_policer_id,
-                                sai_policer_attr_list.size(),
-                                &sai_policer_attr_list[0]))
+                                attr_count,
+                                sai_policer_attr_list))
                          != SAI_STATUS_SUCCESS) {
         return STD_ERR(QOS, CFG, sai_ret);
     }
@@ -500,6 +504,9 @@ t_std_error ndi_qos_delete_policer(npu_id_t npu_id, ndi_obj_id_t ndi_policer_id)
         return STD_ERR(QOS, CFG, sai_ret);
     }
 
+    ndi_stat_baseline_object_delete(NDI_STAT_OBJ_POLICER, npu_id, ndi_policer_id);
+    ndi_qos_policer_last_read_delete(npu_id, ndi_policer_id);
+
     return ret_code;
 }
 
@@ -519,24 +526,28 @@ t_std_error ndi_qos_get_policer(npu_id_t npu_id,
                                 qos_policer_struct_t *p)
 {
     sai_status_t sai_ret = SAI_STATUS_FAILURE;
-    std::vector<sai_attribute_t> attr_list;
+    sai_attribute_t attr_list[NDI_QOS_POLICER_ATTR_MAX];
+    uint_t attr_count = 0;
     qos_policer_struct_t dummy;
 
+    // no values are filled for a get, an empty stat list reads none
+    memset(&dummy, 0, sizeof(dummy));
+
     // Fill the attribute flags
-    ndi_qos_fill_policer_attr_list(nas_attr_list, num_attr, &dummy, attr_list);
+    ndi_qos_fill_policer_attr_list(nas_attr_list, num_attr, &dummy, attr_list, attr_count);
 
     nas_ndi_db_t *ndi_db_ptr = ndi_db_ptr_get(npu_id);
     STD_ASSERT(ndi_db_ptr != NULL);
 
     if ((sai_ret = ndi_sai_qos_policer_api(ndi_db_ptr)->
                     get_policer_attribute(ndi2sai_policer_id(ndi_policer_id),
-                            attr_list.size(), &attr_list[0]))
+                            attr_count, attr_list))
             != SAI_STATUS_SUCCESS) {
         return STD_ERR(QOS, CFG, sai_ret);
     }
 
     //convert attr_list[] to qos_policer_struct_t
-    ndi_qos_utl_fill_policer_info(attr_list, p);
+    ndi_qos_utl_fill_policer_info(attr_list, attr_count, p);
 
     return STD_ERR_OK;
 }
@@ -601,6 +612,10 @@ t_std_error ndi_qos_get_policer_stat(npu_id_t npu_id,
         return STD_ERR(QOS, CFG, sai_ret);
     }
 
+    std::vector<uint64_t> stat_ids(stat_list, stat_list + stat_list_count);
+    ndi_stat_baseline_apply(NDI_STAT_OBJ_POLICER, npu_id, ndi_policer_id,
+                            &stat_ids[0], &counters[0], stat_list_count);
+
     /* copy out SAI-returned value  */
     for (uint_t i = 0; i<stat_list_count; i++) {
         switch (counter_ids[i]) {
@@ -637,4 +652,257 @@ t_std_error ndi_qos_get_policer_stat(npu_id_t npu_id,
     return STD_ERR_OK;
 }
 
+/**
+ * This function clears policer statistics. The current counter values
+ * become the new zero, the hardware counters are not cleared.
+ * @param npu_id npu id
+ * @param ndi_policer_id
+ * @param stat_list_count number of statistics types to clear
+ * @param *stat_list list of statistics types to clear
+ * @return standard error
+ */
+t_std_error ndi_qos_clear_policer_stat(npu_id_t npu_id,
+                                ndi_obj_id_t ndi_policer_id,
+                                uint_t     stat_list_count,
+                                const BASE_QOS_POLICER_STAT_TYPE_t * stat_list)
+{
+    if (stat_list_count > BASE_QOS_POLICER_STAT_TYPE_MAX) {
+        EV_LOGGING(NDI, NOTICE, "NDI-QOS",
+                      "sai_id: %d, ndi_policer_id %u, too many statistics types!\n",
+                      npu_id, ndi_policer_id);
+        return STD_ERR(QOS, CFG, 0);
+    }
+
+    sai_status_t sai_ret = SAI_STATUS_FAILURE;
+    std::vector<sai_policer_stat_counter_t> counter_ids(stat_list_count);
+    std::vector<uint64_t> counters(stat_list_count);
+
+    try {
+        for (uint_t i = 0; i< stat_list_count; i++) {
+            counter_ids[i] = ndi2sai_policer_stat_type.at(stat_list[i]);
+        }
+    }
+    catch (...) {
+        EV_LOGGING(NDI, NOTICE, "NDI-QOS",
+                      "Unknown statistics types!\n");
+        return STD_ERR(QOS, CFG, 0);
+    }
+
+    nas_ndi_db_t *ndi_db_ptr = ndi_db_ptr_get(npu_id);
+    STD_ASSERT(ndi_db_ptr != NULL);
+
+    if ((sai_ret = ndi_sai_qos_policer_api(ndi_db_ptr)->
+                    get_policer_statistics(ndi2sai_policer_id(ndi_policer_id),
+                            &counter_ids[0], stat_list_count,
+                            &counters[0]))
+            != SAI_STATUS_SUCCESS) {
+        return STD_ERR(QOS, CFG, sai_ret);
+    }
+
+    std::vector<uint64_t> stat_ids(stat_list, stat_list + stat_list_count);
+    return ndi_stat_baseline_set(NDI_STAT_OBJ_POLICER, npu_id, ndi_policer_id, NULL,
+                                 &stat_ids[0], &counters[0], stat_list_count);
+}
+
+typedef std::unordered_map<npu_id_t,
+                           std::unordered_map<ndi_obj_id_t, std::vector<uint64_t>>>
+    ndi_qos_policer_last_read_t;
+
+/*  Counter ids of a bulk policer read, translated once. Delta reads are
+ *  relative to the previous delta read through the same plan, so callers
+ *  with their own plans don't see each other's reads. */
+struct _ndi_qos_policer_stat_plan_t {
+    std::vector<sai_policer_stat_counter_t> sai_ids;
+    std::vector<uint64_t> ndi_ids;
 
+    /*  values returned by the last delta read of each policer, in plan
+     *  order, under policer_last_read_lock */
+    mutable ndi_qos_policer_last_read_t last_read;
+};
+
+/*  Live plans, so a deleted policer can be dropped from all of them */
+static std::unordered_set<ndi_qos_policer_stat_plan_t *> g_policer_stat_plans;
+
+static std_mutex_lock_create_static_init_rec(policer_last_read_lock);
+
+/**
+ * This function translates a list of policer statistics types once for
+ * repeated bulk reads.
+ * @param stat_list_count number of statistics types
+ * @param *stat_list list of statistics types, each at most once
+ * @param[out] plan counter plan
+ * @return standard error
+ */
+t_std_error ndi_qos_policer_stat_plan_create(uint_t stat_list_count,
+                                const BASE_QOS_POLICER_STAT_TYPE_t * stat_list,
+                                ndi_qos_policer_stat_plan_t **plan)
+{
+    if ((plan == NULL) || (stat_list_count == 0) ||
+        (stat_list_count > BASE_QOS_POLICER_STAT_TYPE_MAX)) {
+        return STD_ERR(QOS, PARAM, 0);
+    }
+
+    ndi_qos_policer_stat_plan_t *p = new (std::nothrow) ndi_qos_policer_stat_plan_t;
+    if (p == NULL) {
+        return STD_ERR(QOS, NOMEM, 0);
+    }
+
+    try {
+        for (uint_t i = 0; i < stat_list_count; i++) {
+            p->sai_ids.push_back(ndi2sai_policer_stat_type.at(stat_list[i]));
+            p->ndi_ids.push_back(stat_list[i]);
+        }
+    }
+    catch (...) {
+        EV_LOGGING(NDI, NOTICE, "NDI-QOS",
+                      "Unknown statistics types!\n");
+        delete p;
+        return STD_ERR(QOS, CFG, 0);
+    }
+
+    // a type listed twice would be counted twice in delta mode
+    for (uint_t i = 1; i < stat_list_count; i++) {
+        if (std::find(p->ndi_ids.begin(), p->ndi_ids.begin() + i, p->ndi_ids[i])
+                != p->ndi_ids.begin() + i) {
+            EV_LOGGING(NDI, NOTICE, "NDI-QOS",
+                          "Repeated statistics type %lu!\n", p->ndi_ids[i]);
+            delete p;
+            return STD_ERR(QOS, CFG, 0);
+        }
+    }
+
+    std_mutex_simple_lock_guard g(&policer_last_read_lock);
+    try {
+        g_policer_stat_plans.insert(p);
+    } catch (...) {
+        delete p;
+        return STD_ERR(QOS, NOMEM, 0);
+    }
+
+    *plan = p;
+    return STD_ERR_OK;
+}
+
+void ndi_qos_policer_stat_plan_delete(ndi_qos_policer_stat_plan_t *plan)
+{
+    std_mutex_simple_lock_guard g(&policer_last_read_lock);
+    g_policer_stat_plans.erase(plan);
+    delete plan;
+}
+
+/*  Turn counters of one policer into the change since its last delta read
+ *  through the plan */
+static t_std_error ndi_qos_policer_stat_delta(npu_id_t npu_id, ndi_obj_id_t ndi_policer_id,
+                                              const ndi_qos_policer_stat_plan_t *plan,
+                                              uint64_t *counters)
+{
+    std_mutex_simple_lock_guard g(&policer_last_read_lock);
+
+    size_t stat_count = plan->ndi_ids.size();
+    std::vector<uint64_t> *last;
+    bool first;
+    try {
+        auto &npu_last = plan->last_read[npu_id];
+        auto it = npu_last.find(ndi_policer_id);
+        first = (it == npu_last.end());
+        last = first ? &npu_last[ndi_policer_id] : &it->second;
+        if (first) {
+            last->resize(stat_count);
+        }
+    } catch (...) {
+        EV_LOGGING(NDI, NOTICE, "NDI-QOS",
+                      "npu_id %d policer 0x%016lx: no memory for delta read\n",
+                      npu_id, ndi_policer_id);
+        return STD_ERR(QOS, NOMEM, 0);
+    }
+
+    for (size_t i = 0; i < stat_count; i++) {
+        uint64_t cur = counters[i];
+        // first read, or the counter was cleared since: everything is new
+        if (!first && (cur >= (*last)[i])) {
+            counters[i] = cur - (*last)[i];
+        }
+        (*last)[i] = cur;
+    }
+    return STD_ERR_OK;
+}
+
+/**
+ * This function reads the same statistics of a list of policers.
+ * @param npu_id npu id
+ * @param plan counter plan
+ * @param ndi_policer_list policers to read
+ * @param policer_count number of entries in ndi_policer_list
+ * @param delta true to return the change since the previous delta read of
+ *        each counter through plan, false for the value since the last clear
+ * @param[out] counters policer_count * plan counters, counters[i * n + j]
+ *        holding counter j of ndi_policer_list[i]. The row of a policer
+ *        that can't be read is zeroed.
+ * @param[out] status per policer result, may be NULL
+ * @return STD_ERR_OK if all policers were read, error of the last failure otherwise
+ */
+t_std_error ndi_qos_get_policer_stat_bulk(npu_id_t npu_id,
+                                const ndi_qos_policer_stat_plan_t *plan,
+                                const ndi_obj_id_t *ndi_policer_list,
+                                size_t policer_count,
+                                bool delta,
+                                uint64_t *counters,
+                                t_std_error *status)
+{
+    if ((plan == NULL) || (counters == NULL) ||
+        ((ndi_policer_list == NULL) && (policer_count != 0))) {
+        return STD_ERR(QOS, PARAM, 0);
+    }
+
+    nas_ndi_db_t *ndi_db_ptr = ndi_db_ptr_get(npu_id);
+    if (ndi_db_ptr == NULL) {
+        EV_LOGGING(NDI, DEBUG, "NDI-QOS",
+                      "npu_id %d not exist\n", npu_id);
+        return STD_ERR(QOS, CFG, 0);
+    }
+    sai_policer_api_t *policer_api = ndi_sai_qos_policer_api(ndi_db_ptr);
+
+    size_t stat_count = plan->sai_ids.size();
+    t_std_error ret_code = STD_ERR_OK;
+
+    for (size_t i = 0; i < policer_count; i++) {
+        uint64_t *row = &counters[i * stat_count];
+        t_std_error rc = STD_ERR_OK;
+
+        sai_status_t sai_ret = policer_api->get_policer_statistics(
+                                    ndi2sai_policer_id(ndi_policer_list[i]),
+                                    &plan->sai_ids[0], stat_count, row);
+        if (sai_ret != SAI_STATUS_SUCCESS) {
+            EV_LOGGING(NDI, DEBUG, "NDI-QOS",
+                          "npu_id %d policer 0x%016lx stats get failed\n",
+                          npu_id, ndi_policer_list[i]);
+            std::fill(row, row + stat_count, 0);
+            rc = ret_code = STD_ERR(QOS, CFG, sai_ret);
+        } else {
+            ndi_stat_baseline_apply(NDI_STAT_OBJ_POLICER, npu_id, ndi_policer_list[i],
+                                    &plan->ndi_ids[0], row, stat_count);
+            if (delta &&
+                (ndi_qos_policer_stat_delta(npu_id, ndi_policer_list[i], plan, row)
+                        != STD_ERR_OK)) {
+                std::fill(row, row + stat_count, 0);
+                rc = ret_code = STD_ERR(QOS, NOMEM, 0);
+            }
+        }
+        if (status != NULL) {
+            status[i] = rc;
+        }
+    }
+    return ret_code;
+}
+
+static void ndi_qos_policer_last_read_delete(npu_id_t npu_id, ndi_obj_id_t ndi_policer_id)
+{
+    std_mutex_simple_lock_guard g(&policer_last_read_lock);
+
+    for (auto plan : g_policer_stat_plans) {
+        auto it = plan->last_read.find(npu_id);
+        if (it != plan->last_read.end()) {
+            it->second.erase(ndi_policer_id);
+        }
+    }
+}
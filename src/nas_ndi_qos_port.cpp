@@ -24,16 +24,21 @@
 #include "nas_ndi_int.h"
 #include "nas_ndi_utils.h"
 #include "nas_ndi_qos_utl.h"
+#include "nas_ndi_qos_port_profile.h"
 #include "sai.h"
 #include "dell-base-qos.h" //from yang model
 #include "nas_ndi_qos.h"
+#include "std_mutex_lock.h"
 
 #include <stdio.h>
+#include <inttypes.h>
+#include <map>
+#include <new>
 #include <vector>
 #include <unordered_map>
 
 
-static std::unordered_map<BASE_QOS_FLOW_CONTROL_t, sai_port_flow_control_mode_t, std::hash<int>> \
+static const std::unordered_map<BASE_QOS_FLOW_CONTROL_t, sai_port_flow_control_mode_t, std::hash<int>> \
     ndi2sai_flow_control_map = {
         {BASE_QOS_FLOW_CONTROL_DISABLE,        SAI_PORT_FLOW_CONTROL_MODE_DISABLE},
         {BASE_QOS_FLOW_CONTROL_TX_ONLY,        SAI_PORT_FLOW_CONTROL_MODE_TX_ONLY},
@@ -41,7 +46,7 @@ static std::unordered_map<BASE_QOS_FLOW_CONTROL_t, sai_port_flow_control_mode_t,
         {BASE_QOS_FLOW_CONTROL_BOTH_ENABLE,    SAI_PORT_FLOW_CONTROL_MODE_BOTH_ENABLE},
     };
 
-static std::unordered_map<sai_port_flow_control_mode_t, BASE_QOS_FLOW_CONTROL_t, std::hash<int>> \
+static const std::unordered_map<sai_port_flow_control_mode_t, BASE_QOS_FLOW_CONTROL_t, std::hash<int>> \
     sai2ndi_flow_control_map = {
         {SAI_PORT_FLOW_CONTROL_MODE_DISABLE,        BASE_QOS_FLOW_CONTROL_DISABLE        },
         {SAI_PORT_FLOW_CONTROL_MODE_TX_ONLY,        BASE_QOS_FLOW_CONTROL_TX_ONLY        },
@@ -49,41 +54,155 @@ static std::unordered_map<sai_port_flow_control_mode_t, BASE_QOS_FLOW_CONTROL_t,
         {SAI_PORT_FLOW_CONTROL_MODE_BOTH_ENABLE,    BASE_QOS_FLOW_CONTROL_BOTH_ENABLE    },
     };
 
-static  std::unordered_map<BASE_QOS_PORT_INGRESS_t, sai_port_attr_t, std::hash<int>>
-    ndi2sai_port_ing_attr_id_map = {
-    {BASE_QOS_PORT_INGRESS_POLICER_ID,              SAI_PORT_ATTR_POLICER_ID},
-    {BASE_QOS_PORT_INGRESS_FLOOD_STORM_CONTROL,     SAI_PORT_ATTR_FLOOD_STORM_CONTROL_POLICER_ID},
-    {BASE_QOS_PORT_INGRESS_BROADCAST_STORM_CONTROL, SAI_PORT_ATTR_BROADCAST_STORM_CONTROL_POLICER_ID},
-    {BASE_QOS_PORT_INGRESS_MULTICAST_STORM_CONTROL, SAI_PORT_ATTR_MULTICAST_STORM_CONTROL_POLICER_ID},
-    {BASE_QOS_PORT_INGRESS_FLOW_CONTROL,            SAI_PORT_ATTR_GLOBAL_FLOW_CONTROL},
-    {BASE_QOS_PORT_INGRESS_PRIORITY_GROUP_NUMBER,   SAI_PORT_ATTR_NUMBER_OF_PRIORITY_GROUPS},
-    {BASE_QOS_PORT_INGRESS_PRIORITY_GROUP_ID_LIST,  SAI_PORT_ATTR_PRIORITY_GROUP_LIST},
-    {BASE_QOS_PORT_INGRESS_PER_PRIORITY_FLOW_CONTROL, SAI_PORT_ATTR_PRIORITY_FLOW_CONTROL},
-    {BASE_QOS_PORT_INGRESS_DEFAULT_TRAFFIC_CLASS,   SAI_PORT_ATTR_QOS_DEFAULT_TC},
-    {BASE_QOS_PORT_INGRESS_DOT1P_TO_TC_MAP,         SAI_PORT_ATTR_QOS_DOT1P_TO_TC_MAP},
-    {BASE_QOS_PORT_INGRESS_DOT1P_TO_COLOR_MAP,      SAI_PORT_ATTR_QOS_DOT1P_TO_COLOR_MAP},
-    {BASE_QOS_PORT_INGRESS_DOT1P_TO_TC_COLOR_MAP,   SAI_PORT_ATTR_QOS_DOT1P_TO_TC_AND_COLOR_MAP},
-    {BASE_QOS_PORT_INGRESS_DSCP_TO_TC_MAP,          SAI_PORT_ATTR_QOS_DSCP_TO_TC_MAP},
-    {BASE_QOS_PORT_INGRESS_DSCP_TO_COLOR_MAP,       SAI_PORT_ATTR_QOS_DSCP_TO_COLOR_MAP},
-    {BASE_QOS_PORT_INGRESS_DSCP_TO_TC_COLOR_MAP,    SAI_PORT_ATTR_QOS_DSCP_TO_TC_AND_COLOR_MAP},
-    {BASE_QOS_PORT_INGRESS_TC_TO_QUEUE_MAP,         SAI_PORT_ATTR_QOS_TC_TO_QUEUE_MAP},
-    {BASE_QOS_PORT_INGRESS_TC_TO_PRIORITY_GROUP_MAP,SAI_PORT_ATTR_QOS_TC_TO_PRIORITY_GROUP_MAP},
-    {BASE_QOS_PORT_INGRESS_PRIORITY_GROUP_TO_PFC_PRIORITY_MAP, SAI_PORT_ATTR_QOS_PRIORITY_GROUP_TO_PFC_PRIORITY_MAP},
-    {BASE_QOS_PORT_INGRESS_BUFFER_PROFILE_ID_LIST,     SAI_PORT_ATTR_QOS_INGRESS_BUFFER_PROFILE_LIST},
+/*  Which member of the SAI attribute value holds a port QoS attribute */
+typedef enum {
+    NDI_QOS_PORT_VAL_OID,
+    NDI_QOS_PORT_VAL_S32,
+    NDI_QOS_PORT_VAL_U8,
+    NDI_QOS_PORT_VAL_U32,
+    NDI_QOS_PORT_VAL_OBJLIST,
+} ndi_qos_port_val_t;
+
+typedef struct _ndi_qos_port_attr_t {
+    nas_attr_id_t       nas_id;
+    sai_port_attr_t     sai_id;
+    ndi_qos_port_val_t  val;
+    bool                settable;
+} ndi_qos_port_attr_t;
+
+static const ndi_qos_port_attr_t ndi_qos_port_ing_attr_list[] = {
+    {BASE_QOS_PORT_INGRESS_POLICER_ID,              SAI_PORT_ATTR_POLICER_ID,                       NDI_QOS_PORT_VAL_OID, true},
+    {BASE_QOS_PORT_INGRESS_FLOOD_STORM_CONTROL,     SAI_PORT_ATTR_FLOOD_STORM_CONTROL_POLICER_ID,   NDI_QOS_PORT_VAL_OID, true},
+    {BASE_QOS_PORT_INGRESS_BROADCAST_STORM_CONTROL, SAI_PORT_ATTR_BROADCAST_STORM_CONTROL_POLICER_ID, NDI_QOS_PORT_VAL_OID, true},
+    {BASE_QOS_PORT_INGRESS_MULTICAST_STORM_CONTROL, SAI_PORT_ATTR_MULTICAST_STORM_CONTROL_POLICER_ID, NDI_QOS_PORT_VAL_OID, true},
+    {BASE_QOS_PORT_INGRESS_FLOW_CONTROL,            SAI_PORT_ATTR_GLOBAL_FLOW_CONTROL,              NDI_QOS_PORT_VAL_S32, true},
+    {BASE_QOS_PORT_INGRESS_PRIORITY_GROUP_NUMBER,   SAI_PORT_ATTR_NUMBER_OF_PRIORITY_GROUPS,        NDI_QOS_PORT_VAL_U32, false},
+    {BASE_QOS_PORT_INGRESS_PRIORITY_GROUP_ID_LIST,  SAI_PORT_ATTR_PRIORITY_GROUP_LIST,              NDI_QOS_PORT_VAL_OBJLIST, false},
+    {BASE_QOS_PORT_INGRESS_PER_PRIORITY_FLOW_CONTROL, SAI_PORT_ATTR_PRIORITY_FLOW_CONTROL,          NDI_QOS_PORT_VAL_U8, true},
+    {BASE_QOS_PORT_INGRESS_DEFAULT_TRAFFIC_CLASS,   SAI_PORT_ATTR_QOS_DEFAULT_TC,                   NDI_QOS_PORT_VAL_U8, true},
+    {BASE_QOS_PORT_INGRESS_DOT1P_TO_TC_MAP,         SAI_PORT_ATTR_QOS_DOT1P_TO_TC_MAP,              NDI_QOS_PORT_VAL_OID, true},
+    {BASE_QOS_PORT_INGRESS_DOT1P_TO_COLOR_MAP,      SAI_PORT_ATTR_QOS_DOT1P_TO_COLOR_MAP,           NDI_QOS_PORT_VAL_OID, true},
+    {BASE_QOS_PORT_INGRESS_DOT1P_TO_TC_COLOR_MAP,   SAI_PORT_ATTR_QOS_DOT1P_TO_TC_AND_COLOR_MAP,    NDI_QOS_PORT_VAL_OID, true},
+    {BASE_QOS_PORT_INGRESS_DSCP_TO_TC_MAP,          SAI_PORT_ATTR_QOS_DSCP_TO_TC_MAP,               NDI_QOS_PORT_VAL_OID, true},
+    {BASE_QOS_PORT_INGRESS_DSCP_TO_COLOR_MAP,       SAI_PORT_ATTR_QOS_DSCP_TO_COLOR_MAP,            NDI_QOS_PORT_VAL_OID, true},
+    {BASE_QOS_PORT_INGRESS_DSCP_TO_TC_COLOR_MAP,    SAI_PORT_ATTR_QOS_DSCP_TO_TC_AND_COLOR_MAP,     NDI_QOS_PORT_VAL_OID, true},
+    {BASE_QOS_PORT_INGRESS_TC_TO_QUEUE_MAP,         SAI_PORT_ATTR_QOS_TC_TO_QUEUE_MAP,              NDI_QOS_PORT_VAL_OID, true},
+    {BASE_QOS_PORT_INGRESS_TC_TO_PRIORITY_GROUP_MAP,SAI_PORT_ATTR_QOS_TC_TO_PRIORITY_GROUP_MAP,     NDI_QOS_PORT_VAL_OID, true},
+    {BASE_QOS_PORT_INGRESS_PRIORITY_GROUP_TO_PFC_PRIORITY_MAP, SAI_PORT_ATTR_QOS_PRIORITY_GROUP_TO_PFC_PRIORITY_MAP, NDI_QOS_PORT_VAL_OID, true},
+    {BASE_QOS_PORT_INGRESS_BUFFER_PROFILE_ID_LIST,  SAI_PORT_ATTR_QOS_INGRESS_BUFFER_PROFILE_LIST,  NDI_QOS_PORT_VAL_OBJLIST, true},
     };
 
+static const ndi_qos_attr_tbl<ndi_qos_port_attr_t>
+    ndi_qos_port_ing_attr_tbl(ndi_qos_port_ing_attr_list);
+
+/*  Values NDI last set on each port, by SAI attribute id. A scalar value is
+ *  kept as one element, an object list as its elements.
+ */
+typedef std::vector<uint64_t> ndi_qos_port_attr_val_t;
+typedef std::unordered_map<sai_attr_id_t, ndi_qos_port_attr_val_t> ndi_qos_port_attr_vals_t;
+
+static std_mutex_lock_create_static_init_rec(port_qos_cache_lock);
+static std::map<std::pair<npu_id_t, npu_port_t>, ndi_qos_port_attr_vals_t> g_port_qos_attr_cache;
+
+static void _ndi_qos_port_attr_val(const ndi_qos_port_attr_t *desc,
+                                   const sai_attribute_t &attr,
+                                   ndi_qos_port_attr_val_t &val)
+{
+    switch (desc->val) {
+    case NDI_QOS_PORT_VAL_OID:
+        val.assign(1, attr.value.oid);
+        break;
+    case NDI_QOS_PORT_VAL_S32:
+        val.assign(1, (uint64_t)(uint32_t)attr.value.s32);
+        break;
+    case NDI_QOS_PORT_VAL_U8:
+        val.assign(1, attr.value.u8);
+        break;
+    case NDI_QOS_PORT_VAL_U32:
+        val.assign(1, attr.value.u32);
+        break;
+    case NDI_QOS_PORT_VAL_OBJLIST:
+        val.assign(attr.value.objlist.list, attr.value.objlist.list + attr.value.objlist.count);
+        break;
+    }
+}
+
+/**
+ * Set translated QoS attributes on a port and remember the values set.
+ * With skip_equal an attribute holding the value NDI last set is not sent.
+ */
+static t_std_error _ndi_qos_port_attrs_apply(nas_ndi_db_t *ndi_db_ptr,
+                                             npu_id_t npu_id, npu_port_t port_id,
+                                             const sai_attribute_t *attrs,
+                                             const ndi_qos_port_attr_val_t *vals,
+                                             size_t count, bool skip_equal,
+                                             ndi_qos_port_profile_apply_stats_t &stats)
+{
+    sai_status_t sai_ret = SAI_STATUS_FAILURE;
+    t_std_error rc = STD_ERR_OK;
+    sai_object_id_t sai_port;
+
+    if (ndi_sai_port_id_get(npu_id, port_id, &sai_port) != STD_ERR_OK) {
+        return STD_ERR(NPU, PARAM, 0);
+    }
+
+    std_mutex_simple_lock_guard g(&port_qos_cache_lock);
+    auto key = std::make_pair(npu_id, port_id);
+
+    try {
+        ndi_qos_port_attr_vals_t &cache = g_port_qos_attr_cache[key];
+
+        for (size_t ix = 0; ix < count; ++ix) {
+            auto cur = cache.find(attrs[ix].id);
+            if (skip_equal && cur != cache.end() && cur->second == vals[ix]) {
+                stats.attrs_skipped++;
+                continue;
+            }
+
+            stats.attrs_set++;
+            if ((sai_ret = ndi_sai_qos_port_api(ndi_db_ptr)->
+                                set_port_attribute(sai_port, &attrs[ix]))
+                                 != SAI_STATUS_SUCCESS) {
+                EV_LOGGING(NDI, NOTICE, "NDI-QOS",
+                        "port qos set fails: npu_id %u, port_id %u, sai attr_id %u\n",
+                        npu_id, port_id, attrs[ix].id);
+                stats.attrs_failed++;
+                // the value in the NPU is not known anymore
+                if (cur != cache.end())
+                    cache.erase(cur);
+                rc = STD_ERR(QOS, CFG, sai_ret);
+                continue;
+            }
+            cache[attrs[ix].id] = vals[ix];
+        }
+    } catch (std::bad_alloc &) {
+        EV_LOGGING(NDI, NOTICE, "NDI-QOS",
+                "port qos values of npu_id %u, port_id %u dropped, out of memory\n",
+                npu_id, port_id);
+        g_port_qos_attr_cache.erase(key);
+        return STD_ERR(QOS, NOMEM, 0);
+    }
+
+    return rc;
+}
+
+void ndi_qos_port_profile_cache_port_delete(npu_id_t npu_id, npu_port_t port_id)
+{
+    std_mutex_simple_lock_guard g(&port_qos_cache_lock);
+    g_port_qos_attr_cache.erase(std::make_pair(npu_id, port_id));
+}
+
 static t_std_error _fill_port_qos_ing_attr(BASE_QOS_PORT_INGRESS_t attr_id,
                                  const qos_port_ing_struct_t *p,
                                  sai_attribute_t *attr)
 {
-    try {
-        attr->id = ndi2sai_port_ing_attr_id_map[attr_id];
-    }
-    catch (...) {
+    const ndi_qos_port_attr_t *desc = ndi_qos_port_ing_attr_tbl.find(attr_id);
+    if (desc == NULL) {
         EV_LOGGING(NDI, DEBUG, "NDI-QOS",
                       "attr_id %d out of range\n", attr_id);
         return STD_ERR(QOS, CFG, 0);
     }
+    attr->id = desc->sai_id;
 
     switch (attr_id) {
     case BASE_QOS_PORT_INGRESS_POLICER_ID:
@@ -99,8 +218,16 @@ static t_std_error _fill_port_qos_ing_attr(BASE_QOS_PORT_INGRESS_t attr_id,
         attr->value.oid = ndi2sai_policer_id(p->mcast_storm_control);
         break;
     case BASE_QOS_PORT_INGRESS_FLOW_CONTROL:
-        attr->value.s32 = ndi2sai_flow_control_map[p->flow_control];
+    {
+        auto fc = ndi2sai_flow_control_map.find(p->flow_control);
+        if (fc == ndi2sai_flow_control_map.end()) {
+            EV_LOGGING(NDI, DEBUG, "NDI-QOS",
+                          "flow control %d not supported\n", p->flow_control);
+            return STD_ERR(QOS, CFG, 0);
+        }
+        attr->value.s32 = fc->second;
         break;
+    }
     case BASE_QOS_PORT_INGRESS_DEFAULT_TRAFFIC_CLASS:
         attr->value.u8 = p->default_tc;
         break;
@@ -166,8 +293,6 @@ t_std_error ndi_qos_set_port_ing_profile_attr(npu_id_t npu_id,
                                  BASE_QOS_PORT_INGRESS_t attr_id,
                                  const qos_port_ing_struct_t *p)
 {
-    sai_status_t sai_ret = SAI_STATUS_FAILURE;
-    t_std_error rc = STD_ERR_OK;
     nas_ndi_db_t *ndi_db_ptr = ndi_db_ptr_get(npu_id);
     if (ndi_db_ptr == NULL) {
         EV_LOGGING(NDI, DEBUG, "NDI-QOS",
@@ -175,41 +300,36 @@ t_std_error ndi_qos_set_port_ing_profile_attr(npu_id_t npu_id,
         return STD_ERR(QOS, CFG, 0);
     }
 
-    sai_object_id_t sai_port;
-
-    if (ndi_sai_port_id_get(npu_id, port_id, &sai_port) != STD_ERR_OK) {
-        return STD_ERR(NPU, PARAM, 0);
+    const ndi_qos_port_attr_t *desc = ndi_qos_port_ing_attr_tbl.find(attr_id);
+    if (desc == NULL || !desc->settable) {
+        EV_LOGGING(NDI, DEBUG, "NDI-QOS",
+                      "attr_id %d not settable\n", attr_id);
+        return STD_ERR(QOS, CFG, 0);
     }
 
     sai_attribute_t attr;
+    std::vector<sai_object_id_t> obj_list;
+    ndi_qos_port_attr_val_t val;
 
-    if (attr_id == BASE_QOS_PORT_INGRESS_BUFFER_PROFILE_ID_LIST &&
-         p->num_buffer_profile != 0 ) {
-        attr.value.objlist.count = p->num_buffer_profile;
-         attr.value.objlist.list = (sai_object_id_t *)calloc(p->num_buffer_profile, sizeof(sai_object_id_t));
-         if (attr.value.objlist.list == NULL) {
-             EV_LOGGING(NDI, DEBUG, "NDI-QOS", "Out of memeory\n");
-             return STD_ERR(QOS, NOMEM, 0);
-         }
-     }
-
-    _fill_port_qos_ing_attr(attr_id, p, &attr);
-    if ((sai_ret = ndi_sai_qos_port_api(ndi_db_ptr)->
-                        set_port_attribute(sai_port, &attr))
-                         != SAI_STATUS_SUCCESS) {
-        EV_LOGGING(NDI, NOTICE, "NDI-QOS",
-                "port ingress qos set fails: npu_id %u, port_id %u, sai attr_id %u\n",
-                npu_id, port_id, attr.id);
-        rc = STD_ERR(QOS, CFG, sai_ret);
-    }
+    try {
+        if (attr_id == BASE_QOS_PORT_INGRESS_BUFFER_PROFILE_ID_LIST &&
+             p->num_buffer_profile != 0 ) {
+            obj_list.resize(p->num_buffer_profile);
+            attr.value.objlist.count = p->num_buffer_profile;
+            attr.value.objlist.list = &obj_list[0];
+        }
 
-    if (attr_id == BASE_QOS_PORT_INGRESS_BUFFER_PROFILE_ID_LIST &&
-        p->num_buffer_profile != 0 ) {
-        free(attr.value.objlist.list);
-        attr.value.objlist.count = 0;
+        if (_fill_port_qos_ing_attr(attr_id, p, &attr) != STD_ERR_OK)
+            return STD_ERR(QOS, CFG, 0);
+
+        _ndi_qos_port_attr_val(desc, attr, val);
+    } catch (std::bad_alloc &) {
+        EV_LOGGING(NDI, DEBUG, "NDI-QOS", "Out of memory\n");
+        return STD_ERR(QOS, NOMEM, 0);
     }
 
-    return rc;
+    ndi_qos_port_profile_apply_stats_t stats = {0};
+    return _ndi_qos_port_attrs_apply(ndi_db_ptr, npu_id, port_id, &attr, &val, 1, false, stats);
 }
 
 
@@ -236,8 +356,13 @@ static t_std_error _fill_ndi_qos_port_ing_struct(sai_attribute_t *attr_list,
             p->mcast_storm_control = sai2ndi_policer_id(attr->value.oid);
             break;
         case SAI_PORT_ATTR_GLOBAL_FLOW_CONTROL:
-            p->flow_control = sai2ndi_flow_control_map[(sai_port_flow_control_mode_t)(attr->value.s32)];
+        {
+            auto fc = sai2ndi_flow_control_map.find((sai_port_flow_control_mode_t)(attr->value.s32));
+            if (fc == sai2ndi_flow_control_map.end())
+                return STD_ERR(QOS, CFG, 0);
+            p->flow_control = fc->second;
             break;
+        }
         case SAI_PORT_ATTR_QOS_DEFAULT_TC:
             p->default_tc = attr->value.u8;
             break;
@@ -312,12 +437,10 @@ t_std_error ndi_qos_get_port_ing_profile(npu_id_t npu_id,
     sai_status_t sai_ret = SAI_STATUS_FAILURE;
     std::vector<sai_attribute_t> attr_list(num_attr);
     for (uint_t i = 0; i< num_attr; i++) {
-        try {
-            attr_list[i].id = ndi2sai_port_ing_attr_id_map[nas_attr_list[i]];
-        }
-        catch (...) {
+        const ndi_qos_port_attr_t *desc = ndi_qos_port_ing_attr_tbl.find(nas_attr_list[i]);
+        if (desc == NULL)
             return STD_ERR(QOS, CFG, 0);
-        }
+        attr_list[i].id = desc->sai_id;
     }
 
     nas_ndi_db_t *ndi_db_ptr = ndi_db_ptr_get(npu_id);
@@ -345,44 +468,43 @@ t_std_error ndi_qos_get_port_ing_profile(npu_id_t npu_id,
     }
 
     // fill the outgoing parameters
-    _fill_ndi_qos_port_ing_struct(&attr_list[0], num_attr, p);
-
-    return STD_ERR_OK;
+    return _fill_ndi_qos_port_ing_struct(&attr_list[0], num_attr, p);
 
 }
 
-static  std::unordered_map<BASE_QOS_PORT_EGRESS_t, sai_port_attr_t, std::hash<int>>
-    ndi2sai_port_egr_attr_id_map = {
-        {BASE_QOS_PORT_EGRESS_TC_TO_QUEUE_MAP,      SAI_PORT_ATTR_QOS_TC_TO_QUEUE_MAP},
-        {BASE_QOS_PORT_EGRESS_TC_TO_DOT1P_MAP,      SAI_PORT_ATTR_QOS_TC_TO_DOT1P_MAP},
-        {BASE_QOS_PORT_EGRESS_TC_TO_DSCP_MAP,       SAI_PORT_ATTR_QOS_TC_TO_DSCP_MAP},
-        {BASE_QOS_PORT_EGRESS_TC_COLOR_TO_DOT1P_MAP,SAI_PORT_ATTR_QOS_TC_AND_COLOR_TO_DOT1P_MAP},
-        {BASE_QOS_PORT_EGRESS_TC_COLOR_TO_DSCP_MAP, SAI_PORT_ATTR_QOS_TC_AND_COLOR_TO_DSCP_MAP},
-        {BASE_QOS_PORT_EGRESS_WRED_PROFILE_ID,      SAI_PORT_ATTR_QOS_WRED_PROFILE_ID},
-        {BASE_QOS_PORT_EGRESS_SCHEDULER_PROFILE_ID, SAI_PORT_ATTR_QOS_SCHEDULER_PROFILE_ID},
-        {BASE_QOS_PORT_EGRESS_QUEUE_ID_LIST,        SAI_PORT_ATTR_QOS_QUEUE_LIST},
-        {BASE_QOS_PORT_EGRESS_PFC_PRIORITY_TO_QUEUE_MAP,SAI_PORT_ATTR_QOS_PFC_PRIORITY_TO_QUEUE_MAP},
-        {BASE_QOS_PORT_EGRESS_BUFFER_PROFILE_ID_LIST,  SAI_PORT_ATTR_QOS_EGRESS_BUFFER_PROFILE_LIST},
-        {BASE_QOS_PORT_EGRESS_NUM_QUEUE,            SAI_PORT_ATTR_QOS_NUMBER_OF_QUEUES },
-        /** @todo: not supported in SAI api yet
-        {BASE_QOS_PORT_EGRESS_NUM_UNICAST_QUEUE,     0},
-        {BASE_QOS_PORT_EGRESS_NUM_MULTICAST_QUEUE,     0},
-        {BASE_QOS_PORT_EGRESS_BUFFER_LIMIT,         0},
-        */
+static const ndi_qos_port_attr_t ndi_qos_port_egr_attr_list[] = {
+    {BASE_QOS_PORT_EGRESS_TC_TO_QUEUE_MAP,      SAI_PORT_ATTR_QOS_TC_TO_QUEUE_MAP,              NDI_QOS_PORT_VAL_OID, true},
+    {BASE_QOS_PORT_EGRESS_TC_TO_DOT1P_MAP,      SAI_PORT_ATTR_QOS_TC_TO_DOT1P_MAP,              NDI_QOS_PORT_VAL_OID, true},
+    {BASE_QOS_PORT_EGRESS_TC_TO_DSCP_MAP,       SAI_PORT_ATTR_QOS_TC_TO_DSCP_MAP,               NDI_QOS_PORT_VAL_OID, true},
+    {BASE_QOS_PORT_EGRESS_TC_COLOR_TO_DOT1P_MAP,SAI_PORT_ATTR_QOS_TC_AND_COLOR_TO_DOT1P_MAP,    NDI_QOS_PORT_VAL_OID, true},
+    {BASE_QOS_PORT_EGRESS_TC_COLOR_TO_DSCP_MAP, SAI_PORT_ATTR_QOS_TC_AND_COLOR_TO_DSCP_MAP,     NDI_QOS_PORT_VAL_OID, true},
+    {BASE_QOS_PORT_EGRESS_WRED_PROFILE_ID,      SAI_PORT_ATTR_QOS_WRED_PROFILE_ID,              NDI_QOS_PORT_VAL_OID, true},
+    {BASE_QOS_PORT_EGRESS_SCHEDULER_PROFILE_ID, SAI_PORT_ATTR_QOS_SCHEDULER_PROFILE_ID,         NDI_QOS_PORT_VAL_OID, true},
+    {BASE_QOS_PORT_EGRESS_QUEUE_ID_LIST,        SAI_PORT_ATTR_QOS_QUEUE_LIST,                   NDI_QOS_PORT_VAL_OBJLIST, false},
+    {BASE_QOS_PORT_EGRESS_PFC_PRIORITY_TO_QUEUE_MAP,SAI_PORT_ATTR_QOS_PFC_PRIORITY_TO_QUEUE_MAP, NDI_QOS_PORT_VAL_OID, true},
+    {BASE_QOS_PORT_EGRESS_BUFFER_PROFILE_ID_LIST,  SAI_PORT_ATTR_QOS_EGRESS_BUFFER_PROFILE_LIST, NDI_QOS_PORT_VAL_OBJLIST, true},
+    {BASE_QOS_PORT_EGRESS_NUM_QUEUE,            SAI_PORT_ATTR_QOS_NUMBER_OF_QUEUES,             NDI_QOS_PORT_VAL_U32, false},
+    /** @todo: not supported in SAI api yet
+    {BASE_QOS_PORT_EGRESS_NUM_UNICAST_QUEUE,     0},
+    {BASE_QOS_PORT_EGRESS_NUM_MULTICAST_QUEUE,     0},
+    {BASE_QOS_PORT_EGRESS_BUFFER_LIMIT,         0},
+    */
 };
 
+static const ndi_qos_attr_tbl<ndi_qos_port_attr_t>
+    ndi_qos_port_egr_attr_tbl(ndi_qos_port_egr_attr_list);
+
 static t_std_error _fill_port_qos_egr_attr(BASE_QOS_PORT_EGRESS_t attr_id,
                                  const qos_port_egr_struct_t *p,
                                  sai_attribute_t *attr)
 {
-    try {
-        attr->id = ndi2sai_port_egr_attr_id_map[attr_id];
-    }
-    catch (...) {
+    const ndi_qos_port_attr_t *desc = ndi_qos_port_egr_attr_tbl.find(attr_id);
+    if (desc == NULL) {
         EV_LOGGING(NDI, DEBUG, "NDI-QOS",
                       "attr_id %d out of range\n", attr_id);
         return STD_ERR(QOS, CFG, 0);
     }
+    attr->id = desc->sai_id;
 
     switch (attr_id) {
     case BASE_QOS_PORT_EGRESS_TC_TO_QUEUE_MAP:
@@ -445,8 +567,6 @@ t_std_error ndi_qos_set_port_egr_profile_attr(npu_id_t npu_id,
                                  BASE_QOS_PORT_EGRESS_t attr_id,
                                  const qos_port_egr_struct_t *p)
 {
-    sai_status_t sai_ret = SAI_STATUS_FAILURE;
-    t_std_error rc = STD_ERR_OK;
     nas_ndi_db_t *ndi_db_ptr = ndi_db_ptr_get(npu_id);
     if (ndi_db_ptr == NULL) {
         EV_LOGGING(NDI, DEBUG, "NDI-QOS",
@@ -454,42 +574,36 @@ t_std_error ndi_qos_set_port_egr_profile_attr(npu_id_t npu_id,
         return STD_ERR(QOS, CFG, 0);
     }
 
-    sai_object_id_t sai_port;
-
-    if (ndi_sai_port_id_get(npu_id, port_id, &sai_port) != STD_ERR_OK) {
-        return STD_ERR(NPU, PARAM, 0);
+    const ndi_qos_port_attr_t *desc = ndi_qos_port_egr_attr_tbl.find(attr_id);
+    if (desc == NULL || !desc->settable) {
+        EV_LOGGING(NDI, DEBUG, "NDI-QOS",
+                      "attr_id %d not settable\n", attr_id);
+        return STD_ERR(QOS, CFG, 0);
     }
 
     sai_attribute_t attr;
+    std::vector<sai_object_id_t> obj_list;
+    ndi_qos_port_attr_val_t val;
 
-    if (attr_id == BASE_QOS_PORT_EGRESS_BUFFER_PROFILE_ID_LIST &&
-        p->num_buffer_profile != 0 ) {
-        attr.value.objlist.count = p->num_buffer_profile;
-        attr.value.objlist.list = (sai_object_id_t *)calloc(p->num_buffer_profile, sizeof(sai_object_id_t));
-        if (attr.value.objlist.list == NULL) {
-            EV_LOGGING(NDI, DEBUG, "NDI-QOS", "Out of memeory\n");
-            return STD_ERR(QOS, NOMEM, 0);
+    try {
+        if (attr_id == BASE_QOS_PORT_EGRESS_BUFFER_PROFILE_ID_LIST &&
+            p->num_buffer_profile != 0 ) {
+            obj_list.resize(p->num_buffer_profile);
+            attr.value.objlist.count = p->num_buffer_profile;
+            attr.value.objlist.list = &obj_list[0];
         }
-    }
 
-    _fill_port_qos_egr_attr(attr_id, p, &attr);
-    if ((sai_ret = ndi_sai_qos_port_api(ndi_db_ptr)->
-                        set_port_attribute(sai_port, &attr))
-                         != SAI_STATUS_SUCCESS) {
-        EV_LOGGING(NDI, NOTICE, "NDI-QOS",
-                "port egress qos set fails: npu_id %u, port_id %u, sai attr_id %u\n",
-                npu_id, port_id, attr.id);
-        rc = STD_ERR(QOS, CFG, sai_ret);
-    }
+        if (_fill_port_qos_egr_attr(attr_id, p, &attr) != STD_ERR_OK)
+            return STD_ERR(QOS, CFG, 0);
 
-    if (attr_id == BASE_QOS_PORT_EGRESS_BUFFER_PROFILE_ID_LIST &&
-        p->num_buffer_profile != 0 ) {
-        free(attr.value.objlist.list);
-        attr.value.objlist.count = 0;
+        _ndi_qos_port_attr_val(desc, attr, val);
+    } catch (std::bad_alloc &) {
+        EV_LOGGING(NDI, DEBUG, "NDI-QOS", "Out of memory\n");
+        return STD_ERR(QOS, NOMEM, 0);
     }
 
-    return rc;
-
+    ndi_qos_port_profile_apply_stats_t stats = {0};
+    return _ndi_qos_port_attrs_apply(ndi_db_ptr, npu_id, port_id, &attr, &val, 1, false, stats);
 }
 
 static t_std_error _fill_ndi_qos_port_egr_struct(const sai_attribute_t *attr_list,
@@ -608,16 +722,14 @@ t_std_error ndi_qos_get_port_egr_profile(npu_id_t npu_id,
     std::vector<sai_attribute_t> attr_list(num_attr);
     std::vector<sai_object_id_t> queue_id_list;
     for (uint_t i = 0; i< num_attr; i++) {
-        try {
-            attr_list[i].id = ndi2sai_port_egr_attr_id_map[nas_attr_list[i]];
-            if (attr_list[i].id == SAI_PORT_ATTR_QOS_QUEUE_LIST) {
-                attr_list[i].value.objlist.count = p->num_queue_id;
-                queue_id_list.resize(p->num_queue_id);
-                attr_list[i].value.objlist.list = &queue_id_list[0];
-            }
-        }
-        catch (...) {
+        const ndi_qos_port_attr_t *desc = ndi_qos_port_egr_attr_tbl.find(nas_attr_list[i]);
+        if (desc == NULL)
             return STD_ERR(QOS, CFG, 0);
+        attr_list[i].id = desc->sai_id;
+        if (attr_list[i].id == SAI_PORT_ATTR_QOS_QUEUE_LIST) {
+            attr_list[i].value.objlist.count = p->num_queue_id;
+            queue_id_list.resize(p->num_queue_id);
+            attr_list[i].value.objlist.list = &queue_id_list[0];
         }
     }
 
@@ -653,3 +765,121 @@ t_std_error ndi_qos_get_port_egr_profile(npu_id_t npu_id,
     return STD_ERR_OK;
 
 }
+
+/**
+ * Translate a port QoS profile once and set it on each port of port_list.
+ * Only buffer profile lists are settable object lists, each takes
+ * num_buffer_profile entries of one arena so that the attributes stay valid
+ * across all ports.
+ */
+template <typename A, typename P>
+static t_std_error _ndi_qos_port_profile_apply(npu_id_t npu_id,
+                                               const npu_port_t *port_list, size_t port_count,
+                                               const A *attr_list, uint_t num_attr,
+                                               const P *p,
+                                               const ndi_qos_attr_tbl<ndi_qos_port_attr_t> &tbl,
+                                               t_std_error (*fill)(A, const P *, sai_attribute_t *),
+                                               t_std_error *status,
+                                               ndi_qos_port_profile_apply_stats_t *stats)
+{
+    nas_ndi_db_t *ndi_db_ptr = ndi_db_ptr_get(npu_id);
+    if (ndi_db_ptr == NULL) {
+        EV_LOGGING(NDI, DEBUG, "NDI-QOS",
+                      "npu_id %d not exist\n", npu_id);
+        return STD_ERR(QOS, CFG, 0);
+    }
+
+    if ((port_count != 0 && port_list == NULL) ||
+        (num_attr != 0 && (attr_list == NULL || p == NULL))) {
+        return STD_ERR(QOS, PARAM, 0);
+    }
+
+    std::vector<const ndi_qos_port_attr_t *> desc;
+    std::vector<sai_attribute_t> attrs;
+    std::vector<ndi_qos_port_attr_val_t> vals;
+    std::vector<sai_object_id_t> obj_arena;
+
+    try {
+        desc.resize(num_attr);
+        uint_t num_objlist = 0;
+        for (uint_t i = 0; i < num_attr; i++) {
+            desc[i] = tbl.find(attr_list[i]);
+            if (desc[i] == NULL || !desc[i]->settable) {
+                EV_LOGGING(NDI, DEBUG, "NDI-QOS",
+                              "attr_id %d not settable\n", attr_list[i]);
+                return STD_ERR(QOS, CFG, 0);
+            }
+            if (desc[i]->val == NDI_QOS_PORT_VAL_OBJLIST)
+                num_objlist++;
+        }
+
+        attrs.resize(num_attr);
+        vals.resize(num_attr);
+        if (num_objlist != 0)
+            obj_arena.resize(num_objlist * p->num_buffer_profile);
+        size_t obj_used = 0;
+        for (uint_t i = 0; i < num_attr; i++) {
+            if (desc[i]->val == NDI_QOS_PORT_VAL_OBJLIST) {
+                attrs[i].value.objlist.count = p->num_buffer_profile;
+                attrs[i].value.objlist.list = p->num_buffer_profile ? &obj_arena[obj_used] : NULL;
+                obj_used += p->num_buffer_profile;
+            }
+            if (fill(attr_list[i], p, &attrs[i]) != STD_ERR_OK)
+                return STD_ERR(QOS, CFG, 0);
+            _ndi_qos_port_attr_val(desc[i], attrs[i], vals[i]);
+        }
+    } catch (std::bad_alloc &) {
+        EV_LOGGING(NDI, DEBUG, "NDI-QOS", "Out of memory\n");
+        return STD_ERR(QOS, NOMEM, 0);
+    }
+
+    ndi_qos_port_profile_apply_stats_t cnt = {0};
+    t_std_error rc = STD_ERR_OK;
+    for (size_t ix = 0; ix < port_count; ++ix) {
+        t_std_error port_rc = _ndi_qos_port_attrs_apply(ndi_db_ptr, npu_id, port_list[ix],
+                                                        attrs.data(), vals.data(), num_attr,
+                                                        true, cnt);
+        if (status != NULL)
+            status[ix] = port_rc;
+        if (port_rc != STD_ERR_OK)
+            rc = port_rc;
+    }
+
+    EV_LOGGING(NDI, INFO, "NDI-QOS",
+            "port qos profile apply: npu_id %u, %u ports, %u attrs, %" PRIu64 " set, %" PRIu64 " skipped\n",
+            npu_id, (uint_t)port_count, num_attr, cnt.attrs_set, cnt.attrs_skipped);
+
+    if (stats != NULL) {
+        stats->attrs_set += cnt.attrs_set;
+        stats->attrs_skipped += cnt.attrs_skipped;
+        stats->attrs_failed += cnt.attrs_failed;
+    }
+
+    return rc;
+}
+
+t_std_error ndi_qos_port_ing_profile_apply(npu_id_t npu_id,
+                                           const npu_port_t *port_list, size_t port_count,
+                                           const BASE_QOS_PORT_INGRESS_t *attr_list,
+                                           uint_t num_attr,
+                                           const qos_port_ing_struct_t *p,
+                                           t_std_error *status,
+                                           ndi_qos_port_profile_apply_stats_t *stats)
+{
+    return _ndi_qos_port_profile_apply(npu_id, port_list, port_count, attr_list, num_attr, p,
+                                       ndi_qos_port_ing_attr_tbl, _fill_port_qos_ing_attr,
+                                       status, stats);
+}
+
+t_std_error ndi_qos_port_egr_profile_apply(npu_id_t npu_id,
+                                           const npu_port_t *port_list, size_t port_count,
+                                           const BASE_QOS_PORT_EGRESS_t *attr_list,
+                                           uint_t num_attr,
+                                           const qos_port_egr_struct_t *p,
+                                           t_std_error *status,
+                                           ndi_qos_port_profile_apply_stats_t *stats)
+{
+    return _ndi_qos_port_profile_apply(npu_id, port_list, port_count, attr_list, num_attr, p,
+                                       ndi_qos_port_egr_attr_tbl, _fill_port_qos_egr_attr,
+                                       status, stats);
+}
@@ -23,11 +23,20 @@
 #include "nas_ndi_int.h"
 #include "nas_ndi_utils.h"
 #include "nas_ndi_qos_utl.h"
+#include "nas_ndi_qos_topology.h"
+#include "nas_ndi_qos_pg_binding.h"
+#include "nas_ndi_qos_bind_batch.h"
+#include "nas_ndi_stat_baseline.h"
 #include "sai.h"
 #include "dell-base-qos.h" //from yang model
 #include "nas_ndi_qos.h"
+#include "std_mutex_lock.h"
 
 #include <stdio.h>
+#include <inttypes.h>
+#include <algorithm>
+#include <map>
+#include <new>
 #include <vector>
 #include <unordered_map>
 
@@ -38,6 +47,89 @@ const static std::unordered_map<nas_attr_id_t, sai_attr_id_t, std::hash<int>>
 
 };
 
+/*  Buffer profiles NDI last bound to the priority groups of a port */
+typedef struct _ndi_qos_port_pg_state_t {
+    std::unordered_map<ndi_obj_id_t, ndi_obj_id_t> bound;
+} ndi_qos_port_pg_state_t;
+
+static std_mutex_lock_create_static_init_rec(pg_bind_lock);
+static std::map<std::pair<npu_id_t, npu_port_t>, ndi_qos_port_pg_state_t> g_port_pg_state;
+static ndi_qos_pg_headroom_update_fn g_pg_headroom_cb = NULL;
+
+/*  Binding records of a port, spare if they can't be allocated: priority
+ *  groups are still bound, their bindings just aren't remembered
+ */
+static ndi_qos_port_pg_state_t & _ndi_qos_port_pg_state_get(npu_id_t npu_id, npu_port_t port_id,
+                                                            ndi_qos_port_pg_state_t &spare)
+{
+    try {
+        return g_port_pg_state[std::make_pair(npu_id, port_id)];
+    } catch (std::bad_alloc &) {
+        EV_LOGGING(NDI, NOTICE, "NDI-QOS",
+                "npu_id %u port %u priority group bindings not cached, out of memory\n",
+                npu_id, port_id);
+    }
+    return spare;
+}
+
+/*  A priority group can only be bound through the port that owns it */
+static t_std_error _ndi_qos_pg_port_check(npu_id_t npu_id, npu_port_t port_id,
+                                          ndi_obj_id_t ndi_priority_group_id)
+{
+    ndi_port_t ndi_port_id;
+    ndi_port_id.npu_id = npu_id;
+    ndi_port_id.npu_port = port_id;
+
+    ndi_qos_port_topology_ptr_t topo = ndi_qos_port_topology_get(ndi_port_id);
+    if (topo == nullptr) {
+        EV_LOGGING(NDI, NOTICE, "NDI-QOS",
+                "npu_id %u port %u priority groups can't be read\n", npu_id, port_id);
+        return STD_ERR(QOS, FAIL, 0);
+    }
+    if (std::find(topo->pg_list.begin(), topo->pg_list.end(), ndi_priority_group_id)
+            == topo->pg_list.end()) {
+        EV_LOGGING(NDI, NOTICE, "NDI-QOS",
+                "priority group 0x%" PRIx64 " is not on npu_id %u port %u\n",
+                ndi_priority_group_id, npu_id, port_id);
+        return STD_ERR(QOS, PARAM, 0);
+    }
+    return STD_ERR_OK;
+}
+
+/*  Bind a priority group and record the binding, pg_bind_lock held */
+static t_std_error _ndi_qos_pg_bind(nas_ndi_db_t *ndi_db_ptr, npu_id_t npu_id,
+                                    ndi_obj_id_t ndi_priority_group_id,
+                                    ndi_obj_id_t buffer_profile_id,
+                                    ndi_qos_port_pg_state_t &state)
+{
+    sai_status_t sai_ret = SAI_STATUS_FAILURE;
+    sai_attribute_t sai_attr = {0};
+    sai_attr.id = SAI_INGRESS_PRIORITY_GROUP_ATTR_BUFFER_PROFILE;
+    sai_attr.value.oid = ndi2sai_buffer_profile_id(buffer_profile_id);
+
+    if ((sai_ret = ndi_sai_qos_buffer_api(ndi_db_ptr)->
+            set_ingress_priority_group_attr(
+                    ndi2sai_priority_group_id(ndi_priority_group_id),
+                    &sai_attr))
+                         != SAI_STATUS_SUCCESS) {
+        EV_LOGGING(NDI, NOTICE, "NDI-QOS",
+                      "npu_id %d priority_group profile set failed\n", npu_id);
+        // the binding in the NPU is not known anymore
+        state.bound.erase(ndi_priority_group_id);
+        return STD_ERR(QOS, CFG, sai_ret);
+    }
+
+    state.bound.erase(ndi_priority_group_id);
+    if (buffer_profile_id != NDI_QOS_NULL_OBJECT_ID) {
+        try {
+            state.bound[ndi_priority_group_id] = buffer_profile_id;
+        } catch (std::bad_alloc &) {
+            // bound, just not remembered
+        }
+    }
+    return STD_ERR_OK;
+}
+
  /**
   * This function sets the priority_group profile attributes in the NPU.
   * @param ndi_port_id
@@ -49,8 +141,6 @@ t_std_error ndi_qos_set_priority_group_buffer_profile_id(ndi_port_t ndi_port_id,
                                         ndi_obj_id_t ndi_priority_group_id,
                                         ndi_obj_id_t buffer_profile_id)
 {
-    sai_status_t sai_ret = SAI_STATUS_FAILURE;
-
     nas_ndi_db_t *ndi_db_ptr = ndi_db_ptr_get(ndi_port_id.npu_id);
     if (ndi_db_ptr == NULL) {
         EV_LOGGING(NDI, DEBUG, "NDI-QOS",
@@ -58,21 +148,132 @@ t_std_error ndi_qos_set_priority_group_buffer_profile_id(ndi_port_t ndi_port_id,
         return STD_ERR(QOS, CFG, 0);
     }
 
-    sai_attribute_t sai_attr = {0};
-    sai_attr.id = SAI_INGRESS_PRIORITY_GROUP_ATTR_BUFFER_PROFILE;
-    sai_attr.value.oid = ndi2sai_buffer_profile_id(buffer_profile_id);
+    t_std_error rc = _ndi_qos_pg_port_check(ndi_port_id.npu_id, ndi_port_id.npu_port,
+                                            ndi_priority_group_id);
+    if (rc != STD_ERR_OK)
+        return rc;
+
+    std_mutex_simple_lock_guard g(&pg_bind_lock);
+    ndi_qos_port_pg_state_t spare;
+    return _ndi_qos_pg_bind(ndi_db_ptr, ndi_port_id.npu_id, ndi_priority_group_id,
+                            buffer_profile_id,
+                            _ndi_qos_port_pg_state_get(ndi_port_id.npu_id,
+                                                       ndi_port_id.npu_port, spare));
+}
 
-    if ((sai_ret = ndi_sai_qos_buffer_api(ndi_db_ptr)->
-            set_ingress_priority_group_attr(
-                    ndi2sai_priority_group_id(ndi_priority_group_id),
-                    &sai_attr))
-                         != SAI_STATUS_SUCCESS) {
-        EV_LOGGING(NDI, NOTICE, "NDI-QOS",
-                      "npu_id %d priority_group profile set failed\n", ndi_port_id.npu_id);
-        return STD_ERR(QOS, CFG, sai_ret);
+t_std_error ndi_qos_pg_buffer_profile_bind_bulk(npu_id_t npu_id,
+                                                const ndi_qos_pg_binding_t *binding_list,
+                                                size_t count,
+                                                t_std_error *status,
+                                                ndi_qos_pg_binding_stats_t *stats)
+{
+    nas_ndi_db_t *ndi_db_ptr = ndi_db_ptr_get(npu_id);
+    if (ndi_db_ptr == NULL) {
+        EV_LOGGING(NDI, DEBUG, "NDI-QOS",
+                      "npu_id %d not exist\n", npu_id);
+        return STD_ERR(QOS, CFG, 0);
     }
 
-    return STD_ERR_OK;
+    if (count != 0 && binding_list == NULL) {
+        return STD_ERR(QOS, PARAM, 0);
+    }
+
+    ndi_qos_bind_batch_result_t res = {STD_ERR_OK};
+    std::vector<size_t> order;
+    try {
+        order.resize(count);
+    } catch (std::bad_alloc &) {
+        return STD_ERR(QOS, NOMEM, 0);
+    }
+    for (size_t ix = 0; ix < count; ++ix) {
+        order[ix] = ix;
+    }
+
+    std_mutex_simple_lock_guard g(&pg_bind_lock);
+
+    ndi_qos_bind_batch(order,
+        [binding_list](size_t l, size_t r) {
+            if (binding_list[l].port_id != binding_list[r].port_id)
+                return binding_list[l].port_id < binding_list[r].port_id;
+            return binding_list[l].pg_id < binding_list[r].pg_id;
+        },
+        [binding_list](size_t l, size_t r) {
+            return binding_list[l].port_id == binding_list[r].port_id &&
+                   binding_list[l].pg_id == binding_list[r].pg_id;
+        },
+        [binding_list, ndi_db_ptr, npu_id](size_t ix, bool *skipped) {
+            const ndi_qos_pg_binding_t &b = binding_list[ix];
+            t_std_error rc = _ndi_qos_pg_port_check(npu_id, b.port_id, b.pg_id);
+            if (rc != STD_ERR_OK)
+                return rc;
+
+            ndi_qos_port_pg_state_t spare;
+            ndi_qos_port_pg_state_t &state = _ndi_qos_port_pg_state_get(npu_id, b.port_id, spare);
+            auto cur = state.bound.find(b.pg_id);
+            if (cur != state.bound.end() && cur->second == b.buffer_profile_id) {
+                *skipped = true;
+                return STD_ERR_OK;
+            }
+            return _ndi_qos_pg_bind(ndi_db_ptr, npu_id, b.pg_id, b.buffer_profile_id, state);
+        },
+        status, res);
+
+    EV_LOGGING(NDI, INFO, "NDI-QOS",
+            "priority group binding: npu_id %u, %u bindings, %" PRIu64 " set, %" PRIu64 " skipped\n",
+            npu_id, (uint_t)count, res.set, res.skipped);
+
+    if (stats != NULL) {
+        stats->bindings_set += res.set;
+        stats->bindings_skipped += res.skipped;
+        stats->bindings_failed += res.failed;
+    }
+
+    return res.rc;
+}
+
+void ndi_qos_pg_headroom_notify_register(ndi_qos_pg_headroom_update_fn fn)
+{
+    std_mutex_simple_lock_guard g(&pg_bind_lock);
+    g_pg_headroom_cb = fn;
+}
+
+void ndi_qos_pg_port_speed_changed(npu_id_t npu_id, npu_port_t port_id, BASE_IF_SPEED_t speed)
+{
+    ndi_qos_pg_headroom_update_fn cb = NULL;
+    std::vector<ndi_qos_pg_binding_t> binding_list;
+
+    {
+        std_mutex_simple_lock_guard g(&pg_bind_lock);
+        auto state = g_port_pg_state.find(std::make_pair(npu_id, port_id));
+        cb = g_pg_headroom_cb;
+        if (cb == NULL || state == g_port_pg_state.end() || state->second.bound.empty()) {
+            return;
+        }
+        try {
+            binding_list.reserve(state->second.bound.size());
+            for (auto &it : state->second.bound) {
+                binding_list.push_back({port_id, it.first, it.second});
+            }
+        } catch (std::bad_alloc &) {
+            EV_LOGGING(NDI, NOTICE, "NDI-QOS",
+                    "npu_id %u port %u speed change not reported, out of memory\n",
+                    npu_id, port_id);
+            return;
+        }
+    }
+
+    EV_LOGGING(NDI, INFO, "NDI-QOS",
+            "npu_id %u port %u speed changed, %u priority groups to check\n",
+            npu_id, port_id, (uint_t)binding_list.size());
+
+    // outside of the lock, the callback may bind the priority groups again
+    cb(npu_id, port_id, speed, &binding_list[0], binding_list.size());
+}
+
+void ndi_qos_pg_binding_cache_port_delete(npu_id_t npu_id, npu_port_t port_id)
+{
+    std_mutex_simple_lock_guard g(&pg_bind_lock);
+    g_port_pg_state.erase(std::make_pair(npu_id, port_id));
 }
 
 static t_std_error _fill_ndi_qos_priority_group_struct(sai_attribute_t *attr_list,
@@ -156,45 +357,21 @@ uint_t ndi_qos_get_priority_group_id_list(ndi_port_t ndi_port_id,
                                 ndi_obj_id_t *ndi_priority_group_id_list)
 {
     /* get priority_group list */
-    nas_ndi_db_t *ndi_db_ptr = ndi_db_ptr_get(ndi_port_id.npu_id);
-    if (ndi_db_ptr == NULL) {
-        EV_LOGGING(NDI, DEBUG, "NDI-QOS",
-                      "npu_id %d not exist\n", ndi_port_id.npu_id);
-
-        return 0;
-    }
-
-    sai_attribute_t sai_attr;
-    std::vector<sai_object_id_t> sai_priority_group_id_list(count);
-
-    sai_attr.id = SAI_PORT_ATTR_PRIORITY_GROUP_LIST;
-    sai_attr.value.objlist.count = count;
-    sai_attr.value.objlist.list = &sai_priority_group_id_list[0];
-
-    sai_object_id_t sai_port;
-    if (ndi_sai_port_id_get(ndi_port_id.npu_id, ndi_port_id.npu_port, &sai_port) != STD_ERR_OK) {
+    ndi_qos_port_topology_ptr_t topo = ndi_qos_port_topology_get(ndi_port_id);
+    if (topo == nullptr) {
         return 0;
     }
 
-    sai_status_t sai_ret = SAI_STATUS_FAILURE;
-    sai_ret = ndi_sai_qos_port_api(ndi_db_ptr)->
-                        get_port_attribute(sai_port,
-                                    1, &sai_attr);
+    const std::vector<ndi_obj_id_t> &id_list = topo->pg_list;
 
-    if (sai_ret != SAI_STATUS_SUCCESS  &&
-        sai_ret != SAI_STATUS_BUFFER_OVERFLOW) {
-        return 0;
-    }
-
-    // copy out sai-returned priority_group ids to nas
+    // copy out cached priority_group ids to nas
     if (ndi_priority_group_id_list) {
-        for (uint_t i = 0; (i< sai_attr.value.objlist.count) && (i < count); i++) {
-            ndi_priority_group_id_list[i] = sai2ndi_priority_group_id(sai_attr.value.objlist.list[i]);
+        for (uint_t i = 0; (i< id_list.size()) && (i < count); i++) {
+            ndi_priority_group_id_list[i] = id_list[i];
         }
     }
 
-    return sai_attr.value.objlist.count;
-
+    return id_list.size();
 }
 
 
@@ -245,6 +422,22 @@ static void _fill_counter_stat_by_type(sai_ingress_priority_group_stat_t type, u
 }
 
 
+/* Occupancy and watermark counters report a level, not a count */
+static bool _is_gauge_counter(BASE_QOS_PRIORITY_GROUP_STAT_t counter_id)
+{
+    switch(counter_id) {
+    case BASE_QOS_PRIORITY_GROUP_STAT_CURRENT_OCCUPANCY_BYTES:
+    case BASE_QOS_PRIORITY_GROUP_STAT_WATERMARK_BYTES:
+    case BASE_QOS_PRIORITY_GROUP_STAT_SHARED_CURRENT_OCCUPANCY_BYTES:
+    case BASE_QOS_PRIORITY_GROUP_STAT_SHARED_WATERMARK_BYTES:
+    case BASE_QOS_PRIORITY_GROUP_STAT_XOFF_ROOM_CURRENT_OCCUPANCY_BYTES:
+    case BASE_QOS_PRIORITY_GROUP_STAT_XOFF_ROOM_WATERMARK_BYTES:
+        return true;
+    default:
+        return false;
+    }
+}
+
 /**
  * This function gets the priority_group statistics
  * @param ndi_port_id
@@ -268,6 +461,9 @@ t_std_error ndi_qos_get_priority_group_stats(ndi_port_t ndi_port_id,
         return STD_ERR(QOS, CFG, 0);
     }
 
+    if (number_of_counters == 0)
+        return STD_ERR_OK;
+
     std::vector<sai_ingress_priority_group_stat_t> counter_id_list;
     std::vector<uint64_t> counters(number_of_counters);
 
@@ -286,6 +482,11 @@ t_std_error ndi_qos_get_priority_group_stats(ndi_port_t ndi_port_id,
         return STD_ERR(QOS, CFG, sai_ret);
     }
 
+    std::vector<uint64_t> stat_ids(counter_ids, counter_ids + number_of_counters);
+    ndi_stat_baseline_apply(NDI_STAT_OBJ_PRIORITY_GROUP, ndi_port_id.npu_id,
+                            ndi_priority_group_id, stat_ids.data(), counters.data(),
+                            number_of_counters);
+
     // copy the stats out
     for (uint i= 0; i<number_of_counters; i++) {
         _fill_counter_stat_by_type(counter_id_list[i], counters[i], stats);
@@ -316,20 +517,52 @@ t_std_error ndi_qos_clear_priority_group_stats(ndi_port_t ndi_port_id,
     }
 
     std::vector<sai_ingress_priority_group_stat_t> counter_id_list;
-    std::vector<uint64_t> counters(number_of_counters);
+    std::vector<sai_ingress_priority_group_stat_t> gauge_id_list;
+    std::vector<uint64_t> stat_ids;
 
+    // cumulative counters are cleared against a software baseline, only
+    // the gauges are reset in hardware
     for (uint_t i= 0; i<number_of_counters; i++) {
-        counter_id_list.push_back(nas2sai_priority_group_counter_type.at(counter_ids[i]));
+        if (_is_gauge_counter(counter_ids[i])) {
+            gauge_id_list.push_back(nas2sai_priority_group_counter_type.at(counter_ids[i]));
+        } else {
+            counter_id_list.push_back(nas2sai_priority_group_counter_type.at(counter_ids[i]));
+            stat_ids.push_back(counter_ids[i]);
+        }
     }
-    if ((sai_ret = ndi_sai_qos_buffer_api(ndi_db_ptr)->
-                        clear_ingress_priority_group_stats(ndi2sai_priority_group_id(ndi_priority_group_id),
-                                &counter_id_list[0],
-                                number_of_counters))
-                         != SAI_STATUS_SUCCESS) {
-        EV_LOGGING(NDI, NOTICE, "NDI-QOS",
-                "priority_group clear stats fails: npu_id %u\n",
-                ndi_port_id.npu_id);
-        return STD_ERR(QOS, CFG, sai_ret);
+
+    if (counter_id_list.size() > 0) {
+        std::vector<uint64_t> counters(counter_id_list.size());
+        if ((sai_ret = ndi_sai_qos_buffer_api(ndi_db_ptr)->
+                            get_ingress_priority_group_stats(ndi2sai_priority_group_id(ndi_priority_group_id),
+                                    &counter_id_list[0],
+                                    counter_id_list.size(),
+                                    &counters[0]))
+                             != SAI_STATUS_SUCCESS) {
+            EV_LOGGING(NDI, NOTICE, "NDI-QOS",
+                    "priority_group clear stats fails: npu_id %u\n",
+                    ndi_port_id.npu_id);
+            return STD_ERR(QOS, CFG, sai_ret);
+        }
+        t_std_error rc = ndi_stat_baseline_set(NDI_STAT_OBJ_PRIORITY_GROUP, ndi_port_id.npu_id,
+                                               ndi_priority_group_id, &ndi_port_id,
+                                               stat_ids.data(), counters.data(), stat_ids.size());
+        if (rc != STD_ERR_OK) {
+            return rc;
+        }
+    }
+
+    if (gauge_id_list.size() > 0) {
+        if ((sai_ret = ndi_sai_qos_buffer_api(ndi_db_ptr)->
+                            clear_ingress_priority_group_stats(ndi2sai_priority_group_id(ndi_priority_group_id),
+                                    &gauge_id_list[0],
+                                    gauge_id_list.size()))
+                             != SAI_STATUS_SUCCESS) {
+            EV_LOGGING(NDI, NOTICE, "NDI-QOS",
+                    "priority_group clear stats fails: npu_id %u\n",
+                    ndi_port_id.npu_id);
+            return STD_ERR(QOS, CFG, sai_ret);
+        }
     }
 
     return STD_ERR_OK;
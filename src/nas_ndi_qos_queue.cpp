@@ -23,51 +23,127 @@
 #include "nas_ndi_int.h"
 #include "nas_ndi_utils.h"
 #include "nas_ndi_qos_utl.h"
+#include "nas_ndi_qos_topology.h"
+#include "nas_ndi_qos_queue_binding.h"
+#include "nas_ndi_qos_bind_batch.h"
+#include "nas_ndi_stat_baseline.h"
 #include "sai.h"
 #include "dell-base-qos.h" //from yang model
 #include "nas_ndi_qos.h"
 #include "nas_ndi_switch.h"
+#include "std_mutex_lock.h"
 
 #include <stdio.h>
+#include <inttypes.h>
+#include <algorithm>
+#include <map>
+#include <new>
 #include <vector>
 #include <unordered_map>
 
 
-/**
- * This function set queue attribute
- * @param ndi_port_id
- * @param ndi_queue_id
- * @param wred_id
- * @return standard error
+/*  SAI attribute of each binding kind */
+static const struct {
+    sai_queue_attr_t sai_id;
+    sai_object_id_t (*to_sai)(ndi_obj_id_t);
+} ndi_qos_queue_bind_attr[NDI_QOS_QUEUE_BIND_MAX] = {
+    {SAI_QUEUE_ATTR_WRED_PROFILE_ID,
+        [](ndi_obj_id_t id) -> sai_object_id_t { return ndi2sai_wred_profile_id(id); }},
+    {SAI_QUEUE_ATTR_SCHEDULER_PROFILE_ID,
+        [](ndi_obj_id_t id) -> sai_object_id_t { return ndi2sai_scheduler_profile_id(id); }},
+    {SAI_QUEUE_ATTR_BUFFER_PROFILE_ID,
+        [](ndi_obj_id_t id) -> sai_object_id_t { return ndi2sai_buffer_profile_id(id); }},
+};
+
+/*  Profiles NDI last bound to a queue */
+typedef struct _ndi_qos_queue_bound_t {
+    ndi_obj_id_t profile_id[NDI_QOS_QUEUE_BIND_MAX];
+    uint_t valid;                   // bit per ndi_qos_queue_bind_kind_t
+} ndi_qos_queue_bound_t;
+
+static std_mutex_lock_create_static_init_rec(queue_bind_lock);
+static std::map<std::pair<npu_id_t, npu_port_t>,
+                std::unordered_map<ndi_obj_id_t, ndi_qos_queue_bound_t>> g_queue_bound;
+
+/*  Binding record of a queue, spare if it can't be allocated: the queue is
+ *  still bound, its binding just isn't remembered
  */
-t_std_error ndi_qos_set_queue_wred_id(ndi_port_t ndi_port_id,
-                                    ndi_obj_id_t ndi_queue_id,
-                                    ndi_obj_id_t wred_id)
+static ndi_qos_queue_bound_t & _ndi_qos_queue_bound_get(npu_id_t npu_id, npu_port_t port_id,
+                                                        ndi_obj_id_t ndi_queue_id,
+                                                        ndi_qos_queue_bound_t &spare)
 {
-    sai_status_t sai_ret = SAI_STATUS_FAILURE;
-    nas_ndi_db_t *ndi_db_ptr = ndi_db_ptr_get(ndi_port_id.npu_id);
-    if (ndi_db_ptr == NULL) {
-        EV_LOGGING(NDI, DEBUG, "NDI-QOS",
-                      "npu_id %d not exist\n", ndi_port_id.npu_id);
-        return STD_ERR(QOS, CFG, 0);
+    try {
+        return g_queue_bound[std::make_pair(npu_id, port_id)][ndi_queue_id];
+    } catch (std::bad_alloc &) {
+        EV_LOGGING(NDI, NOTICE, "NDI-QOS",
+                "queue 0x%" PRIx64 " binding not cached, out of memory\n", ndi_queue_id);
     }
+    spare = ndi_qos_queue_bound_t();
+    return spare;
+}
 
+/*  Bind a queue and record the binding, queue_bind_lock held */
+static t_std_error _ndi_qos_queue_bind(nas_ndi_db_t *ndi_db_ptr, npu_id_t npu_id,
+                                       ndi_obj_id_t ndi_queue_id,
+                                       ndi_qos_queue_bind_kind_t kind,
+                                       ndi_obj_id_t profile_id,
+                                       ndi_qos_queue_bound_t &bound)
+{
+    sai_status_t sai_ret = SAI_STATUS_FAILURE;
     sai_attribute_t attr = {0};
-    attr.id = SAI_QUEUE_ATTR_WRED_PROFILE_ID;
-    attr.value.oid = ndi2sai_wred_profile_id(wred_id);
+    attr.id = ndi_qos_queue_bind_attr[kind].sai_id;
+    attr.value.oid = ndi_qos_queue_bind_attr[kind].to_sai(profile_id);
 
     if ((sai_ret = ndi_sai_qos_queue_api(ndi_db_ptr)->
                         set_queue_attribute(ndi2sai_queue_id(ndi_queue_id), &attr))
                          != SAI_STATUS_SUCCESS) {
         EV_LOGGING(NDI, NOTICE, "NDI-QOS",
                 "queue set fails: npu_id %u\n",
-                ndi_port_id.npu_id);
+                npu_id);
+        // the binding in the NPU is not known anymore
+        bound.valid &= ~(1u << kind);
         return STD_ERR(QOS, CFG, sai_ret);
     }
 
+    bound.profile_id[kind] = profile_id;
+    bound.valid |= (1u << kind);
     return STD_ERR_OK;
 }
 
+static t_std_error _ndi_qos_set_queue_binding(ndi_port_t ndi_port_id,
+                                              ndi_obj_id_t ndi_queue_id,
+                                              ndi_qos_queue_bind_kind_t kind,
+                                              ndi_obj_id_t profile_id)
+{
+    nas_ndi_db_t *ndi_db_ptr = ndi_db_ptr_get(ndi_port_id.npu_id);
+    if (ndi_db_ptr == NULL) {
+        EV_LOGGING(NDI, DEBUG, "NDI-QOS",
+                      "npu_id %d not exist\n", ndi_port_id.npu_id);
+        return STD_ERR(QOS, CFG, 0);
+    }
+
+    std_mutex_simple_lock_guard g(&queue_bind_lock);
+    ndi_qos_queue_bound_t spare;
+    return _ndi_qos_queue_bind(ndi_db_ptr, ndi_port_id.npu_id, ndi_queue_id, kind, profile_id,
+                               _ndi_qos_queue_bound_get(ndi_port_id.npu_id, ndi_port_id.npu_port,
+                                                        ndi_queue_id, spare));
+}
+
+/**
+ * This function set queue attribute
+ * @param ndi_port_id
+ * @param ndi_queue_id
+ * @param wred_id
+ * @return standard error
+ */
+t_std_error ndi_qos_set_queue_wred_id(ndi_port_t ndi_port_id,
+                                    ndi_obj_id_t ndi_queue_id,
+                                    ndi_obj_id_t wred_id)
+{
+    return _ndi_qos_set_queue_binding(ndi_port_id, ndi_queue_id,
+                                      NDI_QOS_QUEUE_BIND_WRED, wred_id);
+}
+
 /**
  * This function set queue attribute
  * @param ndi_port_id
@@ -79,28 +155,8 @@ t_std_error ndi_qos_set_queue_buffer_profile_id(ndi_port_t ndi_port_id,
                                     ndi_obj_id_t ndi_queue_id,
                                     ndi_obj_id_t buffer_profile_id)
 {
-    sai_status_t sai_ret = SAI_STATUS_FAILURE;
-    nas_ndi_db_t *ndi_db_ptr = ndi_db_ptr_get(ndi_port_id.npu_id);
-    if (ndi_db_ptr == NULL) {
-        EV_LOGGING(NDI, DEBUG, "NDI-QOS",
-                      "npu_id %d not exist\n", ndi_port_id.npu_id);
-        return STD_ERR(QOS, CFG, 0);
-    }
-
-    sai_attribute_t attr = {0};
-    attr.id = SAI_QUEUE_ATTR_BUFFER_PROFILE_ID;
-    attr.value.oid = ndi2sai_buffer_profile_id(buffer_profile_id);
-
-    if ((sai_ret = ndi_sai_qos_queue_api(ndi_db_ptr)->
-                        set_queue_attribute(ndi2sai_queue_id(ndi_queue_id), &attr))
-                         != SAI_STATUS_SUCCESS) {
-        EV_LOGGING(NDI, NOTICE, "NDI-QOS",
-                "queue set fails: npu_id %u\n",
-                ndi_port_id.npu_id);
-        return STD_ERR(QOS, CFG, sai_ret);
-    }
-
-    return STD_ERR_OK;
+    return _ndi_qos_set_queue_binding(ndi_port_id, ndi_queue_id,
+                                      NDI_QOS_QUEUE_BIND_BUFFER_PROFILE, buffer_profile_id);
 }
 
 /**
@@ -114,28 +170,101 @@ t_std_error ndi_qos_set_queue_scheduler_profile_id(ndi_port_t ndi_port_id,
                                     ndi_obj_id_t ndi_queue_id,
                                     ndi_obj_id_t scheduler_profile_id)
 {
-    sai_status_t sai_ret = SAI_STATUS_FAILURE;
-    nas_ndi_db_t *ndi_db_ptr = ndi_db_ptr_get(ndi_port_id.npu_id);
+    return _ndi_qos_set_queue_binding(ndi_port_id, ndi_queue_id,
+                                      NDI_QOS_QUEUE_BIND_SCHEDULER, scheduler_profile_id);
+}
+
+t_std_error ndi_qos_queue_binding_set_bulk(npu_id_t npu_id,
+                                           const ndi_qos_queue_binding_t *binding_list,
+                                           size_t count,
+                                           t_std_error *status,
+                                           ndi_qos_queue_binding_stats_t *stats)
+{
+    nas_ndi_db_t *ndi_db_ptr = ndi_db_ptr_get(npu_id);
     if (ndi_db_ptr == NULL) {
         EV_LOGGING(NDI, DEBUG, "NDI-QOS",
-                      "npu_id %d not exist\n", ndi_port_id.npu_id);
+                      "npu_id %d not exist\n", npu_id);
         return STD_ERR(QOS, CFG, 0);
     }
 
-    sai_attribute_t attr = {0};
-    attr.id = SAI_QUEUE_ATTR_SCHEDULER_PROFILE_ID;
-    attr.value.oid = ndi2sai_scheduler_profile_id(scheduler_profile_id);
+    if (count != 0 && binding_list == NULL) {
+        return STD_ERR(QOS, PARAM, 0);
+    }
 
-    if ((sai_ret = ndi_sai_qos_queue_api(ndi_db_ptr)->
-                        set_queue_attribute(ndi2sai_queue_id(ndi_queue_id), &attr))
-                         != SAI_STATUS_SUCCESS) {
-        EV_LOGGING(NDI, NOTICE, "NDI-QOS",
-                "queue set fails: npu_id %u\n",
-                ndi_port_id.npu_id);
-        return STD_ERR(QOS, CFG, sai_ret);
+    ndi_qos_bind_batch_result_t res = {STD_ERR_OK};
+    std::vector<size_t> order;
+    try {
+        order.reserve(count);
+    } catch (std::bad_alloc &) {
+        return STD_ERR(QOS, NOMEM, 0);
+    }
+    for (size_t ix = 0; ix < count; ++ix) {
+        if ((uint_t)binding_list[ix].kind >= NDI_QOS_QUEUE_BIND_MAX) {
+            EV_LOGGING(NDI, DEBUG, "NDI-QOS",
+                          "queue binding kind %d not supported\n", binding_list[ix].kind);
+            ndi_qos_bind_batch_fail(res, ix, STD_ERR(QOS, PARAM, 0));
+            if (status != NULL)
+                status[ix] = STD_ERR(QOS, PARAM, 0);
+            continue;
+        }
+        order.push_back(ix);
     }
 
-    return STD_ERR_OK;
+    std_mutex_simple_lock_guard g(&queue_bind_lock);
+
+    ndi_qos_bind_batch(order,
+        [binding_list](size_t l, size_t r) {
+            if (binding_list[l].port_id != binding_list[r].port_id)
+                return binding_list[l].port_id < binding_list[r].port_id;
+            if (binding_list[l].queue_id != binding_list[r].queue_id)
+                return binding_list[l].queue_id < binding_list[r].queue_id;
+            return binding_list[l].kind < binding_list[r].kind;
+        },
+        [binding_list](size_t l, size_t r) {
+            return binding_list[l].port_id == binding_list[r].port_id &&
+                   binding_list[l].queue_id == binding_list[r].queue_id &&
+                   binding_list[l].kind == binding_list[r].kind;
+        },
+        [binding_list, ndi_db_ptr, npu_id](size_t ix, bool *skipped) {
+            const ndi_qos_queue_binding_t &q = binding_list[ix];
+            ndi_qos_queue_bound_t spare;
+            ndi_qos_queue_bound_t &bound = _ndi_qos_queue_bound_get(npu_id, q.port_id,
+                                                                    q.queue_id, spare);
+            if ((bound.valid & (1u << q.kind)) && bound.profile_id[q.kind] == q.profile_id) {
+                *skipped = true;
+                return STD_ERR_OK;
+            }
+            return _ndi_qos_queue_bind(ndi_db_ptr, npu_id, q.queue_id, q.kind,
+                                       q.profile_id, bound);
+        },
+        status, res);
+
+    EV_LOGGING(NDI, INFO, "NDI-QOS",
+            "queue binding: npu_id %u, %u bindings, %" PRIu64 " set, %" PRIu64 " skipped\n",
+            npu_id, (uint_t)count, res.set, res.skipped);
+
+    if (stats != NULL) {
+        stats->bindings_set += res.set;
+        stats->bindings_skipped += res.skipped;
+        stats->bindings_failed += res.failed;
+    }
+
+    return res.rc;
+}
+
+void ndi_qos_queue_binding_cache_flush(npu_id_t npu_id)
+{
+    std_mutex_simple_lock_guard g(&queue_bind_lock);
+    auto it = g_queue_bound.lower_bound(std::make_pair(npu_id, (npu_port_t)0));
+    while (it != g_queue_bound.end() && it->first.first == npu_id) {
+        it = g_queue_bound.erase(it);
+    }
+}
+
+void ndi_qos_queue_binding_cache_port_delete(npu_id_t npu_id, npu_port_t port_id)
+{
+    std_mutex_simple_lock_guard g(&queue_bind_lock);
+    g_queue_bound.erase(std::make_pair(npu_id, port_id));
 }
 
 /**
@@ -233,45 +362,21 @@ uint_t ndi_qos_get_queue_id_list(ndi_port_t ndi_port_id,
                                 ndi_obj_id_t *ndi_queue_id_list)
 {
     /* get queue list */
-    nas_ndi_db_t *ndi_db_ptr = ndi_db_ptr_get(ndi_port_id.npu_id);
-    if (ndi_db_ptr == NULL) {
-        EV_LOGGING(NDI, DEBUG, "NDI-QOS",
-                      "npu_id %d not exist\n", ndi_port_id.npu_id);
-
+    ndi_qos_port_topology_ptr_t topo = ndi_qos_port_topology_get(ndi_port_id);
+    if (topo == nullptr) {
         return 0;
     }
 
-    sai_attribute_t sai_attr;
-    std::vector<sai_object_id_t> sai_queue_id_list(count);
+    const std::vector<ndi_obj_id_t> &id_list = topo->queue_list;
 
-    sai_attr.id = SAI_PORT_ATTR_QOS_QUEUE_LIST;
-    sai_attr.value.objlist.count = count;
-    sai_attr.value.objlist.list = &sai_queue_id_list[0];
-
-    sai_object_id_t sai_port;
-    if (ndi_sai_port_id_get(ndi_port_id.npu_id, ndi_port_id.npu_port, &sai_port) != STD_ERR_OK) {
-        return 0;
-    }
-
-    sai_status_t sai_ret = SAI_STATUS_FAILURE;
-    sai_ret = ndi_sai_qos_port_api(ndi_db_ptr)->
-                        get_port_attribute(sai_port,
-                                    1, &sai_attr);
-
-    if (sai_ret != SAI_STATUS_SUCCESS  &&
-        sai_ret != SAI_STATUS_BUFFER_OVERFLOW) {
-        return 0;
-    }
-
-    // copy out sai-returned queue ids to nas
+    // copy out cached queue ids to nas
     if (ndi_queue_id_list) {
-        for (uint_t i = 0; (i< sai_attr.value.objlist.count) && (i < count); i++) {
-            ndi_queue_id_list[i] = sai2ndi_queue_id(sai_attr.value.objlist.list[i]);
+        for (uint_t i = 0; (i< id_list.size()) && (i < count); i++) {
+            ndi_queue_id_list[i] = id_list[i];
         }
     }
 
-    return sai_attr.value.objlist.count;
-
+    return id_list.size();
 }
 
 
@@ -401,6 +506,20 @@ static void _fill_counter_stat_by_type(sai_queue_stat_t type, uint64_t val,
 }
 
 
+/* Occupancy and watermark counters report a level, not a count */
+static bool _is_gauge_counter(BASE_QOS_QUEUE_STAT_t counter_id)
+{
+    switch(counter_id) {
+    case BASE_QOS_QUEUE_STAT_CURRENT_OCCUPANCY_BYTES:
+    case BASE_QOS_QUEUE_STAT_WATERMARK_BYTES:
+    case BASE_QOS_QUEUE_STAT_SHARED_CURRENT_OCCUPANCY_BYTES:
+    case BASE_QOS_QUEUE_STAT_SHARED_WATERMARK_BYTES:
+        return true;
+    default:
+        return false;
+    }
+}
+
 /**
  * This function gets the queue statistics
  * @param ndi_port_id
@@ -424,6 +543,9 @@ t_std_error ndi_qos_get_queue_stats(ndi_port_t ndi_port_id,
         return STD_ERR(QOS, CFG, 0);
     }
 
+    if (number_of_counters == 0)
+        return STD_ERR_OK;
+
     std::vector<sai_queue_stat_t> counter_id_list;
     std::vector<uint64_t> counters(number_of_counters);
 
@@ -442,6 +564,10 @@ t_std_error ndi_qos_get_queue_stats(ndi_port_t ndi_port_id,
         return STD_ERR(QOS, CFG, sai_ret);
     }
 
+    std::vector<uint64_t> stat_ids(counter_ids, counter_ids + number_of_counters);
+    ndi_stat_baseline_apply(NDI_STAT_OBJ_QUEUE, ndi_port_id.npu_id,
+                            ndi_queue_id, stat_ids.data(), counters.data(), number_of_counters);
+
     // copy the stats out
     for (uint i= 0; i<number_of_counters; i++) {
         _fill_counter_stat_by_type(counter_id_list[i], counters[i], stats);
@@ -472,20 +598,52 @@ t_std_error ndi_qos_clear_queue_stats(ndi_port_t ndi_port_id,
     }
 
     std::vector<sai_queue_stat_t> counter_id_list;
-    std::vector<uint64_t> counters(number_of_counters);
+    std::vector<sai_queue_stat_t> gauge_id_list;
+    std::vector<uint64_t> stat_ids;
 
+    // cumulative counters are cleared against a software baseline, only
+    // the gauges are reset in hardware
     for (uint_t i= 0; i<number_of_counters; i++) {
-        counter_id_list.push_back(nas2sai_queue_counter_type.at(counter_ids[i]));
+        if (_is_gauge_counter(counter_ids[i])) {
+            gauge_id_list.push_back(nas2sai_queue_counter_type.at(counter_ids[i]));
+        } else {
+            counter_id_list.push_back(nas2sai_queue_counter_type.at(counter_ids[i]));
+            stat_ids.push_back(counter_ids[i]);
+        }
     }
-    if ((sai_ret = ndi_sai_qos_queue_api(ndi_db_ptr)->
-                        clear_queue_stats(ndi2sai_queue_id(ndi_queue_id),
-                                &counter_id_list[0],
-                                number_of_counters))
-                         != SAI_STATUS_SUCCESS) {
-        EV_LOGGING(NDI, NOTICE, "NDI-QOS",
-                "queue clear stats fails: npu_id %u\n",
-                ndi_port_id.npu_id);
-        return STD_ERR(QOS, CFG, sai_ret);
+
+    if (counter_id_list.size() > 0) {
+        std::vector<uint64_t> counters(counter_id_list.size());
+        if ((sai_ret = ndi_sai_qos_queue_api(ndi_db_ptr)->
+                            get_queue_stats(ndi2sai_queue_id(ndi_queue_id),
+                                    &counter_id_list[0],
+                                    counter_id_list.size(),
+                                    &counters[0]))
+                             != SAI_STATUS_SUCCESS) {
+            EV_LOGGING(NDI, NOTICE, "NDI-QOS",
+                    "queue clear stats fails: npu_id %u\n",
+                    ndi_port_id.npu_id);
+            return STD_ERR(QOS, CFG, sai_ret);
+        }
+        t_std_error rc = ndi_stat_baseline_set(NDI_STAT_OBJ_QUEUE, ndi_port_id.npu_id,
+                                               ndi_queue_id, &ndi_port_id,
+                                               stat_ids.data(), counters.data(), stat_ids.size());
+        if (rc != STD_ERR_OK) {
+            return rc;
+        }
+    }
+
+    if (gauge_id_list.size() > 0) {
+        if ((sai_ret = ndi_sai_qos_queue_api(ndi_db_ptr)->
+                            clear_queue_stats(ndi2sai_queue_id(ndi_queue_id),
+                                    &gauge_id_list[0],
+                                    gauge_id_list.size()))
+                             != SAI_STATUS_SUCCESS) {
+            EV_LOGGING(NDI, NOTICE, "NDI-QOS",
+                    "queue clear stats fails: npu_id %u\n",
+                    ndi_port_id.npu_id);
+            return STD_ERR(QOS, CFG, sai_ret);
+        }
     }
 
     return STD_ERR_OK;
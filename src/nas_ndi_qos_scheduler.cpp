@@ -29,56 +29,94 @@
 
 #include <stdio.h>
 #include <vector>
-#include <unordered_map>
+
+
+typedef struct _ndi_qos_scheduler_attr_t {
+    nas_attr_id_t nas_id;
+    sai_attr_id_t sai_id;
+    void (*fill)(const qos_scheduler_struct_t *p, sai_attribute_value_t &v);
+} ndi_qos_scheduler_attr_t;
+
+// Only the following attributes are settable
+static const ndi_qos_scheduler_attr_t ndi_qos_scheduler_attr_list[] = {
+    {BASE_QOS_SCHEDULER_PROFILE_ALGORITHM,  SAI_SCHEDULER_ATTR_SCHEDULING_ALGORITHM,
+        [](const qos_scheduler_struct_t *p, sai_attribute_value_t &v) {
+            v.s32 = (p->algorithm == BASE_QOS_SCHEDULING_TYPE_SP?
+                        SAI_SCHEDULING_TYPE_STRICT:
+                        (p->algorithm == BASE_QOS_SCHEDULING_TYPE_WRR?
+                            SAI_SCHEDULING_TYPE_WRR:    SAI_SCHEDULING_TYPE_DWRR)); }},
+    {BASE_QOS_SCHEDULER_PROFILE_WEIGHT,     SAI_SCHEDULER_ATTR_SCHEDULING_WEIGHT,
+        [](const qos_scheduler_struct_t *p, sai_attribute_value_t &v) { v.u8 = p->weight; }},
+    {BASE_QOS_SCHEDULER_PROFILE_METER_TYPE, SAI_SCHEDULER_ATTR_SHAPER_TYPE,
+        [](const qos_scheduler_struct_t *p, sai_attribute_value_t &v) {
+            v.s32 = (p->meter_type == BASE_QOS_METER_TYPE_PACKET?
+                        SAI_METER_TYPE_PACKETS: SAI_METER_TYPE_BYTES); }},
+    {BASE_QOS_SCHEDULER_PROFILE_MIN_RATE,   SAI_SCHEDULER_ATTR_MIN_BANDWIDTH_RATE,
+        [](const qos_scheduler_struct_t *p, sai_attribute_value_t &v) { v.u64 = p->min_rate; }},
+    {BASE_QOS_SCHEDULER_PROFILE_MIN_BURST,  SAI_SCHEDULER_ATTR_MIN_BANDWIDTH_BURST_RATE,
+        [](const qos_scheduler_struct_t *p, sai_attribute_value_t &v) { v.u64 = p->min_burst; }},
+    {BASE_QOS_SCHEDULER_PROFILE_MAX_RATE,   SAI_SCHEDULER_ATTR_MAX_BANDWIDTH_RATE,
+        [](const qos_scheduler_struct_t *p, sai_attribute_value_t &v) { v.u64 = p->max_rate; }},
+    {BASE_QOS_SCHEDULER_PROFILE_MAX_BURST,  SAI_SCHEDULER_ATTR_MAX_BANDWIDTH_BURST_RATE,
+        [](const qos_scheduler_struct_t *p, sai_attribute_value_t &v) { v.u64 = p->max_burst; }},
+};
+
+static const ndi_qos_attr_tbl<ndi_qos_scheduler_attr_t>
+    ndi_qos_scheduler_attr_tbl(ndi_qos_scheduler_attr_list);
+
+#define NDI_QOS_SCHEDULER_ATTR_MAX  NDI_QOS_TBL_SIZE(ndi_qos_scheduler_attr_list)
 
 
 static t_std_error ndi_qos_fill_scheduler_attr(nas_attr_id_t attr_id,
                         const qos_scheduler_struct_t *p,
                         sai_attribute_t &sai_attr)
 {
-    // Only the following attributes are settable
-    if (attr_id == BASE_QOS_SCHEDULER_PROFILE_ALGORITHM) {
-        sai_attr.id = SAI_SCHEDULER_ATTR_SCHEDULING_ALGORITHM;
-        sai_attr.value.s32 = (p->algorithm == BASE_QOS_SCHEDULING_TYPE_SP?
-                                SAI_SCHEDULING_TYPE_STRICT:
-                                (p->algorithm == BASE_QOS_SCHEDULING_TYPE_WRR?
-                                    SAI_SCHEDULING_TYPE_WRR:    SAI_SCHEDULING_TYPE_DWRR));
-    }
-    else if (attr_id == BASE_QOS_SCHEDULER_PROFILE_WEIGHT) {
-        sai_attr.id = SAI_SCHEDULER_ATTR_SCHEDULING_WEIGHT;
-        sai_attr.value.u8 = p->weight;
-    }
-    else if (attr_id == BASE_QOS_SCHEDULER_PROFILE_METER_TYPE) {
-        sai_attr.id = SAI_SCHEDULER_ATTR_SHAPER_TYPE;
-        sai_attr.value.s32 = (p->meter_type == BASE_QOS_METER_TYPE_PACKET?
-                SAI_METER_TYPE_PACKETS: SAI_METER_TYPE_BYTES);
-    }
-    else if (attr_id == BASE_QOS_SCHEDULER_PROFILE_MIN_RATE) {
-        sai_attr.id = SAI_SCHEDULER_ATTR_MIN_BANDWIDTH_RATE;
-        sai_attr.value.u64 = p->min_rate;
-    }
-    else if (attr_id == BASE_QOS_SCHEDULER_PROFILE_MIN_BURST) {
-        sai_attr.id = SAI_SCHEDULER_ATTR_MIN_BANDWIDTH_BURST_RATE;
-        sai_attr.value.u64 = p->min_burst;
-    }
-    else if (attr_id == BASE_QOS_SCHEDULER_PROFILE_MAX_RATE) {
-        sai_attr.id = SAI_SCHEDULER_ATTR_MAX_BANDWIDTH_RATE;
-        sai_attr.value.u64 = p->max_rate;
-    }
-    else if (attr_id == BASE_QOS_SCHEDULER_PROFILE_MAX_BURST) {
-        sai_attr.id = SAI_SCHEDULER_ATTR_MAX_BANDWIDTH_BURST_RATE;
-        sai_attr.value.u64 = p->max_burst;
+    const ndi_qos_scheduler_attr_t *entry = ndi_qos_scheduler_attr_tbl.find(attr_id);
+    if (entry == NULL) {
+        EV_LOGGING(NDI, DEBUG, "NDI-QOS",
+                      "attr_id %u not supported\n", attr_id);
+        return STD_ERR(QOS, CFG, 0);
     }
 
+    sai_attr.id = entry->sai_id;
+    entry->fill(p, sai_attr.value);
+
     return STD_ERR_OK;
 }
 
+/*  Fill the SAI attributes of the attributes interpreted at ndi level */
+static t_std_error ndi_qos_fill_scheduler_attr_list(const nas_attr_id_t *nas_attr_list,
+                                    uint_t num_attr,
+                                    const qos_scheduler_struct_t *p,
+                                    sai_attribute_t *attr_list,
+                                    uint_t &count)
+{
+    count = 0;
+    for (uint_t i=0; i< num_attr; i++ ) {
+        if (nas_attr_list[i] == BASE_QOS_SCHEDULER_PROFILE_SWITCH_ID ||
+            nas_attr_list[i] == BASE_QOS_SCHEDULER_PROFILE_ID ||
+            nas_attr_list[i] == BASE_QOS_SCHEDULER_PROFILE_NPU_ID_LIST)
+            continue; // these attributes are not interpreted at ndi level
+
+        if (count >= NDI_QOS_SCHEDULER_ATTR_MAX)
+            return STD_ERR(QOS, CFG, 0);
+
+        if (ndi_qos_fill_scheduler_attr(nas_attr_list[i], p, attr_list[count])
+                != STD_ERR_OK)
+            return STD_ERR(QOS, CFG, 0);
+
+        count++;
+    }
+
+    return STD_ERR_OK;
+}
 
 
-static void _fill_ndi_qos_scheduler_info(const std::vector<sai_attribute_t> attr_list,
+static void _fill_ndi_qos_scheduler_info(const sai_attribute_t *attr_list, uint_t count,
                                         qos_scheduler_struct_t *p)
 {
-    for (auto attr: attr_list) {
+    for (uint_t i = 0; i < count; i++) {
+        const sai_attribute_t &attr = attr_list[i];
         switch (attr.id) {
         case SAI_SCHEDULER_ATTR_SCHEDULING_ALGORITHM:
             p->algorithm = (attr.value.s32 == SAI_SCHEDULING_TYPE_STRICT?
@@ -131,7 +169,8 @@ t_std_error ndi_qos_create_scheduler_profile(npu_id_t npu_id,
 {
     sai_status_t sai_ret = SAI_STATUS_FAILURE;
 
-    std::vector<sai_attribute_t>  sai_scheduler_attr_list;
+    sai_attribute_t sai_scheduler_attr_list[NDI_QOS_SCHEDULER_ATTR_MAX];
+    uint_t sai_attr_count = 0;
 
     nas_ndi_db_t *ndi_db_ptr = ndi_db_ptr_get(npu_id);
     if (ndi_db_ptr == NULL) {
@@ -140,26 +179,16 @@ t_std_error ndi_qos_create_scheduler_profile(npu_id_t npu_id,
         return STD_ERR(QOS, CFG, 0);
     }
 
-    sai_attribute_t sai_attr = {0};
-    std::vector<int32_t> list;
-    for (uint_t i=0; i< num_attr; i++ ) {
-        if (nas_attr_list[i] == BASE_QOS_SCHEDULER_PROFILE_SWITCH_ID ||
-            nas_attr_list[i] == BASE_QOS_SCHEDULER_PROFILE_ID ||
-            nas_attr_list[i] == BASE_QOS_SCHEDULER_PROFILE_NPU_ID_LIST)
-            continue; // these attributes are not interpreted at ndi level
-
-        if (ndi_qos_fill_scheduler_attr(nas_attr_list[i], p, sai_attr)
-                != STD_ERR_OK)
-            return STD_ERR(QOS, CFG, 0);
-
-        sai_scheduler_attr_list.push_back(sai_attr);
-    }
+    if (ndi_qos_fill_scheduler_attr_list(nas_attr_list, num_attr, p,
+                                         sai_scheduler_attr_list, sai_attr_count)
+            != STD_ERR_OK)
+        return STD_ERR(QOS, CFG, 0);
 
     sai_object_id_t sai_scheduler_id;
     if ((sai_ret = ndi_sai_qos_scheduler_api(ndi_db_ptr)->
                     create_scheduler_profile(&sai_scheduler_id,
-                                sai_scheduler_attr_list.size(),
-                                &sai_scheduler_attr_list[0]))
+                                sai_attr_count,
+                                sai_scheduler_attr_list))
                          != SAI_STATUS_SUCCESS) {
         return STD_ERR(QOS, CFG, sai_ret);
     }
@@ -255,22 +284,14 @@ t_std_error ndi_qos_get_scheduler_profile(npu_id_t npu_id,
 
 {
     sai_status_t sai_ret = SAI_STATUS_FAILURE;
-    std::vector<sai_attribute_t> attr_list;
-    sai_attribute_t sai_attr;
+    sai_attribute_t attr_list[NDI_QOS_SCHEDULER_ATTR_MAX];
+    uint_t attr_count = 0;
 
     // Fill the attribute flags
-    for (uint_t i=0; i< num_attr; i++ ) {
-        if (nas_attr_list[i] == BASE_QOS_SCHEDULER_PROFILE_SWITCH_ID ||
-            nas_attr_list[i] == BASE_QOS_SCHEDULER_PROFILE_ID ||
-            nas_attr_list[i] == BASE_QOS_SCHEDULER_PROFILE_NPU_ID_LIST)
-            continue; // these attributes are not interpreted at ndi level
-
-        if (ndi_qos_fill_scheduler_attr(nas_attr_list[i], p, sai_attr)
-                != STD_ERR_OK)
-            return STD_ERR(QOS, CFG, 0);
-
-        attr_list.push_back(sai_attr);
-    }
+    if (ndi_qos_fill_scheduler_attr_list(nas_attr_list, num_attr, p,
+                                         attr_list, attr_count)
+            != STD_ERR_OK)
+        return STD_ERR(QOS, CFG, 0);
 
     nas_ndi_db_t *ndi_db_ptr = ndi_db_ptr_get(npu_id);
     STD_ASSERT(ndi_db_ptr != NULL);
@@ -278,13 +299,13 @@ t_std_error ndi_qos_get_scheduler_profile(npu_id_t npu_id,
     if ((sai_ret = ndi_sai_qos_scheduler_api(ndi_db_ptr)->
                     get_scheduler_attribute(
                             ndi2sai_scheduler_profile_id(ndi_scheduler_id),
-                            attr_list.size(), &attr_list[0]))
+                            attr_count, attr_list))
             != SAI_STATUS_SUCCESS) {
         return STD_ERR(QOS, CFG, sai_ret);
     }
 
     //convert attr_list[] to qos_scheduler_struct_t
-    _fill_ndi_qos_scheduler_info(attr_list, p);
+    _fill_ndi_qos_scheduler_info(attr_list, attr_count, p);
 
     return STD_ERR_OK;
 
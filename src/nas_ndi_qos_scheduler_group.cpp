@@ -23,13 +23,17 @@
 #include "nas_ndi_int.h"
 #include "nas_ndi_utils.h"
 #include "nas_ndi_qos_utl.h"
+#include "nas_ndi_qos_topology.h"
 #include "sai.h"
 #include "dell-base-qos.h" //from yang model
 #include "nas_ndi_qos.h"
 
 #include <stdio.h>
 #include <vector>
+#include <map>
 #include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
 
 #define MAX_SCHEDULER_LEVEL 4
 
@@ -127,6 +131,12 @@ t_std_error ndi_qos_create_scheduler_group(npu_id_t npu_id,
         return STD_ERR(QOS, CFG, sai_ret);
     }
     *ndi_scheduler_group_id = sai2ndi_scheduler_group_id(sai_qos_sg_id);
+
+    for (uint_t i = 0; i < num_attr; i++) {
+        if (nas_attr_list[i] == BASE_QOS_SCHEDULER_GROUP_PORT_ID) {
+            ndi_qos_port_topology_port_delete(p->ndi_port.npu_id, p->ndi_port.npu_port);
+        }
+    }
     return STD_ERR_OK;
 
 }
@@ -197,6 +207,7 @@ t_std_error ndi_qos_delete_scheduler_group(npu_id_t npu_id,
         return STD_ERR(QOS, CFG, sai_ret);
     }
 
+    ndi_qos_port_topology_sg_invalidate(ndi_scheduler_group_id);
     return STD_ERR_OK;
 
 }
@@ -370,6 +381,8 @@ t_std_error ndi_qos_add_child_to_scheduler_group(npu_id_t npu_id,
         return STD_ERR(QOS, CFG, sai_ret);
     }
 
+    ndi_qos_port_topology_sg_child_update(ndi_scheduler_group_id, child_count,
+                                          ndi_child_list, true);
     return STD_ERR_OK;
 
 }
@@ -412,6 +425,8 @@ t_std_error ndi_qos_delete_child_from_scheduler_group(npu_id_t npu_id,
         return STD_ERR(QOS, CFG, sai_ret);
     }
 
+    ndi_qos_port_topology_sg_child_update(ndi_scheduler_group_id, child_count,
+                                          ndi_child_list, false);
     return STD_ERR_OK;
 
 }
@@ -423,34 +438,15 @@ t_std_error ndi_qos_delete_child_from_scheduler_group(npu_id_t npu_id,
  */
 uint_t ndi_qos_get_number_of_scheduler_groups(ndi_port_t ndi_port_id)
 {
-    nas_ndi_db_t *ndi_db_ptr = ndi_db_ptr_get(ndi_port_id.npu_id);
-    if (ndi_db_ptr == NULL) {
+    ndi_qos_port_topology_ptr_t topo = ndi_qos_port_topology_get(ndi_port_id);
+    if (topo == nullptr) {
         EV_LOGGING(NDI, DEBUG, "NDI-QOS",
-                      "npu_id %d not exist\n", ndi_port_id.npu_id);
-        return 0;
-    }
-
-    sai_attribute_t sai_attr;
-    sai_attr.id = SAI_PORT_ATTR_QOS_NUMBER_OF_SCHEDULER_GROUPS;
-
-    sai_object_id_t sai_port;
-    if (ndi_sai_port_id_get(ndi_port_id.npu_id, ndi_port_id.npu_port, &sai_port) != STD_ERR_OK) {
-        EV_LOGGING(NDI, DEBUG, "NDI-QOS",
-                      "Failed to find SAI port for npu_id %d port %d\n",
+                      "Failed to get QoS topology of npu_id %d port %d\n",
                       ndi_port_id.npu_id, ndi_port_id.npu_port);
         return 0;
     }
 
-    sai_status_t sai_ret = ndi_sai_qos_port_api(ndi_db_ptr)->get_port_attribute(sai_port,
-                                                                                1, &sai_attr);
-
-    if (sai_ret != SAI_STATUS_SUCCESS) {
-         EV_LOGGING(NDI, DEBUG, "NDI-QOS",
-                       "Failed to get port attribute\n");
-         return 0;
-    }
-
-    return sai_attr.value.u32;
+    return topo->sg_count;
 }
 
 /**
@@ -466,46 +462,261 @@ uint_t ndi_qos_get_scheduler_group_id_list(ndi_port_t ndi_port_id,
                                            ndi_obj_id_t *ndi_sg_id_list)
 {
     /* get scheduler-group list */
-    nas_ndi_db_t *ndi_db_ptr = ndi_db_ptr_get(ndi_port_id.npu_id);
-    if (ndi_db_ptr == NULL) {
-        EV_LOGGING(NDI, DEBUG, "NDI-QOS",
-                      "npu_id %d not exist\n", ndi_port_id.npu_id);
-
+    ndi_qos_port_topology_ptr_t topo = ndi_qos_port_topology_get(ndi_port_id);
+    if (topo == nullptr) {
         return 0;
     }
 
-    sai_attribute_t sai_attr;
-    std::vector<sai_object_id_t> sai_sg_id_list(count);
+    uint_t sg_count = topo->sg_list.size();
+    if (sg_count > count) {
+        // caller didn't provide enough buffer to store all IDs,
+        // only returns the count of IDs
+        return sg_count;
+    }
 
-    sai_attr.id = SAI_PORT_ATTR_QOS_SCHEDULER_GROUP_LIST;
-    sai_attr.value.objlist.count = count;
-    sai_attr.value.objlist.list = &sai_sg_id_list[0];
+    // copy out cached scheduler-group ids to nas
+    if (ndi_sg_id_list) {
+        for (uint_t i = 0; i < sg_count; i++) {
+            ndi_sg_id_list[i] = topo->sg_list[i].sg_id;
+        }
+    }
 
-    sai_object_id_t sai_port;
-    if (ndi_sai_port_id_get(ndi_port_id.npu_id, ndi_port_id.npu_port, &sai_port) != STD_ERR_OK) {
-        return 0;
+    return sg_count;
+}
+
+/*  Children to move for one scheduler group of a reconcile */
+struct ndi_qos_sg_child_diff_t {
+    ndi_obj_id_t sg_id;
+    uint32_t level;
+    std::vector<ndi_obj_id_t> detach;
+    std::vector<ndi_obj_id_t> attach;
+};
+
+static t_std_error ndi_qos_sg_tree_diff(const ndi_qos_port_topology_t &topo,
+                                        const ndi_qos_sg_children_t *desired,
+                                        size_t count,
+                                        std::vector<ndi_qos_sg_child_diff_t> &diff_list,
+                                        uint32_t &current_children)
+{
+    std::unordered_set<ndi_obj_id_t> seen_sg;
+    std::unordered_set<ndi_obj_id_t> seen_child;
+    std::unordered_map<ndi_obj_id_t, ndi_obj_id_t> parent_of;
+    std::map<ndi_obj_id_t, ndi_qos_sg_child_diff_t> unlisted;
+
+    for (size_t ix = 0; ix < count; ++ix) {
+        if (topo.sg_index.find(desired[ix].sg_id) == topo.sg_index.end() ||
+            !seen_sg.insert(desired[ix].sg_id).second) {
+            EV_LOGGING(NDI, NOTICE, "NDI-QOS",
+                       "Scheduler group 0x%016lx not on port or listed twice\n",
+                       desired[ix].sg_id);
+            return STD_ERR(QOS, PARAM, 0);
+        }
+    }
+    for (auto &node : topo.sg_list) {
+        for (auto child : node.child_list) {
+            parent_of[child] = node.sg_id;
+        }
     }
 
-    sai_status_t sai_ret = SAI_STATUS_FAILURE;
-    sai_ret = ndi_sai_qos_port_api(ndi_db_ptr)->
-                        get_port_attribute(sai_port,
-                                    1, &sai_attr);
+    current_children = 0;
+    for (size_t ix = 0; ix < count; ++ix) {
+        const ndi_qos_sg_children_t &entry = desired[ix];
+        const ndi_qos_sg_node_t &node = topo.sg_list[topo.sg_index.at(entry.sg_id)];
+        if (!node.children_valid) {
+            EV_LOGGING(NDI, NOTICE, "NDI-QOS",
+                       "Children of scheduler group 0x%016lx are not known\n",
+                       entry.sg_id);
+            return STD_ERR(QOS, CFG, 0);
+        }
 
-    if (sai_ret != SAI_STATUS_SUCCESS  &&
-        sai_ret != SAI_STATUS_BUFFER_OVERFLOW) {
-        return 0;
-    } else if (sai_ret == SAI_STATUS_BUFFER_OVERFLOW) {
-        // caller didn't provide enough buffer to store all IDs,
-        // only returns the count of IDs
-        return sai_attr.value.objlist.count;
+        std::unordered_set<ndi_obj_id_t> want;
+        for (uint32_t cx = 0; cx < entry.child_count; ++cx) {
+            if (!seen_child.insert(entry.child_list[cx]).second) {
+                EV_LOGGING(NDI, NOTICE, "NDI-QOS",
+                           "Child 0x%016lx given more than one parent\n",
+                           entry.child_list[cx]);
+                return STD_ERR(QOS, PARAM, 0);
+            }
+            want.insert(entry.child_list[cx]);
+        }
+
+        ndi_qos_sg_child_diff_t diff;
+        diff.sg_id = entry.sg_id;
+        diff.level = node.level;
+
+        std::unordered_set<ndi_obj_id_t> have(node.child_list.begin(), node.child_list.end());
+        for (auto child : node.child_list) {
+            if (want.find(child) == want.end()) {
+                diff.detach.push_back(child);
+            }
+        }
+        for (uint32_t cx = 0; cx < entry.child_count; ++cx) {
+            ndi_obj_id_t child = entry.child_list[cx];
+            if (have.find(child) != have.end()) {
+                continue;
+            }
+            diff.attach.push_back(child);
+
+            // a child still under a scheduler group that isn't listed is
+            // detached from it first, listed parents detach it themselves
+            auto parent = parent_of.find(child);
+            if (parent != parent_of.end() && seen_sg.find(parent->second) == seen_sg.end()) {
+                ndi_qos_sg_child_diff_t &old = unlisted[parent->second];
+                old.sg_id = parent->second;
+                old.level = topo.sg_list[topo.sg_index.at(parent->second)].level;
+                old.detach.push_back(child);
+                current_children++;
+            }
+        }
+        current_children += node.child_list.size();
+
+        if (!diff.detach.empty() || !diff.attach.empty()) {
+            diff_list.push_back(std::move(diff));
+        }
     }
+    for (auto &it : unlisted) {
+        diff_list.push_back(std::move(it.second));
+    }
+    return STD_ERR_OK;
+}
 
-    // copy out sai-returned scheduler-group ids to nas
-    if (ndi_sg_id_list) {
-        for (uint_t i = 0; i < sai_attr.value.objlist.count; i++) {
-            ndi_sg_id_list[i] = sai2ndi_scheduler_group_id(sai_attr.value.objlist.list[i]);
+/*  A child list call done by a reconcile, undone in reverse on failure */
+struct ndi_qos_sg_child_op_t {
+    ndi_obj_id_t sg_id;
+    bool attach;
+    const std::vector<ndi_obj_id_t> *children;
+};
+
+static t_std_error ndi_qos_sg_child_op_do(npu_id_t npu_id, const ndi_qos_sg_child_op_t &op,
+                                          bool undo)
+{
+    uint32_t count = op.children->size();
+    const ndi_obj_id_t *list = &(*op.children)[0];
+
+    if (op.attach != undo) {
+        return ndi_qos_add_child_to_scheduler_group(npu_id, op.sg_id, count, list);
+    }
+    return ndi_qos_delete_child_from_scheduler_group(npu_id, op.sg_id, count, list);
+}
+
+static t_std_error ndi_qos_sg_tree_apply(npu_id_t npu_id,
+                                         std::vector<ndi_qos_sg_child_diff_t> &diff_list,
+                                         ndi_qos_sg_reconcile_stats_t &st)
+{
+    std::vector<ndi_qos_sg_child_op_t> ops;
+    t_std_error rc = STD_ERR_OK;
+
+    try {
+        ops.reserve(2 * diff_list.size());
+    } catch (...) {
+        return STD_ERR(QOS, NOMEM, 0);
+    }
+    for (auto &diff : diff_list) {
+        if (!diff.detach.empty()) {
+            ops.push_back({diff.sg_id, false, &diff.detach});
+        }
+    }
+    for (auto it = diff_list.rbegin(); it != diff_list.rend(); ++it) {
+        if (!it->attach.empty()) {
+            ops.push_back({it->sg_id, true, &it->attach});
+        }
+    }
+
+    size_t done = 0;
+    for (; done < ops.size(); ++done) {
+        rc = ndi_qos_sg_child_op_do(npu_id, ops[done], false);
+        if (rc != STD_ERR_OK) {
+            break;
+        }
+        if (ops[done].attach) {
+            st.children_attached += ops[done].children->size();
+        } else {
+            st.children_detached += ops[done].children->size();
         }
+        st.sai_calls++;
+    }
+    if (rc == STD_ERR_OK) {
+        return STD_ERR_OK;
     }
 
-    return sai_attr.value.objlist.count;
+    // put back what was changed, last change first
+    while (done-- > 0) {
+        if (ndi_qos_sg_child_op_do(npu_id, ops[done], true) != STD_ERR_OK) {
+            EV_LOGGING(NDI, NOTICE, "NDI-QOS",
+                       "Failed to restore children of scheduler group 0x%016lx\n",
+                       ops[done].sg_id);
+        }
+    }
+    return rc;
+}
+
+t_std_error ndi_qos_port_sg_tree_reconcile(ndi_port_t ndi_port_id,
+                                           const ndi_qos_sg_children_t *desired,
+                                           size_t count,
+                                           ndi_qos_sg_reconcile_stats_t *stats)
+{
+    ndi_qos_sg_reconcile_stats_t st = {0};
+    if (stats != NULL) {
+        *stats = st;
+    }
+    if (desired == NULL && count != 0) {
+        return STD_ERR(QOS, PARAM, 0);
+    }
+
+    ndi_qos_port_topology_ptr_t topo = ndi_qos_port_topology_get(ndi_port_id);
+    if (topo == nullptr) {
+        EV_LOGGING(NDI, NOTICE, "NDI-QOS",
+                   "Failed to get QoS topology of npu_id %d port %d\n",
+                   ndi_port_id.npu_id, ndi_port_id.npu_port);
+        return STD_ERR(QOS, CFG, 0);
+    }
+
+    std::vector<ndi_qos_sg_child_diff_t> diff_list;
+    uint32_t current_children = 0;
+    uint32_t desired_children = 0;
+    t_std_error rc;
+
+    try {
+        rc = ndi_qos_sg_tree_diff(*topo, desired, count, diff_list, current_children);
+    } catch (...) {
+        rc = STD_ERR(QOS, NOMEM, 0);
+    }
+    if (rc != STD_ERR_OK) {
+        return rc;
+    }
+    for (size_t ix = 0; ix < count; ++ix) {
+        desired_children += desired[ix].child_count;
+    }
+
+    // leaves first when detaching, roots first when attaching
+    std::stable_sort(diff_list.begin(), diff_list.end(),
+                     [](const ndi_qos_sg_child_diff_t &a, const ndi_qos_sg_child_diff_t &b) {
+                         return a.level > b.level;
+                     });
+
+    rc = ndi_qos_sg_tree_apply(ndi_port_id.npu_id, diff_list, st);
+    if (rc != STD_ERR_OK) {
+        EV_LOGGING(NDI, NOTICE, "NDI-QOS",
+                   "npu_id %d port %d scheduler tree reconcile failed after %u SAI calls\n",
+                   ndi_port_id.npu_id, ndi_port_id.npu_port, st.sai_calls);
+        // changes made are rolled back, read the tree again in case a
+        // rollback failed too
+        ndi_qos_port_topology_port_delete(ndi_port_id.npu_id, ndi_port_id.npu_port);
+        if (stats != NULL) {
+            *stats = st;
+        }
+        return rc;
+    }
+
+    // a rebuild without the cache detaches and attaches every child one by one
+    st.sai_calls_saved = current_children + desired_children - st.sai_calls;
+    EV_LOGGING(NDI, INFO, "NDI-QOS",
+               "npu_id %d port %d scheduler tree: %u detached, %u attached, "
+               "%u SAI calls, %u saved\n",
+               ndi_port_id.npu_id, ndi_port_id.npu_port, st.children_detached,
+               st.children_attached, st.sai_calls, st.sai_calls_saved);
+    if (stats != NULL) {
+        *stats = st;
+    }
+    return STD_ERR_OK;
 }
@@ -0,0 +1,323 @@
+/*
+ * Copyright (c) 2016 Dell Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License. You may obtain
+ * a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * THIS CODE IS PROVIDED ON AN *AS IS* BASIS, WITHOUT WARRANTIES OR
+ * CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ * LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ * FOR A PARTICULAR PURPOSE, MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ * See the Apache Version 2.0 License for specific language governing
+ * permissions and limitations under the License.
+ */
+
+/*
+ * filename: nas_ndi_qos_topology.cpp
+ */
+
+#include "std_error_codes.h"
+#include "std_mutex_lock.h"
+#include "nas_ndi_event_logs.h"
+#include "nas_ndi_int.h"
+#include "nas_ndi_utils.h"
+#include "nas_ndi_qos_utl.h"
+#include "nas_ndi_qos_topology.h"
+#include "sai.h"
+
+#include <algorithm>
+
+/*  initial list size, lists found longer are read again at their size */
+#define NDI_QOS_TOPOLOGY_LIST_HINT      32
+
+static std::unordered_map<uint64_t, ndi_qos_port_topology_ptr_t> g_qos_topology;
+
+/*  scheduler group id to the key of the port topology holding it */
+static std::unordered_map<ndi_obj_id_t, uint64_t> g_qos_sg_owner;
+
+static std_mutex_lock_create_static_init_rec(qos_topology_lock);
+
+static inline uint64_t ndi_qos_topology_key(npu_id_t npu_id, npu_port_t port_id)
+{
+    return (((uint64_t)npu_id << 32) | port_id);
+}
+
+/*  Read object list attributes in one get, reading again if a list overflows */
+static sai_status_t ndi_qos_topology_objlists_get(sai_status_t (*get)(sai_object_id_t, uint32_t,
+                                                                      sai_attribute_t *),
+                                                  sai_object_id_t obj,
+                                                  const sai_attr_id_t *ids, size_t count,
+                                                  std::vector<sai_object_id_t> *lists,
+                                                  sai_attribute_t *extra)
+{
+    std::vector<sai_attribute_t> attr(count + (extra != NULL ? 1 : 0));
+    sai_status_t sai_ret = SAI_STATUS_FAILURE;
+
+    for (size_t ix = 0; ix < count; ++ix) {
+        if (lists[ix].empty()) {
+            lists[ix].resize(NDI_QOS_TOPOLOGY_LIST_HINT);
+        }
+    }
+
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        for (size_t ix = 0; ix < count; ++ix) {
+            attr[ix].id = ids[ix];
+            attr[ix].value.objlist.count = lists[ix].size();
+            attr[ix].value.objlist.list = &lists[ix][0];
+        }
+        if (extra != NULL) {
+            attr[count] = *extra;
+        }
+
+        sai_ret = get(obj, attr.size(), &attr[0]);
+        if (sai_ret == SAI_STATUS_BUFFER_OVERFLOW) {
+            for (size_t ix = 0; ix < count; ++ix) {
+                if (attr[ix].value.objlist.count > lists[ix].size()) {
+                    lists[ix].resize(attr[ix].value.objlist.count);
+                }
+            }
+            continue;
+        }
+        if (sai_ret == SAI_STATUS_SUCCESS) {
+            for (size_t ix = 0; ix < count; ++ix) {
+                lists[ix].resize(attr[ix].value.objlist.count);
+            }
+            if (extra != NULL) {
+                *extra = attr[count];
+            }
+        }
+        break;
+    }
+    return sai_ret;
+}
+
+/*  Number of queues, scheduler groups and priority groups of a port. A
+ *  count SAI can't answer is left unknown.
+ */
+static void ndi_qos_topology_counts_get(sai_status_t (*get)(sai_object_id_t, uint32_t,
+                                                            sai_attribute_t *),
+                                        sai_object_id_t sai_port, const sai_attr_id_t *ids,
+                                        size_t count, uint32_t *val, bool *known)
+{
+    std::vector<sai_attribute_t> attr(count);
+
+    for (size_t ix = 0; ix < count; ++ix) {
+        attr[ix].id = ids[ix];
+        attr[ix].value.u32 = 0;
+    }
+    if (get(sai_port, attr.size(), &attr[0]) == SAI_STATUS_SUCCESS) {
+        for (size_t ix = 0; ix < count; ++ix) {
+            val[ix] = attr[ix].value.u32;
+            known[ix] = true;
+        }
+        return;
+    }
+    for (size_t ix = 0; ix < count; ++ix) {
+        known[ix] = (get(sai_port, 1, &attr[ix]) == SAI_STATUS_SUCCESS);
+        val[ix] = known[ix] ? attr[ix].value.u32 : 0;
+    }
+}
+
+static t_std_error ndi_qos_topology_build(nas_ndi_db_t *ndi_db_ptr, sai_object_id_t sai_port,
+                                          ndi_qos_port_topology_t &topo)
+{
+    enum { QUEUE_LIST, SG_LIST, PG_LIST, LIST_MAX };
+    const sai_attr_id_t ids[LIST_MAX] = {
+        SAI_PORT_ATTR_QOS_QUEUE_LIST,
+        SAI_PORT_ATTR_QOS_SCHEDULER_GROUP_LIST,
+        SAI_PORT_ATTR_PRIORITY_GROUP_LIST,
+    };
+    const sai_attr_id_t count_ids[LIST_MAX] = {
+        SAI_PORT_ATTR_QOS_NUMBER_OF_QUEUES,
+        SAI_PORT_ATTR_QOS_NUMBER_OF_SCHEDULER_GROUPS,
+        SAI_PORT_ATTR_NUMBER_OF_PRIORITY_GROUPS,
+    };
+    std::vector<sai_object_id_t> lists[LIST_MAX];
+    uint32_t counts[LIST_MAX];
+    bool counts_known[LIST_MAX];
+
+    auto port_get = ndi_sai_qos_port_api(ndi_db_ptr)->get_port_attribute;
+
+    /*  not every port has every list (e.g. the CPU port has no PGs), a list
+     *  is only required when SAI reports a non zero count for it */
+    ndi_qos_topology_counts_get(port_get, sai_port, count_ids, LIST_MAX, counts, counts_known);
+    for (size_t ix = 0; ix < LIST_MAX; ++ix) {
+        if (counts_known[ix] && (counts[ix] > 0)) {
+            lists[ix].resize(counts[ix]);
+        }
+    }
+    topo.sg_count = counts[SG_LIST];
+
+    if (ndi_qos_topology_objlists_get(port_get, sai_port, ids, LIST_MAX, lists, NULL)
+            != SAI_STATUS_SUCCESS) {
+        for (size_t ix = 0; ix < LIST_MAX; ++ix) {
+            if (counts_known[ix] && (counts[ix] == 0)) {
+                lists[ix].clear();
+                continue;
+            }
+            if (ndi_qos_topology_objlists_get(port_get, sai_port, &ids[ix], 1, &lists[ix], NULL)
+                    == SAI_STATUS_SUCCESS) {
+                continue;
+            }
+            if (counts_known[ix]) {
+                EV_LOGGING(NDI, NOTICE, "NDI-QOS",
+                           "Failed to read QoS list %d of SAI port 0x%016lx with %u entries\n",
+                           (int)ids[ix], sai_port, counts[ix]);
+                return STD_ERR(QOS, FAIL, 0);
+            }
+            lists[ix].clear();
+        }
+    }
+
+    for (auto id : lists[QUEUE_LIST]) {
+        topo.queue_list.push_back(sai2ndi_queue_id(id));
+    }
+    for (auto id : lists[PG_LIST]) {
+        topo.pg_list.push_back(sai2ndi_priority_group_id(id));
+    }
+
+    auto sg_get = ndi_sai_qos_scheduler_group_api(ndi_db_ptr)->get_scheduler_group_attribute;
+    const sai_attr_id_t child_id = SAI_SCHEDULER_GROUP_ATTR_CHILD_LIST;
+
+    for (auto id : lists[SG_LIST]) {
+        ndi_qos_sg_node_t node;
+        std::vector<sai_object_id_t> child_list;
+        sai_attribute_t level;
+
+        level.id = SAI_SCHEDULER_GROUP_ATTR_LEVEL;
+        level.value.u32 = 0;
+
+        node.sg_id = sai2ndi_scheduler_group_id(id);
+        node.children_valid = (ndi_qos_topology_objlists_get(sg_get, id, &child_id, 1,
+                                                             &child_list, &level)
+                                    == SAI_STATUS_SUCCESS);
+        if (!node.children_valid) {
+            EV_LOGGING(NDI, NOTICE, "NDI-QOS",
+                       "Children of scheduler group 0x%016lx could not be read\n",
+                       node.sg_id);
+            child_list.clear();
+        }
+        node.level = level.value.u32;
+        for (auto child : child_list) {
+            node.child_list.push_back(child);
+        }
+
+        topo.sg_index[node.sg_id] = topo.sg_list.size();
+        topo.sg_list.push_back(std::move(node));
+    }
+    return STD_ERR_OK;
+}
+
+ndi_qos_port_topology_ptr_t ndi_qos_port_topology_get(ndi_port_t ndi_port_id)
+{
+    uint64_t key = ndi_qos_topology_key(ndi_port_id.npu_id, ndi_port_id.npu_port);
+
+    std_mutex_simple_lock_guard g(&qos_topology_lock);
+
+    auto it = g_qos_topology.find(key);
+    if (it != g_qos_topology.end()) {
+        return it->second;
+    }
+
+    nas_ndi_db_t *ndi_db_ptr = ndi_db_ptr_get(ndi_port_id.npu_id);
+    if (ndi_db_ptr == NULL) {
+        EV_LOGGING(NDI, DEBUG, "NDI-QOS",
+                      "npu_id %d not exist\n", ndi_port_id.npu_id);
+        return nullptr;
+    }
+
+    sai_object_id_t sai_port;
+    if (ndi_sai_port_id_get(ndi_port_id.npu_id, ndi_port_id.npu_port, &sai_port) != STD_ERR_OK) {
+        EV_LOGGING(NDI, DEBUG, "NDI-QOS",
+                      "Failed to find SAI port for npu_id %d port %d\n",
+                      ndi_port_id.npu_id, ndi_port_id.npu_port);
+        return nullptr;
+    }
+
+    try {
+        auto topo = std::make_shared<ndi_qos_port_topology_t>();
+        /*  a partly read topology is not cached, the next use reads again */
+        if (ndi_qos_topology_build(ndi_db_ptr, sai_port, *topo) != STD_ERR_OK) {
+            return nullptr;
+        }
+        for (auto &node : topo->sg_list) {
+            g_qos_sg_owner[node.sg_id] = key;
+        }
+        g_qos_topology[key] = topo;
+        return topo;
+    } catch (...) {
+        EV_LOGGING(NDI, NOTICE, "NDI-QOS",
+                   "Unable to cache QoS topology of npu_id %d port %d\n",
+                   ndi_port_id.npu_id, ndi_port_id.npu_port);
+    }
+    return nullptr;
+}
+
+/*  Caller holds qos_topology_lock */
+static void ndi_qos_topology_drop_locked(uint64_t key)
+{
+    auto it = g_qos_topology.find(key);
+    if (it == g_qos_topology.end()) {
+        return;
+    }
+    for (auto &node : it->second->sg_list) {
+        g_qos_sg_owner.erase(node.sg_id);
+    }
+    g_qos_topology.erase(it);
+}
+
+extern "C" {
+
+void ndi_qos_port_topology_sg_child_update(ndi_obj_id_t sg_id, uint32_t child_count,
+                                           const ndi_obj_id_t *child_list, bool add)
+{
+    std_mutex_simple_lock_guard g(&qos_topology_lock);
+
+    auto owner = g_qos_sg_owner.find(sg_id);
+    if (owner == g_qos_sg_owner.end()) {
+        return;
+    }
+    uint64_t key = owner->second;
+    auto it = g_qos_topology.find(key);
+    if (it == g_qos_topology.end()) {
+        return;
+    }
+
+    try {
+        auto topo = std::make_shared<ndi_qos_port_topology_t>(*it->second);
+        auto &children = topo->sg_list[topo->sg_index.at(sg_id)].child_list;
+
+        for (uint32_t ix = 0; ix < child_count; ++ix) {
+            auto pos = std::find(children.begin(), children.end(), child_list[ix]);
+            if (add && (pos == children.end())) {
+                children.push_back(child_list[ix]);
+            } else if (!add && (pos != children.end())) {
+                children.erase(pos);
+            }
+        }
+        it->second = topo;
+    } catch (...) {
+        /*  read from SAI again on next use */
+        ndi_qos_topology_drop_locked(key);
+    }
+}
+
+void ndi_qos_port_topology_sg_invalidate(ndi_obj_id_t sg_id)
+{
+    std_mutex_simple_lock_guard g(&qos_topology_lock);
+
+    auto owner = g_qos_sg_owner.find(sg_id);
+    if (owner != g_qos_sg_owner.end()) {
+        ndi_qos_topology_drop_locked(owner->second);
+    }
+}
+
+void ndi_qos_port_topology_port_delete(npu_id_t npu_id, npu_port_t port_id)
+{
+    std_mutex_simple_lock_guard g(&qos_topology_lock);
+    ndi_qos_topology_drop_locked(ndi_qos_topology_key(npu_id, port_id));
+}
+
+}
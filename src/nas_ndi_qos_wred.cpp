@@ -29,70 +29,64 @@
 
 #include <stdio.h>
 #include <vector>
-#include <unordered_map>
-
-
-const static std::unordered_map<nas_attr_id_t, sai_attr_id_t, std::hash<int>>
-    ndi2sai_wred_profile_attr_id_map = {
-    {BASE_QOS_WRED_PROFILE_GREEN_ENABLE,        SAI_WRED_ATTR_GREEN_ENABLE},
-    {BASE_QOS_WRED_PROFILE_GREEN_MIN_THRESHOLD, SAI_WRED_ATTR_GREEN_MIN_THRESHOLD},
-    {BASE_QOS_WRED_PROFILE_GREEN_MAX_THRESHOLD, SAI_WRED_ATTR_GREEN_MAX_THRESHOLD},
-    {BASE_QOS_WRED_PROFILE_GREEN_DROP_PROBABILITY,  SAI_WRED_ATTR_GREEN_DROP_PROBABILITY},
-    {BASE_QOS_WRED_PROFILE_YELLOW_ENABLE,           SAI_WRED_ATTR_YELLOW_ENABLE},
-    {BASE_QOS_WRED_PROFILE_YELLOW_MIN_THRESHOLD,    SAI_WRED_ATTR_YELLOW_MIN_THRESHOLD},
-    {BASE_QOS_WRED_PROFILE_YELLOW_MAX_THRESHOLD,    SAI_WRED_ATTR_YELLOW_MAX_THRESHOLD},
-    {BASE_QOS_WRED_PROFILE_YELLOW_DROP_PROBABILITY, SAI_WRED_ATTR_YELLOW_DROP_PROBABILITY},
-    {BASE_QOS_WRED_PROFILE_RED_ENABLE,              SAI_WRED_ATTR_RED_ENABLE},
-    {BASE_QOS_WRED_PROFILE_RED_MIN_THRESHOLD,       SAI_WRED_ATTR_RED_MIN_THRESHOLD},
-    {BASE_QOS_WRED_PROFILE_RED_MAX_THRESHOLD,       SAI_WRED_ATTR_RED_MAX_THRESHOLD},
-    {BASE_QOS_WRED_PROFILE_RED_DROP_PROBABILITY,    SAI_WRED_ATTR_RED_DROP_PROBABILITY},
-    {BASE_QOS_WRED_PROFILE_WEIGHT,        SAI_WRED_ATTR_WEIGHT},
-    {BASE_QOS_WRED_PROFILE_ECN_ENABLE,    SAI_WRED_ATTR_ECN_MARK_ENABLE},
+
+
+typedef struct _ndi_qos_wred_attr_t {
+    nas_attr_id_t nas_id;
+    sai_attr_id_t sai_id;
+    void (*fill)(const qos_wred_struct_t *p, sai_attribute_value_t &v);
+} ndi_qos_wred_attr_t;
+
+// Only the settable attributes are included
+static const ndi_qos_wred_attr_t ndi_qos_wred_attr_list[] = {
+    {BASE_QOS_WRED_PROFILE_GREEN_ENABLE,            SAI_WRED_ATTR_GREEN_ENABLE,
+        [](const qos_wred_struct_t *p, sai_attribute_value_t &v) { v.booldata = p->g_enable; }},
+    {BASE_QOS_WRED_PROFILE_GREEN_MIN_THRESHOLD,     SAI_WRED_ATTR_GREEN_MIN_THRESHOLD,
+        [](const qos_wred_struct_t *p, sai_attribute_value_t &v) { v.u32 = p->g_min; }},
+    {BASE_QOS_WRED_PROFILE_GREEN_MAX_THRESHOLD,     SAI_WRED_ATTR_GREEN_MAX_THRESHOLD,
+        [](const qos_wred_struct_t *p, sai_attribute_value_t &v) { v.u32 = p->g_max; }},
+    {BASE_QOS_WRED_PROFILE_GREEN_DROP_PROBABILITY,  SAI_WRED_ATTR_GREEN_DROP_PROBABILITY,
+        [](const qos_wred_struct_t *p, sai_attribute_value_t &v) { v.u32 = p->g_drop_prob; }},
+    {BASE_QOS_WRED_PROFILE_YELLOW_ENABLE,           SAI_WRED_ATTR_YELLOW_ENABLE,
+        [](const qos_wred_struct_t *p, sai_attribute_value_t &v) { v.booldata = p->y_enable; }},
+    {BASE_QOS_WRED_PROFILE_YELLOW_MIN_THRESHOLD,    SAI_WRED_ATTR_YELLOW_MIN_THRESHOLD,
+        [](const qos_wred_struct_t *p, sai_attribute_value_t &v) { v.u32 = p->y_min; }},
+    {BASE_QOS_WRED_PROFILE_YELLOW_MAX_THRESHOLD,    SAI_WRED_ATTR_YELLOW_MAX_THRESHOLD,
+        [](const qos_wred_struct_t *p, sai_attribute_value_t &v) { v.u32 = p->y_max; }},
+    {BASE_QOS_WRED_PROFILE_YELLOW_DROP_PROBABILITY, SAI_WRED_ATTR_YELLOW_DROP_PROBABILITY,
+        [](const qos_wred_struct_t *p, sai_attribute_value_t &v) { v.u32 = p->y_drop_prob; }},
+    {BASE_QOS_WRED_PROFILE_RED_ENABLE,              SAI_WRED_ATTR_RED_ENABLE,
+        [](const qos_wred_struct_t *p, sai_attribute_value_t &v) { v.booldata = p->r_enable; }},
+    {BASE_QOS_WRED_PROFILE_RED_MIN_THRESHOLD,       SAI_WRED_ATTR_RED_MIN_THRESHOLD,
+        [](const qos_wred_struct_t *p, sai_attribute_value_t &v) { v.u32 = p->r_min; }},
+    {BASE_QOS_WRED_PROFILE_RED_MAX_THRESHOLD,       SAI_WRED_ATTR_RED_MAX_THRESHOLD,
+        [](const qos_wred_struct_t *p, sai_attribute_value_t &v) { v.u32 = p->r_max; }},
+    {BASE_QOS_WRED_PROFILE_RED_DROP_PROBABILITY,    SAI_WRED_ATTR_RED_DROP_PROBABILITY,
+        [](const qos_wred_struct_t *p, sai_attribute_value_t &v) { v.u32 = p->r_drop_prob; }},
+    {BASE_QOS_WRED_PROFILE_WEIGHT,                  SAI_WRED_ATTR_WEIGHT,
+        [](const qos_wred_struct_t *p, sai_attribute_value_t &v) { v.u8 = p->weight; }},
+    {BASE_QOS_WRED_PROFILE_ECN_ENABLE,              SAI_WRED_ATTR_ECN_MARK_ENABLE,
+        [](const qos_wred_struct_t *p, sai_attribute_value_t &v) { v.booldata = p->ecn_enable; }},
 };
 
+static const ndi_qos_attr_tbl<ndi_qos_wred_attr_t> ndi_qos_wred_attr_tbl(ndi_qos_wred_attr_list);
+
+#define NDI_QOS_WRED_ATTR_MAX   NDI_QOS_TBL_SIZE(ndi_qos_wred_attr_list)
+
 
 static t_std_error ndi_qos_fill_wred_attr(nas_attr_id_t attr_id,
                         const qos_wred_struct_t *p,
                         sai_attribute_t &sai_attr)
 {
-    // Only the settable attributes are included
-    try {
-        sai_attr.id = ndi2sai_wred_profile_attr_id_map.at(attr_id);
-    }
-    catch (...) {
+    const ndi_qos_wred_attr_t *entry = ndi_qos_wred_attr_tbl.find(attr_id);
+    if (entry == NULL) {
         EV_LOGGING(NDI, DEBUG, "NDI-QOS",
                       "attr_id %u not supported\n", attr_id);
         return STD_ERR(QOS, CFG, 0);
     }
 
-    if (attr_id == BASE_QOS_WRED_PROFILE_GREEN_ENABLE)
-        sai_attr.value.booldata = p->g_enable;
-    else if (attr_id == BASE_QOS_WRED_PROFILE_GREEN_MIN_THRESHOLD)
-        sai_attr.value.u32 = p->g_min;
-    else if (attr_id == BASE_QOS_WRED_PROFILE_GREEN_MAX_THRESHOLD)
-        sai_attr.value.u32 = p->g_max;
-    else if (attr_id == BASE_QOS_WRED_PROFILE_GREEN_DROP_PROBABILITY)
-        sai_attr.value.u32 = p->g_drop_prob;
-    else if (attr_id == BASE_QOS_WRED_PROFILE_YELLOW_ENABLE)
-        sai_attr.value.booldata = p->y_enable;
-    else if (attr_id == BASE_QOS_WRED_PROFILE_YELLOW_MIN_THRESHOLD)
-        sai_attr.value.u32 = p->y_min;
-    else if (attr_id == BASE_QOS_WRED_PROFILE_YELLOW_MAX_THRESHOLD)
-        sai_attr.value.u32 = p->y_max;
-    else if (attr_id == BASE_QOS_WRED_PROFILE_YELLOW_DROP_PROBABILITY)
-        sai_attr.value.u32 = p->y_drop_prob;
-    else if (attr_id == BASE_QOS_WRED_PROFILE_RED_ENABLE)
-        sai_attr.value.booldata = p->r_enable;
-    else if (attr_id == BASE_QOS_WRED_PROFILE_RED_MIN_THRESHOLD)
-        sai_attr.value.u32 = p->r_min;
-    else if (attr_id == BASE_QOS_WRED_PROFILE_RED_MAX_THRESHOLD)
-        sai_attr.value.u32 = p->r_max;
-    else if (attr_id == BASE_QOS_WRED_PROFILE_RED_DROP_PROBABILITY)
-        sai_attr.value.u32 = p->r_drop_prob;
-    else if (attr_id == BASE_QOS_WRED_PROFILE_WEIGHT)
-        sai_attr.value.u8 = p->weight;
-    else if (attr_id == BASE_QOS_WRED_PROFILE_ECN_ENABLE)
-        sai_attr.value.booldata = p->ecn_enable;
+    sai_attr.id = entry->sai_id;
+    entry->fill(p, sai_attr.value);
 
     return STD_ERR_OK;
 }
@@ -101,17 +95,16 @@ static t_std_error ndi_qos_fill_wred_attr(nas_attr_id_t attr_id,
 static t_std_error ndi_qos_fill_wred_attr_list(const nas_attr_id_t *nas_attr_list,
                                     uint_t num_attr,
                                     const qos_wred_struct_t *p,
-                                    std::vector<sai_attribute_t> &attr_list)
+                                    sai_attribute_t *attr_list)
 {
-    sai_attribute_t sai_attr = {0};
     t_std_error      rc = STD_ERR_OK;
 
+    if (num_attr > NDI_QOS_WRED_ATTR_MAX)
+        return STD_ERR(QOS, CFG, 0);
+
     for (uint_t i = 0; i < num_attr; i++) {
-        if ((rc = ndi_qos_fill_wred_attr(nas_attr_list[i], p, sai_attr)) != STD_ERR_OK)
+        if ((rc = ndi_qos_fill_wred_attr(nas_attr_list[i], p, attr_list[i])) != STD_ERR_OK)
             return rc;
-
-        attr_list.push_back(sai_attr);
-
     }
 
     return STD_ERR_OK;
@@ -143,7 +136,7 @@ t_std_error ndi_qos_create_wred_profile(npu_id_t npu_id,
         return STD_ERR(QOS, CFG, 0);
     }
 
-    std::vector<sai_attribute_t>  attr_list;
+    sai_attribute_t attr_list[NDI_QOS_WRED_ATTR_MAX];
 
     if (ndi_qos_fill_wred_attr_list(nas_attr_list, num_attr, p, attr_list)
             != STD_ERR_OK)
@@ -152,8 +145,8 @@ t_std_error ndi_qos_create_wred_profile(npu_id_t npu_id,
     sai_object_id_t sai_qos_wred_profile_id;
     if ((sai_ret = ndi_sai_qos_wred_api(ndi_db_ptr)->
             create_wred_profile(&sai_qos_wred_profile_id,
-                                attr_list.size(),
-                                &attr_list[0]))
+                                num_attr,
+                                attr_list))
                          != SAI_STATUS_SUCCESS) {
         EV_LOGGING(NDI, NOTICE, "NDI-QOS",
                       "npu_id %d wred profile creation failed\n", npu_id);
@@ -287,8 +280,7 @@ t_std_error ndi_qos_get_wred_profile(npu_id_t npu_id,
 
 {
     sai_status_t sai_ret = SAI_STATUS_FAILURE;
-    std::vector<sai_attribute_t> attr_list;
-    sai_attribute_t sai_attr;
+    sai_attribute_t attr_list[NDI_QOS_WRED_ATTR_MAX];
 
     nas_ndi_db_t *ndi_db_ptr = ndi_db_ptr_get(npu_id);
     if (ndi_db_ptr == NULL) {
@@ -297,23 +289,24 @@ t_std_error ndi_qos_get_wred_profile(npu_id_t npu_id,
         return STD_ERR(QOS, CFG, 0);
     }
 
-    try {
-        for (uint_t i = 0; i < num_attr; i++) {
-            sai_attr.id = ndi2sai_wred_profile_attr_id_map.at(nas_attr_list[i]);
-            attr_list.push_back(sai_attr);
-        }
-    }
-    catch(...) {
-        EV_LOGGING(NDI, NOTICE, "NDI-QOS",
-                    "Unexpected error.\n", npu_id);
+    if (num_attr > NDI_QOS_WRED_ATTR_MAX)
         return STD_ERR(QOS, CFG, 0);
+
+    for (uint_t i = 0; i < num_attr; i++) {
+        const ndi_qos_wred_attr_t *entry = ndi_qos_wred_attr_tbl.find(nas_attr_list[i]);
+        if (entry == NULL) {
+            EV_LOGGING(NDI, NOTICE, "NDI-QOS",
+                        "attr_id %u not supported\n", nas_attr_list[i]);
+            return STD_ERR(QOS, CFG, 0);
+        }
+        attr_list[i].id = entry->sai_id;
     }
 
     if ((sai_ret = ndi_sai_qos_wred_api(ndi_db_ptr)->
             get_wred_attribute(
                     ndi2sai_wred_profile_id(ndi_wred_id),
                     num_attr,
-                    &attr_list[0]))
+                    attr_list))
                          != SAI_STATUS_SUCCESS) {
         EV_LOGGING(NDI, NOTICE, "NDI-QOS",
                       "npu_id %d wred profile get failed\n", npu_id);
@@ -321,7 +314,7 @@ t_std_error ndi_qos_get_wred_profile(npu_id_t npu_id,
     }
 
     // convert sai result to NAS format
-    _fill_ndi_qos_wred_profile_struct(&attr_list[0], num_attr, p);
+    _fill_ndi_qos_wred_profile_struct(attr_list, num_attr, p);
 
 
     return STD_ERR_OK;
@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2016 Dell Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License. You may obtain
+ * a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * THIS CODE IS PROVIDED ON AN *AS IS* BASIS, WITHOUT WARRANTIES OR
+ * CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ * LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ * FOR A PARTICULAR PURPOSE, MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ * See the Apache Version 2.0 License for specific language governing
+ * permissions and limitations under the License.
+ */
+
+/*
+ * filename: nas_ndi_stat_baseline.cpp
+ */
+
+#include "std_error_codes.h"
+#include "std_mutex_lock.h"
+#include "nas_ndi_event_logs.h"
+#include "nas_ndi_stat_baseline.h"
+
+#include <inttypes.h>
+#include <map>
+#include <tuple>
+#include <unordered_map>
+
+typedef struct _ndi_stat_baseline_obj_t {
+    bool has_owner = false;
+    ndi_port_t owner;
+    std::unordered_map<uint64_t, uint64_t> base;
+} ndi_stat_baseline_obj_t;
+
+typedef std::tuple<int, npu_id_t, uint64_t> ndi_stat_baseline_key_t;
+
+static std::map<ndi_stat_baseline_key_t, ndi_stat_baseline_obj_t> g_ndi_stat_baseline_tbl;
+
+static std_mutex_lock_create_static_init_rec(stat_baseline_lock);
+
+extern "C" {
+
+t_std_error ndi_stat_baseline_set(ndi_stat_obj_type_t type, npu_id_t npu_id,
+                                  uint64_t obj_id, const ndi_port_t *owner,
+                                  const uint64_t *stat_ids, const uint64_t *hw_vals,
+                                  size_t count)
+{
+    if ((count != 0) && ((stat_ids == NULL) || (hw_vals == NULL))) {
+        return STD_ERR(NPU, PARAM, 0);
+    }
+
+    std_mutex_simple_lock_guard g(&stat_baseline_lock);
+    try {
+        ndi_stat_baseline_obj_t &obj =
+            g_ndi_stat_baseline_tbl[ndi_stat_baseline_key_t(type, npu_id, obj_id)];
+        if (owner != NULL) {
+            obj.has_owner = true;
+            obj.owner = *owner;
+        }
+        for (size_t ix = 0; ix < count; ++ix) {
+            obj.base[stat_ids[ix]] = hw_vals[ix];
+        }
+    } catch (...) {
+        NDI_LOG_ERROR("NDI-STAT", "Failed to save counter baseline of object %d:%" PRIu64,
+                      type, obj_id);
+        return STD_ERR(NPU, NOMEM, 0);
+    }
+    return STD_ERR_OK;
+}
+
+void ndi_stat_baseline_apply(ndi_stat_obj_type_t type, npu_id_t npu_id, uint64_t obj_id,
+                             const uint64_t *stat_ids, uint64_t *vals, size_t count)
+{
+    if ((stat_ids == NULL) || (vals == NULL)) {
+        return;
+    }
+
+    std_mutex_simple_lock_guard g(&stat_baseline_lock);
+
+    auto it = g_ndi_stat_baseline_tbl.find(ndi_stat_baseline_key_t(type, npu_id, obj_id));
+    if (it == g_ndi_stat_baseline_tbl.end()) {
+        return;
+    }
+
+    auto &base = it->second.base;
+    for (size_t ix = 0; ix < count; ++ix) {
+        auto b = base.find(stat_ids[ix]);
+        if (b == base.end()) {
+            continue;
+        }
+        if (vals[ix] >= b->second) {
+            vals[ix] -= b->second;
+        } else {
+            /*  hardware counter was reset, it is the reference again */
+            base.erase(b);
+        }
+    }
+}
+
+void ndi_stat_baseline_object_delete(ndi_stat_obj_type_t type, npu_id_t npu_id,
+                                     uint64_t obj_id)
+{
+    std_mutex_simple_lock_guard g(&stat_baseline_lock);
+    g_ndi_stat_baseline_tbl.erase(ndi_stat_baseline_key_t(type, npu_id, obj_id));
+}
+
+void ndi_stat_baseline_port_delete(npu_id_t npu_id, npu_port_t port_id)
+{
+    std_mutex_simple_lock_guard g(&stat_baseline_lock);
+
+    g_ndi_stat_baseline_tbl.erase(ndi_stat_baseline_key_t(NDI_STAT_OBJ_PORT, npu_id, port_id));
+
+    for (auto it = g_ndi_stat_baseline_tbl.begin(); it != g_ndi_stat_baseline_tbl.end(); ) {
+        if (it->second.has_owner && (it->second.owner.npu_id == npu_id) &&
+            (it->second.owner.npu_port == port_id)) {
+            it = g_ndi_stat_baseline_tbl.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+}
@@ -21,6 +21,7 @@
 #include "dell-base-stg.h"
 #include "event_log.h"
 #include "std_error_codes.h"
+#include "std_mutex_lock.h"
 
 #include "nas_ndi_stg.h"
 #include "nas_ndi_int.h"
@@ -57,6 +58,17 @@ sai_to_ndi_stp_state_map = {
     {SAI_PORT_STP_STATE_FORWARDING,BASE_STG_INTERFACE_STATE_FORWARDING}
 };
 
+/*  SAI ports of each npu as of the port list generation last seen */
+typedef struct _ndi_stg_sai_port_cache_t {
+    bool valid = false;
+    uint64_t generation = 0;
+    std::vector<sai_object_id_t> ports;
+} ndi_stg_sai_port_cache_t;
+
+static std::unordered_map<npu_id_t, ndi_stg_sai_port_cache_t> ndi_stg_sai_port_cache;
+
+static std_mutex_lock_create_static_init_rec(stg_port_cache_lock);
+
 static inline  sai_stp_api_t * ndi_stp_api_get(nas_ndi_db_t *ndi_db_ptr) {
     return(ndi_db_ptr->ndi_sai_api_tbl.n_sai_stp_api_tbl);
 }
@@ -265,20 +277,41 @@ t_std_error ndi_stg_get_default_id(npu_id_t npu_id, ndi_stg_id_t *stg_id, hal_vl
 
 }
 
+/*  Length and contents come from one port list snapshot, and are only
+ *  read again once the port list generation has moved */
+static t_std_error ndi_stg_sai_port_list_get(npu_id_t npu_id, std::vector<sai_object_id_t> &list){
+    std_mutex_simple_lock_guard g(&stg_port_cache_lock);
+
+    try {
+        ndi_stg_sai_port_cache_t &cache = ndi_stg_sai_port_cache[npu_id];
+        if (!cache.valid || (cache.generation != ndi_port_sai_ports_generation_get(npu_id))){
+            cache.valid = false;
+            size_t len = cache.ports.size();
+            t_std_error rc;
+            while ((rc = ndi_port_sai_ports_snapshot_get(npu_id,cache.ports.data(),&len,
+                                                         &cache.generation)) != STD_ERR_OK){
+                if (len <= cache.ports.size()){
+                    return rc;
+                }
+                /*  ports were added since the list was sized */
+                cache.ports.resize(len);
+            }
+            cache.ports.resize(len);
+            cache.valid = true;
+        }
+        list = cache.ports;
+    } catch (...) {
+        return STD_ERR(STG,NOMEM,0);
+    }
+    return STD_ERR_OK;
+}
+
 extern "C"{
 
 t_std_error ndi_stg_set_all_stp_port_state(npu_id_t npu_id, ndi_stg_id_t stg_id,
                                                           BASE_STG_INTERFACE_STATE_t port_stp_state){
-    size_t len=0;
-    if (ndi_port_get_sai_ports_len(npu_id,&len) != STD_ERR_OK){
-        EV_LOGGING(NAS_L2,ERR,"SET-ALL-PORT-STATE","Couldn't get list len for sai port list");
-        return STD_ERR(STG,FAIL,0);
-    }
-
     std::vector<sai_object_id_t> sai_port_list;
-    sai_port_list.resize(len);
-
-    if (ndi_port_get_all_sai_ports(npu_id,&sai_port_list[0],len) != STD_ERR_OK){
+    if (ndi_stg_sai_port_list_get(npu_id,sai_port_list) != STD_ERR_OK){
         EV_LOGGING(NAS_L2,ERR,"SET-ALL-PORT-STATE","Couldn't get sai port list");
         return STD_ERR(STG,FAIL,0);
     }
@@ -32,7 +32,9 @@
 #include "saiport.h"
 #include "saivlan.h"
 
-#include <map>
+#include <algorithm>
+#include <initializer_list>
+#include <vector>
 #include <stdlib.h>
 #include <stdio.h>
 
@@ -42,8 +44,66 @@
 #define NDI_SAI_PORT_OBJECT_ID_BITMASK       0x0000ffffffffffff
 #define NDI_SAI_PORT_OBJECT_TYPE_BITMASK     0x0fff000000000000
 
+/*  Largest hole between two NDI stat ids kept inside one dense segment */
+#define NDI_STAT_XLATE_MAX_GAP      32
+#define NDI_STAT_XLATE_INVALID      (-1)
 
-static std::map<ndi_stat_id_t ,sai_port_stat_t>
+/*  NDI stat ids come from a few yang enums, each a tight range of values.
+ *  The translation pairs are compiled into one dense array per range,
+ *  indexed by the id minus the range base, so a lookup is a range check
+ *  and an array load per segment.
+ */
+template <typename T>
+class ndi_stat_xlate_tbl {
+  public:
+    ndi_stat_xlate_tbl(std::initializer_list<std::pair<ndi_stat_id_t, T>> pairs) {
+        std::vector<std::pair<ndi_stat_id_t, T>> sorted(pairs);
+        std::sort(sorted.begin(), sorted.end(),
+                  [](const std::pair<ndi_stat_id_t, T> &a,
+                     const std::pair<ndi_stat_id_t, T> &b) { return a.first < b.first; });
+
+        for (auto &p : sorted) {
+            if (segs.empty() ||
+                (p.first > segs.back().base + segs.back().ids.size() + NDI_STAT_XLATE_MAX_GAP)) {
+                segs.push_back(seg_t{p.first, {}});
+            }
+            seg_t &seg = segs.back();
+            seg.ids.resize(p.first - seg.base + 1, NDI_STAT_XLATE_INVALID);
+            seg.ids[p.first - seg.base] = static_cast<int32_t>(p.second);
+        }
+    }
+
+    bool get(ndi_stat_id_t ndi_id, T *sai_id) const {
+        for (auto &seg : segs) {
+            uint64_t off = ndi_id - seg.base;
+            if (off < seg.ids.size()) {
+                int32_t v = seg.ids[off];
+                *sai_id = static_cast<T>(v);
+                return (v != NDI_STAT_XLATE_INVALID);
+            }
+        }
+        return false;
+    }
+
+    /*  Translate a whole id list, no early exit so the loop stays branch light */
+    bool get_multi(const ndi_stat_id_t *ndi_ids, T *sai_ids, size_t count) const {
+        bool ok = true;
+        for (size_t ix = 0; ix < count; ++ix) {
+            ok &= get(ndi_ids[ix], &sai_ids[ix]);
+        }
+        return ok;
+    }
+
+  private:
+    struct seg_t {
+        ndi_stat_id_t base;
+        std::vector<int32_t> ids;
+    };
+    std::vector<seg_t> segs;
+};
+
+
+static const ndi_stat_xlate_tbl<sai_port_stat_t>
 ndi_to_sai_if_stat_ids = {
     { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_IF_OUT_QLEN  ,SAI_PORT_STAT_IF_OUT_QLEN },
     { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_ETHER_DROP_EVENTS  ,SAI_PORT_STAT_ETHER_STATS_DROP_EVENTS },
@@ -127,7 +187,7 @@ ndi_to_sai_if_stat_ids = {
 };
 
 
-static std::map<ndi_stat_id_t,sai_vlan_stat_t>
+static const ndi_stat_xlate_tbl<sai_vlan_stat_t>
 ndi_to_sai_vlan_stat_ids =
 {
     {  IF_INTERFACES_STATE_INTERFACE_STATISTICS_IN_OCTETS ,SAI_VLAN_STAT_IN_OCTETS },
@@ -209,21 +269,47 @@ bool ndi_port_to_sai_oid(ndi_port_t * ndi_port, sai_object_id_t *oid){
 
 
 bool ndi_to_sai_if_stats(ndi_stat_id_t ndi_id, sai_port_stat_t * sai_id){
-    auto it = ndi_to_sai_if_stat_ids.find(ndi_id);
-    if(it == ndi_to_sai_if_stat_ids.end() || (sai_id == NULL)){
+    if((sai_id == NULL) || !ndi_to_sai_if_stat_ids.get(ndi_id, sai_id)){
         NDI_LOG_ERROR(0,"NAS-NDI-UTILS","Failed to get the sai stat id for ndi id %d ",ndi_id);
         return false;
     }
-    *sai_id = it->second;
     return true;
 }
 
 bool ndi_to_sai_vlan_stats(ndi_stat_id_t ndi_id, sai_vlan_stat_t * sai_id){
-    auto it = ndi_to_sai_vlan_stat_ids.find(ndi_id);
-    if(it == ndi_to_sai_vlan_stat_ids.end() || (sai_id == NULL)){
+    if((sai_id == NULL) || !ndi_to_sai_vlan_stat_ids.get(ndi_id, sai_id)){
         NDI_LOG_ERROR(0,"NAS-NDI-UTILS","Failed to get the sai stat id for ndi id %d",ndi_id);
         return false;
     }
-    *sai_id = it->second;
     return true;
 }
+
+bool ndi_to_sai_if_stats_multi(const ndi_stat_id_t *ndi_ids, sai_port_stat_t *sai_ids,
+                               size_t count){
+    if((ndi_ids == NULL) || (sai_ids == NULL)){
+        return (count == 0);
+    }
+    if(ndi_to_sai_if_stat_ids.get_multi(ndi_ids, sai_ids, count)){
+        return true;
+    }
+    /*  slow path, only to log the id that failed */
+    for (size_t ix = 0; ix < count; ++ix) {
+        if (!ndi_to_sai_if_stats(ndi_ids[ix], &sai_ids[ix])) break;
+    }
+    return false;
+}
+
+bool ndi_to_sai_vlan_stats_multi(const ndi_stat_id_t *ndi_ids, sai_vlan_stat_t *sai_ids,
+                                 size_t count){
+    if((ndi_ids == NULL) || (sai_ids == NULL)){
+        return (count == 0);
+    }
+    if(ndi_to_sai_vlan_stat_ids.get_multi(ndi_ids, sai_ids, count)){
+        return true;
+    }
+    /*  slow path, only to log the id that failed */
+    for (size_t ix = 0; ix < count; ++ix) {
+        if (!ndi_to_sai_vlan_stats(ndi_ids[ix], &sai_ids[ix])) break;
+    }
+    return false;
+}
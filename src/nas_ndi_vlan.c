@@ -26,7 +26,10 @@
 #include "std_assert.h"
 #include "nas_ndi_event_logs.h"
 #include "nas_ndi_vlan.h"
+#include "nas_ndi_vlan_utl.h"
 #include "nas_ndi_utils.h"
+#include "nas_ndi_plat_stat.h"
+#include "nas_ndi_stat_baseline.h"
 #include "sai.h"
 #include "saivlan.h"
 
@@ -59,6 +62,8 @@ t_std_error ndi_delete_vlan(npu_id_t npu_id, hal_vlan_id_t vlan_id)
             != SAI_STATUS_SUCCESS) {
          return STD_ERR(INTERFACE, CFG, sai_ret);
     }
+    ndi_vlan_member_cache_vlan_delete(npu_id, vlan_id);
+    ndi_stat_baseline_object_delete(NDI_STAT_OBJ_VLAN, npu_id, vlan_id);
     return STD_ERR_OK;
 }
 
@@ -78,6 +83,7 @@ static t_std_error ndi_sai_copy_vlan_ports(sai_vlan_port_t *p_sai_vlan_port_list
                                           &p_sai_port->port_id)) != STD_ERR_OK) {
                 NDI_VLAN_LOG_ERROR("SAI port id get failed for NPU-id:%d NPU-port:%d",
                                    p_ndi_port->npu_id, p_ndi_port->npu_port);
+                return rc;
             }
 
             p_sai_port->tagging_mode = SAI_VLAN_TAGGING_MODE_TAGGED;
@@ -94,6 +100,7 @@ static t_std_error ndi_sai_copy_vlan_ports(sai_vlan_port_t *p_sai_vlan_port_list
                                           &p_sai_port->port_id)) != STD_ERR_OK) {
                 NDI_VLAN_LOG_ERROR("SAI port id get failed for NPU-id:%d NPU-port:%d",
                                    p_ndi_port->npu_id, p_ndi_port->npu_port);
+                return rc;
             }
 
             p_sai_port->tagging_mode = SAI_VLAN_TAGGING_MODE_UNTAGGED;
@@ -102,65 +109,306 @@ static t_std_error ndi_sai_copy_vlan_ports(sai_vlan_port_t *p_sai_vlan_port_list
     return(STD_ERR_OK);
 }
 
-t_std_error ndi_add_ports_to_vlan(npu_id_t npu_id, hal_vlan_id_t vlan_id,  \
-                                  ndi_port_list_t *p_t_port_list, ndi_port_list_t *p_ut_port_list)
+/*  Common path for adding/removing VLAN members. The membership cache is
+ *  updated only once SAI has accepted the change.
+ */
+static t_std_error ndi_vlan_ports_program(npu_id_t npu_id, hal_vlan_id_t vlan_id,
+                                          ndi_port_list_t *p_t_port_list,
+                                          ndi_port_list_t *p_ut_port_list,
+                                          bool add)
 {
     sai_status_t sai_ret = SAI_STATUS_FAILURE;
     sai_vlan_port_t *p_sai_vlan_port_list = NULL;
     uint32_t t_port_count = p_t_port_list ? p_t_port_list->port_count : 0 ;
     uint32_t ut_port_count = p_ut_port_list ? p_ut_port_list->port_count : 0 ;
     uint32_t port_count = ut_port_count + t_port_count;
+    t_std_error rc;
 
     nas_ndi_db_t *ndi_db_ptr = ndi_db_ptr_get(npu_id);
-    STD_ASSERT(ndi_db_ptr != NULL);
+    if(ndi_db_ptr == NULL){
+        return STD_ERR(NPU, PARAM, 0);
+    }
 
-    p_sai_vlan_port_list = malloc((sizeof(sai_vlan_port_t) * port_count));
+    if (port_count == 0) {
+        return STD_ERR_OK;
+    }
 
+    p_sai_vlan_port_list = calloc(port_count, sizeof(sai_vlan_port_t));
     if(p_sai_vlan_port_list == NULL) {
         return STD_ERR(INTERFACE, NOMEM, 0);
     }
 
-    memset(p_sai_vlan_port_list, 0, (sizeof(sai_vlan_port_t) * port_count));
+    if ((rc = ndi_sai_copy_vlan_ports(p_sai_vlan_port_list, p_t_port_list, p_ut_port_list))
+            != STD_ERR_OK) {
+        free(p_sai_vlan_port_list);
+        return rc;
+    }
 
-    ndi_sai_copy_vlan_ports(p_sai_vlan_port_list, p_t_port_list, p_ut_port_list);
+    if (add) {
+        sai_ret = ndi_sai_vlan_api(ndi_db_ptr)->add_ports_to_vlan((sai_vlan_id_t)vlan_id,
+                                                                  port_count, p_sai_vlan_port_list);
+    } else {
+        sai_ret = ndi_sai_vlan_api(ndi_db_ptr)->remove_ports_from_vlan((sai_vlan_id_t)vlan_id,
+                                                                       port_count, p_sai_vlan_port_list);
+    }
+    free(p_sai_vlan_port_list);
 
-    if ((sai_ret = ndi_sai_vlan_api(ndi_db_ptr)->add_ports_to_vlan((sai_vlan_id_t)vlan_id, port_count, p_sai_vlan_port_list))
-            != SAI_STATUS_SUCCESS) {
-        free(p_sai_vlan_port_list);
+    if (sai_ret != SAI_STATUS_SUCCESS) {
         return STD_ERR(INTERFACE, CFG, sai_ret);
     }
-    free(p_sai_vlan_port_list);
 
+    ndi_vlan_member_cache_update(npu_id, vlan_id, p_t_port_list, p_ut_port_list, add);
     return STD_ERR_OK;
 }
 
+t_std_error ndi_add_ports_to_vlan(npu_id_t npu_id, hal_vlan_id_t vlan_id,  \
+                                  ndi_port_list_t *p_t_port_list, ndi_port_list_t *p_ut_port_list)
+{
+    return ndi_vlan_ports_program(npu_id, vlan_id, p_t_port_list, p_ut_port_list, true);
+}
+
 t_std_error ndi_del_ports_from_vlan(npu_id_t npu_id, hal_vlan_id_t vlan_id, \
                                     ndi_port_list_t *p_t_port_list, ndi_port_list_t *p_ut_port_list)
+{
+    return ndi_vlan_ports_program(npu_id, vlan_id, p_t_port_list, p_ut_port_list, false);
+}
+
+/*  VLAN 0 and 4095 are reserved, flag them in failed */
+static bool ndi_vlan_bitmap_ids_valid(const ndi_vlan_bitmap_t *vlans, ndi_vlan_bitmap_t *failed)
+{
+    static const hal_vlan_id_t reserved[] = { 0, NDI_VLAN_ID_MAX };
+    bool valid = true;
+    size_t ix;
+
+    for (ix = 0; ix < sizeof(reserved)/sizeof(reserved[0]); ++ix) {
+        if (ndi_vlan_bitmap_test(vlans, reserved[ix])) {
+            NDI_VLAN_LOG_ERROR("Reserved VLAN %d requested", reserved[ix]);
+            if (failed != NULL) {
+                ndi_vlan_bitmap_set(failed, reserved[ix]);
+            }
+            valid = false;
+        }
+    }
+    return valid;
+}
+
+static t_std_error ndi_vlan_range_program(npu_id_t npu_id, const ndi_vlan_bitmap_t *vlans,
+                                          ndi_vlan_bitmap_t *failed, bool create)
 {
     sai_status_t sai_ret = SAI_STATUS_FAILURE;
-    sai_vlan_port_t *p_sai_vlan_port_list = NULL;
-    uint32_t t_port_count = p_t_port_list ? p_t_port_list->port_count : 0 ;
-    uint32_t ut_port_count = p_ut_port_list ? p_ut_port_list->port_count : 0 ;
-    uint32_t port_count = ut_port_count + t_port_count;
+    t_std_error rc = STD_ERR_OK;
+    int vlan_id;
+
     nas_ndi_db_t *ndi_db_ptr = ndi_db_ptr_get(npu_id);
-    STD_ASSERT(ndi_db_ptr != NULL);
+    if ((ndi_db_ptr == NULL) || (vlans == NULL)) {
+        return STD_ERR(NPU, PARAM, 0);
+    }
+    if (failed != NULL) {
+        ndi_vlan_bitmap_clear_all(failed);
+    }
+    if (!ndi_vlan_bitmap_ids_valid(vlans, failed)) {
+        return STD_ERR(NPU, PARAM, 0);
+    }
 
-    p_sai_vlan_port_list = malloc((sizeof(sai_vlan_port_t)) * port_count);
+    sai_vlan_api_t *vlan_api = ndi_sai_vlan_api(ndi_db_ptr);
 
-    if(p_sai_vlan_port_list == NULL) {
-        return STD_ERR(INTERFACE, NOMEM, 0);
+    NDI_VLAN_BITMAP_FOR_EACH(vlans, vlan_id) {
+        if (create) {
+            sai_ret = vlan_api->create_vlan((sai_vlan_id_t)vlan_id);
+        } else {
+            sai_ret = vlan_api->remove_vlan((sai_vlan_id_t)vlan_id);
+        }
+        if (sai_ret != SAI_STATUS_SUCCESS) {
+            NDI_VLAN_LOG_ERROR("VLAN %s failed for NPU-id:%d VLAN:%d, ret %d",
+                               create ? "create" : "delete", npu_id, vlan_id, sai_ret);
+            if (failed != NULL) {
+                ndi_vlan_bitmap_set(failed, vlan_id);
+            }
+            rc = STD_ERR(INTERFACE, CFG, sai_ret);
+            continue;
+        }
+        if (!create) {
+            ndi_vlan_member_cache_vlan_delete(npu_id, vlan_id);
+            ndi_stat_baseline_object_delete(NDI_STAT_OBJ_VLAN, npu_id, vlan_id);
+        }
     }
+    return rc;
+}
 
-    memset(p_sai_vlan_port_list, 0, (sizeof(sai_vlan_port_t) * port_count));
+t_std_error ndi_create_vlan_range(npu_id_t npu_id, const ndi_vlan_bitmap_t *vlans,
+                                  ndi_vlan_bitmap_t *failed)
+{
+    return ndi_vlan_range_program(npu_id, vlans, failed, true);
+}
 
-    ndi_sai_copy_vlan_ports(p_sai_vlan_port_list, p_t_port_list, p_ut_port_list);
+t_std_error ndi_delete_vlan_range(npu_id_t npu_id, const ndi_vlan_bitmap_t *vlans,
+                                  ndi_vlan_bitmap_t *failed)
+{
+    return ndi_vlan_range_program(npu_id, vlans, failed, false);
+}
 
-    if((sai_ret = ndi_sai_vlan_api(ndi_db_ptr)->remove_ports_from_vlan((sai_vlan_id_t)vlan_id, port_count, p_sai_vlan_port_list))
-        != SAI_STATUS_SUCCESS) {
-        free(p_sai_vlan_port_list);
-        return STD_ERR(INTERFACE, CFG, sai_ret);
+/*  Program one port into or out of a set of VLANs. The SAI port is resolved
+ *  once and VLANs the cache shows as already in the requested state are
+ *  skipped, so only real changes reach SAI. A port changing tagging mode is
+ *  removed first, and added back in its old mode if the new one fails.
+ */
+static t_std_error ndi_port_vlans_program(npu_id_t npu_id, npu_port_t port_id, bool tagged,
+                                          const ndi_vlan_bitmap_t *vlans,
+                                          ndi_vlan_bitmap_t *failed, bool add)
+{
+    sai_status_t sai_ret = SAI_STATUS_FAILURE;
+    sai_vlan_port_t sai_vlan_port;
+    t_std_error rc = STD_ERR_OK;
+    ndi_port_t ndi_port = { .npu_id = npu_id, .npu_port = port_id };
+    ndi_port_list_t port_list = { .port_count = 1, .port_list = &ndi_port };
+    bool cur_tagged = false;
+    int vlan_id;
+
+    nas_ndi_db_t *ndi_db_ptr = ndi_db_ptr_get(npu_id);
+    if ((ndi_db_ptr == NULL) || (vlans == NULL)) {
+        return STD_ERR(NPU, PARAM, 0);
+    }
+    if (failed != NULL) {
+        ndi_vlan_bitmap_clear_all(failed);
+    }
+    if (!ndi_vlan_bitmap_ids_valid(vlans, failed)) {
+        return STD_ERR(NPU, PARAM, 0);
+    }
+
+    memset(&sai_vlan_port, 0, sizeof(sai_vlan_port));
+    if ((rc = ndi_sai_port_id_get(npu_id, port_id, &sai_vlan_port.port_id)) != STD_ERR_OK) {
+        NDI_VLAN_LOG_ERROR("SAI port id get failed for NPU-id:%d NPU-port:%d",
+                           npu_id, port_id);
+        return rc;
+    }
+
+    sai_vlan_api_t *vlan_api = ndi_sai_vlan_api(ndi_db_ptr);
+
+    NDI_VLAN_BITMAP_FOR_EACH(vlans, vlan_id) {
+        bool member = ndi_vlan_member_cache_test(npu_id, vlan_id, port_id, &cur_tagged);
+
+        if (add && member && (cur_tagged == tagged)) continue;
+        if (!add && !member) {
+            NDI_VLAN_LOG_ERROR("NPU-port:%d is not a known member of VLAN:%d",
+                               port_id, vlan_id);
+            if (failed != NULL) {
+                ndi_vlan_bitmap_set(failed, vlan_id);
+            }
+            rc = STD_ERR(NPU, PARAM, 0);
+            continue;
+        }
+
+        if (member) {
+            sai_vlan_port.tagging_mode = cur_tagged ? SAI_VLAN_TAGGING_MODE_TAGGED :
+                                                      SAI_VLAN_TAGGING_MODE_UNTAGGED;
+            sai_ret = vlan_api->remove_ports_from_vlan((sai_vlan_id_t)vlan_id, 1, &sai_vlan_port);
+            if (sai_ret != SAI_STATUS_SUCCESS) {
+                NDI_VLAN_LOG_ERROR("VLAN port remove failed for NPU-id:%d NPU-port:%d VLAN:%d, ret %d",
+                                   npu_id, port_id, vlan_id, sai_ret);
+                if (failed != NULL) {
+                    ndi_vlan_bitmap_set(failed, vlan_id);
+                }
+                rc = STD_ERR(INTERFACE, CFG, sai_ret);
+                continue;
+            }
+            ndi_vlan_member_cache_update(npu_id, vlan_id, cur_tagged ? &port_list : NULL,
+                                         cur_tagged ? NULL : &port_list, false);
+        }
+        if (!add) continue;
+
+        sai_vlan_port.tagging_mode = tagged ? SAI_VLAN_TAGGING_MODE_TAGGED :
+                                              SAI_VLAN_TAGGING_MODE_UNTAGGED;
+        sai_ret = vlan_api->add_ports_to_vlan((sai_vlan_id_t)vlan_id, 1, &sai_vlan_port);
+        if (sai_ret != SAI_STATUS_SUCCESS) {
+            NDI_VLAN_LOG_ERROR("VLAN port add failed for NPU-id:%d NPU-port:%d VLAN:%d, ret %d",
+                               npu_id, port_id, vlan_id, sai_ret);
+            if (member) {
+                /*  keep the port in the VLAN with its old mode */
+                sai_vlan_port.tagging_mode = cur_tagged ? SAI_VLAN_TAGGING_MODE_TAGGED :
+                                                          SAI_VLAN_TAGGING_MODE_UNTAGGED;
+                sai_status_t restore_ret = vlan_api->add_ports_to_vlan((sai_vlan_id_t)vlan_id,
+                                                                       1, &sai_vlan_port);
+                if (restore_ret == SAI_STATUS_SUCCESS) {
+                    ndi_vlan_member_cache_update(npu_id, vlan_id,
+                                                 cur_tagged ? &port_list : NULL,
+                                                 cur_tagged ? NULL : &port_list, true);
+                } else {
+                    NDI_VLAN_LOG_ERROR("VLAN port restore failed for NPU-id:%d NPU-port:%d VLAN:%d, ret %d",
+                                       npu_id, port_id, vlan_id, restore_ret);
+                }
+            }
+            if (failed != NULL) {
+                ndi_vlan_bitmap_set(failed, vlan_id);
+            }
+            rc = STD_ERR(INTERFACE, CFG, sai_ret);
+            continue;
+        }
+        ndi_vlan_member_cache_update(npu_id, vlan_id, tagged ? &port_list : NULL,
+                                     tagged ? NULL : &port_list, true);
+    }
+    return rc;
+}
+
+t_std_error ndi_add_port_to_vlans(npu_id_t npu_id, npu_port_t port_id, bool tagged,
+                                  const ndi_vlan_bitmap_t *vlans,
+                                  ndi_vlan_bitmap_t *failed)
+{
+    return ndi_port_vlans_program(npu_id, port_id, tagged, vlans, failed, true);
+}
+
+t_std_error ndi_del_port_from_vlans(npu_id_t npu_id, npu_port_t port_id,
+                                    const ndi_vlan_bitmap_t *vlans,
+                                    ndi_vlan_bitmap_t *failed)
+{
+    return ndi_port_vlans_program(npu_id, port_id, false, vlans, failed, false);
+}
+
+/*  Translate a set of NDI VLAN counter ids to SAI once. A NULL id list
+ *  stands for the platform VLAN counter list. The NDI ids used are copied
+ *  to ndi_ids_used.
+ */
+static t_std_error ndi_vlan_stats_translate(const ndi_stat_id_t *ndi_stat_ids,
+                                            size_t stat_count,
+                                            sai_vlan_stat_t *sai_vlan_stats_ids,
+                                            ndi_stat_id_t *ndi_ids_used)
+{
+    if (ndi_stat_ids == NULL) {
+        unsigned int plat_len = stat_count;
+        if ((ndi_plat_vlan_stat_list_get(ndi_ids_used, &plat_len) != STD_ERR_OK) ||
+            (plat_len != stat_count)) {
+            NDI_VLAN_LOG_ERROR("Platform VLAN counter list does not match %d counters",
+                               (int)stat_count);
+            return STD_ERR(NPU, PARAM, 0);
+        }
+    } else {
+        memcpy(ndi_ids_used, ndi_stat_ids, stat_count * sizeof(*ndi_ids_used));
+    }
+
+    if(!ndi_to_sai_vlan_stats_multi(ndi_ids_used, sai_vlan_stats_ids, stat_count)){
+        return STD_ERR(NPU,PARAM,0);
+    }
+    return STD_ERR_OK;
+}
+
+static t_std_error ndi_vlan_stats_read(nas_ndi_db_t *ndi_db_ptr, npu_id_t npu_id,
+                                       hal_vlan_id_t vlan_id,
+                                       const sai_vlan_stat_t *sai_vlan_stats_ids,
+                                       size_t len, uint64_t *stats_val)
+{
+    sai_vlan_id_t sai_vlan_id;
+    t_std_error ret_code = STD_ERR_OK;
+    sai_status_t sai_ret = SAI_STATUS_FAILURE;
+
+    if ((ret_code = ndi_sai_vlan_id_get(npu_id, vlan_id, &sai_vlan_id)) != STD_ERR_OK) {
+        return ret_code;
+    }
+
+    if ((sai_ret = ndi_sai_vlan_api(ndi_db_ptr)->get_vlan_stats(sai_vlan_id,sai_vlan_stats_ids,
+                   len, stats_val)) != SAI_STATUS_SUCCESS) {
+        NDI_VLAN_LOG_ERROR("Vlan stats Get failed for npu %d, vlan %d, ret %d \n",
+                            npu_id, vlan_id, sai_ret);
+        return STD_ERR(NPU, FAIL, sai_ret);
     }
-    free(p_sai_vlan_port_list);
     return STD_ERR_OK;
 }
 
@@ -168,11 +416,10 @@ t_std_error ndi_vlan_stats_get(npu_id_t npu_id, hal_vlan_id_t vlan_id,
                                ndi_stat_id_t *ndi_stat_ids,
                                uint64_t* stats_val, size_t len)
 {
-    sai_vlan_id_t sai_vlan_id;
     const unsigned int list_len = len;
     sai_vlan_stat_t sai_vlan_stats_ids[list_len];
+    ndi_stat_id_t ndi_ids_used[list_len];
     t_std_error ret_code = STD_ERR_OK;
-    sai_status_t sai_ret = SAI_STATUS_FAILURE;
 
     nas_ndi_db_t *ndi_db_ptr = ndi_db_ptr_get(npu_id);
 
@@ -181,64 +428,153 @@ t_std_error ndi_vlan_stats_get(npu_id_t npu_id, hal_vlan_id_t vlan_id,
         return STD_ERR(NPU, PARAM, 0);
     }
 
-    if ((ret_code = ndi_sai_vlan_id_get(npu_id, vlan_id, &sai_vlan_id) != STD_ERR_OK)) {
+    if ((ret_code = ndi_vlan_stats_translate(ndi_stat_ids, len, sai_vlan_stats_ids,
+                                             ndi_ids_used)) != STD_ERR_OK) {
         return ret_code;
     }
 
-    size_t ix = 0;
-    for ( ; ix < len ; ++ix){
-        if(!ndi_to_sai_vlan_stats(ndi_stat_ids[ix],&sai_vlan_stats_ids[ix])){
-            return STD_ERR(NPU,PARAM,0);
-        }
+    if ((ret_code = ndi_vlan_stats_read(ndi_db_ptr, npu_id, vlan_id, sai_vlan_stats_ids,
+                                        len, stats_val)) != STD_ERR_OK) {
+        return ret_code;
     }
+    ndi_stat_baseline_apply(NDI_STAT_OBJ_VLAN, npu_id, vlan_id, ndi_ids_used, stats_val, len);
+    return STD_ERR_OK;
+}
 
-    if ((sai_ret = ndi_sai_vlan_api(ndi_db_ptr)->get_vlan_stats(sai_vlan_id,sai_vlan_stats_ids,
-                   len, stats_val)) != SAI_STATUS_SUCCESS) {
-        NDI_VLAN_LOG_ERROR("Vlan stats Get failed for npu %d, vlan %d, ret %d \n",
-                            npu_id, vlan_id, sai_ret);
-        return STD_ERR(NPU, FAIL, sai_ret);
+t_std_error ndi_vlan_stats_clear(npu_id_t npu_id, hal_vlan_id_t vlan_id,
+                                 const ndi_stat_id_t *ndi_stat_ids, size_t len)
+{
+    const unsigned int list_len = (len != 0) ? len : 1;
+    sai_vlan_stat_t sai_vlan_stats_ids[list_len];
+    ndi_stat_id_t ndi_ids_used[list_len];
+    uint64_t hw_vals[list_len];
+    t_std_error ret_code = STD_ERR_OK;
+
+    nas_ndi_db_t *ndi_db_ptr = ndi_db_ptr_get(npu_id);
+
+    if (ndi_db_ptr == NULL) {
+        NDI_VLAN_LOG_ERROR("Invalid NPU Id %d passed",npu_id);
+        return STD_ERR(NPU, PARAM, 0);
+    }
+    if (len == 0) {
+        return STD_ERR(NPU, PARAM, 0);
     }
 
-    return ret_code;
-}
+    if ((ret_code = ndi_vlan_stats_translate(ndi_stat_ids, len, sai_vlan_stats_ids,
+                                             ndi_ids_used)) != STD_ERR_OK) {
+        return ret_code;
+    }
 
+    /*  the current values become the new zero, the hardware keeps counting */
+    if ((ret_code = ndi_vlan_stats_read(ndi_db_ptr, npu_id, vlan_id, sai_vlan_stats_ids,
+                                        len, hw_vals)) != STD_ERR_OK) {
+        return ret_code;
+    }
+    return ndi_stat_baseline_set(NDI_STAT_OBJ_VLAN, npu_id, vlan_id, NULL,
+                                 ndi_ids_used, hw_vals, len);
+}
 
-t_std_error ndi_add_or_del_ports_to_vlan(npu_id_t npu_id, hal_vlan_id_t vlan_id,
-                                         ndi_port_list_t *p_tagged_list,
-                                         ndi_port_list_t *p_untagged_list,
-                                         bool add_vlan)
+/*  Fill the counter matrix for either a VLAN list or a VLAN bitmap */
+static t_std_error ndi_vlan_stats_get_rows(npu_id_t npu_id, const hal_vlan_id_t *vlan_list,
+                                           size_t vlan_count, const ndi_vlan_bitmap_t *vlans,
+                                           const ndi_stat_id_t *ndi_stat_ids,
+                                           size_t stat_count, uint64_t *stats_matrix,
+                                           ndi_vlan_bitmap_t *failed)
 {
-    sai_status_t sai_ret = SAI_STATUS_FAILURE;
-    uint32_t t_port_count = p_tagged_list ? p_tagged_list->port_count : 0 ;
-    uint32_t ut_port_count = p_untagged_list ? p_untagged_list->port_count : 0 ;
-    uint32_t port_count = ut_port_count + t_port_count;
-    sai_vlan_port_t sai_vlan_port_list[port_count];
+    sai_vlan_stat_t *sai_vlan_stats_ids = NULL;
+    ndi_stat_id_t *ndi_ids_used = NULL;
+    t_std_error ret_code = STD_ERR_OK;
+    t_std_error rc;
+    uint64_t *row = stats_matrix;
+    size_t ix = 0;
+    int vlan_id;
 
     nas_ndi_db_t *ndi_db_ptr = ndi_db_ptr_get(npu_id);
-    if(ndi_db_ptr == NULL){
+
+    if (ndi_db_ptr == NULL) {
+        NDI_VLAN_LOG_ERROR("Invalid NPU Id %d passed",npu_id);
         return STD_ERR(NPU, PARAM, 0);
     }
+    if ((stats_matrix == NULL) || (stat_count == 0) ||
+        ((vlans == NULL) && (vlan_list == NULL) && (vlan_count != 0))) {
+        return STD_ERR(NPU, PARAM, 0);
+    }
+    if (failed != NULL) {
+        ndi_vlan_bitmap_clear_all(failed);
+    }
 
-    memset(sai_vlan_port_list, 0, (sizeof(sai_vlan_port_t) * port_count));
+    sai_vlan_stats_ids = calloc(stat_count, sizeof(sai_vlan_stat_t));
+    ndi_ids_used = calloc(stat_count, sizeof(ndi_stat_id_t));
+    if ((sai_vlan_stats_ids == NULL) || (ndi_ids_used == NULL)) {
+        free(sai_vlan_stats_ids);
+        free(ndi_ids_used);
+        return STD_ERR(NPU, NOMEM, 0);
+    }
+    if ((ret_code = ndi_vlan_stats_translate(ndi_stat_ids, stat_count, sai_vlan_stats_ids,
+                                             ndi_ids_used)) != STD_ERR_OK) {
+        free(sai_vlan_stats_ids);
+        free(ndi_ids_used);
+        return ret_code;
+    }
 
-    ndi_sai_copy_vlan_ports(&sai_vlan_port_list[0], p_tagged_list, p_untagged_list);
+    vlan_id = (vlans != NULL) ? ndi_vlan_bitmap_next(vlans, 0) :
+              ((vlan_count > 0) ? vlan_list[0] : -1);
 
-    if(add_vlan) {
-        if ((sai_ret = ndi_sai_vlan_api(ndi_db_ptr)->add_ports_to_vlan((sai_vlan_id_t)vlan_id,
-                                                                        port_count,
-                                                                        &sai_vlan_port_list[0]))
-                != SAI_STATUS_SUCCESS) {
-            return STD_ERR(INTERFACE, CFG, sai_ret);
+    while (vlan_id >= 0) {
+        rc = ndi_vlan_stats_read(ndi_db_ptr, npu_id, vlan_id, sai_vlan_stats_ids,
+                                 stat_count, row);
+        if (rc != STD_ERR_OK) {
+            memset(row, 0, stat_count * sizeof(*row));
+            if (failed != NULL) {
+                ndi_vlan_bitmap_set(failed, vlan_id);
+            }
+            ret_code = rc;
+        } else {
+            ndi_stat_baseline_apply(NDI_STAT_OBJ_VLAN, npu_id, vlan_id, ndi_ids_used,
+                                    row, stat_count);
         }
-    }
-    else {
-        if ((sai_ret = ndi_sai_vlan_api(ndi_db_ptr)->remove_ports_from_vlan((sai_vlan_id_t)vlan_id,
-                                                    port_count, &sai_vlan_port_list[0]))
-                != SAI_STATUS_SUCCESS) {
-            return STD_ERR(INTERFACE, CFG, sai_ret);
+        row += stat_count;
+
+        if (vlans != NULL) {
+            vlan_id = ndi_vlan_bitmap_next(vlans, vlan_id + 1);
+        } else {
+            vlan_id = (++ix < vlan_count) ? vlan_list[ix] : -1;
         }
     }
-    return STD_ERR_OK;
+
+    free(sai_vlan_stats_ids);
+    free(ndi_ids_used);
+    return ret_code;
+}
+
+t_std_error ndi_vlan_stats_get_multi(npu_id_t npu_id, const hal_vlan_id_t *vlan_list,
+                                     size_t vlan_count, const ndi_stat_id_t *ndi_stat_ids,
+                                     size_t stat_count, uint64_t *stats_matrix,
+                                     ndi_vlan_bitmap_t *failed)
+{
+    return ndi_vlan_stats_get_rows(npu_id, vlan_list, vlan_count, NULL, ndi_stat_ids,
+                                   stat_count, stats_matrix, failed);
+}
+
+t_std_error ndi_vlan_stats_get_bitmap(npu_id_t npu_id, const ndi_vlan_bitmap_t *vlans,
+                                      const ndi_stat_id_t *ndi_stat_ids,
+                                      size_t stat_count, uint64_t *stats_matrix,
+                                      ndi_vlan_bitmap_t *failed)
+{
+    if (vlans == NULL) {
+        return STD_ERR(NPU, PARAM, 0);
+    }
+    return ndi_vlan_stats_get_rows(npu_id, NULL, 0, vlans, ndi_stat_ids,
+                                   stat_count, stats_matrix, failed);
+}
+
+
+t_std_error ndi_add_or_del_ports_to_vlan(npu_id_t npu_id, hal_vlan_id_t vlan_id,
+                                         ndi_port_list_t *p_tagged_list,
+                                         ndi_port_list_t *p_untagged_list,
+                                         bool add_vlan)
+{
+    return ndi_vlan_ports_program(npu_id, vlan_id, p_tagged_list, p_untagged_list, add_vlan);
 }
 
 
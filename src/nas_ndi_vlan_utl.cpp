@@ -0,0 +1,477 @@
+/*
+ * Copyright (c) 2016 Dell Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License. You may obtain
+ * a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * THIS CODE IS PROVIDED ON AN *AS IS* BASIS, WITHOUT WARRANTIES OR
+ * CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ * LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ * FOR A PARTICULAR PURPOSE, MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ * See the Apache Version 2.0 License for specific language governing
+ * permissions and limitations under the License.
+ */
+
+/*
+ * filename: nas_ndi_vlan_utl.cpp
+ */
+
+#include "std_error_codes.h"
+#include "std_mutex_lock.h"
+#include "nas_ndi_event_logs.h"
+#include "nas_ndi_vlan.h"
+#include "nas_ndi_vlan_utl.h"
+#include "nas_ndi_utils.h"
+#include "nas_ndi_int.h"
+#include "nas_ndi_port_map.h"
+#include "sai.h"
+#include "saivlan.h"
+
+#include <stdint.h>
+#define __STDC_FORMAT_MACROS
+#include <inttypes.h>
+#include <algorithm>
+#include <vector>
+#include <unordered_map>
+
+/*  This file keeps the per VLAN tagged/untagged port membership programmed
+ *  through NDI. Each VLAN holds two port bitmaps indexed by npu_port. The
+ *  cache lets ndi_vlan_set_members() send SAI only the membership delta and
+ *  answers port to VLAN queries without going to SAI. A VLAN is read from
+ *  SAI once before its first ndi_vlan_set_members(), so that members NDI
+ *  didn't add, e.g. of the default VLAN, are known and can be removed.
+ */
+
+typedef std::vector<uint64_t> ndi_port_bitmap_t;
+
+typedef struct _ndi_vlan_members_t {
+    ndi_port_bitmap_t tagged;
+    ndi_port_bitmap_t untagged;
+    bool seeded;                /*  read from SAI */
+} ndi_vlan_members_t;
+
+/*  key is (npu_id, vlan_id) */
+typedef std::unordered_map<uint32_t, ndi_vlan_members_t> ndi_vlan_member_tbl_t;
+
+static ndi_vlan_member_tbl_t g_ndi_vlan_member_tbl;
+
+static std_mutex_lock_create_static_init_rec(vlan_member_lock);
+
+static inline uint32_t ndi_vlan_member_key(npu_id_t npu_id, hal_vlan_id_t vlan_id)
+{
+    return (((uint32_t)npu_id << 16) | vlan_id);
+}
+
+static inline npu_id_t ndi_vlan_member_key_npu(uint32_t key)
+{
+    return (npu_id_t)(key >> 16);
+}
+
+static inline hal_vlan_id_t ndi_vlan_member_key_vlan(uint32_t key)
+{
+    return (hal_vlan_id_t)(key & 0xffff);
+}
+
+static inline bool ndi_port_bitmap_test(const ndi_port_bitmap_t &bmp, npu_port_t port)
+{
+    size_t word = port / 64;
+    return (word < bmp.size()) && (bmp[word] & ((uint64_t)1 << (port % 64)));
+}
+
+static inline void ndi_port_bitmap_set(ndi_port_bitmap_t &bmp, npu_port_t port)
+{
+    size_t word = port / 64;
+    if (word >= bmp.size()) {
+        bmp.resize(word + 1, 0);
+    }
+    bmp[word] |= ((uint64_t)1 << (port % 64));
+}
+
+static inline void ndi_port_bitmap_clear(ndi_port_bitmap_t &bmp, npu_port_t port)
+{
+    size_t word = port / 64;
+    if (word < bmp.size()) {
+        bmp[word] &= ~((uint64_t)1 << (port % 64));
+    }
+}
+
+/*  Walk every port set in the bitmap */
+template <typename F>
+static void ndi_port_bitmap_for_each(const ndi_port_bitmap_t &bmp, F fn)
+{
+    for (size_t word = 0; word < bmp.size(); ++word) {
+        uint64_t bits = bmp[word];
+        while (bits != 0) {
+            npu_port_t port = (npu_port_t)(word * 64 + __builtin_ctzll(bits));
+            bits &= (bits - 1);
+            fn(port);
+        }
+    }
+}
+
+static void ndi_vlan_member_cache_apply(ndi_port_bitmap_t &bmp, ndi_port_bitmap_t &other,
+                                        const ndi_port_list_t *p_port_list, bool add)
+{
+    if (p_port_list == NULL) return;
+
+    for (uint32_t ix = 0; ix < p_port_list->port_count; ++ix) {
+        npu_port_t port = p_port_list->port_list[ix].npu_port;
+        if (add) {
+            ndi_port_bitmap_set(bmp, port);
+            /*  a port carries a single tagging mode per VLAN */
+            ndi_port_bitmap_clear(other, port);
+        } else {
+            ndi_port_bitmap_clear(bmp, port);
+        }
+    }
+}
+
+extern "C" {
+
+void ndi_vlan_member_cache_update(npu_id_t npu_id, hal_vlan_id_t vlan_id,
+                                  const ndi_port_list_t *p_t_port_list,
+                                  const ndi_port_list_t *p_ut_port_list,
+                                  bool add)
+{
+    std_mutex_simple_lock_guard g(&vlan_member_lock);
+
+    try {
+        ndi_vlan_members_t &members = g_ndi_vlan_member_tbl[ndi_vlan_member_key(npu_id, vlan_id)];
+        ndi_vlan_member_cache_apply(members.tagged, members.untagged, p_t_port_list, add);
+        ndi_vlan_member_cache_apply(members.untagged, members.tagged, p_ut_port_list, add);
+    } catch (...) {
+        NDI_VLAN_LOG_ERROR("VLAN %d membership cache update failed", vlan_id);
+    }
+}
+
+bool ndi_vlan_member_cache_test(npu_id_t npu_id, hal_vlan_id_t vlan_id,
+                                npu_port_t port_id, bool *tagged)
+{
+    std_mutex_simple_lock_guard g(&vlan_member_lock);
+
+    auto it = g_ndi_vlan_member_tbl.find(ndi_vlan_member_key(npu_id, vlan_id));
+    if (it == g_ndi_vlan_member_tbl.end()) {
+        return false;
+    }
+    if (ndi_port_bitmap_test(it->second.tagged, port_id)) {
+        if (tagged != NULL) *tagged = true;
+        return true;
+    }
+    if (ndi_port_bitmap_test(it->second.untagged, port_id)) {
+        if (tagged != NULL) *tagged = false;
+        return true;
+    }
+    return false;
+}
+
+void ndi_vlan_member_cache_vlan_delete(npu_id_t npu_id, hal_vlan_id_t vlan_id)
+{
+    std_mutex_simple_lock_guard g(&vlan_member_lock);
+    g_ndi_vlan_member_tbl.erase(ndi_vlan_member_key(npu_id, vlan_id));
+}
+
+void ndi_vlan_member_cache_port_delete(npu_id_t npu_id, npu_port_t port_id)
+{
+    std_mutex_simple_lock_guard g(&vlan_member_lock);
+
+    for (auto &it : g_ndi_vlan_member_tbl) {
+        if (ndi_vlan_member_key_npu(it.first) != npu_id) continue;
+        ndi_port_bitmap_clear(it.second.tagged, port_id);
+        ndi_port_bitmap_clear(it.second.untagged, port_id);
+    }
+}
+
+t_std_error ndi_vlan_port_membership_get(npu_id_t npu_id, npu_port_t port_id,
+                                         ndi_vlan_bitmap_t *tagged,
+                                         ndi_vlan_bitmap_t *untagged)
+{
+    if (tagged != NULL) ndi_vlan_bitmap_clear_all(tagged);
+    if (untagged != NULL) ndi_vlan_bitmap_clear_all(untagged);
+
+    std_mutex_simple_lock_guard g(&vlan_member_lock);
+
+    for (auto &it : g_ndi_vlan_member_tbl) {
+        if (ndi_vlan_member_key_npu(it.first) != npu_id) continue;
+        hal_vlan_id_t vlan_id = ndi_vlan_member_key_vlan(it.first);
+
+        if ((tagged != NULL) && ndi_port_bitmap_test(it.second.tagged, port_id)) {
+            ndi_vlan_bitmap_set(tagged, vlan_id);
+        }
+        if ((untagged != NULL) && ndi_port_bitmap_test(it.second.untagged, port_id)) {
+            ndi_vlan_bitmap_set(untagged, vlan_id);
+        }
+    }
+    return STD_ERR_OK;
+}
+
+static t_std_error ndi_vlan_port_list_to_bitmap(npu_id_t npu_id, const ndi_port_list_t *p_port_list,
+                                                ndi_port_bitmap_t &bmp)
+{
+    if (p_port_list == NULL) return STD_ERR_OK;
+
+    for (uint32_t ix = 0; ix < p_port_list->port_count; ++ix) {
+        const ndi_port_t *p_ndi_port = &p_port_list->port_list[ix];
+        if (p_ndi_port->npu_id != npu_id) {
+            NDI_VLAN_LOG_ERROR("Port %d:%d does not belong to NPU %d",
+                               p_ndi_port->npu_id, p_ndi_port->npu_port, npu_id);
+            return STD_ERR(NPU, PARAM, 0);
+        }
+        ndi_port_bitmap_set(bmp, p_ndi_port->npu_port);
+    }
+    return STD_ERR_OK;
+}
+
+/*  Collect the ports set in 'from' and not set in 'minus' */
+static void ndi_vlan_port_bitmap_diff(npu_id_t npu_id, const ndi_port_bitmap_t &from,
+                                      const ndi_port_bitmap_t &minus,
+                                      std::vector<ndi_port_t> &diff)
+{
+    ndi_port_bitmap_for_each(from, [&](npu_port_t port) {
+        if (!ndi_port_bitmap_test(minus, port)) {
+            ndi_port_t ndi_port;
+            ndi_port.npu_id = npu_id;
+            ndi_port.npu_port = port;
+            diff.push_back(ndi_port);
+        }
+    });
+}
+
+#define NDI_VLAN_SEED_PORT_COUNT   64
+
+/*  Read the membership of a VLAN from SAI */
+static t_std_error ndi_vlan_member_read(npu_id_t npu_id, hal_vlan_id_t vlan_id,
+                                        ndi_vlan_members_t &members)
+{
+    nas_ndi_db_t *ndi_db_ptr = ndi_db_ptr_get(npu_id);
+    if (ndi_db_ptr == NULL) {
+        return STD_ERR(NPU, PARAM, 0);
+    }
+
+    std::vector<sai_vlan_port_t> sai_ports(NDI_VLAN_SEED_PORT_COUNT);
+    sai_attribute_t sai_attr;
+    sai_status_t sai_ret;
+    for (;;) {
+        sai_attr.id = SAI_VLAN_ATTR_PORT_LIST;
+        sai_attr.value.vlanportlist.count = sai_ports.size();
+        sai_attr.value.vlanportlist.list = &sai_ports[0];
+        sai_ret = ndi_db_ptr->ndi_sai_api_tbl.n_sai_vlan_api_tbl->
+                        get_vlan_attribute((sai_vlan_id_t)vlan_id, 1, &sai_attr);
+        if ((sai_ret != SAI_STATUS_BUFFER_OVERFLOW) ||
+            (sai_attr.value.vlanportlist.count <= sai_ports.size())) {
+            break;
+        }
+        sai_ports.resize(sai_attr.value.vlanportlist.count);
+    }
+    if (sai_ret != SAI_STATUS_SUCCESS) {
+        NDI_VLAN_LOG_ERROR("VLAN %d port list get failed", vlan_id);
+        return STD_ERR(NPU, FAIL, sai_ret);
+    }
+
+    members.tagged.clear();
+    members.untagged.clear();
+    for (uint32_t ix = 0; ix < sai_attr.value.vlanportlist.count; ++ix) {
+        npu_id_t port_npu;
+        npu_port_t port;
+        /*  ports NDI doesn't map, e.g. the CPU port, can't be set through NDI */
+        if ((ndi_npu_port_id_get(sai_ports[ix].port_id, &port_npu, &port) != STD_ERR_OK) ||
+            (port_npu != npu_id)) {
+            continue;
+        }
+        if (sai_ports[ix].tagging_mode == SAI_VLAN_TAGGING_MODE_UNTAGGED) {
+            ndi_port_bitmap_set(members.untagged, port);
+        } else {
+            ndi_port_bitmap_set(members.tagged, port);
+        }
+    }
+    members.seeded = true;
+    return STD_ERR_OK;
+}
+
+static inline ndi_port_list_t ndi_vlan_port_list_make(std::vector<ndi_port_t> &ports)
+{
+    ndi_port_list_t port_list;
+    port_list.port_count = ports.size();
+    port_list.port_list = ports.empty() ? NULL : &ports[0];
+    return port_list;
+}
+
+t_std_error ndi_vlan_set_members(npu_id_t npu_id, hal_vlan_id_t vlan_id,
+                                 ndi_port_list_t *p_t_port_list,
+                                 ndi_port_list_t *p_ut_port_list)
+{
+    t_std_error rc = STD_ERR_OK;
+    ndi_vlan_members_t target = {};
+    ndi_vlan_members_t current = {};
+    std::vector<ndi_port_t> del_t, del_ut, add_t, add_ut;
+
+    try {
+        if (((rc = ndi_vlan_port_list_to_bitmap(npu_id, p_t_port_list, target.tagged)) != STD_ERR_OK) ||
+            ((rc = ndi_vlan_port_list_to_bitmap(npu_id, p_ut_port_list, target.untagged)) != STD_ERR_OK)) {
+            return rc;
+        }
+
+        bool conflict = false;
+        ndi_port_bitmap_for_each(target.tagged, [&](npu_port_t port) {
+            if (ndi_port_bitmap_test(target.untagged, port)) conflict = true;
+        });
+        if (conflict) {
+            NDI_VLAN_LOG_ERROR("VLAN %d port listed as both tagged and untagged member", vlan_id);
+            return STD_ERR(NPU, PARAM, 0);
+        }
+
+        {
+            std_mutex_simple_lock_guard g(&vlan_member_lock);
+            auto it = g_ndi_vlan_member_tbl.find(ndi_vlan_member_key(npu_id, vlan_id));
+            if (it != g_ndi_vlan_member_tbl.end()) {
+                current = it->second;
+            }
+            if (!current.seeded) {
+                /*  SAI holds every member, including the ones NDI added */
+                if ((rc = ndi_vlan_member_read(npu_id, vlan_id, current)) != STD_ERR_OK) {
+                    return rc;
+                }
+                g_ndi_vlan_member_tbl[ndi_vlan_member_key(npu_id, vlan_id)] = current;
+            }
+        }
+
+        /*  Ports that change tagging mode show up in both the remove and the add set */
+        ndi_vlan_port_bitmap_diff(npu_id, current.tagged, target.tagged, del_t);
+        ndi_vlan_port_bitmap_diff(npu_id, current.untagged, target.untagged, del_ut);
+        ndi_vlan_port_bitmap_diff(npu_id, target.tagged, current.tagged, add_t);
+        ndi_vlan_port_bitmap_diff(npu_id, target.untagged, current.untagged, add_ut);
+    } catch (...) {
+        NDI_VLAN_LOG_ERROR("VLAN %d membership delta computation failed", vlan_id);
+        return STD_ERR(NPU, NOMEM, 0);
+    }
+
+    if (!del_t.empty() || !del_ut.empty()) {
+        ndi_port_list_t t_list = ndi_vlan_port_list_make(del_t);
+        ndi_port_list_t ut_list = ndi_vlan_port_list_make(del_ut);
+        if ((rc = ndi_add_or_del_ports_to_vlan(npu_id, vlan_id, &t_list, &ut_list, false))
+                != STD_ERR_OK) {
+            NDI_VLAN_LOG_ERROR("VLAN %d failed to remove %d tagged %d untagged ports",
+                               vlan_id, (int)del_t.size(), (int)del_ut.size());
+            return rc;
+        }
+    }
+
+    if (!add_t.empty() || !add_ut.empty()) {
+        ndi_port_list_t t_list = ndi_vlan_port_list_make(add_t);
+        ndi_port_list_t ut_list = ndi_vlan_port_list_make(add_ut);
+        if ((rc = ndi_add_or_del_ports_to_vlan(npu_id, vlan_id, &t_list, &ut_list, true))
+                != STD_ERR_OK) {
+            NDI_VLAN_LOG_ERROR("VLAN %d failed to add %d tagged %d untagged ports",
+                               vlan_id, (int)add_t.size(), (int)add_ut.size());
+            return rc;
+        }
+    }
+
+    return STD_ERR_OK;
+}
+
+/*  Ports SAI announces start out as untagged members of the default VLAN.
+ *  Their removal is deferred here and sent as one multi-port SAI call per
+ *  port event burst, or when the switch becomes operationally up.
+ */
+#define NDI_DEFAULT_VLAN_ID     1
+
+static std::unordered_map<npu_id_t, std::vector<sai_object_id_t>> g_ndi_default_vlan_pending;
+static ndi_vlan_default_remove_stats_t g_ndi_default_vlan_remove_stats;
+
+static std_mutex_lock_create_static_init_rec(default_vlan_lock);
+
+void ndi_vlan_default_remove_defer(npu_id_t npu_id, sai_object_id_t sai_port)
+{
+    std_mutex_simple_lock_guard g(&default_vlan_lock);
+    try {
+        g_ndi_default_vlan_pending[npu_id].push_back(sai_port);
+    } catch (...) {
+        NDI_VLAN_LOG_ERROR("Failed to defer default VLAN removal of port 0x%" PRIx64, sai_port);
+    }
+}
+
+void ndi_vlan_default_remove_cancel(npu_id_t npu_id, sai_object_id_t sai_port)
+{
+    std_mutex_simple_lock_guard g(&default_vlan_lock);
+
+    auto it = g_ndi_default_vlan_pending.find(npu_id);
+    if (it == g_ndi_default_vlan_pending.end()) {
+        return;
+    }
+    auto &ports = it->second;
+    ports.erase(std::remove(ports.begin(), ports.end(), sai_port), ports.end());
+}
+
+t_std_error ndi_vlan_default_remove_flush(npu_id_t npu_id)
+{
+    std::vector<sai_object_id_t> ports;
+    std::vector<sai_vlan_port_t> vlan_ports;
+    sai_status_t sai_ret = SAI_STATUS_FAILURE;
+    t_std_error rc = STD_ERR_OK;
+
+    nas_ndi_db_t *ndi_db_ptr = ndi_db_ptr_get(npu_id);
+    if (ndi_db_ptr == NULL) {
+        return STD_ERR(NPU, PARAM, 0);
+    }
+
+    std_mutex_simple_lock_guard g(&default_vlan_lock);
+
+    auto it = g_ndi_default_vlan_pending.find(npu_id);
+    if ((it == g_ndi_default_vlan_pending.end()) || it->second.empty()) {
+        return STD_ERR_OK;
+    }
+    ports.swap(it->second);
+
+    try {
+        vlan_ports.resize(ports.size());
+    } catch (...) {
+        it->second.swap(ports);
+        return STD_ERR(NPU, NOMEM, 0);
+    }
+    for (size_t ix = 0; ix < ports.size(); ++ix) {
+        vlan_ports[ix].port_id = ports[ix];
+        vlan_ports[ix].tagging_mode = SAI_VLAN_TAGGING_MODE_UNTAGGED;
+    }
+
+    EV_LOG_INFO(ev_log_t_NDI, ev_log_s_MAJOR, "NDI_VLAN",
+                "Deleting %d ports from system default vlan %d",
+                (int)vlan_ports.size(), NDI_DEFAULT_VLAN_ID);
+
+    sai_vlan_api_t *vlan_api = ndi_db_ptr->ndi_sai_api_tbl.n_sai_vlan_api_tbl;
+
+    ++g_ndi_default_vlan_remove_stats.flushes;
+    ++g_ndi_default_vlan_remove_stats.sai_calls;
+    g_ndi_default_vlan_remove_stats.ports_batched += vlan_ports.size();
+
+    sai_ret = vlan_api->remove_ports_from_vlan(NDI_DEFAULT_VLAN_ID, vlan_ports.size(),
+                                               &vlan_ports[0]);
+    if ((sai_ret == SAI_STATUS_SUCCESS) || (vlan_ports.size() == 1)) {
+        return (sai_ret == SAI_STATUS_SUCCESS) ? STD_ERR_OK : STD_ERR(INTERFACE, CFG, sai_ret);
+    }
+
+    /*  One bad port fails the whole list, retry one by one so the rest
+     *  still leave the default VLAN */
+    for (auto &vlan_port : vlan_ports) {
+        ++g_ndi_default_vlan_remove_stats.sai_calls;
+        ++g_ndi_default_vlan_remove_stats.fallback_ports;
+        if ((sai_ret = vlan_api->remove_ports_from_vlan(NDI_DEFAULT_VLAN_ID, 1, &vlan_port))
+                != SAI_STATUS_SUCCESS) {
+            NDI_VLAN_LOG_ERROR("Failed to delete port 0x%" PRIx64 " from default vlan, ret %d",
+                               vlan_port.port_id, sai_ret);
+            rc = STD_ERR(INTERFACE, CFG, sai_ret);
+        }
+    }
+    return rc;
+}
+
+void ndi_vlan_default_remove_stats_get(ndi_vlan_default_remove_stats_t *stats)
+{
+    if (stats == NULL) return;
+
+    std_mutex_simple_lock_guard g(&default_vlan_lock);
+    *stats = g_ndi_default_vlan_remove_stats;
+}
+
+} //extern "C"
@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2016 Dell Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License. You may obtain
+ * a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * THIS CODE IS PROVIDED ON AN *AS IS* BASIS, WITHOUT WARRANTIES OR
+ * CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ * LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ * FOR A PARTICULAR PURPOSE, MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ * See the Apache Version 2.0 License for specific language governing
+ * permissions and limitations under the License.
+ */
+
+/*
+ * filename: nas_ndi_link_damp_ut.cpp
+ *
+ * The link state filter doesn't need SAI. Each test uses its own port with
+ * its own configuration, timers run on the real monotonic clock.
+ */
+
+#include <gtest/gtest.h>
+
+#include <limits.h>
+#include <unistd.h>
+#include <vector>
+
+extern "C"{
+#include "std_error_codes.h"
+#include  "nas_ndi_link_damp.h"
+}
+
+static std::vector<ndi_port_oper_status_t> emitted;
+
+static void emit_record(npu_id_t npu_id, npu_port_t port_id, ndi_port_oper_status_t state)
+{
+    emitted.push_back(state);
+}
+
+static ndi_link_damp_cfg_t damp_cfg(uint32_t penalty, uint32_t suppress, uint32_t reuse,
+                                    uint32_t half_life_ms, uint32_t max_penalty)
+{
+    ndi_link_damp_cfg_t cfg = {0};
+    cfg.damp_enable = true;
+    cfg.flap_penalty = penalty;
+    cfg.suppress_threshold = suppress;
+    cfg.reuse_threshold = reuse;
+    cfg.half_life_ms = half_life_ms;
+    cfg.max_penalty = max_penalty;
+    return cfg;
+}
+
+/*  Run the event thread loop until no timer is left, bounded */
+static void run_timers(void)
+{
+    for (int loop = 0; loop < 100; ++loop) {
+        int timeout = ndi_link_damp_next_timeout_ms();
+        if (timeout < 0) return;
+        usleep(timeout * 1000);
+        ndi_link_damp_tick(emit_record);
+    }
+    FAIL() << "timers never expired";
+}
+
+TEST(nas_ndi_link_damp_test, cfg_must_release) {
+    ndi_link_damp_cfg_t cfg = damp_cfg(1000, 2000, 750, 0, 0);
+    EXPECT_NE(STD_ERR_OK, ndi_link_damp_default_cfg_set(&cfg));
+    EXPECT_NE(STD_ERR_OK, ndi_link_damp_port_cfg_set(0, 1, &cfg));
+
+    cfg = damp_cfg(1000, 2000, 0, 1000, 0);
+    EXPECT_NE(STD_ERR_OK, ndi_link_damp_default_cfg_set(&cfg));
+    EXPECT_NE(STD_ERR_OK, ndi_link_damp_port_cfg_set(0, 1, &cfg));
+
+    cfg = damp_cfg(1000, 2000, 2500, 1000, 0);
+    EXPECT_NE(STD_ERR_OK, ndi_link_damp_port_cfg_set(0, 1, &cfg));
+
+    cfg = damp_cfg(1000, 2000, 750, 1000, 0);
+    EXPECT_EQ(STD_ERR_OK, ndi_link_damp_port_cfg_set(0, 1, &cfg));
+
+    /*  zeros are fine while dampening is off */
+    cfg = damp_cfg(0, 0, 0, 0, 0);
+    cfg.damp_enable = false;
+    EXPECT_EQ(STD_ERR_OK, ndi_link_damp_default_cfg_set(&cfg));
+    ndi_link_damp_port_delete(0, 1);
+}
+
+TEST(nas_ndi_link_damp_test, suppress_decay_release) {
+    ndi_link_damp_cfg_t cfg = damp_cfg(1000, 1500, 800, 40, 4000);
+    ASSERT_EQ(STD_ERR_OK, ndi_link_damp_port_cfg_set(0, 2, &cfg));
+    emitted.clear();
+
+    ndi_link_damp_event(0, 2, ndi_port_OPER_UP, emit_record);
+    ndi_link_damp_event(0, 2, ndi_port_OPER_DOWN, emit_record);
+    ndi_link_damp_event(0, 2, ndi_port_OPER_UP, emit_record);
+    ndi_link_damp_event(0, 2, ndi_port_OPER_DOWN, emit_record);
+    ASSERT_EQ(4u, emitted.size());
+
+    /*  second flap crossed the suppress threshold, the port stays down */
+    ndi_link_damp_event(0, 2, ndi_port_OPER_UP, emit_record);
+    EXPECT_EQ(4u, emitted.size());
+
+    ndi_link_damp_state_t state;
+    ASSERT_EQ(STD_ERR_OK, ndi_link_damp_state_get(0, 2, &state));
+    EXPECT_TRUE(state.suppressed);
+    EXPECT_EQ(ndi_port_OPER_DOWN, state.reported_state);
+    EXPECT_EQ(ndi_port_OPER_UP, state.raw_state);
+    EXPECT_GT(ndi_link_damp_next_timeout_ms(), 0);
+
+    run_timers();
+    ASSERT_EQ(5u, emitted.size());
+    EXPECT_EQ(ndi_port_OPER_UP, emitted.back());
+    ASSERT_EQ(STD_ERR_OK, ndi_link_damp_state_get(0, 2, &state));
+    EXPECT_FALSE(state.suppressed);
+    EXPECT_LE(state.penalty, cfg.reuse_threshold);
+    EXPECT_EQ(-1, ndi_link_damp_next_timeout_ms());
+
+    /*  a repeated SAI state is not a transition */
+    ndi_link_damp_event(0, 2, ndi_port_OPER_UP, emit_record);
+    EXPECT_EQ(5u, emitted.size());
+    ndi_link_damp_port_delete(0, 2);
+}
+
+TEST(nas_ndi_link_damp_test, penalty_at_reuse_threshold_releases) {
+    /*  no decay to speak of, the penalty sits exactly on the reuse threshold */
+    ndi_link_damp_cfg_t cfg = damp_cfg(1000, 1000, 1000, 3600000, 1000);
+    ASSERT_EQ(STD_ERR_OK, ndi_link_damp_port_cfg_set(0, 3, &cfg));
+    emitted.clear();
+
+    ndi_link_damp_event(0, 3, ndi_port_OPER_UP, emit_record);
+    ndi_link_damp_event(0, 3, ndi_port_OPER_DOWN, emit_record);
+    ndi_link_damp_event(0, 3, ndi_port_OPER_UP, emit_record);
+
+    ndi_link_damp_state_t state;
+    ASSERT_EQ(STD_ERR_OK, ndi_link_damp_state_get(0, 3, &state));
+    EXPECT_FALSE(state.suppressed);
+    EXPECT_EQ(ndi_port_OPER_UP, state.reported_state);
+    EXPECT_EQ(3u, emitted.size());
+    EXPECT_EQ(-1, ndi_link_damp_next_timeout_ms());
+    ndi_link_damp_port_delete(0, 3);
+}
+
+TEST(nas_ndi_link_damp_test, suppressed_port_never_polls_now) {
+    ndi_link_damp_cfg_t cfg = damp_cfg(1000, 1000, 500, 60000, 4000);
+    ASSERT_EQ(STD_ERR_OK, ndi_link_damp_port_cfg_set(0, 4, &cfg));
+    emitted.clear();
+
+    ndi_link_damp_event(0, 4, ndi_port_OPER_UP, emit_record);
+    ndi_link_damp_event(0, 4, ndi_port_OPER_DOWN, emit_record);
+    ndi_link_damp_event(0, 4, ndi_port_OPER_UP, emit_record);
+
+    ndi_link_damp_state_t state;
+    ASSERT_EQ(STD_ERR_OK, ndi_link_damp_state_get(0, 4, &state));
+    EXPECT_TRUE(state.suppressed);
+
+    /*  a tick before the reuse time must leave a timeout in the future */
+    for (int loop = 0; loop < 10; ++loop) {
+        ndi_link_damp_tick(emit_record);
+        EXPECT_GT(ndi_link_damp_next_timeout_ms(), 0);
+    }
+    EXPECT_EQ(2u, emitted.size());
+    ndi_link_damp_port_delete(0, 4);
+    EXPECT_EQ(-1, ndi_link_damp_next_timeout_ms());
+}
+
+TEST(nas_ndi_link_damp_test, long_reuse_time_caps_timeout) {
+    /*  the reuse time is about 4 years away */
+    ndi_link_damp_cfg_t cfg = damp_cfg(4000000000u, 1, 1, UINT_MAX, 4000000000u);
+    ASSERT_EQ(STD_ERR_OK, ndi_link_damp_port_cfg_set(0, 5, &cfg));
+    emitted.clear();
+
+    ndi_link_damp_event(0, 5, ndi_port_OPER_UP, emit_record);
+    ndi_link_damp_event(0, 5, ndi_port_OPER_DOWN, emit_record);
+
+    ndi_link_damp_state_t state;
+    ASSERT_EQ(STD_ERR_OK, ndi_link_damp_state_get(0, 5, &state));
+    EXPECT_TRUE(state.suppressed);
+    EXPECT_EQ(INT_MAX, ndi_link_damp_next_timeout_ms());
+    ndi_link_damp_port_delete(0, 5);
+    EXPECT_EQ(-1, ndi_link_damp_next_timeout_ms());
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2016 Dell Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License. You may obtain
+ * a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * THIS CODE IS PROVIDED ON AN *AS IS* BASIS, WITHOUT WARRANTIES OR
+ * CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ * LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ * FOR A PARTICULAR PURPOSE, MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ * See the Apache Version 2.0 License for specific language governing
+ * permissions and limitations under the License.
+ */
+
+/*
+ * filename: nas_ndi_link_snapshot_ut.cpp
+ *
+ * The SAI port API is replaced by a mock once NDI is up. The mock answers
+ * the link attributes and counts get_port_attribute calls per SAI port.
+ */
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <vector>
+
+extern "C"{
+#include "std_error_codes.h"
+#include  "nas_ndi_int.h"
+#include  "nas_ndi_init.h"
+#include  "nas_ndi_port.h"
+#include  "nas_ndi_port_utils.h"
+#include  "nas_ndi_utils.h"
+}
+#include "nas_ndi_ut_fixture.h"
+
+static sai_port_api_t mock_port_api;
+static std::map<sai_object_id_t, size_t> mock_get_calls;
+
+static sai_status_t mock_get_port_attribute(sai_object_id_t port_id, uint32_t attr_count,
+                                            sai_attribute_t *attr_list)
+{
+    ++mock_get_calls[port_id];
+
+    for (uint32_t ix = 0; ix < attr_count; ++ix) {
+        switch (attr_list[ix].id) {
+        case SAI_PORT_ATTR_OPER_STATUS:
+            attr_list[ix].value.s32 = SAI_PORT_OPER_STATUS_UP;
+            break;
+        case SAI_PORT_ATTR_SPEED:
+            attr_list[ix].value.u32 = 10000;
+            break;
+        case SAI_PORT_ATTR_FULL_DUPLEX_MODE:
+        case SAI_PORT_ATTR_AUTO_NEG_MODE:
+            attr_list[ix].value.booldata = true;
+            break;
+        default:
+            return SAI_STATUS_NOT_SUPPORTED;
+        }
+    }
+    return SAI_STATUS_SUCCESS;
+}
+
+class nas_ndi_link_snapshot_test : public nas_ndi_ut_fixture {
+protected:
+    virtual void mock_install(nas_ndi_db_t *ndi_db_ptr) {
+        if (ndi_db_ptr->ndi_sai_api_tbl.n_sai_port_api_tbl != &mock_port_api) {
+            mock_port_api = *ndi_db_ptr->ndi_sai_api_tbl.n_sai_port_api_tbl;
+            mock_port_api.get_port_attribute = mock_get_port_attribute;
+            ndi_db_ptr->ndi_sai_api_tbl.n_sai_port_api_tbl = &mock_port_api;
+        }
+        mock_get_calls.clear();
+    }
+};
+
+TEST_F(nas_ndi_link_snapshot_test, one_call_per_port) {
+    size_t max_port = ndi_max_npu_port_get(0);
+    std::vector<npu_port_t> ports(max_port);
+    std::vector<ndi_port_link_snapshot_t> snapshots(max_port);
+    size_t count = max_port;
+
+    ASSERT_EQ(STD_ERR_OK, ndi_port_link_snapshot_get_all(0, &ports[0], &snapshots[0], &count));
+    ASSERT_NE(0, count);
+    ASSERT_EQ(count, mock_get_calls.size());
+
+    for (size_t ix = 0; ix < count; ++ix) {
+        sai_object_id_t sai_port;
+        ASSERT_EQ(STD_ERR_OK, ndi_sai_port_id_get(0, ports[ix], &sai_port));
+        EXPECT_EQ(1, mock_get_calls[sai_port]);
+        EXPECT_EQ(ndi_port_OPER_UP, snapshots[ix].oper_status);
+        EXPECT_EQ(BASE_CMN_DUPLEX_TYPE_FULL, snapshots[ix].duplex);
+        EXPECT_TRUE(snapshots[ix].autoneg);
+    }
+
+    mock_get_calls.clear();
+    ndi_port_link_snapshot_t snapshot;
+    ASSERT_EQ(STD_ERR_OK, ndi_port_link_snapshot_get(0, ports[0], &snapshot));
+    EXPECT_EQ(1, mock_get_calls.size());
+    EXPECT_EQ(snapshots[0].speed, snapshot.speed);
+}
+
+TEST_F(nas_ndi_link_snapshot_test, speed_get_one_call) {
+    size_t max_port = ndi_max_npu_port_get(0);
+    std::vector<npu_port_t> ports(max_port);
+    std::vector<ndi_port_link_snapshot_t> snapshots(max_port);
+    size_t count = max_port;
+    ASSERT_EQ(STD_ERR_OK, ndi_port_link_snapshot_get_all(0, &ports[0], &snapshots[0], &count));
+    ASSERT_NE(0, count);
+
+    sai_object_id_t sai_port;
+    ASSERT_EQ(STD_ERR_OK, ndi_sai_port_id_get(0, ports[0], &sai_port));
+
+    mock_get_calls.clear();
+    BASE_IF_SPEED_t speed;
+    ASSERT_EQ(STD_ERR_OK, ndi_port_speed_get(0, ports[0], &speed));
+    EXPECT_EQ(1, mock_get_calls[sai_port]);
+    EXPECT_EQ(snapshots[0].speed, speed);
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,382 @@
+/*
+ * Copyright (c) 2016 Dell Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License. You may obtain
+ * a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * THIS CODE IS PROVIDED ON AN *AS IS* BASIS, WITHOUT WARRANTIES OR
+ * CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ * LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ * FOR A PARTICULAR PURPOSE, MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ * See the Apache Version 2.0 License for specific language governing
+ * permissions and limitations under the License.
+ */
+
+/*
+ * filename: nas_ndi_qos_binding_ut.cpp
+ *
+ * The SAI queue API, the priority group binding and the port QoS lists and
+ * speed are replaced by mocks once NDI is up. Each port gets a few queues
+ * and priority groups with made up ids, set calls are counted per object
+ * and can be made to fail.
+ */
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <string.h>
+#include <vector>
+
+extern "C"{
+#include "std_error_codes.h"
+#include  "nas_ndi_int.h"
+#include  "nas_ndi_init.h"
+#include  "nas_ndi_port.h"
+#include  "nas_ndi_port_utils.h"
+#include  "nas_ndi_utils.h"
+#include  "nas_ndi_qos_queue_binding.h"
+#include  "nas_ndi_qos_pg_binding.h"
+}
+#include "nas_ndi_qos_utl.h"
+#include "nas_ndi_qos_topology.h"
+#include "nas_ndi_ut_fixture.h"
+
+#define MOCK_QUEUES_PER_PORT    2
+#define MOCK_PGS_PER_PORT       2
+#define MOCK_PORT_SPEED         10000
+
+static sai_port_api_t mock_port_api;
+static sai_queue_api_t mock_queue_api;
+static sai_buffer_api_t mock_buffer_api;
+static std::map<sai_object_id_t, size_t> mock_set_calls;
+static std::map<sai_object_id_t, sai_status_t> mock_set_fail;
+static std::map<sai_object_id_t, uint32_t> mock_port_speed;
+
+/*  Made up queue and priority group ids, unique per SAI port */
+static sai_object_id_t mock_queue_id(sai_object_id_t sai_port, uint32_t ix)
+{
+    return (sai_port << 8) | (ix + 1);
+}
+
+static sai_object_id_t mock_pg_id(sai_object_id_t sai_port, uint32_t ix)
+{
+    return (sai_port << 8) | (0x80 + ix);
+}
+
+static sai_status_t mock_objlist_fill(sai_attribute_t *attr, sai_object_id_t sai_port,
+                                      sai_object_id_t (*id_of)(sai_object_id_t, uint32_t),
+                                      uint32_t count)
+{
+    if (attr->value.objlist.count < count) {
+        attr->value.objlist.count = count;
+        return SAI_STATUS_BUFFER_OVERFLOW;
+    }
+    for (uint32_t ix = 0; ix < count; ++ix) {
+        attr->value.objlist.list[ix] = id_of(sai_port, ix);
+    }
+    attr->value.objlist.count = count;
+    return SAI_STATUS_SUCCESS;
+}
+
+static sai_status_t mock_get_port_attribute(sai_object_id_t port_id, uint32_t attr_count,
+                                            sai_attribute_t *attr_list)
+{
+    sai_status_t ret = SAI_STATUS_SUCCESS;
+
+    for (uint32_t ix = 0; ix < attr_count; ++ix) {
+        switch (attr_list[ix].id) {
+        case SAI_PORT_ATTR_QOS_NUMBER_OF_QUEUES:
+            attr_list[ix].value.u32 = MOCK_QUEUES_PER_PORT;
+            break;
+        case SAI_PORT_ATTR_NUMBER_OF_PRIORITY_GROUPS:
+            attr_list[ix].value.u32 = MOCK_PGS_PER_PORT;
+            break;
+        case SAI_PORT_ATTR_QOS_NUMBER_OF_SCHEDULER_GROUPS:
+            attr_list[ix].value.u32 = 0;
+            break;
+        case SAI_PORT_ATTR_QOS_QUEUE_LIST:
+            if (mock_objlist_fill(&attr_list[ix], port_id, mock_queue_id, MOCK_QUEUES_PER_PORT)
+                    != SAI_STATUS_SUCCESS) {
+                ret = SAI_STATUS_BUFFER_OVERFLOW;
+            }
+            break;
+        case SAI_PORT_ATTR_PRIORITY_GROUP_LIST:
+            if (mock_objlist_fill(&attr_list[ix], port_id, mock_pg_id, MOCK_PGS_PER_PORT)
+                    != SAI_STATUS_SUCCESS) {
+                ret = SAI_STATUS_BUFFER_OVERFLOW;
+            }
+            break;
+        case SAI_PORT_ATTR_QOS_SCHEDULER_GROUP_LIST:
+            attr_list[ix].value.objlist.count = 0;
+            break;
+        case SAI_PORT_ATTR_SPEED:
+            attr_list[ix].value.u32 = mock_port_speed.count(port_id) ?
+                                        mock_port_speed[port_id] : MOCK_PORT_SPEED;
+            break;
+        default:
+            return SAI_STATUS_NOT_SUPPORTED;
+        }
+    }
+    return ret;
+}
+
+static sai_status_t mock_set_port_attribute(sai_object_id_t port_id, const sai_attribute_t *attr)
+{
+    if (attr->id != SAI_PORT_ATTR_SPEED)
+        return SAI_STATUS_NOT_SUPPORTED;
+    mock_port_speed[port_id] = attr->value.u32;
+    return SAI_STATUS_SUCCESS;
+}
+
+static sai_status_t mock_set_pg_attr(sai_object_id_t pg_id, const sai_attribute_t *attr)
+{
+    ++mock_set_calls[pg_id];
+    return SAI_STATUS_SUCCESS;
+}
+
+static sai_status_t mock_set_queue_attribute(sai_object_id_t queue_id, const sai_attribute_t *attr)
+{
+    ++mock_set_calls[queue_id];
+    auto fail = mock_set_fail.find(queue_id);
+    return (fail != mock_set_fail.end()) ? fail->second : SAI_STATUS_SUCCESS;
+}
+
+class nas_ndi_qos_binding_test : public nas_ndi_ut_fixture {
+protected:
+    virtual void mock_install(nas_ndi_db_t *ndi_db_ptr) {
+        if (ndi_db_ptr->ndi_sai_api_tbl.n_sai_port_api_tbl != &mock_port_api) {
+            mock_port_api = *ndi_db_ptr->ndi_sai_api_tbl.n_sai_port_api_tbl;
+            mock_port_api.get_port_attribute = mock_get_port_attribute;
+            mock_port_api.set_port_attribute = mock_set_port_attribute;
+            ndi_db_ptr->ndi_sai_api_tbl.n_sai_port_api_tbl = &mock_port_api;
+        }
+        if (ndi_db_ptr->ndi_sai_api_tbl.n_sai_qos_queue_api_tbl != &mock_queue_api) {
+            mock_queue_api = *ndi_db_ptr->ndi_sai_api_tbl.n_sai_qos_queue_api_tbl;
+            mock_queue_api.set_queue_attribute = mock_set_queue_attribute;
+            ndi_db_ptr->ndi_sai_api_tbl.n_sai_qos_queue_api_tbl = &mock_queue_api;
+        }
+        if (ndi_db_ptr->ndi_sai_api_tbl.n_sai_buffer_api_tbl != &mock_buffer_api) {
+            mock_buffer_api = *ndi_db_ptr->ndi_sai_api_tbl.n_sai_buffer_api_tbl;
+            mock_buffer_api.set_ingress_priority_group_attr = mock_set_pg_attr;
+            ndi_db_ptr->ndi_sai_api_tbl.n_sai_buffer_api_tbl = &mock_buffer_api;
+        }
+        mock_set_calls.clear();
+        mock_set_fail.clear();
+        mock_port_speed.clear();
+        headroom_calls.clear();
+    }
+
+    struct headroom_call {
+        npu_port_t port_id;
+        BASE_IF_SPEED_t speed;
+        std::vector<ndi_qos_pg_binding_t> binding_list;
+    };
+    static std::vector<headroom_call> headroom_calls;
+
+    static void headroom_update(npu_id_t npu_id, npu_port_t port_id, BASE_IF_SPEED_t speed,
+                                const ndi_qos_pg_binding_t *binding_list, size_t count) {
+        headroom_calls.push_back({port_id, speed,
+                std::vector<ndi_qos_pg_binding_t>(binding_list, binding_list + count)});
+    }
+
+    /*  First ports of npu 0 with a SAI port, their topology read afresh */
+    static void ports_get(size_t count, std::vector<npu_port_t> &ports,
+                          std::vector<sai_object_id_t> &sai_ports) {
+        for (npu_port_t port = 0; port < ndi_max_npu_port_get(0) && ports.size() < count; ++port) {
+            sai_object_id_t sai_port;
+            if (ndi_sai_port_id_get(0, port, &sai_port) != STD_ERR_OK)
+                continue;
+            ndi_qos_port_topology_port_delete(0, port);
+            ports.push_back(port);
+            sai_ports.push_back(sai_port);
+        }
+    }
+};
+
+std::vector<nas_ndi_qos_binding_test::headroom_call> nas_ndi_qos_binding_test::headroom_calls;
+
+TEST_F(nas_ndi_qos_binding_test, queue_last_binding_wins_and_repeats_skip) {
+    std::vector<npu_port_t> ports;
+    std::vector<sai_object_id_t> sai_ports;
+    ports_get(1, ports, sai_ports);
+    ASSERT_EQ(1u, ports.size());
+
+    ndi_obj_id_t q0 = mock_queue_id(sai_ports[0], 0);
+    ndi_obj_id_t q1 = mock_queue_id(sai_ports[0], 1);
+    ndi_qos_queue_binding_cache_port_delete(0, ports[0]);
+
+    ndi_qos_queue_binding_t binding_list[] = {
+        {ports[0], q1, NDI_QOS_QUEUE_BIND_WRED, 0x11},
+        {ports[0], q0, NDI_QOS_QUEUE_BIND_WRED, 0x10},
+        {ports[0], q1, NDI_QOS_QUEUE_BIND_WRED, 0x12},
+        {ports[0], q1, NDI_QOS_QUEUE_BIND_SCHEDULER, 0x20},
+    };
+    t_std_error status[4];
+    ndi_qos_queue_binding_stats_t stats = {0};
+
+    ASSERT_EQ(STD_ERR_OK, ndi_qos_queue_binding_set_bulk(0, binding_list, 4, status, &stats));
+    EXPECT_EQ(1u, mock_set_calls[q0]);
+    EXPECT_EQ(2u, mock_set_calls[q1]);
+    EXPECT_EQ(3u, stats.bindings_set);
+    EXPECT_EQ(1u, stats.bindings_skipped);
+
+    /*  all bound already */
+    mock_set_calls.clear();
+    ASSERT_EQ(STD_ERR_OK, ndi_qos_queue_binding_set_bulk(0, binding_list, 4, status, &stats));
+    EXPECT_EQ(0u, mock_set_calls.size());
+    EXPECT_EQ(3u, stats.bindings_set);
+    EXPECT_EQ(5u, stats.bindings_skipped);
+}
+
+TEST_F(nas_ndi_qos_binding_test, queue_error_of_latest_failure_in_input_order) {
+    std::vector<npu_port_t> ports;
+    std::vector<sai_object_id_t> sai_ports;
+    ports_get(1, ports, sai_ports);
+    ASSERT_EQ(1u, ports.size());
+
+    ndi_obj_id_t q0 = mock_queue_id(sai_ports[0], 0);
+    ndi_obj_id_t q1 = mock_queue_id(sai_ports[0], 1);
+    ndi_qos_queue_binding_cache_port_delete(0, ports[0]);
+    mock_set_fail[q0] = SAI_STATUS_INVALID_PARAMETER;
+    mock_set_fail[q1] = SAI_STATUS_NO_MEMORY;
+
+    /*  q1 sorts after q0 but comes first in the batch */
+    ndi_qos_queue_binding_t binding_list[] = {
+        {ports[0], q1, NDI_QOS_QUEUE_BIND_BUFFER_PROFILE, 0x30},
+        {ports[0], q0, NDI_QOS_QUEUE_BIND_BUFFER_PROFILE, 0x31},
+    };
+    t_std_error status[2];
+
+    EXPECT_EQ(STD_ERR(QOS, CFG, SAI_STATUS_INVALID_PARAMETER),
+              ndi_qos_queue_binding_set_bulk(0, binding_list, 2, status, NULL));
+    EXPECT_EQ(STD_ERR(QOS, CFG, SAI_STATUS_NO_MEMORY), status[0]);
+    EXPECT_EQ(STD_ERR(QOS, CFG, SAI_STATUS_INVALID_PARAMETER), status[1]);
+
+    /*  a failed binding is not remembered */
+    mock_set_fail.clear();
+    mock_set_calls.clear();
+    ASSERT_EQ(STD_ERR_OK, ndi_qos_queue_binding_set_bulk(0, binding_list, 2, status, NULL));
+    EXPECT_EQ(1u, mock_set_calls[q0]);
+    EXPECT_EQ(1u, mock_set_calls[q1]);
+}
+
+TEST_F(nas_ndi_qos_binding_test, queue_port_delete_forgets_only_its_queues) {
+    std::vector<npu_port_t> ports;
+    std::vector<sai_object_id_t> sai_ports;
+    ports_get(2, ports, sai_ports);
+    ASSERT_EQ(2u, ports.size());
+
+    std::vector<ndi_qos_queue_binding_t> binding_list;
+    for (size_t px = 0; px < ports.size(); ++px) {
+        for (uint32_t ix = 0; ix < MOCK_QUEUES_PER_PORT; ++ix) {
+            binding_list.push_back({ports[px], mock_queue_id(sai_ports[px], ix),
+                                    NDI_QOS_QUEUE_BIND_WRED, 0x40});
+        }
+    }
+    ndi_qos_queue_binding_cache_port_delete(0, ports[0]);
+    ndi_qos_queue_binding_cache_port_delete(0, ports[1]);
+    ASSERT_EQ(STD_ERR_OK, ndi_qos_queue_binding_set_bulk(0, &binding_list[0],
+                                                         binding_list.size(), NULL, NULL));
+
+    ndi_qos_queue_binding_cache_port_delete(0, ports[0]);
+    mock_set_calls.clear();
+    ASSERT_EQ(STD_ERR_OK, ndi_qos_queue_binding_set_bulk(0, &binding_list[0],
+                                                         binding_list.size(), NULL, NULL));
+    for (uint32_t ix = 0; ix < MOCK_QUEUES_PER_PORT; ++ix) {
+        EXPECT_EQ(1u, mock_set_calls[mock_queue_id(sai_ports[0], ix)]);
+        EXPECT_EQ(0u, mock_set_calls[mock_queue_id(sai_ports[1], ix)]);
+    }
+}
+
+TEST_F(nas_ndi_qos_binding_test, pg_must_belong_to_its_port) {
+    std::vector<npu_port_t> ports;
+    std::vector<sai_object_id_t> sai_ports;
+    ports_get(2, ports, sai_ports);
+    ASSERT_EQ(2u, ports.size());
+    ndi_qos_pg_binding_cache_port_delete(0, ports[0]);
+
+    ndi_qos_pg_binding_t binding_list[] = {
+        {ports[0], mock_pg_id(sai_ports[1], 0), 0x50},
+        {ports[0], mock_pg_id(sai_ports[0], 0), 0x50},
+    };
+    t_std_error status[2];
+    ndi_qos_pg_binding_stats_t stats = {0};
+
+    EXPECT_EQ(STD_ERR(QOS, PARAM, 0),
+              ndi_qos_pg_buffer_profile_bind_bulk(0, binding_list, 2, status, &stats));
+    EXPECT_EQ(STD_ERR(QOS, PARAM, 0), status[0]);
+    EXPECT_EQ(STD_ERR_OK, status[1]);
+    EXPECT_EQ(0u, mock_set_calls[mock_pg_id(sai_ports[1], 0)]);
+    EXPECT_EQ(1u, mock_set_calls[mock_pg_id(sai_ports[0], 0)]);
+    EXPECT_EQ(1u, stats.bindings_failed);
+
+    ndi_port_t ndi_port_id;
+    ndi_port_id.npu_id = 0;
+    ndi_port_id.npu_port = ports[0];
+    EXPECT_EQ(STD_ERR(QOS, PARAM, 0),
+              ndi_qos_set_priority_group_buffer_profile_id(ndi_port_id,
+                                                          mock_pg_id(sai_ports[1], 1), 0x50));
+
+    /*  bound already */
+    mock_set_calls.clear();
+    EXPECT_EQ(STD_ERR_OK, ndi_qos_pg_buffer_profile_bind_bulk(0, &binding_list[1], 1,
+                                                              NULL, &stats));
+    EXPECT_EQ(0u, mock_set_calls.size());
+    EXPECT_EQ(1u, stats.bindings_skipped);
+}
+
+TEST_F(nas_ndi_qos_binding_test, speed_hook_only_on_change) {
+    std::vector<npu_port_t> ports;
+    std::vector<sai_object_id_t> sai_ports;
+    ports_get(1, ports, sai_ports);
+    ASSERT_EQ(1u, ports.size());
+    ndi_qos_pg_binding_cache_port_delete(0, ports[0]);
+
+    ndi_qos_pg_binding_t binding = {ports[0], mock_pg_id(sai_ports[0], 1), 0x60};
+    ASSERT_EQ(STD_ERR_OK, ndi_qos_pg_buffer_profile_bind_bulk(0, &binding, 1, NULL, NULL));
+    ndi_qos_pg_headroom_notify_register(headroom_update);
+
+    /*  as after start-up: nothing cached, SAI has the port at 10G */
+    ndi_port_attr_cache_port_delete(0, ports[0]);
+    EXPECT_EQ(STD_ERR_OK, ndi_port_speed_set(0, ports[0], BASE_IF_SPEED_10GIGE));
+    EXPECT_EQ(0u, headroom_calls.size());
+
+    ndi_port_profile_t profile;
+    memset(&profile, 0, sizeof(profile));
+    profile.valid = NDI_PORT_PROFILE_SPEED;
+    profile.speed = BASE_IF_SPEED_10GIGE;
+    EXPECT_EQ(STD_ERR_OK, ndi_port_profile_set(0, ports[0], &profile));
+    EXPECT_EQ(0u, headroom_calls.size());
+
+    /*  AUTO is not programmed by either path */
+    EXPECT_EQ(STD_ERR_OK, ndi_port_speed_set(0, ports[0], BASE_IF_SPEED_AUTO));
+    profile.speed = BASE_IF_SPEED_AUTO;
+    EXPECT_EQ(STD_ERR_OK, ndi_port_profile_set(0, ports[0], &profile));
+    EXPECT_EQ(0u, headroom_calls.size());
+
+    EXPECT_EQ(STD_ERR_OK, ndi_port_speed_set(0, ports[0], BASE_IF_SPEED_40GIGE));
+    ASSERT_EQ(1u, headroom_calls.size());
+    EXPECT_EQ(ports[0], headroom_calls[0].port_id);
+    EXPECT_EQ(BASE_IF_SPEED_40GIGE, headroom_calls[0].speed);
+    ASSERT_EQ(1u, headroom_calls[0].binding_list.size());
+    EXPECT_EQ(binding.pg_id, headroom_calls[0].binding_list[0].pg_id);
+    EXPECT_EQ(binding.buffer_profile_id, headroom_calls[0].binding_list[0].buffer_profile_id);
+
+    profile.speed = BASE_IF_SPEED_40GIGE;
+    EXPECT_EQ(STD_ERR_OK, ndi_port_profile_set(0, ports[0], &profile));
+    EXPECT_EQ(1u, headroom_calls.size());
+
+    profile.speed = BASE_IF_SPEED_25GIGE;
+    EXPECT_EQ(STD_ERR_OK, ndi_port_profile_set(0, ports[0], &profile));
+    ASSERT_EQ(2u, headroom_calls.size());
+    EXPECT_EQ(BASE_IF_SPEED_25GIGE, headroom_calls[1].speed);
+
+    ndi_qos_pg_headroom_notify_register(NULL);
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) 2016 Dell Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License. You may obtain
+ * a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * THIS CODE IS PROVIDED ON AN *AS IS* BASIS, WITHOUT WARRANTIES OR
+ * CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ * LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ * FOR A PARTICULAR PURPOSE, MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ * See the Apache Version 2.0 License for specific language governing
+ * permissions and limitations under the License.
+ */
+
+/*
+ * filename: nas_ndi_qos_fill_bench.cpp
+ *
+ * Microbenchmark of policer and WRED profile creates. The SAI create calls
+ * are replaced by mocks that only count, so the time left is the attribute
+ * translation. The unordered_map and std::vector build the fillers used to
+ * do is replicated here and timed against the dense attribute tables.
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <unordered_map>
+#include <vector>
+#include <stdio.h>
+
+extern "C"{
+#include "std_error_codes.h"
+#include  "nas_ndi_int.h"
+#include  "nas_ndi_init.h"
+#include  "nas_ndi_utils.h"
+}
+#include "nas_ndi_qos_utl.h"
+#include "nas_ndi_ut_fixture.h"
+
+#define FILL_BENCH_ROUNDS      200000
+
+static sai_policer_api_t mock_policer_api;
+static sai_wred_api_t mock_wred_api;
+static size_t mock_create_calls;
+static size_t mock_create_attrs;
+
+static sai_status_t mock_create_policer(sai_object_id_t *policer_id, uint32_t attr_count,
+                                        const sai_attribute_t *attr_list)
+{
+    ++mock_create_calls;
+    mock_create_attrs += attr_count;
+    *policer_id = mock_create_calls;
+    return SAI_STATUS_SUCCESS;
+}
+
+static sai_status_t mock_create_wred_profile(sai_object_id_t *wred_id, uint32_t attr_count,
+                                             const sai_attribute_t *attr_list)
+{
+    ++mock_create_calls;
+    mock_create_attrs += attr_count;
+    *wred_id = mock_create_calls;
+    return SAI_STATUS_SUCCESS;
+}
+
+class nas_ndi_qos_fill_bench : public nas_ndi_ut_fixture {
+protected:
+    virtual void mock_install(nas_ndi_db_t *ndi_db_ptr) {
+        if (ndi_db_ptr->ndi_sai_api_tbl.n_sai_policer_api_tbl != &mock_policer_api) {
+            mock_policer_api = *ndi_db_ptr->ndi_sai_api_tbl.n_sai_policer_api_tbl;
+            mock_policer_api.create_policer = mock_create_policer;
+            ndi_db_ptr->ndi_sai_api_tbl.n_sai_policer_api_tbl = &mock_policer_api;
+        }
+        if (ndi_db_ptr->ndi_sai_api_tbl.n_sai_wred_api_tbl != &mock_wred_api) {
+            mock_wred_api = *ndi_db_ptr->ndi_sai_api_tbl.n_sai_wred_api_tbl;
+            mock_wred_api.create_wred_profile = mock_create_wred_profile;
+            ndi_db_ptr->ndi_sai_api_tbl.n_sai_wred_api_tbl = &mock_wred_api;
+        }
+        mock_create_calls = mock_create_attrs = 0;
+    }
+};
+
+static const nas_attr_id_t policer_attrs[] = {
+    BASE_QOS_METER_TYPE, BASE_QOS_METER_MODE, BASE_QOS_METER_COLOR_SOURCE,
+    BASE_QOS_METER_GREEN_PACKET_ACTION, BASE_QOS_METER_YELLOW_PACKET_ACTION,
+    BASE_QOS_METER_RED_PACKET_ACTION, BASE_QOS_METER_COMMITTED_BURST,
+    BASE_QOS_METER_COMMITTED_RATE, BASE_QOS_METER_PEAK_BURST, BASE_QOS_METER_PEAK_RATE,
+};
+
+static const nas_attr_id_t wred_attrs[] = {
+    BASE_QOS_WRED_PROFILE_GREEN_ENABLE, BASE_QOS_WRED_PROFILE_GREEN_MIN_THRESHOLD,
+    BASE_QOS_WRED_PROFILE_GREEN_MAX_THRESHOLD, BASE_QOS_WRED_PROFILE_GREEN_DROP_PROBABILITY,
+    BASE_QOS_WRED_PROFILE_YELLOW_ENABLE, BASE_QOS_WRED_PROFILE_YELLOW_MIN_THRESHOLD,
+    BASE_QOS_WRED_PROFILE_YELLOW_MAX_THRESHOLD, BASE_QOS_WRED_PROFILE_YELLOW_DROP_PROBABILITY,
+    BASE_QOS_WRED_PROFILE_RED_ENABLE, BASE_QOS_WRED_PROFILE_RED_MIN_THRESHOLD,
+    BASE_QOS_WRED_PROFILE_RED_MAX_THRESHOLD, BASE_QOS_WRED_PROFILE_RED_DROP_PROBABILITY,
+    BASE_QOS_WRED_PROFILE_WEIGHT, BASE_QOS_WRED_PROFILE_ECN_ENABLE,
+};
+
+/*  The translation as it was done before the dense tables */
+static const std::unordered_map<nas_attr_id_t, sai_attr_id_t, std::hash<int>> old_policer_map = {
+    {BASE_QOS_METER_TYPE,                 SAI_POLICER_ATTR_METER_TYPE},
+    {BASE_QOS_METER_MODE,                 SAI_POLICER_ATTR_MODE},
+    {BASE_QOS_METER_COLOR_SOURCE,         SAI_POLICER_ATTR_COLOR_SOURCE},
+    {BASE_QOS_METER_GREEN_PACKET_ACTION,  SAI_POLICER_ATTR_GREEN_PACKET_ACTION},
+    {BASE_QOS_METER_YELLOW_PACKET_ACTION, SAI_POLICER_ATTR_YELLOW_PACKET_ACTION},
+    {BASE_QOS_METER_RED_PACKET_ACTION,    SAI_POLICER_ATTR_RED_PACKET_ACTION},
+    {BASE_QOS_METER_COMMITTED_BURST,      SAI_POLICER_ATTR_CBS},
+    {BASE_QOS_METER_COMMITTED_RATE,       SAI_POLICER_ATTR_CIR},
+    {BASE_QOS_METER_PEAK_BURST,           SAI_POLICER_ATTR_PBS},
+    {BASE_QOS_METER_PEAK_RATE,            SAI_POLICER_ATTR_PIR},
+};
+
+static const std::unordered_map<nas_attr_id_t, sai_attr_id_t, std::hash<int>> old_wred_map = {
+    {BASE_QOS_WRED_PROFILE_GREEN_ENABLE,            SAI_WRED_ATTR_GREEN_ENABLE},
+    {BASE_QOS_WRED_PROFILE_GREEN_MIN_THRESHOLD,     SAI_WRED_ATTR_GREEN_MIN_THRESHOLD},
+    {BASE_QOS_WRED_PROFILE_GREEN_MAX_THRESHOLD,     SAI_WRED_ATTR_GREEN_MAX_THRESHOLD},
+    {BASE_QOS_WRED_PROFILE_GREEN_DROP_PROBABILITY,  SAI_WRED_ATTR_GREEN_DROP_PROBABILITY},
+    {BASE_QOS_WRED_PROFILE_YELLOW_ENABLE,           SAI_WRED_ATTR_YELLOW_ENABLE},
+    {BASE_QOS_WRED_PROFILE_YELLOW_MIN_THRESHOLD,    SAI_WRED_ATTR_YELLOW_MIN_THRESHOLD},
+    {BASE_QOS_WRED_PROFILE_YELLOW_MAX_THRESHOLD,    SAI_WRED_ATTR_YELLOW_MAX_THRESHOLD},
+    {BASE_QOS_WRED_PROFILE_YELLOW_DROP_PROBABILITY, SAI_WRED_ATTR_YELLOW_DROP_PROBABILITY},
+    {BASE_QOS_WRED_PROFILE_RED_ENABLE,              SAI_WRED_ATTR_RED_ENABLE},
+    {BASE_QOS_WRED_PROFILE_RED_MIN_THRESHOLD,       SAI_WRED_ATTR_RED_MIN_THRESHOLD},
+    {BASE_QOS_WRED_PROFILE_RED_MAX_THRESHOLD,       SAI_WRED_ATTR_RED_MAX_THRESHOLD},
+    {BASE_QOS_WRED_PROFILE_RED_DROP_PROBABILITY,    SAI_WRED_ATTR_RED_DROP_PROBABILITY},
+    {BASE_QOS_WRED_PROFILE_WEIGHT,                  SAI_WRED_ATTR_WEIGHT},
+    {BASE_QOS_WRED_PROFILE_ECN_ENABLE,              SAI_WRED_ATTR_ECN_MARK_ENABLE},
+};
+
+static void old_create(const std::unordered_map<nas_attr_id_t, sai_attr_id_t, std::hash<int>> &map,
+                       const nas_attr_id_t *nas_attr_list, uint_t num_attr,
+                       sai_status_t (*create)(sai_object_id_t *, uint32_t, const sai_attribute_t *))
+{
+    std::vector<sai_attribute_t> attr_list;
+    sai_attribute_t sai_attr = {0};
+    for (uint_t i = 0; i < num_attr; i++) {
+        sai_attr.id = map.at(nas_attr_list[i]);
+        sai_attr.value.u64 = nas_attr_list[i];
+        attr_list.push_back(sai_attr);
+    }
+    sai_object_id_t id;
+    create(&id, attr_list.size(), &attr_list[0]);
+}
+
+static void bench_report(const char *name, size_t creates,
+                         std::chrono::steady_clock::duration elapsed)
+{
+    double secs = std::chrono::duration<double>(elapsed).count();
+    printf("%-24s %12.0f creates/s\n", name, creates / secs);
+}
+
+TEST_F(nas_ndi_qos_fill_bench, all_attrs_passed) {
+    qos_policer_struct_t policer = {};
+    qos_wred_struct_t wred = {};
+    ndi_obj_id_t id;
+
+    ASSERT_EQ(STD_ERR_OK, ndi_qos_create_policer(0, policer_attrs,
+                NDI_QOS_TBL_SIZE(policer_attrs), &policer, &id));
+    EXPECT_EQ(1, mock_create_calls);
+    EXPECT_EQ(NDI_QOS_TBL_SIZE(policer_attrs), mock_create_attrs);
+
+    mock_create_calls = mock_create_attrs = 0;
+    ASSERT_EQ(STD_ERR_OK, ndi_qos_create_wred_profile(0, wred_attrs,
+                NDI_QOS_TBL_SIZE(wred_attrs), &wred, &id));
+    EXPECT_EQ(1, mock_create_calls);
+    EXPECT_EQ(NDI_QOS_TBL_SIZE(wred_attrs), mock_create_attrs);
+
+    nas_attr_id_t bad_attr = BASE_QOS_WRED_PROFILE_ECN_ENABLE + 1000;
+    EXPECT_NE(STD_ERR_OK, ndi_qos_create_wred_profile(0, &bad_attr, 1, &wred, &id));
+}
+
+TEST_F(nas_ndi_qos_fill_bench, creates_per_second) {
+    qos_policer_struct_t policer = {};
+    qos_wred_struct_t wred = {};
+    ndi_obj_id_t id;
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < FILL_BENCH_ROUNDS; ++r) {
+        old_create(old_policer_map, policer_attrs, NDI_QOS_TBL_SIZE(policer_attrs),
+                   mock_create_policer);
+    }
+    bench_report("policer, map+vector", FILL_BENCH_ROUNDS, std::chrono::steady_clock::now() - start);
+
+    start = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < FILL_BENCH_ROUNDS; ++r) {
+        ndi_qos_create_policer(0, policer_attrs, NDI_QOS_TBL_SIZE(policer_attrs), &policer, &id);
+    }
+    bench_report("policer, dense", FILL_BENCH_ROUNDS, std::chrono::steady_clock::now() - start);
+
+    start = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < FILL_BENCH_ROUNDS; ++r) {
+        old_create(old_wred_map, wred_attrs, NDI_QOS_TBL_SIZE(wred_attrs),
+                   mock_create_wred_profile);
+    }
+    bench_report("wred, map+vector", FILL_BENCH_ROUNDS, std::chrono::steady_clock::now() - start);
+
+    start = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < FILL_BENCH_ROUNDS; ++r) {
+        ndi_qos_create_wred_profile(0, wred_attrs, NDI_QOS_TBL_SIZE(wred_attrs), &wred, &id);
+    }
+    bench_report("wred, dense", FILL_BENCH_ROUNDS, std::chrono::steady_clock::now() - start);
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,233 @@
+/*
+ * Copyright (c) 2016 Dell Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License. You may obtain
+ * a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * THIS CODE IS PROVIDED ON AN *AS IS* BASIS, WITHOUT WARRANTIES OR
+ * CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ * LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ * FOR A PARTICULAR PURPOSE, MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ * See the Apache Version 2.0 License for specific language governing
+ * permissions and limitations under the License.
+ */
+
+/*
+ * filename: nas_ndi_qos_map_ut.cpp
+ *
+ * The SAI QoS map API is replaced by a mock once NDI is up. The mock keeps
+ * the dot1p to tc entries of every map it created, so a test can tell
+ * which map a write went to, and creates and sets can be made to fail.
+ * Two ports sharing a map are stood for by the map id each of them holds.
+ */
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <string.h>
+
+extern "C"{
+#include "std_error_codes.h"
+#include  "nas_ndi_int.h"
+#include  "nas_ndi_init.h"
+}
+#include "nas_ndi_qos_utl.h"
+#include "nas_ndi_ut_fixture.h"
+
+typedef std::map<uint_t, uint_t> mock_map_t;   // dot1p to tc
+
+static sai_qos_map_api_t mock_qos_map_api;
+static std::map<sai_object_id_t, mock_map_t> mock_maps;
+static sai_object_id_t mock_next_id = 0x5000;
+static size_t mock_set_calls;
+static sai_status_t mock_create_rc;
+static sai_status_t mock_set_rc;
+
+static void mock_map_fill(mock_map_t &map, const sai_attribute_t *attr)
+{
+    map.clear();
+    for (uint32_t ix = 0; ix < attr->value.qosmap.count; ++ix) {
+        map[attr->value.qosmap.list[ix].key.dot1p] = attr->value.qosmap.list[ix].value.tc;
+    }
+}
+
+static sai_status_t mock_create_qos_map(sai_object_id_t *qos_map_id, uint32_t attr_count,
+                                        const sai_attribute_t *attr_list)
+{
+    if (mock_create_rc != SAI_STATUS_SUCCESS)
+        return mock_create_rc;
+    *qos_map_id = ++mock_next_id;
+    mock_map_t &map = mock_maps[*qos_map_id];
+    for (uint32_t ix = 0; ix < attr_count; ++ix) {
+        if (attr_list[ix].id == SAI_QOS_MAP_ATTR_MAP_TO_VALUE_LIST)
+            mock_map_fill(map, &attr_list[ix]);
+    }
+    return SAI_STATUS_SUCCESS;
+}
+
+static sai_status_t mock_remove_qos_map(sai_object_id_t qos_map_id)
+{
+    return mock_maps.erase(qos_map_id) ? SAI_STATUS_SUCCESS : SAI_STATUS_INVALID_PARAMETER;
+}
+
+/*  The SAI replaces all entries of a map on a set */
+static sai_status_t mock_set_qos_map_attribute(sai_object_id_t qos_map_id,
+                                               const sai_attribute_t *attr)
+{
+    ++mock_set_calls;
+    if (mock_set_rc != SAI_STATUS_SUCCESS)
+        return mock_set_rc;
+    mock_map_fill(mock_maps.at(qos_map_id), attr);
+    return SAI_STATUS_SUCCESS;
+}
+
+static ndi_qos_map_struct_t map_entry(uint_t dot1p, uint_t tc)
+{
+    ndi_qos_map_struct_t entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.key.dot1p = dot1p;
+    entry.value.tc = tc;
+    return entry;
+}
+
+static uint_t ref_count(ndi_obj_id_t ndi_map_id)
+{
+    uint_t count = 0;
+    EXPECT_EQ(STD_ERR_OK, ndi_qos_map_ref_count_get(0, ndi_map_id, &count));
+    return count;
+}
+
+class nas_ndi_qos_map_test : public nas_ndi_ut_fixture {
+protected:
+    virtual void mock_install(nas_ndi_db_t *ndi_db_ptr) {
+        if (ndi_db_ptr->ndi_sai_api_tbl.n_sai_qos_map_api_tbl != &mock_qos_map_api) {
+            mock_qos_map_api = *ndi_db_ptr->ndi_sai_api_tbl.n_sai_qos_map_api_tbl;
+            mock_qos_map_api.create_qos_map = mock_create_qos_map;
+            mock_qos_map_api.remove_qos_map = mock_remove_qos_map;
+            mock_qos_map_api.set_qos_map_attribute = mock_set_qos_map_attribute;
+            ndi_db_ptr->ndi_sai_api_tbl.n_sai_qos_map_api_tbl = &mock_qos_map_api;
+        }
+        mock_maps.clear();
+        mock_set_calls = 0;
+        mock_create_rc = SAI_STATUS_SUCCESS;
+        mock_set_rc = SAI_STATUS_SUCCESS;
+        ASSERT_EQ(STD_ERR_OK, ndi_qos_map_partial_update_set(0, false));
+    }
+
+    /*  Two ports get the same map */
+    static void share(const ndi_qos_map_struct_t *entries, uint_t count,
+                      ndi_obj_id_t &port_a_map, ndi_obj_id_t &port_b_map) {
+        ASSERT_EQ(STD_ERR_OK, ndi_qos_create_shared_map(0, NDI_QOS_MAP_DOT1P_TO_TC,
+                                                        count, entries, &port_a_map));
+        ASSERT_EQ(STD_ERR_OK, ndi_qos_create_shared_map(0, NDI_QOS_MAP_DOT1P_TO_TC,
+                                                        count, entries, &port_b_map));
+        ASSERT_EQ(port_a_map, port_b_map);
+        ASSERT_EQ(1u, mock_maps.size());
+        ASSERT_EQ(2u, ref_count(port_a_map));
+    }
+};
+
+TEST_F(nas_ndi_qos_map_test, shared_map_copied_on_update) {
+    ndi_qos_map_struct_t entries[] = {map_entry(0, 1), map_entry(1, 2)};
+    ndi_obj_id_t port_a_map, port_b_map;
+    share(entries, 2, port_a_map, port_b_map);
+    ndi_obj_id_t shared_map = port_a_map;
+
+    ndi_qos_map_struct_t change = map_entry(1, 5);
+    ASSERT_EQ(STD_ERR_OK, ndi_qos_map_update_entries(0, &port_a_map, 1, &change));
+
+    /*  port a moved to a copy, the shared map itself was not written */
+    EXPECT_NE(shared_map, port_a_map);
+    EXPECT_EQ(shared_map, port_b_map);
+    EXPECT_EQ(0u, mock_set_calls);
+    EXPECT_EQ(1u, ref_count(port_a_map));
+    EXPECT_EQ(1u, ref_count(port_b_map));
+    EXPECT_EQ((mock_map_t{{0, 1}, {1, 2}}), mock_maps[port_b_map]);
+    EXPECT_EQ((mock_map_t{{0, 1}, {1, 5}}), mock_maps[port_a_map]);
+
+    EXPECT_EQ(STD_ERR_OK, ndi_qos_delete_map(0, port_a_map));
+    EXPECT_EQ(STD_ERR_OK, ndi_qos_delete_map(0, port_b_map));
+    EXPECT_EQ(0u, mock_maps.size());
+}
+
+TEST_F(nas_ndi_qos_map_test, shared_map_copied_on_set) {
+    ndi_qos_map_struct_t entries[] = {map_entry(2, 1), map_entry(3, 2)};
+    ndi_obj_id_t port_a_map, port_b_map;
+    share(entries, 2, port_a_map, port_b_map);
+    ndi_obj_id_t shared_map = port_a_map;
+
+    ndi_qos_map_struct_t change = map_entry(2, 6);
+    ASSERT_EQ(STD_ERR_OK, ndi_qos_map_set_entries(0, &port_a_map, 1, &change));
+
+    EXPECT_NE(shared_map, port_a_map);
+    EXPECT_EQ(shared_map, port_b_map);
+    EXPECT_EQ(0u, mock_set_calls);
+    EXPECT_EQ(1u, ref_count(port_a_map));
+    EXPECT_EQ(1u, ref_count(port_b_map));
+    EXPECT_EQ((mock_map_t{{2, 1}, {3, 2}}), mock_maps[port_b_map]);
+    EXPECT_EQ((mock_map_t{{2, 6}}), mock_maps[port_a_map]);
+
+    EXPECT_EQ(STD_ERR_OK, ndi_qos_delete_map(0, port_a_map));
+    EXPECT_EQ(STD_ERR_OK, ndi_qos_delete_map(0, port_b_map));
+}
+
+TEST_F(nas_ndi_qos_map_test, failed_copy_keeps_binding_and_ref_count) {
+    ndi_qos_map_struct_t entries[] = {map_entry(4, 1), map_entry(5, 2)};
+    ndi_obj_id_t port_a_map, port_b_map;
+    share(entries, 2, port_a_map, port_b_map);
+    ndi_obj_id_t shared_map = port_a_map;
+
+    mock_create_rc = SAI_STATUS_NO_MEMORY;
+    ndi_qos_map_struct_t change = map_entry(5, 7);
+    EXPECT_NE(STD_ERR_OK, ndi_qos_map_update_entries(0, &port_a_map, 1, &change));
+    EXPECT_NE(STD_ERR_OK, ndi_qos_map_set_entries(0, &port_a_map, 1, &change));
+
+    EXPECT_EQ(shared_map, port_a_map);
+    EXPECT_EQ(2u, ref_count(shared_map));
+    EXPECT_EQ(1u, mock_maps.size());
+    EXPECT_EQ((mock_map_t{{4, 1}, {5, 2}}), mock_maps[shared_map]);
+
+    EXPECT_EQ(STD_ERR_OK, ndi_qos_delete_map(0, port_a_map));
+    EXPECT_EQ(STD_ERR_OK, ndi_qos_delete_map(0, port_b_map));
+}
+
+TEST_F(nas_ndi_qos_map_test, failed_set_keeps_map_and_its_sharing) {
+    ndi_qos_map_struct_t entries[] = {map_entry(6, 1), map_entry(7, 2)};
+    ndi_obj_id_t port_a_map;
+    ASSERT_EQ(STD_ERR_OK, ndi_qos_create_shared_map(0, NDI_QOS_MAP_DOT1P_TO_TC,
+                                                    2, entries, &port_a_map));
+    ndi_obj_id_t map_id = port_a_map;
+
+    mock_set_rc = SAI_STATUS_FAILURE;
+    ndi_qos_map_struct_t change = map_entry(7, 3);
+    EXPECT_NE(STD_ERR_OK, ndi_qos_map_update_entries(0, &port_a_map, 1, &change));
+    EXPECT_EQ(map_id, port_a_map);
+    EXPECT_EQ(1u, ref_count(map_id));
+    EXPECT_EQ((mock_map_t{{6, 1}, {7, 2}}), mock_maps[map_id]);
+
+    /*  the map is still offered under its old entries */
+    ndi_obj_id_t port_b_map;
+    ASSERT_EQ(STD_ERR_OK, ndi_qos_create_shared_map(0, NDI_QOS_MAP_DOT1P_TO_TC,
+                                                    2, entries, &port_b_map));
+    EXPECT_EQ(map_id, port_b_map);
+    EXPECT_EQ(2u, ref_count(map_id));
+    EXPECT_EQ(1u, mock_maps.size());
+
+    /*  and the failed change was not remembered as done */
+    EXPECT_EQ(STD_ERR_OK, ndi_qos_delete_map(0, port_b_map));
+    mock_set_rc = SAI_STATUS_SUCCESS;
+    mock_set_calls = 0;
+    ASSERT_EQ(STD_ERR_OK, ndi_qos_map_update_entries(0, &port_a_map, 1, &change));
+    EXPECT_EQ(map_id, port_a_map);
+    EXPECT_EQ(1u, mock_set_calls);
+    EXPECT_EQ((mock_map_t{{6, 1}, {7, 3}}), mock_maps[map_id]);
+
+    EXPECT_EQ(STD_ERR_OK, ndi_qos_delete_map(0, port_a_map));
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
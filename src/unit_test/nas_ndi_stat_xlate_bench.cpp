@@ -0,0 +1,255 @@
+/*
+ * Copyright (c) 2016 Dell Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License. You may obtain
+ * a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * THIS CODE IS PROVIDED ON AN *AS IS* BASIS, WITHOUT WARRANTIES OR
+ * CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ * LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ * FOR A PARTICULAR PURPOSE, MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ * See the Apache Version 2.0 License for specific language governing
+ * permissions and limitations under the License.
+ */
+
+/*
+ * filename: nas_ndi_stat_xlate_bench.cpp
+ *
+ * Microbenchmark of the NDI to SAI port counter id translation. The
+ * translation pairs below are the std::map contents the translators used
+ * before the dense tables; every dense result is checked against them and
+ * the std::map lookup is timed against the per id and batch translation.
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <map>
+#include <set>
+#include <vector>
+#include <stdio.h>
+
+extern "C"{
+#include "std_error_codes.h"
+#include  "nas_ndi_utils.h"
+#include  "dell-interface.h"
+#include  "ietf-interfaces.h"
+#include  "saiport.h"
+#include  "saivlan.h"
+}
+
+#define XLATE_BENCH_ROUNDS      200000
+
+/*  Ids this close to a translated one are checked to be rejected */
+#define XLATE_BENCH_MARGIN      64
+
+static const std::map<ndi_stat_id_t, sai_port_stat_t> bench_if_map = {
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_IF_OUT_QLEN  ,SAI_PORT_STAT_IF_OUT_QLEN },
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_ETHER_DROP_EVENTS  ,SAI_PORT_STAT_ETHER_STATS_DROP_EVENTS },
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_ETHER_MULTICAST_PKTS  ,SAI_PORT_STAT_ETHER_STATS_MULTICAST_PKTS },
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_ETHER_BROADCAST_PKTS  ,SAI_PORT_STAT_ETHER_STATS_BROADCAST_PKTS },
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_ETHER_UNDERSIZE_PKTS  ,SAI_PORT_STAT_ETHER_STATS_UNDERSIZE_PKTS },
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_ETHER_FRAGMENTS  ,SAI_PORT_STAT_ETHER_STATS_FRAGMENTS },
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_ETHER_OVERSIZE_PKTS  ,SAI_PORT_STAT_ETHER_STATS_OVERSIZE_PKTS },
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_ETHER_RX_OVERSIZE_PKTS  ,SAI_PORT_STAT_ETHER_RX_OVERSIZE_PKTS },
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_ETHER_TX_OVERSIZE_PKTS  ,SAI_PORT_STAT_ETHER_TX_OVERSIZE_PKTS },
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_ETHER_JABBERS  ,SAI_PORT_STAT_ETHER_STATS_JABBERS },
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_ETHER_OCTETS  ,SAI_PORT_STAT_ETHER_STATS_OCTETS },
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_ETHER_PKTS  ,SAI_PORT_STAT_ETHER_STATS_PKTS },
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_ETHER_COLLISIONS  ,SAI_PORT_STAT_ETHER_STATS_COLLISIONS },
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_ETHER_CRC_ALIGN_ERRORS  ,SAI_PORT_STAT_ETHER_STATS_CRC_ALIGN_ERRORS },
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_ETHER_TX_NO_ERRORS  ,SAI_PORT_STAT_ETHER_STATS_TX_NO_ERRORS },
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_ETHER_RX_NO_ERRORS  ,SAI_PORT_STAT_ETHER_STATS_RX_NO_ERRORS },
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_GREEN_DISCARD_DROPPED_PACKETS  ,SAI_PORT_STAT_GREEN_DISCARD_DROPPED_PACKETS },
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_GREEN_DISCARD_DROPPED_BYTES  ,SAI_PORT_STAT_GREEN_DISCARD_DROPPED_BYTES },
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_YELLOW_DISCARD_DROPPED_PACKETS  ,SAI_PORT_STAT_YELLOW_DISCARD_DROPPED_PACKETS },
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_YELLOW_DISCARD_DROPPED_BYTES  ,SAI_PORT_STAT_YELLOW_DISCARD_DROPPED_BYTES },
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_RED_DISCARD_DROPPED_PACKETS  ,SAI_PORT_STAT_RED_DISCARD_DROPPED_PACKETS },
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_RED_DISCARD_DROPPED_BYTES  ,SAI_PORT_STAT_RED_DISCARD_DROPPED_BYTES },
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_DISCARD_DROPPED_PACKETS  ,SAI_PORT_STAT_DISCARD_DROPPED_PACKETS },
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_DISCARD_DROPPED_BYTES  ,SAI_PORT_STAT_DISCARD_DROPPED_BYTES },
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_ETHER_IN_PKTS_64_OCTETS  ,SAI_PORT_STAT_ETHER_IN_PKTS_64_OCTETS },
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_ETHER_IN_PKTS_65_TO_127_OCTETS  ,SAI_PORT_STAT_ETHER_IN_PKTS_65_TO_127_OCTETS },
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_ETHER_IN_PKTS_128_TO_255_OCTETS  ,SAI_PORT_STAT_ETHER_IN_PKTS_128_TO_255_OCTETS },
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_ETHER_IN_PKTS_256_TO_511_OCTETS  ,SAI_PORT_STAT_ETHER_IN_PKTS_256_TO_511_OCTETS },
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_ETHER_IN_PKTS_512_TO_1023_OCTETS  ,SAI_PORT_STAT_ETHER_IN_PKTS_512_TO_1023_OCTETS },
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_ETHER_IN_PKTS_1024_TO_1518_OCTETS  ,SAI_PORT_STAT_ETHER_IN_PKTS_1024_TO_1518_OCTETS },
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_ETHER_IN_PKTS_1519_TO_2047_OCTETS  ,SAI_PORT_STAT_ETHER_IN_PKTS_1519_TO_2047_OCTETS },
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_ETHER_IN_PKTS_2048_TO_4095_OCTETS  ,SAI_PORT_STAT_ETHER_IN_PKTS_2048_TO_4095_OCTETS },
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_ETHER_IN_PKTS_4096_TO_9216_OCTETS  ,SAI_PORT_STAT_ETHER_IN_PKTS_4096_TO_9216_OCTETS },
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_ETHER_IN_PKTS_9217_TO_16383_OCTETS  ,SAI_PORT_STAT_ETHER_IN_PKTS_9217_TO_16383_OCTETS },
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_ETHER_OUT_PKTS_64_OCTETS  ,SAI_PORT_STAT_ETHER_OUT_PKTS_64_OCTETS },
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_ETHER_OUT_PKTS_65_TO_127_OCTETS  ,SAI_PORT_STAT_ETHER_OUT_PKTS_65_TO_127_OCTETS },
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_ETHER_OUT_PKTS_128_TO_255_OCTETS  ,SAI_PORT_STAT_ETHER_OUT_PKTS_128_TO_255_OCTETS },
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_ETHER_OUT_PKTS_256_TO_511_OCTETS  ,SAI_PORT_STAT_ETHER_OUT_PKTS_256_TO_511_OCTETS },
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_ETHER_OUT_PKTS_512_TO_1023_OCTETS  ,SAI_PORT_STAT_ETHER_OUT_PKTS_512_TO_1023_OCTETS },
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_ETHER_OUT_PKTS_1024_TO_1518_OCTETS  ,SAI_PORT_STAT_ETHER_OUT_PKTS_1024_TO_1518_OCTETS },
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_ETHER_OUT_PKTS_1519_TO_2047_OCTETS  ,SAI_PORT_STAT_ETHER_OUT_PKTS_1519_TO_2047_OCTETS },
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_ETHER_OUT_PKTS_2048_TO_4095_OCTETS  ,SAI_PORT_STAT_ETHER_OUT_PKTS_2048_TO_4095_OCTETS },
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_ETHER_OUT_PKTS_4096_TO_9216_OCTETS  ,SAI_PORT_STAT_ETHER_OUT_PKTS_4096_TO_9216_OCTETS },
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_ETHER_OUT_PKTS_9217_TO_16383_OCTETS  ,SAI_PORT_STAT_ETHER_OUT_PKTS_9217_TO_16383_OCTETS },
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_CURRENT_OCCUPANCY_BYTES ,SAI_PORT_STAT_CURR_OCCUPANCY_BYTES },
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_WATERMARK_BYTES , SAI_PORT_STAT_WATERMARK_BYTES},
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_SHARED_CURRENT_OCCUPANCY_BYTES ,SAI_PORT_STAT_SHARED_CURR_OCCUPANCY_BYTES },
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_SHARED_WATERMARK_BYTES , SAI_PORT_STAT_SHARED_WATERMARK_BYTES},
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_PAUSE_RX_PKTS , SAI_PORT_STAT_PAUSE_RX_PKTS},
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_PAUSE_TX_PKTS , SAI_PORT_STAT_PAUSE_TX_PKTS},
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_PFC_0_RX_PKTS , SAI_PORT_STAT_PFC_0_RX_PKTS},
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_PFC_0_TX_PKTS , SAI_PORT_STAT_PFC_0_TX_PKTS},
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_PFC_1_RX_PKTS , SAI_PORT_STAT_PFC_1_RX_PKTS},
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_PFC_1_TX_PKTS , SAI_PORT_STAT_PFC_1_TX_PKTS},
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_PFC_2_RX_PKTS , SAI_PORT_STAT_PFC_2_RX_PKTS},
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_PFC_2_TX_PKTS , SAI_PORT_STAT_PFC_2_TX_PKTS},
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_PFC_3_RX_PKTS , SAI_PORT_STAT_PFC_3_RX_PKTS},
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_PFC_3_TX_PKTS , SAI_PORT_STAT_PFC_3_TX_PKTS},
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_PFC_4_RX_PKTS , SAI_PORT_STAT_PFC_4_RX_PKTS},
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_PFC_4_TX_PKTS , SAI_PORT_STAT_PFC_4_TX_PKTS},
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_PFC_5_RX_PKTS , SAI_PORT_STAT_PFC_5_RX_PKTS},
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_PFC_5_TX_PKTS , SAI_PORT_STAT_PFC_5_TX_PKTS},
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_PFC_6_RX_PKTS , SAI_PORT_STAT_PFC_6_RX_PKTS},
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_PFC_6_TX_PKTS , SAI_PORT_STAT_PFC_6_TX_PKTS},
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_PFC_7_RX_PKTS , SAI_PORT_STAT_PFC_7_RX_PKTS},
+    { DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_PFC_7_TX_PKTS , SAI_PORT_STAT_PFC_7_TX_PKTS},
+    { IF_INTERFACES_STATE_INTERFACE_STATISTICS_IN_OCTETS  ,SAI_PORT_STAT_IF_IN_OCTETS },
+    { IF_INTERFACES_STATE_INTERFACE_STATISTICS_IN_UNICAST_PKTS  ,SAI_PORT_STAT_IF_IN_UCAST_PKTS },
+    { IF_INTERFACES_STATE_INTERFACE_STATISTICS_IN_BROADCAST_PKTS  ,SAI_PORT_STAT_IF_IN_BROADCAST_PKTS },
+    { IF_INTERFACES_STATE_INTERFACE_STATISTICS_IN_MULTICAST_PKTS  ,SAI_PORT_STAT_IF_IN_MULTICAST_PKTS },
+    { IF_INTERFACES_STATE_INTERFACE_STATISTICS_IN_DISCARDS  ,SAI_PORT_STAT_IF_IN_DISCARDS },
+    { IF_INTERFACES_STATE_INTERFACE_STATISTICS_IN_ERRORS  ,SAI_PORT_STAT_IF_IN_ERRORS },
+    { IF_INTERFACES_STATE_INTERFACE_STATISTICS_IN_UNKNOWN_PROTOS  ,SAI_PORT_STAT_IF_IN_UNKNOWN_PROTOS },
+    { IF_INTERFACES_STATE_INTERFACE_STATISTICS_OUT_OCTETS  ,SAI_PORT_STAT_IF_OUT_OCTETS },
+    { IF_INTERFACES_STATE_INTERFACE_STATISTICS_OUT_UNICAST_PKTS  ,SAI_PORT_STAT_IF_OUT_UCAST_PKTS },
+    { IF_INTERFACES_STATE_INTERFACE_STATISTICS_OUT_BROADCAST_PKTS  ,SAI_PORT_STAT_IF_OUT_BROADCAST_PKTS },
+    { IF_INTERFACES_STATE_INTERFACE_STATISTICS_OUT_MULTICAST_PKTS  ,SAI_PORT_STAT_IF_OUT_MULTICAST_PKTS },
+    { IF_INTERFACES_STATE_INTERFACE_STATISTICS_OUT_DISCARDS  ,SAI_PORT_STAT_IF_OUT_DISCARDS },
+    { IF_INTERFACES_STATE_INTERFACE_STATISTICS_OUT_ERRORS  ,SAI_PORT_STAT_IF_OUT_ERRORS },
+};
+
+static const std::map<ndi_stat_id_t, sai_vlan_stat_t> bench_vlan_map = {
+    {  IF_INTERFACES_STATE_INTERFACE_STATISTICS_IN_OCTETS ,SAI_VLAN_STAT_IN_OCTETS },
+    {  IF_INTERFACES_STATE_INTERFACE_STATISTICS_IN_UNICAST_PKTS ,SAI_VLAN_STAT_IN_UCAST_PKTS },
+    {  IF_INTERFACES_STATE_INTERFACE_STATISTICS_IN_DISCARDS ,SAI_VLAN_STAT_IN_DISCARDS},
+    {  IF_INTERFACES_STATE_INTERFACE_STATISTICS_IN_ERRORS ,SAI_VLAN_STAT_IN_ERRORS},
+    {  IF_INTERFACES_STATE_INTERFACE_STATISTICS_IN_UNKNOWN_PROTOS ,SAI_VLAN_STAT_IN_UNKNOWN_PROTOS},
+    {  IF_INTERFACES_STATE_INTERFACE_STATISTICS_OUT_OCTETS ,SAI_VLAN_STAT_OUT_OCTETS},
+    {  IF_INTERFACES_STATE_INTERFACE_STATISTICS_OUT_UNICAST_PKTS ,SAI_VLAN_STAT_OUT_UCAST_PKTS },
+    {  IF_INTERFACES_STATE_INTERFACE_STATISTICS_OUT_DISCARDS ,SAI_VLAN_STAT_OUT_DISCARDS },
+    {  IF_INTERFACES_STATE_INTERFACE_STATISTICS_OUT_ERRORS ,SAI_VLAN_STAT_OUT_ERRORS },
+    {  DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_IF_OUT_QLEN ,SAI_VLAN_STAT_OUT_QLEN },
+    {  DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_IN_PKTS ,SAI_VLAN_STAT_IN_PACKETS },
+    {  DELL_IF_IF_INTERFACES_STATE_INTERFACE_STATISTICS_OUT_PKTS ,SAI_VLAN_STAT_OUT_PACKETS },
+};
+
+template <typename T>
+static std::vector<ndi_stat_id_t> bench_map_ids(const std::map<ndi_stat_id_t, T> &m)
+{
+    std::vector<ndi_stat_id_t> ids;
+    for (auto &it : m) ids.push_back(it.first);
+    return ids;
+}
+
+/*  Ids near the translated ones, including the holes inside a dense
+ *  range, that are missing from the map and must be rejected
+ */
+template <typename T>
+static std::set<ndi_stat_id_t> bench_unmapped_ids(const std::map<ndi_stat_id_t, T> &m)
+{
+    std::set<ndi_stat_id_t> ids;
+    for (auto &it : m) {
+        ndi_stat_id_t lo = (it.first > XLATE_BENCH_MARGIN) ? it.first - XLATE_BENCH_MARGIN : 0;
+        for (ndi_stat_id_t id = lo; id <= it.first + XLATE_BENCH_MARGIN; ++id) {
+            if (m.find(id) == m.end()) ids.insert(id);
+        }
+    }
+    return ids;
+}
+
+static void bench_report(const char *name, size_t translations,
+                         std::chrono::steady_clock::duration elapsed)
+{
+    double secs = std::chrono::duration<double>(elapsed).count();
+    printf("%-24s %12.0f translations/s\n", name, translations / secs);
+}
+
+TEST(nas_ndi_stat_xlate_bench, if_dense_matches_map) {
+    std::vector<ndi_stat_id_t> ids = bench_map_ids(bench_if_map);
+    std::vector<sai_port_stat_t> sai_ids(ids.size());
+
+    ASSERT_TRUE(ndi_to_sai_if_stats_multi(&ids[0], &sai_ids[0], ids.size()));
+    for (size_t ix = 0; ix < ids.size(); ++ix) {
+        sai_port_stat_t sai_id;
+        EXPECT_TRUE(ndi_to_sai_if_stats(ids[ix], &sai_id));
+        EXPECT_EQ(bench_if_map.at(ids[ix]), sai_id);
+        EXPECT_EQ(bench_if_map.at(ids[ix]), sai_ids[ix]);
+    }
+
+    for (auto id : bench_unmapped_ids(bench_if_map)) {
+        sai_port_stat_t sai_id;
+        EXPECT_FALSE(ndi_to_sai_if_stats(id, &sai_id)) << "id " << id;
+        ids.push_back(id);
+        sai_ids.resize(ids.size());
+        EXPECT_FALSE(ndi_to_sai_if_stats_multi(&ids[0], &sai_ids[0], ids.size()));
+        ids.pop_back();
+    }
+    sai_port_stat_t sai_id;
+    EXPECT_FALSE(ndi_to_sai_if_stats((ndi_stat_id_t)-1, &sai_id));
+}
+
+TEST(nas_ndi_stat_xlate_bench, vlan_dense_matches_map) {
+    std::vector<ndi_stat_id_t> ids = bench_map_ids(bench_vlan_map);
+    std::vector<sai_vlan_stat_t> sai_ids(ids.size());
+
+    ASSERT_TRUE(ndi_to_sai_vlan_stats_multi(&ids[0], &sai_ids[0], ids.size()));
+    for (size_t ix = 0; ix < ids.size(); ++ix) {
+        sai_vlan_stat_t sai_id;
+        EXPECT_TRUE(ndi_to_sai_vlan_stats(ids[ix], &sai_id));
+        EXPECT_EQ(bench_vlan_map.at(ids[ix]), sai_id);
+        EXPECT_EQ(bench_vlan_map.at(ids[ix]), sai_ids[ix]);
+    }
+
+    for (auto id : bench_unmapped_ids(bench_vlan_map)) {
+        sai_vlan_stat_t sai_id;
+        EXPECT_FALSE(ndi_to_sai_vlan_stats(id, &sai_id)) << "id " << id;
+    }
+}
+
+TEST(nas_ndi_stat_xlate_bench, translations_per_second) {
+    std::vector<ndi_stat_id_t> bench_ids = bench_map_ids(bench_if_map);
+    std::vector<sai_port_stat_t> sai_ids(bench_ids.size());
+    size_t n = bench_ids.size() * XLATE_BENCH_ROUNDS;
+    uint64_t sink = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < XLATE_BENCH_ROUNDS; ++r) {
+        for (size_t ix = 0; ix < bench_ids.size(); ++ix) {
+            sai_ids[ix] = bench_if_map.find(bench_ids[ix])->second;
+        }
+        sink += sai_ids[r % sai_ids.size()];
+    }
+    bench_report("std::map", n, std::chrono::steady_clock::now() - start);
+
+    start = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < XLATE_BENCH_ROUNDS; ++r) {
+        for (size_t ix = 0; ix < bench_ids.size(); ++ix) {
+            ndi_to_sai_if_stats(bench_ids[ix], &sai_ids[ix]);
+        }
+        sink += sai_ids[r % sai_ids.size()];
+    }
+    bench_report("dense, per id", n, std::chrono::steady_clock::now() - start);
+
+    start = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < XLATE_BENCH_ROUNDS; ++r) {
+        ndi_to_sai_if_stats_multi(&bench_ids[0], &sai_ids[0], bench_ids.size());
+        sink += sai_ids[r % sai_ids.size()];
+    }
+    bench_report("dense, batch", n, std::chrono::steady_clock::now() - start);
+
+    EXPECT_NE(0, sink);
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2016 Dell Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License. You may obtain
+ * a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * THIS CODE IS PROVIDED ON AN *AS IS* BASIS, WITHOUT WARRANTIES OR
+ * CONDITIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ * LIMITATION ANY IMPLIED WARRANTIES OR CONDITIONS OF TITLE, FITNESS
+ * FOR A PARTICULAR PURPOSE, MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ * See the Apache Version 2.0 License for specific language governing
+ * permissions and limitations under the License.
+ */
+
+/*
+ * filename: nas_ndi_ut_fixture.h
+ *
+ * Test fixture for unit tests that replace SAI API calls with mocks. NDI
+ * comes up once for the test case and every test starts with the mocks
+ * installed, so the tests can run in any order.
+ */
+
+#ifndef _NAS_NDI_UT_FIXTURE_H_
+#define _NAS_NDI_UT_FIXTURE_H_
+
+#include <gtest/gtest.h>
+
+extern "C"{
+#include "std_error_codes.h"
+#include  "nas_ndi_int.h"
+#include  "nas_ndi_init.h"
+}
+
+class nas_ndi_ut_fixture : public ::testing::Test {
+protected:
+    static void SetUpTestCase() {
+        init_rc() = nas_ndi_init();
+    }
+
+    virtual void SetUp() {
+        ASSERT_EQ(STD_ERR_OK, init_rc());
+        nas_ndi_db_t *ndi_db_ptr = ndi_db_ptr_get(0);
+        ASSERT_TRUE(ndi_db_ptr != NULL);
+        mock_install(ndi_db_ptr);
+    }
+
+    /*  Point the SAI API tables at the mocks, called before every test and
+     *  must leave already installed mocks alone
+     */
+    virtual void mock_install(nas_ndi_db_t *ndi_db_ptr) = 0;
+
+    static t_std_error &init_rc() {
+        static t_std_error rc = STD_ERR_OK;
+        return rc;
+    }
+};
+
+#endif  /*  _NAS_NDI_UT_FIXTURE_H_ */